@@ -0,0 +1,45 @@
+#pragma once
+#include "core/graph.h"
+
+namespace infini {
+
+/**
+ * @brief A compiled model is one file holding an optimized and planned
+ * graph, so a process can go from file to a runnable graph without
+ * importing, optimizing, planning or tuning it again.
+ *
+ * The file starts with a header, then lists the tensors (shape, data type,
+ * role, layout and arena offset) and the operators in execution order with
+ * their attributes and PerfRecords. The weights follow, starting at a
+ * multiple of compiledModelAlignment so that they can be mapped directly.
+ * Operators with attributes that have no encoding halt with IT_TODO_HALT.
+ */
+constexpr size_t compiledModelAlignment = 4096;
+
+/**
+ * @brief Names of the graph inputs and outputs, in order, e.g. the ONNX
+ * names used by the Python frontend.
+ */
+using NamedTensors = vector<std::pair<string, Tensor>>;
+
+/**
+ * @brief Write a graph allocated by dataMalloc(), with the PerfRecords of
+ * its operators from PerfEngine, to `path`.
+ */
+void saveCompiledModel(const Graph &graph, const string &path,
+                       const NamedTensors &inputs = {},
+                       const NamedTensors &outputs = {});
+
+/**
+ * @brief Read a graph written by saveCompiledModel() into `runtime`. The
+ * graph keeps the saved operator order and memory plan, and the saved
+ * PerfRecords are added to PerfEngine. On CPU runtimes the weights are
+ * mapped from the file without copying (see GraphObj::mapWeight());
+ * otherwise they are copied into the weight arena. Named inputs
+ * and outputs are returned through `inputs` and `outputs` when given.
+ */
+Graph loadCompiledModel(const Runtime &runtime, const string &path,
+                        NamedTensors *inputs = nullptr,
+                        NamedTensors *outputs = nullptr);
+
+} // namespace infini
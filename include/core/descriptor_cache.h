@@ -0,0 +1,85 @@
+#pragma once
+#include "core/common.h"
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace infini {
+
+/**
+ * @brief A shared infiniop descriptor and the workspace it needs. The
+ * descriptor is destroyed when neither the cache nor an operator holds it.
+ */
+struct InfiniopDesc {
+    std::shared_ptr<void> desc;
+    size_t workspaceSize = 0;
+};
+
+/**
+ * @brief Least-recently-used cache of infiniop descriptors, keyed by the
+ * runtime, operator type and attributes, and the data types and shapes of
+ * the inputs and outputs (see OperatorObj::reuseInfiniOpDesc()). Operators
+ * that are re-specialized to shapes seen before take the cached descriptor
+ * instead of creating one.
+ */
+class DescriptorCache {
+  public:
+    using Key = vector<int64_t>;
+
+    DescriptorCache() = default;
+    // DescriptorCache is singleton
+    DescriptorCache(DescriptorCache &other) = delete;
+    DescriptorCache &operator=(DescriptorCache const &) = delete;
+
+    static DescriptorCache &getInstance() {
+        static DescriptorCache instance;
+        return instance;
+    }
+
+    /**
+     * @brief Find the descriptor for `key` and mark it as the most recently
+     * used, counting a hit. Returns nullopt if there is none.
+     */
+    optional<InfiniopDesc> lookup(const Key &key);
+
+    /**
+     * @brief Add a newly created descriptor, counting a miss, and evict the
+     * least recently used ones beyond the capacity.
+     */
+    void insert(const Key &key, const InfiniopDesc &desc);
+
+    /**
+     * @brief Set the maximum number of descriptors kept, evicting the least
+     * recently used ones if needed. 0 disables caching.
+     */
+    void setCapacity(size_t capacity);
+    size_t getCapacity() const { return capacity; }
+    size_t size() const;
+
+    size_t getHits() const { return hits; }
+    size_t getMisses() const { return misses; }
+    size_t getEvictions() const { return evictions; }
+
+    /**
+     * @brief Drop every descriptor and reset the counters.
+     */
+    void clear();
+
+  private:
+    struct KeyHash {
+        size_t operator()(const Key &key) const;
+    };
+    using Entry = std::pair<Key, InfiniopDesc>;
+
+    void evict();
+
+    mutable std::mutex mutex;
+    size_t capacity = 1024;
+    size_t hits = 0, misses = 0, evictions = 0;
+    // The most recently used first.
+    std::list<Entry> entries;
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+};
+
+} // namespace infini
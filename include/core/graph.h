@@ -1,4 +1,5 @@
 #pragma once
+#include "core/graph_pass.h"
 #include "core/lazy_allocator.h"
 #include "core/operator.h"
 #include "core/tensor.h"
@@ -7,11 +8,15 @@
 
 namespace infini {
 
+class MappedFile;
+
 class GraphObj : public Object {
   protected:
     Runtime runtime;
-    TensorVec tensors;
-    OpVec ops;
+    // Removing a tensor or an operator only clears its slot; compact()
+    // drops the cleared slots before the vectors are read again.
+    mutable TensorVec tensors;
+    mutable OpVec ops;
     LazyAllocator allocator;
 
   public:
@@ -30,17 +35,28 @@ class GraphObj : public Object {
     Tensor cloneTensor(const Tensor &tensor) {
         return addTensor(tensor->clone(runtime));
     }
-    void removeOperator(Operator op) {
-        auto it = std::find(ops.begin(), ops.end(), op);
-        if (it != ops.end())
-            ops.erase(it);
-    }
+    /**
+     * @brief Remove an operator without disconnecting it, in O(1).
+     */
+    void removeOperator(Operator op);
 
-    void removeTensor(Tensor tensor) {
-        auto it = std::find(tensors.begin(), tensors.end(), tensor);
-        if (it != tensors.end())
-            tensors.erase(it);
+    /**
+     * @brief Remove a tensor in O(1).
+     */
+    void removeTensor(Tensor tensor);
+
+    bool hasOperator(const Operator &op) const {
+        return opSlot.count(op.get());
     }
+    bool hasTensor(const Tensor &tensor) const {
+        return tensorSlot.count(tensor.get());
+    }
+
+    /**
+     * @brief Disconnect an operator from its inputs, outputs and neighbours,
+     * then remove it. Its outputs stay in the graph without a source.
+     */
+    void eraseOperator(const Operator &op);
 
     void deleteConnection(Tensor tensor, Operator op);
     void addConnection(Tensor tensor, Operator op);
@@ -52,10 +68,23 @@ class GraphObj : public Object {
         return opClone;
     }
 
-    const TensorVec &getTensors() const { return tensors; }
-    const OpVec &getOperators() const { return ops; }
+    const TensorVec &getTensors() const {
+        compact();
+        return tensors;
+    }
+    const OpVec &getOperators() const {
+        compact();
+        return ops;
+    }
     OpVec getComputeOps() const;
-    Tensor getTensor(int) const;
+    /**
+     * @brief Find a tensor by its FUID, or return nullptr.
+     */
+    Tensor getTensor(int fuid) const;
+    /**
+     * @brief Find an operator by its GUID, or return nullptr.
+     */
+    Operator getOperator(int guid) const;
 
     /**
      * Sort the nodes in topological order.
@@ -65,12 +94,108 @@ class GraphObj : public Object {
      */
     bool topo_sort();
 
-    void optimize();
+    /**
+     * @brief Run the registered graph passes (see GraphPassRegistry) until
+     * the graph stops changing. With `dump`, the graph is printed after each
+     * pass that changes it. Per-pass statistics are kept in getPassStats().
+     */
+    void optimize(bool dump = false);
+
+    const vector<PassStat> &getPassStats() const { return passStats; }
+
+    /**
+     * @brief Replace DequantizeLinear -> Conv/MatMul -> QuantizeLinear chains
+     * with QLinearConv/QLinearMatMul. A Conv bias is folded only if its
+     * scale data equals xScale * wScale and its zero point is 0. A MatMul
+     * weight that holds data is transposed once, for the int8 dot products
+     * of QLinearMatMul. Returns true if the graph is changed.
+     */
+    bool foldQuantizeDequantize();
+
+    /**
+     * @brief Evaluate operators whose inputs are all weights once, on the
+     * CPU, and turn their outputs into weights. The weight arena is then
+     * laid out again without the weights that are no longer used. Returns
+     * true if the graph is changed.
+     */
+    bool foldConstants();
+
+    /**
+     * @brief Fold inference BatchNorm into the weight and bias of the
+     * preceding Conv, ConvTranspose, Gemm or 2-D MatMul. ConvTranspose has
+     * no bias input, so its bias is added by a per-channel Add. The folded
+     * weights are moved into the weight arena. Returns true if the graph is
+     * changed.
+     */
+    bool foldBatchNorm();
+
+    /**
+     * @brief Bytes of the weight arena, 0 before the first dataMalloc().
+     */
+    size_t getWeightBytes() const { return allocator.getWeightPeak(); }
 
+    /**
+     * @brief Reorder the operators to lower the peak of activation memory
+     * planned by dataMalloc(), which calls this once for every new set of
+     * operators. Graphs of up to 64 operators are searched exactly unless
+     * they have too many valid orders; larger ones are scheduled greedily.
+     * The new order is kept only if the allocator peak drops, and the old
+     * peak is shown by the allocator info. Returns true if the order is
+     * changed.
+     */
+    bool scheduleForMemory();
+
+    /**
+     * @brief Bytes of the activation arena planned by the last dataMalloc().
+     */
+    size_t getActivationBytes() const { return allocator.getPeak(); }
+
+    /**
+     * @brief Offset of a tensor in the weight arena if it is a weight, or
+     * else in the activation arena, after dataMalloc().
+     */
+    size_t getArenaOffset(const Tensor &tensor);
+
+    /**
+     * @brief Infer the output shapes again after input shapes change. The
+     * infiniop descriptors of the operators are re-specialized to the new
+     * shapes through DescriptorCache.
+     */
     void shape_infer();
 
     void dataMalloc(bool useNaiveAllocator = false, size_t memPoolSize = 0);
 
+    /**
+     * @brief Allocate arenas of the given sizes and bind each tensor of
+     * getTensors() to the offset at the same index, keeping the current
+     * operator order instead of sorting and planning. `weights` holds the
+     * whole weight arena on the host; mapped weights are left as they are.
+     * Used to restore a compiled model.
+     */
+    void dataMallocWithPlan(size_t weightBytes, size_t activationBytes,
+                            const vector<size_t> &offsets,
+                            const void *weights);
+
+    /**
+     * @brief Point a weight at `offset` in a mapped file instead of the
+     * weight arena, without copying. CPU runtimes only; dataMalloc() then
+     * leaves the weight out of the arena. The graph keeps the mapping alive.
+     * Returns false, leaving the weight alone, if the data is not aligned
+     * to its element size; the caller then copies it instead.
+     */
+    bool mapWeight(const Tensor &tensor,
+                   const std::shared_ptr<MappedFile> &file, size_t offset);
+
+    bool isMappedWeight(const Tensor &tensor) const {
+        return mappedWeights.count(tensor.get());
+    }
+
+    /**
+     * @brief Read all the pages of the mapped weights from disk in parallel
+     * instead of on first use.
+     */
+    void prefetchWeights() const;
+
     Tensor cloneKV(Tensor &tensor);
 
     void freeHeap();
@@ -100,7 +225,7 @@ class GraphObj : public Object {
      */
     inline TensorVec getInputs() const {
         TensorVec ret;
-        for (const auto &t : tensors)
+        for (const auto &t : getTensors())
             if (!t->getSource())
                 ret.emplace_back(t);
         return ret;
@@ -111,7 +236,7 @@ class GraphObj : public Object {
      */
     inline TensorVec getOutputs() const {
         TensorVec ret;
-        for (const auto &t : tensors)
+        for (const auto &t : getTensors())
             if (t->getTargets().empty())
                 ret.emplace_back(t);
         return ret;
@@ -120,20 +245,58 @@ class GraphObj : public Object {
     bool checkValid() const;
 
   private:
+    /**
+     * @brief Move every weight into a freshly laid out weight arena.
+     */
+    void repackWeights();
+
     /**
      * @brief Add reverse connections and Op relationship in ctor.
      */
     void addOperatorAndConnect(const Operator &op);
 
+    /**
+     * @brief Drop the slots cleared by removeTensor() and removeOperator().
+     * Linear, but only after removals, so removal stays amortized O(1).
+     */
+    void compact() const;
+
+    /**
+     * @brief Record the slot of every operator after `ops` is reordered.
+     */
+    void reindexOperators();
+
+    // Slot of every tensor and operator in `tensors` and `ops`.
+    mutable std::unordered_map<TensorObj *, size_t> tensorSlot;
+    mutable std::unordered_map<OperatorObj *, size_t> opSlot;
+    // First tensor added with each FUID, and operators by GUID.
+    std::unordered_map<UidBaseType, TensorObj *> fuidIndex;
+    std::unordered_map<UidBaseType, OperatorObj *> guidIndex;
+    mutable size_t removedTensors = 0, removedOps = 0;
+
+    // Files that mapped weights point into, and those weights.
+    vector<std::shared_ptr<MappedFile>> mappedFiles;
+    std::unordered_set<TensorObj *> mappedWeights;
+
     /**
      * @brief If the nodes is sorted in topological order.
      */
     bool sorted;
 
+    /**
+     * @brief If the operators are in the order chosen by scheduleForMemory().
+     */
+    bool scheduled = false;
+
     /**
      * @brief If the weight tensors are allocated.
      */
     bool weightAllocated = false;
+
+    /**
+     * @brief Statistics of the last optimize() call.
+     */
+    vector<PassStat> passStats;
 };
 
 } // namespace infini
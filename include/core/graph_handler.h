@@ -1,8 +1,11 @@
 ﻿#pragma once
 
+#include "core/compiled_model.h"
 #include "core/graph.h"
 #include "core/operator.h"
 #include "core/runtime.h"
+#include "core/sequence_buckets.h"
+#include "utils/mapped_file.h"
 #include <cstdint>
 #include <iostream>
 
@@ -15,6 +18,21 @@ namespace infini {
 class GraphHandlerObj {
     Graph g;
 
+    // Observed [min, max] of float activations, keyed by tensor fuid.
+    std::map<int, std::pair<float, float>> calibrationRanges;
+
+    // Files mapped by map_weight(), and the weights to copy from them once
+    // allocated: all of them on other runtimes than CPU, and misaligned
+    // ones on CPU.
+    std::map<string, std::shared_ptr<MappedFile>> mappedFiles;
+    vector<std::tuple<Tensor, std::shared_ptr<MappedFile>, size_t>>
+        pendingWeights;
+
+    // Set by specialize(); dropped when the graph is replaced or optimized.
+    std::unique_ptr<SymbolicGraph> symbolic;
+    // Set by set_buckets() on top of `symbolic`, and dropped with it.
+    std::unique_ptr<SequenceBuckets> buckets;
+
   public:
     GraphHandlerObj(Runtime runtime)
         : g(make_ref<GraphObj>(std::move(runtime))) {}
@@ -35,6 +53,12 @@ class GraphHandlerObj {
                   std::string matmul_compute_type = "default");
     Tensor gemm(Tensor a, Tensor b, Tensor y, Tensor c, float alpha, float beta,
                 bool transA, bool transB);
+    Tensor quantizedMatmul(Tensor a, Tensor b, Tensor scale, Tensor zeroPoint,
+                           Tensor y, int bits, int groupSize);
+    Tensor quantizeLinear(Tensor input, Tensor scale, Tensor zeroPoint,
+                          Tensor output, int axis, int blockSize);
+    Tensor dequantizeLinear(Tensor input, Tensor scale, Tensor zeroPoint,
+                            Tensor output, int axis, int blockSize);
     Tensor batchNormalization(Tensor input, Tensor output, Tensor mean,
                               Tensor var, Tensor scale, Tensor bias,
                               float momentum, float eps, bool training);
@@ -42,7 +66,7 @@ class GraphHandlerObj {
                               Tensor bias, float eps, int axis, int stash_type);
     Tensor instanceNormalization(Tensor input, Tensor output, Tensor scale,
                                  Tensor bias, float eps);
-    Tensor rmsNorm(Tensor input, Tensor weight, Tensor output);
+    Tensor rmsNorm(Tensor input, Tensor weight, Tensor output, float eps);
 
     Tensor maxPool(Tensor input, Tensor output, int kh, int kw, int dh, int dw,
                    int ph, int pw, int sh, int sw, int ceilMode);
@@ -130,28 +154,147 @@ class GraphHandlerObj {
 
     inline bool topo_sort() { return g->topo_sort(); }
 
-    inline void optimize() { g->optimize(); }
+    inline void optimize(bool dump = false) {
+        buckets.reset();
+        symbolic.reset();
+        g->optimize(dump);
+    }
+
+    /**
+     * @brief Per-pass (name, runs, changes, ops removed, time in ms, note) of
+     * the last optimize() call.
+     */
+    vector<std::tuple<string, int, int, int, double, string>>
+    get_pass_stats() const;
 
     inline void shape_infer() { g->shape_infer(); }
 
     void change_shape(const vector<int> &shape, int tensorId);
     //------ runtime
 
-    inline void data_malloc(bool useNaiveAllocator = false,
-                            size_t memPoolSize = 0) {
-        g->dataMalloc(useNaiveAllocator, memPoolSize);
-    }
+    void data_malloc(bool useNaiveAllocator = false, size_t memPoolSize = 0);
+
+    /**
+     * @brief Take the data of a weight from `offset` in the file at `path`,
+     * e.g. ONNX external data. Each file is mapped once. On CPU runtimes
+     * the weight points into the mapping if it is aligned (see
+     * GraphObj::mapWeight()); otherwise it is copied from the mapping by the
+     * next data_malloc().
+     */
+    void map_weight(Tensor tensor, const string &path, size_t offset);
+
+    inline void prefetch_weights() { g->prefetchWeights(); }
 
     inline Tensor clone_KV(Tensor &tensor) { return g->cloneKV(tensor); }
 
     inline void free_heap() { g->freeHeap(); }
 
-    inline void tune() { g->getRuntime()->run(g, true); }
+    /**
+     * @brief Tune the kernels of the graph within `budget` ms of wall time
+     * (0 for no limit), with `threads` operators at a time on CPU (see
+     * Tuner::tuneGraph()).
+     */
+    void tune(double budget, int threads);
 
     inline void run() { g->getRuntime()->run(g); }
 
     inline double get_perf_time() { return g->getRuntime()->getPerfTime(g); }
 
+    //------ calibration
+
+    /**
+     * @brief Run the graph operator by operator and widen the recorded range
+     * of every float activation with the values it holds. Call it once per
+     * sample input; ranges accumulate until clear_calibration().
+     */
+    void calibrate();
+
+    inline std::map<int, std::pair<float, float>> get_calibration() const {
+        return calibrationRanges;
+    }
+
+    inline void clear_calibration() { calibrationRanges.clear(); }
+
+    //------ compiled model
+
+    /**
+     * @brief Write the allocated graph, its memory plan, PerfRecords and
+     * weights to `path` (see saveCompiledModel()).
+     */
+    inline void save_compiled(const string &path, const NamedTensors &inputs,
+                              const NamedTensors &outputs) {
+        saveCompiledModel(g, path, inputs, outputs);
+    }
+
+    /**
+     * @brief Replace the graph with a ready-to-run one read from `path`, and
+     * return its named inputs and outputs.
+     */
+    std::pair<NamedTensors, NamedTensors> load_compiled(const string &path);
+
+    //------ symbolic shapes
+
+    /**
+     * @brief Specialize the allocated graph for symbols named `names`, each
+     * set on the input dimensions given as (tensor fuid, axis) pairs (see
+     * SymbolicGraph).
+     */
+    void specialize(const vector<string> &names,
+                    const vector<vector<std::pair<int, int>>> &dims);
+
+    /**
+     * @brief Give the symbols of specialize() new values, without shape
+     * inference or memory planning.
+     */
+    inline void bind_symbols(const vector<int> &values) {
+        IT_ASSERT(symbolic, "The graph is not specialized");
+        symbolic->bind(values);
+    }
+
+    /**
+     * @brief The shape of a tensor of the specialized graph for `values`,
+     * e.g. to crop the outputs of a padded request.
+     */
+    inline Shape symbolic_shape(Tensor tensor, const vector<int> &values) {
+        IT_ASSERT(symbolic, "The graph is not specialized");
+        return symbolic->getShape(tensor, values);
+    }
+
+    //------ sequence buckets
+
+    /**
+     * @brief Prepare the specialized graph for `values`, one value per
+     * symbol in each bucket, and tune each bucket if `tune` (see
+     * SequenceBuckets).
+     */
+    void set_buckets(const vector<vector<int>> &values, bool tune);
+
+    /**
+     * @brief Bind the smallest bucket that holds `values` and return its
+     * index in get_bucket_stats(), or bind `values` exactly and return -1
+     * if none does. Inputs are then padded up to the bucket's shapes.
+     */
+    inline int bind_bucket(const vector<int> &values) {
+        IT_ASSERT(buckets, "No buckets are set");
+        return buckets->bind(values);
+    }
+
+    /**
+     * @brief Per-bucket (values, hits, used input elements, padded input
+     * elements), smallest bucket first.
+     */
+    vector<std::tuple<vector<int>, size_t, size_t, size_t>>
+    get_bucket_stats() const;
+
+    inline size_t get_bucket_misses() const {
+        return buckets ? buckets->getMisses() : 0;
+    }
+
+    inline void reset_bucket_stats() {
+        if (buckets)
+            buckets->resetStats();
+    }
+
 #ifdef USE_CUDA
     inline void run_with_cudagraph() {
         (as<CudaRuntimeObj>(g->getRuntime()))->runWithCudaGraph(g);
@@ -0,0 +1,111 @@
+#pragma once
+#include "core/common.h"
+#include "core/ref.h"
+
+namespace infini {
+
+class GraphObj;
+
+/**
+ * @brief A graph-level rewrite driven by PassManager.
+ */
+class GraphPass {
+  public:
+    virtual ~GraphPass() {}
+    virtual string getName() const = 0;
+    /**
+     * @brief Rewrite the graph in place. Returns true if the graph is
+     * changed, which makes the pass manager run another iteration.
+     */
+    virtual bool run(GraphObj *graph) = 0;
+    /**
+     * @brief Pass-specific summary of the last changing run, kept in
+     * PassStat::note.
+     */
+    virtual string report() const { return ""; }
+};
+
+/**
+ * @brief Passes registered through REGISTER_GRAPH_PASS, run by ascending
+ * order. Orders in use:
+ *   100 fold Q/DQ into QLinear ops
+ *   200 constant folding
+ *   300 common subexpression elimination
+ *   400 BatchNorm folding into Conv/Gemm/MatMul
+ *   450 Transpose/Reshape canonicalization
+ *   500 epilogue fusion into MatMul/Conv
+ *   550 horizontal fusion of sibling MatMuls on CPU
+ *   600 element-wise fusion
+ *   700 NHWC layout assignment on CPU
+ *   900 dead code elimination
+ */
+class GraphPassRegistry {
+  public:
+    using PassRecord = std::pair<int, GraphPass *>; // order, pass
+
+  private:
+    vector<PassRecord> passes;
+
+  public:
+    ~GraphPassRegistry() {
+        for (auto &[order, pass] : passes)
+            delete pass;
+    }
+    static GraphPassRegistry &getInstance() {
+        static GraphPassRegistry instance;
+        return instance;
+    }
+    bool registerPass(int order, GraphPass *pass);
+    const vector<PassRecord> &getPasses() const { return passes; }
+};
+
+struct PassStat {
+    string name;
+    int runs = 0;
+    // Number of runs that changed the graph.
+    int changes = 0;
+    // Operators removed (positive) or added (negative) in total.
+    int opsRemoved = 0;
+    double timeMs = 0;
+    string note;
+};
+
+/**
+ * @brief Runs the registered passes in order, repeating the pipeline until
+ * no pass changes the graph or maxIterations is reached.
+ */
+class PassManager {
+  public:
+    int maxIterations = 8;
+    // Print the graph after each pass that changes it.
+    bool dump = false;
+#ifdef DEBUG_MODE
+    bool verify = true;
+#else
+    bool verify = false;
+#endif
+
+  private:
+    vector<PassStat> stats;
+    int iterations = 0;
+
+  public:
+    /**
+     * @brief Returns true if any pass changed the graph.
+     */
+    bool run(GraphObj *graph);
+    const vector<PassStat> &getStats() const { return stats; }
+    int getIterations() const { return iterations; }
+    string statsToString() const;
+};
+
+} // namespace infini
+
+#define _REGISTER_GRAPH_PASS_1(order, pass, cnt)                               \
+    namespace infini {                                                         \
+    static const bool _CAT(_register_graph_pass_, cnt) =                       \
+        GraphPassRegistry::getInstance().registerPass(order, new pass());      \
+    }
+
+#define REGISTER_GRAPH_PASS(order, pass)                                       \
+    _REGISTER_GRAPH_PASS_1(order, pass, __COUNTER__)
@@ -2,6 +2,7 @@
 #include "core/common.h"
 #include "core/operator.h"
 #include "core/tensor.h"
+#include "core/tuner.h"
 #include "utils/operator_utils.h"
 #include <functional>
 #include <nlohmann/json.hpp>
@@ -15,13 +16,16 @@ struct PerfRecordObj {
     PerfRecordObj(double time) : time(time){};
     virtual ~PerfRecordObj(){};
     double time = 0; // in milliseconds
+    // Name of the candidate kernel that the record was tuned for, or empty
+    // for the highest-ranked one (see KernelRegistry).
+    string kernel;
     virtual void to_json(json &j) {
         j["type"] = 0;
         j["data"] = time;
     }
     static Ref<PerfRecordObj> from_json(const json &j) {
         PerfRecordObj tmp;
-        tmp.time = j["data"].get<int>();
+        tmp.time = j["data"].get<double>();
         return make_ref<PerfRecordObj>(tmp);
     }
 };
@@ -70,8 +74,8 @@ class Kernel {
         double t = std::numeric_limits<double>::max();
         ComputeFuncPtr funcPtr;
         for (auto &itPtr : funcVec) {
-            double tem =
-                timeit([&]() { itPtr(op, record, context); }, [&]() {});
+            double tem = Tuner::getInstance().measure(
+                [&]() { itPtr(op, record, context); });
             if (tem < t) {
                 t = tem;
                 funcPtr = itPtr;
@@ -129,41 +133,94 @@ class PerfRecordRegistry {
     }
 };
 
+/**
+ * @brief Where a candidate kernel applies. Empty lists accept anything.
+ */
+struct KernelConstraints {
+    // Data types accepted for the operator (see OperatorObj::getDType()).
+    vector<DataType> dtypes;
+    // Layouts accepted for every input and output.
+    vector<TensorLayout> layouts;
+    // Any other condition, e.g. on shapes or attributes.
+    std::function<bool(const Operator &)> check;
+
+    bool accepts(const Operator &op) const;
+};
+
+/**
+ * @brief Candidate kernels for each (Device, OpType), highest priority
+ * first, and in registration order for equal priorities.
+ *
+ * Without a PerfRecord, an operator runs on the first candidate whose
+ * constraints accept it. tune() times every accepted candidate and names
+ * the fastest in its record, which later runs follow. A forced kernel,
+ * set by forceKernel() or by the comma-separated names in the
+ * INFINI_FORCE_KERNEL environment variable, is used wherever it is
+ * registered instead, regardless of constraints and records; it is meant
+ * for debugging.
+ */
+// Priority of native CPU kernels registered next to infiniop ones, which
+// are preferred until tuning says otherwise.
+constexpr int nativeKernelPriority = -1;
+
 class KernelRegistry {
   public:
-    using KernelRecord =
-        tuple<Kernel *const, const string, const int>; // Kernel, name, ID
+    struct Candidate {
+        Kernel *kernel;
+        string name;
+        int id;
+        int priority;
+        KernelConstraints constraints;
+    };
 
   private:
-    std::map<KernelAttrs, KernelRecord> kernels;
+    std::map<KernelAttrs, vector<Candidate>> kernels;
+    std::set<string> forced;
     int nKernels = 0;
 
+    KernelRegistry();
+
   public:
     ~KernelRegistry() {
         for (auto &[k, v] : kernels)
-            delete std::get<0>(v);
+            for (auto &candidate : v)
+                delete candidate.kernel;
     }
     static KernelRegistry &getInstance() {
         static KernelRegistry instance;
         return instance;
     }
-    bool registerKernel(const KernelAttrs &key, Kernel *kernel, string name) {
-        // TODO: mutliple kernels support: priority and check name
-        IT_ASSERT(kernels.find(key) == kernels.end(),
-                  "Kernel already registered");
-        kernels.emplace(key, KernelRecord{kernel, name, ++nKernels});
-        return true;
-    }
-    Kernel *getKernel(const KernelAttrs &kernelAttrs) const {
-        auto it = kernels.find(kernelAttrs);
-        IT_ASSERT(it != kernels.end(), "Kernel not found for key {" +
-                                           get_kernel_attrs_str(kernelAttrs) +
-                                           "}");
-        return std::get<0>(it->second);
-    }
-    const KernelRecord &getKernelItem(const KernelAttrs &kernelAttrs) const {
-        return kernels.at(kernelAttrs);
+    bool registerKernel(const KernelAttrs &key, Kernel *kernel, string name,
+                        int priority = 0, KernelConstraints constraints = {});
+    /**
+     * @brief The highest-ranked candidate, whatever the operator.
+     */
+    Kernel *getKernel(const KernelAttrs &kernelAttrs) const;
+    /**
+     * @brief The forced candidate, else the one named by `record` if it
+     * accepts `op`, else the highest-ranked one that accepts `op`.
+     */
+    Kernel *getKernel(const KernelAttrs &kernelAttrs, const Operator &op,
+                      const PerfRecord &record = nullptr) const;
+    /**
+     * @brief The candidates that accept `op`, ranked, or only the forced
+     * one.
+     */
+    vector<const Candidate *> getCandidates(const KernelAttrs &kernelAttrs,
+                                            const Operator &op) const;
+    bool hasKernel(const KernelAttrs &kernelAttrs) const {
+        return kernels.find(kernelAttrs) != kernels.end();
     }
+    /**
+     * @brief Tune every candidate of getCandidates() on `op` and return the
+     * record of the fastest, named after it. Candidates whose tune() gives
+     * no record are timed on their default arguments.
+     */
+    PerfRecord tune(const KernelAttrs &kernelAttrs, const Operator &op,
+                    const RuntimeObj *context) const;
+
+    void forceKernel(const string &name) { forced.insert(name); }
+    void clearForcedKernels() { forced.clear(); }
 };
 
 class CpuKernelWithoutConfig : public Kernel {
@@ -177,7 +234,8 @@ class CpuKernelWithoutConfig : public Kernel {
     // Premise: op is idempotent since it is called multiple times.
     virtual PerfRecord tune(const Operator &op,
                             const RuntimeObj *context) const override {
-        return make_ref<PerfRecordObj>(timeit([&]() { compute(op, context); }));
+        return make_ref<PerfRecordObj>(
+            Tuner::getInstance().measure([&]() { compute(op, context); }));
     }
 };
 
@@ -194,6 +252,22 @@ class CpuKernelWithoutConfig : public Kernel {
 #define REGISTER_KERNEL(device, opType, kernel, name)                          \
     _REGISTER_KERNEL_1(device, opType, kernel, name, __COUNTER__)
 
+#define _REGISTER_KERNEL_CANDIDATE_1(device, opType, kernel, name, priority,   \
+                                     constraints, cnt)                         \
+    namespace infini {                                                         \
+    static const bool _CAT(_register_kernel_, cnt) =                           \
+        KernelRegistry::getInstance().registerKernel(                          \
+            KernelAttrs{device, opType}, new kernel(), name, priority,         \
+            constraints);                                                      \
+    }
+
+// Register a kernel next to others for the same device and operator type,
+// with a priority and the KernelConstraints where it applies.
+#define REGISTER_KERNEL_CANDIDATE(device, opType, kernel, name, priority,      \
+                                  constraints)                                 \
+    _REGISTER_KERNEL_CANDIDATE_1(device, opType, kernel, name, priority,       \
+                                 constraints, __COUNTER__)
+
 #define _REGISTER_CONSTRUCTOR_1(type, constructor, cnt)                        \
     namespace infini {                                                         \
     static const bool _CAT(_register_constructor_, cnt) =                      \
@@ -28,6 +28,10 @@ class LazyAllocator {
 
     size_t heapPeak = 0;
 
+    // Peak of the operator order before memory-aware scheduling, 0 if the
+    // order was kept.
+    size_t unscheduledPeak = 0;
+
     size_t alignment;
 
     bool hasMemPool = false;
@@ -109,6 +113,18 @@ class LazyAllocator {
 
     void *getWeightPtr();
 
+    size_t getWeightPeak() const { return weightPeak; }
+
+    size_t getPeak() const { return peak; }
+
+    void setUnscheduledPeak(size_t peak) { unscheduledPeak = peak; }
+
+    /**
+     * @brief Release the weight arena so that weights can be laid out again
+     * with allocWeight().
+     */
+    void resetWeight();
+
     void *getHeapPtr();
 
     void info();
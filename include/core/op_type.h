@@ -239,6 +239,9 @@ struct OpType {
         Broadcast,
         Send,
         Recv,
+
+        QuantizedMatMul,  // ComputationIntensive
+        FusedElementWise, // Fusion
     } type;
 
     constexpr OpType(decltype(type) t) : type(t) {}
@@ -265,6 +268,8 @@ enum class ActType {
     LeakyRelu,
     Sigmoid,
     Tanh,
+    Gelu,
+    Silu,
 };
 
 } // namespace infini
@@ -53,7 +53,13 @@ class OperatorObj : public Object {
     TensorVec outputs;
     vector<WRef<OperatorObj>> predecessors;
     vector<WRef<OperatorObj>> successors;
-    void *opDesc;
+    // Only set by initInfiniOp(), which operators built without a graph skip.
+    void *opDesc = nullptr;
+    // Owns opDesc together with DescriptorCache, and the key and workspace
+    // size it was created with.
+    std::shared_ptr<void> descHolder;
+    vector<int64_t> descKey;
+    size_t descWorkspaceSize = 0;
 
   public:
     OperatorObj(OpType opType, TensorVec inputs, TensorVec outputs);
@@ -67,6 +73,11 @@ class OperatorObj : public Object {
      * function.
      */
     bool checkValid(GraphObj *graph);
+    /**
+     * @brief Create the infiniop descriptor for the current input and output
+     * shapes, or take it from DescriptorCache. Called again by
+     * GraphObj::shape_infer() when the shapes change.
+     */
     virtual void initInfiniOp(const Runtime context);
     OpPerfKey getOpPerfKey() const;
     /**
@@ -74,12 +85,27 @@ class OperatorObj : public Object {
      * considered.
      */
     HashType hash() const;
+    /**
+     * @brief Whether the operator has the same type and attributes as `rhs`.
+     * Like hash(), inputs and outputs are not compared.
+     */
+    bool hasSameAttrs(const OperatorObj &rhs) const;
 
   public:
   public: // getter and setter
     const TensorVec &getInputs() const { return inputs; }
     const TensorVec &getOutputs() const { return outputs; }
     void *getOpDesc() const { return opDesc; }
+    /**
+     * @brief Whether initInfiniOp() has created a descriptor, which then
+     * follows shape changes.
+     */
+    bool hasInfiniOpDesc() const { return !descKey.empty(); }
+    /**
+     * @brief Workspace bytes the descriptor needs, queried once when it is
+     * created.
+     */
+    size_t getDescWorkspaceSize() const { return descWorkspaceSize; }
     Tensor getInputs(size_t i) const { return inputs.at(i); }
     Tensor getOutput() const {
         IT_ASSERT(outputs.size() == 1, "Unimplemented");
@@ -91,6 +117,7 @@ class OperatorObj : public Object {
     }
     OpVec getPredecessors() const { return wrefs_to_refs(predecessors); }
     OpVec getSuccessors() const { return wrefs_to_refs(successors); }
+    bool hasSuccessors() const { return !successors.empty(); }
     OpType getOpType() const { return type; }
     // HACK: set correct data type
     DataType getDType() const { return getInputs(0)->getDType(); }
@@ -112,6 +139,19 @@ class OperatorObj : public Object {
     optional<vector<Shape>> inferShape();
     vector<DataType> inferDataType() const;
 
+    /**
+     * @brief Called first by initInfiniOp(). Returns true if the descriptor
+     * already matches the current shapes or is found in DescriptorCache.
+     * Otherwise the old descriptor is released, and the caller creates a new
+     * one in opDesc and hands it to cacheInfiniOpDesc().
+     */
+    bool reuseInfiniOpDesc(const Runtime &context);
+    /**
+     * @brief Share the descriptor just created in opDesc with
+     * DescriptorCache. `destroy` is called once no operator uses it.
+     */
+    void cacheInfiniOpDesc(void (*destroy)(void *), size_t workspaceSize = 0);
+
   private:
     /**
      * @brief The returned vector includes operator attributes, such as paddings
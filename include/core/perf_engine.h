@@ -1,22 +1,47 @@
 #pragma once
 #include "core/graph.h"
 #include "core/kernel.h"
+#include <mutex>
 #include <nlohmann/json_fwd.hpp>
+#include <shared_mutex>
 namespace infini {
 using json = nlohmann::json;
 
+/**
+ * @brief PerfRecords of tuned kernels, keyed by kernel and operator. It is
+ * safe to use from several threads: lookups share a lock and updates take
+ * it exclusively.
+ *
+ * On disk, a tuning database is a JSON Lines file. The first line holds
+ * the format version and the hardware fingerprint of the writer, and every
+ * other line holds one record. Records are appended under a file lock, so
+ * several processes on the same hardware can share one file; when a key
+ * is read more than once, the fastest record is kept. Files written by
+ * other hardware are skipped, and files of the old single-object format
+ * are still read.
+ */
 class PerfEngine {
   public:
     // TODO: Key should be OpPerfKey + Context(maybe implicat) to support
     // multiple candiate kernels.
     using Key = std::pair<KernelAttrs, OpPerfKey>;
-    PerfEngine() = default;
+    static constexpr int formatVersion = 2;
+
+    PerfEngine() : fingerprint(hostFingerprint()) {}
     // PerfEngine is singleton
     PerfEngine(PerfEngine &other) = delete;
     PerfEngine &operator=(PerfEngine const &) = delete;
 
   private:
-    map<Key, PerfRecord> data;
+    struct KeyHash {
+        size_t operator()(const Key &key) const;
+    };
+
+    mutable std::shared_mutex mutex;
+    std::unordered_map<Key, PerfRecord, KeyHash> data;
+    // Keys set since the last appendPerfEngineData().
+    std::unordered_set<Key, KeyHash> unsaved;
+    string fingerprint;
 
   public:
     static PerfEngine &getInstance() {
@@ -29,23 +54,57 @@ class PerfEngine {
      *
      * @return PerfRecord nullptr if no record is fnoud.
      */
-    PerfRecord getPerfData(const Key &key) {
-        auto it = data.find(key);
-        if (it != data.end()) // find previous evaluating results
-            return data.at(key);
-        else
-            return nullptr;
-    }
+    PerfRecord getPerfData(const Key &key) const;
 
-    void setPerfData(const Key &key, PerfRecord record) {
-        IT_ASSERT(data.find(key) == data.end(), "Perf data already exist");
-        data.emplace(key, record);
-    }
-    map<Key, PerfRecord> get_data() { return data; }
-    void set_data(map<Key, PerfRecord> data) { this->data = data; }
+    /**
+     * @brief Add the record of `key`, or replace it if it exists.
+     */
+    void setPerfData(const Key &key, PerfRecord record);
+
+    /**
+     * @brief Add the record of `key`, or replace it if it is slower.
+     * Returns true if `record` is kept.
+     */
+    bool mergePerfData(const Key &key, PerfRecord record);
+
+    size_t size() const;
+    map<Key, PerfRecord> get_data() const;
+    void set_data(map<Key, PerfRecord> data);
+
+    /**
+     * @brief Identifies the hardware that the records were measured on:
+     * the CPU model and thread count by default. Runtimes with devices may
+     * set their own, e.g. with the device name added.
+     */
+    string getFingerprint() const;
+    void setFingerprint(string fingerprint);
+    static string hostFingerprint();
+
+    /**
+     * @brief Replace `file_path` with all the records, atomically.
+     */
     void savePerfEngineData(std::string file_path);
-    void loadPerfEngineData(std::string file_path);
+
+    /**
+     * @brief Append the records set since the last append to `file_path`,
+     * creating it if needed. Halts if the file was written by other
+     * hardware.
+     */
+    void appendPerfEngineData(std::string file_path);
+
+    /**
+     * @brief Merge the records of `file_path` (see mergePerfData()) and
+     * return how many are read. Returns 0 if the file was written by other
+     * hardware. Lines cut short by a crashed writer are skipped.
+     */
+    size_t loadPerfEngineData(std::string file_path);
 };
+/**
+ * @brief A PerfRecord with the name of its kernel, in any registered
+ * PerfRecordObj type.
+ */
+void to_json(json &j, const PerfRecord &p);
+void from_json(const json &j, PerfRecord &p);
 void to_json(json &j, const PerfEngine &p);
 void from_json(const json &j, PerfEngine &p);
 
@@ -104,6 +104,7 @@ class RuntimeObj : public std::enable_shared_from_this<RuntimeObj> {
                                        size_t bytes) const = 0;
     virtual string toString() const = 0;
 
+    Device getDevice() const { return device; }
     int getDeviceId() const { return deviceId; }
 
     virtual void initComm(const string &name, int worldSize, int rank) = 0;
@@ -163,10 +164,24 @@ class NativeCpuRuntimeObj : public CpuRuntimeObj {
 
     size_t getWorkspaceSize() const override { return workspaceSize; }
 
-    void *getWorkspace(size_t size) const override {
-        IT_ASSERT(size <= workspaceSize);
-        return workspace;
-    }
+    void *getWorkspace(size_t size) const override;
+
+    /**
+     * @brief While alive, kernels run by the constructing thread get a
+     * workspace of their own instead of the shared one, so that several
+     * threads can run kernels at once.
+     */
+    class ThreadWorkspace {
+        vector<uint64_t> buffer;
+
+      public:
+        ThreadWorkspace();
+        ~ThreadWorkspace();
+        ThreadWorkspace(const ThreadWorkspace &) = delete;
+        ThreadWorkspace &operator=(const ThreadWorkspace &) = delete;
+
+        void *get(size_t size);
+    };
 };
 
 } // namespace infini
@@ -0,0 +1,67 @@
+#pragma once
+#include "core/symbolic_shape.h"
+
+namespace infini {
+
+/**
+ * @brief A few symbol values (buckets), e.g. sequence lengths 32, 64 and
+ * 128, that a SymbolicGraph is prepared for once, so that variable-length
+ * requests run on one of them, padded up, instead of on a new shape each.
+ *
+ * Preparing a bucket binds it, which creates its infiniop descriptors in
+ * DescriptorCache, and with `tune` runs the graph once to record the
+ * PerfRecords of its shapes. Buckets are prepared from the largest, so the
+ * arena of the SymbolicGraph is allocated once for all of them. The
+ * DescriptorCache capacity should cover the operators of every bucket.
+ *
+ * Padded positions hold whatever the caller writes there; the outputs at
+ * the request's own positions are exact only if the model ignores the
+ * padding, e.g. through an attention mask padded with zeros, or because
+ * positions only see earlier ones.
+ */
+class SequenceBuckets {
+  public:
+    struct Stat {
+        vector<int> values;
+        size_t hits = 0;
+        // Elements of the inputs that carry symbols, as requested and as
+        // added by padding, summed over the hits.
+        size_t usedElements = 0, paddedElements = 0;
+    };
+
+    /**
+     * @brief Prepare `buckets`, each holding a value for every symbol of
+     * `graph`. The graph must outlive this object.
+     */
+    SequenceBuckets(SymbolicGraph &graph, vector<vector<int>> buckets,
+                    bool tune = false);
+
+    /**
+     * @brief Index of the bucket with the smallest activation arena that
+     * holds `values` in every symbol, or -1 if none does.
+     */
+    int find(const vector<int> &values) const;
+
+    /**
+     * @brief Bind the bucket of `values` and count the hit and its padding.
+     * If no bucket holds them, `values` are bound exactly and counted as a
+     * miss. Returns the index of the bucket, or -1.
+     */
+    int bind(const vector<int> &values);
+
+    const vector<Stat> &getStats() const { return stats; }
+    size_t getMisses() const { return misses; }
+    void resetStats();
+
+  private:
+    // Elements of the inputs that carry symbols for `values`.
+    size_t inputElements(const vector<int> &values) const;
+
+    SymbolicGraph &graph;
+    // Sorted by the bytes of their activation arena.
+    vector<Stat> stats;
+    TensorVec inputs;
+    size_t misses = 0;
+};
+
+} // namespace infini
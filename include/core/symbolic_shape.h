@@ -0,0 +1,119 @@
+#pragma once
+#include "core/graph.h"
+#include <map>
+
+namespace infini {
+
+/**
+ * @brief A dimension as an affine function c + sum_i a_i * s_i of the
+ * symbols s_i of a SymbolicGraph.
+ */
+struct AffineExpr {
+    int64_t constant = 0;
+    vector<int64_t> coeffs;
+
+    int64_t eval(const vector<int> &values) const;
+    bool isConstant() const;
+    string toString(const vector<string> &names) const;
+};
+
+/**
+ * @brief A polynomial in the symbols with integer coefficients, such as the
+ * bytes of a tensor whose dimensions are AffineExprs.
+ */
+class Polynomial {
+    // Each monomial is the sorted list of its symbol indices, with
+    // repetition; the constant term is the empty list.
+    std::map<vector<int>, int64_t> terms;
+
+  public:
+    Polynomial(int64_t constant = 0);
+    explicit Polynomial(const AffineExpr &expr);
+
+    Polynomial operator*(const Polynomial &rhs) const;
+    bool operator==(const Polynomial &rhs) const { return terms == rhs.terms; }
+    /**
+     * @brief The coefficient-wise maximum, which is at least both
+     * polynomials wherever the symbols are non-negative.
+     */
+    Polynomial upperBound(const Polynomial &rhs) const;
+    int64_t eval(const vector<int> &values) const;
+    string toString(const vector<string> &names) const;
+};
+
+/**
+ * @brief A graph specialized once for symbolic input dimensions such as
+ * `batch` and `seq`, so that other values can be bound without shape
+ * inference or memory planning.
+ *
+ * The dimensions of every tensor are fitted as AffineExprs of the symbols
+ * by running the operators' inferShape() at a few probe values, and
+ * checked at one more. Activations are then assigned to slots in operator
+ * order, like dataMalloc() assigns them to blocks: tensors whose lifetimes
+ * do not overlap share a slot, whose size is the Polynomial upper bound of
+ * theirs. Binding values evaluates the dimensions and slot sizes, and a
+ * tensor's offset is the sum of the slot sizes before its slot.
+ */
+class SymbolicGraph {
+  public:
+    struct Symbol {
+        string name;
+        // Input dimensions, as (tensor, axis), that take the symbol's value.
+        vector<std::pair<Tensor, int>> dims;
+    };
+
+    /**
+     * @brief Specialize a graph whose weights are allocated by dataMalloc().
+     * The current sizes of the symbol dimensions are used as the base
+     * values, and the graph is bound to them. Halts if a dimension is not
+     * affine in the symbols or if a weight depends on them.
+     */
+    SymbolicGraph(Graph graph, vector<Symbol> symbols);
+    ~SymbolicGraph();
+    SymbolicGraph(const SymbolicGraph &) = delete;
+    SymbolicGraph &operator=(const SymbolicGraph &) = delete;
+
+    const Graph &getGraph() const { return graph; }
+    const vector<Symbol> &getSymbols() const { return symbols; }
+    const vector<AffineExpr> &getDims(const Tensor &tensor) const;
+    /**
+     * @brief The shape of a tensor for `values`, without binding them.
+     */
+    Shape getShape(const Tensor &tensor, const vector<int> &values) const;
+    Polynomial getBytes(const Tensor &tensor) const;
+    size_t getNumSlots() const { return slotBytes.size(); }
+
+    /**
+     * @brief Bytes of the activation arena for `values`.
+     */
+    size_t getActivationBytes(const vector<int> &values) const;
+
+    /**
+     * @brief Give the symbols new values: set the shape of every tensor,
+     * re-specialize the infiniop descriptors (see DescriptorCache) and
+     * place the activations in an arena owned by this object, grown when
+     * needed. Data of the activations is not kept. Operators whose inputs
+     * change refresh the sizes they keep (e.g. Matmul's m, n and k) with
+     * inferShape(), which is checked against the closed forms.
+     */
+    void bind(const vector<int> &values);
+
+  private:
+    // Shapes of all the tensors after propagating `values` through
+    // inferShape().
+    vector<Shape> probe(const vector<int> &values);
+    void planSlots(const vector<int> &values);
+
+    Graph graph;
+    vector<Symbol> symbols;
+    TensorVec tensors;
+    std::unordered_map<TensorObj *, vector<AffineExpr>> dims;
+    // Slot of every activation, and the size bound of each slot.
+    vector<std::pair<Tensor, size_t>> slotOf;
+    vector<Polynomial> slotBytes;
+    vector<size_t> slotOffsets;
+    void *arena = nullptr;
+    size_t arenaBytes = 0;
+};
+
+} // namespace infini
@@ -24,6 +24,7 @@ class TensorObj : public TensorBaseObj {
     Fuid fuid;    // Cloned tensors share the same id. Tensors constructed from
                   // scratch have a new id.
     TensorType tensorType = TensorType::others;
+    TensorLayout layout = TensorLayout::NCHW;
 
   public:
     TensorObj(Shape shape, DataType dtype, Runtime runtime);
@@ -38,6 +39,10 @@ class TensorObj : public TensorBaseObj {
     size_t getRank() const { return shape.size(); }
     Shape getStride() const;
     size_t getOffset(const vector<int> &ds) const;
+    TensorLayout getLayout() const { return layout; }
+    void setLayout(TensorLayout layout_);
+    // Dims in memory order, e.g. [N, H, W, C] for an NHWC tensor.
+    Shape getPhysicalDims() const;
     void dataMalloc();
     UidBaseType getFuid() const { return fuid; }
     bool isWeight() const { return tensorType == TensorType::weight; }
@@ -76,7 +81,14 @@ class TensorObj : public TensorBaseObj {
         }
     }
 
-    void load(std::string file_path);
+    /**
+     * @brief Read the data from a .npy file (see loadTensorData()), through
+     * a mapping of the file if `useMmap` is set.
+     */
+    void load(std::string file_path, bool useMmap = false);
+    /**
+     * @brief Write the data to a .npy file that numpy.load() can read.
+     */
     void save(std::string file_path);
 
     void copyin(const void *ptr, size_t size) {
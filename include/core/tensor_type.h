@@ -4,4 +4,8 @@ namespace infini {
 
 enum class TensorType { weight, input, output, others };
 
+// Memory order of a 4-D tensor whose dims are always given as NCHW. NHWC
+// keeps the channels of a pixel contiguous.
+enum class TensorLayout { NCHW, NHWC };
+
 } // namespace infini
@@ -0,0 +1,74 @@
+#pragma once
+#include "core/runtime.h"
+
+namespace infini {
+
+struct TuneOptions {
+    // Untimed runs before the trials.
+    int warmupRounds = 2;
+    // Trials are taken until the 95% confidence interval of their median
+    // is within `relativeError` of it, but at least minRounds and at most
+    // maxRounds of them, and for at most maxTime ms.
+    int minRounds = 5;
+    int maxRounds = 200;
+    double relativeError = 0.02;
+    double maxTime = 200;
+    // A trial of a kernel shorter than this repeats it, so that timer
+    // resolution does not dominate. In ms.
+    double minTrialTime = 0.02;
+    // Bytes written between trials to evict the caches; 0 to keep them.
+    size_t flushBytes = 32 << 20;
+    // Wall time allowed to tune one graph, in ms; 0 for no limit. Operators
+    // left when it runs out keep their highest-ranked kernel.
+    double graphBudget = 0;
+    // Operators tuned at once on CPU runtimes, each on its own cores.
+    int threads = 1;
+};
+
+/**
+ * @brief Times kernels for tuning. A measurement takes the median of
+ * adaptive trials, after rejecting outliers more than three scaled median
+ * absolute deviations away, with the caches flushed before each trial.
+ */
+class Tuner {
+  public:
+    struct GraphStats {
+        size_t tuned = 0;
+        // Operators that already had a record or share one with another.
+        size_t reused = 0;
+        // Operators left untuned because the budget ran out.
+        size_t skipped = 0;
+        double time = 0; // in milliseconds
+    };
+
+    static Tuner &getInstance() {
+        static Tuner instance;
+        return instance;
+    }
+
+    TuneOptions &getOptions() { return options; }
+
+    /**
+     * @brief The time of one run of `func` in ms. `sync` waits for the work
+     * of `func` to finish, e.g. on a device stream.
+     */
+    double measure(const std::function<void()> &func,
+                   const std::function<void()> &sync = {},
+                   bool flushCache = true) const;
+
+    /**
+     * @brief Tune the operators of `graph` without a PerfRecord (see
+     * KernelRegistry::tune()) within the graph budget. On CPU runtimes,
+     * operators whose tensors do not overlap in memory are tuned in
+     * parallel by `threads` workers, and an operator waits for the earlier
+     * ones it overlaps, so each sees the same data as in a sequential run.
+     * Each worker has its own runtime workspace (see
+     * NativeCpuRuntimeObj::ThreadWorkspace).
+     */
+    GraphStats tuneGraph(const Graph &graph, const RuntimeObj *runtime) const;
+
+  private:
+    TuneOptions options;
+};
+
+} // namespace infini
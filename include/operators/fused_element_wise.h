@@ -0,0 +1,46 @@
+#pragma once
+#include "core/operator.h"
+
+namespace infini {
+/**
+ * @brief Several element-wise operators evaluated in one pass, created by
+ * the element-wise fusion graph pass.
+ *
+ * The expression is a list of instructions over registers: registers
+ * 0..numInputs()-1 hold the inputs, instruction i writes register
+ * numInputs() + i and the last instruction produces the output. Inputs are
+ * broadcast to the output shape, and all tensors share one data type.
+ */
+class FusedElementWiseObj : public OperatorObj {
+  public:
+    struct Instr {
+        OpType type;
+        // Operand registers; b is -1 for unary operators.
+        int a, b;
+    };
+
+  private:
+    vector<Instr> program;
+
+  public:
+    FusedElementWiseObj(GraphObj *graph, TensorVec inputs, Tensor output,
+                        vector<Instr> program);
+    OP_CLONE(FusedElementWiseObj);
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
+    std::string toString() const override;
+
+    int numInputs() const override { return inputs.size(); }
+    int numOutputs() const override { return 1; }
+    const vector<Instr> &getProgram() const { return program; }
+
+    /**
+     * @brief Whether an operator of this type can become an instruction.
+     */
+    static bool isSupported(OpType type);
+
+  private:
+    vector<int> getWorkloadVector() const override;
+    vector<int> getOpAttrVector() const override;
+};
+
+} // namespace infini
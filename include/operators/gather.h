@@ -38,22 +38,6 @@ class GatherObj : public GatherBaseObj {
     GatherObj(GraphObj *graph, Tensor input, Tensor indices, Tensor output,
               int axis);
     OP_CLONE(GatherObj);
-    ~GatherObj() override {
-      if (opDesc) {
-          try {
-              if (type == OpType::Gather) {
-                  CHECK_ERROR(infiniopDestroyGatherDescriptor(
-                      (infiniopGatherDescriptor_t)opDesc));
-              } else {
-                  IT_ASSERT(false, "Unsupported gather operator type "
-                                   "for infini op destroy");
-              }
-          } catch (const std::exception &e) {
-              std::cerr << "Error in ~GatherObj: " << e.what()
-                        << std::endl;
-          }
-      }
-  }
     void initInfiniOp(const Runtime context) override;
     std::string toString() const override;
     optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
@@ -85,22 +69,6 @@ class GatherElementsObj : public GatherBaseObj {
     GatherElementsObj(GraphObj *graph, Tensor input, Tensor indices,
                       Tensor output, int axis);
     OP_CLONE(GatherElementsObj);
-    ~GatherElementsObj() override {
-      if (opDesc) {
-          try {
-              if (type == OpType::GatherElements) {
-                  CHECK_ERROR(infiniopDestroyGatherElementsDescriptor(
-                      (infiniopGatherElementsDescriptor_t)opDesc));
-              } else {
-                  IT_ASSERT(false, "Unsupported gather_elements operator type "
-                                   "for infini op destroy");
-              }
-          } catch (const std::exception &e) {
-              std::cerr << "Error in ~GatherElementsObj: " << e.what()
-                        << std::endl;
-          }
-      }
-  }
     void initInfiniOp(const Runtime context) override;
     std::string toString() const override;
     optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
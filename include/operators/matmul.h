@@ -13,6 +13,8 @@ class MatmulObj : public OperatorObj {
     // oppsite to the column-major BLAS.
     bool transA, transB;
     ActType act;
+    // Whether the last input is a residual added before the activation.
+    bool hasResidual;
 
     // Auxiliary attributes which are not a part of operator attributes.
     int b, m, n, k;
@@ -20,6 +22,10 @@ class MatmulObj : public OperatorObj {
     // Specifies the data precision for the matrix multiply.
     std::string computeType = "default";
 
+    // Column counts of the outputs of a horizontally fused MatMul; empty
+    // for the usual single output.
+    vector<int> splitN;
+
   public:
     /**
      * @brief Matmul operator with batch broadcast and tensor transpose
@@ -42,19 +48,39 @@ class MatmulObj : public OperatorObj {
      * @param bias The bias tensor.
      * @param act The activation function.
      * @param computeType Specifies the data precision for the matrix multiply.
+     * @param residual A tensor with the shape of C, added together with the
+     * bias. The epilogue computes C = act(A * B + bias + residual).
      */
     MatmulObj(GraphObj *graph, Tensor A, Tensor B, Tensor C,
               bool transA = false, bool transB = false, Tensor bias = nullptr,
-              ActType act = ActType::None, std::string computeType = "default");
+              ActType act = ActType::None, std::string computeType = "default",
+              Tensor residual = nullptr);
+    /**
+     * @brief Matmul whose N columns are split among several outputs, the
+     * i-th output getting the next `splitN[i]` columns. Siblings reading
+     * the same A are fused into one such Matmul, which writes every result
+     * in place. Residuals and bias tensors with the shape of C are not
+     * supported.
+     *
+     * @param outputs The outputs, or empty if they are going to be created
+     * in the constructor.
+     */
+    MatmulObj(GraphObj *graph, Tensor A, Tensor B, TensorVec outputs,
+              vector<int> splitN, bool transA = false, bool transB = false,
+              Tensor bias = nullptr, ActType act = ActType::None,
+              std::string computeType = "default");
     OP_CLONE(MatmulObj);
 
     std::string toString() const override;
     optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
 
     int numInputs() const override { return inputs.size(); }
-    int numOutputs() const override { return 1; }
+    int numOutputs() const override { return outputs.size(); }
 
-    Tensor getBias() const { return inputs.size() > 2 ? inputs[2] : nullptr; }
+    Tensor getBias() const {
+        return inputs.size() - hasResidual > 2 ? inputs[2] : nullptr;
+    }
+    Tensor getResidual() const { return hasResidual ? inputs.back() : nullptr; }
     ActType getAct() const { return act; }
     auto getBMNKTransAB() const { return tuple(b, m, n, k, transA, transB); }
     bool getTransA() const { return transA; }
@@ -65,6 +91,7 @@ class MatmulObj : public OperatorObj {
     int getK() const { return k; }
     auto getBMNK() const { return tuple{b, m, n, k}; }
     std::string getComputeType() const { return computeType; }
+    const vector<int> &getSplitN() const { return splitN; }
 
   private:
     vector<int> getWorkloadVector() const override;
@@ -0,0 +1,178 @@
+#pragma once
+#include "core/operator.h"
+
+namespace infini {
+/**
+ * @brief Quantize a tensor, y = saturate(round(x / scale) + zeroPoint).
+ * `scale` and `zeroPoint` follow the same per-tensor, per-axis or blocked
+ * layouts as DequantizeLinear. The output has the data type of `zeroPoint`,
+ * or UInt8 if it is absent.
+ */
+class QuantizeLinearObj : public OperatorObj {
+    int axis, blockSize;
+
+  public:
+    QuantizeLinearObj(GraphObj *graph, Tensor input, Tensor scale,
+                      Tensor zeroPoint, Tensor output, int axis = 1,
+                      int blockSize = 0);
+    OP_CLONE(QuantizeLinearObj);
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
+    std::string toString() const override;
+
+    Tensor getZeroPoint() const {
+        return inputs.size() > 2 ? inputs[2] : nullptr;
+    }
+    int numInputs() const override { return inputs.size(); }
+    int numOutputs() const override { return 1; }
+    int getAxis() const { return axis; }
+    int getBlockSize() const { return blockSize; }
+
+  private:
+    vector<int> getWorkloadVector() const override;
+    vector<int> getOpAttrVector() const override;
+
+    vector<DataType> inferDataType(const TensorVec &inputs) const override;
+};
+
+/**
+ * @brief Dequantize a low-precision tensor, y = (x - zeroPoint) * scale.
+ * `scale` and `zeroPoint` are scalars for per-tensor quantization, 1-D
+ * tensors along `axis` for per-channel quantization, or tensors with the
+ * shape of x where dimension `axis` is divided by `blockSize` for blocked
+ * quantization. The output has the data type of `scale`.
+ */
+class DequantizeLinearObj : public OperatorObj {
+    int axis, blockSize;
+
+  public:
+    DequantizeLinearObj(GraphObj *graph, Tensor input, Tensor scale,
+                        Tensor zeroPoint, Tensor output, int axis = 1,
+                        int blockSize = 0);
+    OP_CLONE(DequantizeLinearObj);
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
+    std::string toString() const override;
+
+    Tensor getZeroPoint() const {
+        return inputs.size() > 2 ? inputs[2] : nullptr;
+    }
+    int numInputs() const override { return inputs.size(); }
+    int numOutputs() const override { return 1; }
+    int getAxis() const { return axis; }
+    int getBlockSize() const { return blockSize; }
+
+  private:
+    vector<int> getWorkloadVector() const override;
+    vector<int> getOpAttrVector() const override;
+
+    vector<DataType> inferDataType(const TensorVec &inputs) const override;
+};
+
+/**
+ * @brief Matmul with a weight-only quantized right operand, C = A * B^T.
+ * B is stored row-major as [N, K] so the weights of one output channel are
+ * contiguous. For `bits` = 8 it holds Int8 values; for `bits` = 4 it holds
+ * UInt8 with two unsigned nibbles per byte (low nibble first), shape
+ * [N, K / 2]. `scale` has shape [N, K / groupSize]; `zeroPoint`, if present,
+ * has the same shape and data type Int8 (8-bit) or UInt8 (4-bit). Without a
+ * zero point 8-bit weights are symmetric and 4-bit weights are centered on 8.
+ * A `groupSize` of K gives per-channel quantization.
+ */
+class QuantizedMatmulObj : public OperatorObj {
+    int bits, groupSize;
+
+    // Auxiliary attributes which are not a part of operator attributes.
+    int m, n, k;
+
+  public:
+    QuantizedMatmulObj(GraphObj *graph, Tensor A, Tensor B, Tensor scale,
+                       Tensor zeroPoint, Tensor C, int bits, int groupSize);
+    OP_CLONE(QuantizedMatmulObj);
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
+    std::string toString() const override;
+
+    Tensor getScale() const { return inputs[2]; }
+    Tensor getZeroPoint() const {
+        return inputs.size() > 3 ? inputs[3] : nullptr;
+    }
+    int numInputs() const override { return inputs.size(); }
+    int numOutputs() const override { return 1; }
+    int getBits() const { return bits; }
+    int getGroupSize() const { return groupSize; }
+    int getM() const { return m; }
+    int getN() const { return n; }
+    int getK() const { return k; }
+
+  private:
+    vector<int> getWorkloadVector() const override;
+    vector<int> getOpAttrVector() const override;
+};
+
+/**
+ * @brief Matmul on quantized tensors as defined by ONNX QLinearMatMul. The
+ * inputs are (A, aScale, aZeroPoint, B, bScale, bZeroPoint, yScale,
+ * yZeroPoint). A is [..., M, K] and B is a [K, N] matrix, or [N, K] with
+ * transB; all values are UInt8 or Int8. The scales of A and Y are scalars,
+ * the scale of B is a scalar or has one value per column. The Q/DQ folding
+ * pass transposes a constant B once, so that every output is a contiguous
+ * int8 dot product.
+ */
+class QLinearMatmulObj : public OperatorObj {
+    bool transB;
+    // Auxiliary attributes which are not a part of operator attributes.
+    int m, n, k;
+
+  public:
+    QLinearMatmulObj(GraphObj *graph, TensorVec inputs, Tensor output,
+                     bool transB = false);
+    OP_CLONE(QLinearMatmulObj);
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
+    std::string toString() const override;
+
+    int numInputs() const override { return 8; }
+    int numOutputs() const override { return 1; }
+    int getM() const { return m; }
+    int getN() const { return n; }
+    int getK() const { return k; }
+    bool getTransB() const { return transB; }
+
+  private:
+    vector<int> getWorkloadVector() const override;
+    vector<int> getOpAttrVector() const override;
+
+    vector<DataType> inferDataType(const TensorVec &inputs) const override;
+};
+
+/**
+ * @brief 2-D convolution on quantized tensors as defined by ONNX QLinearConv.
+ * The inputs are (X, xScale, xZeroPoint, W, wScale, wZeroPoint, yScale,
+ * yZeroPoint, [B]). X is NCHW and W is FCRS; the scale of W is a scalar or
+ * has one value per filter. The optional bias B is Int32 with scale
+ * xScale * wScale and no zero point. Padding, stride and dilation have the
+ * same meaning as for ConvObj.
+ */
+class QLinearConvObj : public OperatorObj {
+    int ph, pw, sh, sw, dh, dw;
+
+  public:
+    QLinearConvObj(GraphObj *graph, TensorVec inputs, Tensor output, int ph,
+                   int pw, int sh = 1, int sw = 1, int dh = 1, int dw = 1);
+    OP_CLONE(QLinearConvObj);
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
+    std::string toString() const override;
+
+    Tensor getBias() const { return inputs.size() > 8 ? inputs[8] : nullptr; }
+    int numInputs() const override { return inputs.size(); }
+    int numOutputs() const override { return 1; }
+    int getNumGroups() const {
+        return inputs[0]->getDims()[1] / inputs[3]->getDims()[1];
+    }
+    auto getPadStrideDilation() const { return tuple(ph, pw, sh, sw, dh, dw); }
+
+  private:
+    vector<int> getWorkloadVector() const override;
+    vector<int> getOpAttrVector() const override;
+
+    vector<DataType> inferDataType(const TensorVec &inputs) const override;
+};
+
+} // namespace infini
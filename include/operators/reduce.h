@@ -46,87 +46,23 @@ class ReduceMeanObj : public ReduceBaseObj {
   public:
     ReduceMeanObj(GraphObj *graph, Tensor input, Tensor output,
                   const optional<vector<int>> &axes, bool keepDims = true);
-    ~ReduceMeanObj() override {
-      if (opDesc) {
-          try {
-            if (type == OpType::ReduceMean) {
-                CHECK_ERROR(infiniopDestroyReduceMeanDescriptor(
-                    (infiniopReduceMeanDescriptor_t)opDesc));
-            } else {
-                IT_ASSERT(false, "Unsupported ReduceMean operator type "
-                                 "for infini op destroy");
-            }
-          } catch (const std::exception &e) {
-            std::cerr << "Error in ~ReduceMeanObj: " << e.what()
-                      << std::endl;
-        }
-      }
-    }
 };
 
 class ReduceMaxObj : public ReduceBaseObj {
   public:
     ReduceMaxObj(GraphObj *graph, Tensor input, Tensor output,
                   const optional<vector<int>> &axes, bool keepDims = true);
-    ~ReduceMaxObj() override {
-      if (opDesc) {
-          try {
-            if (type == OpType::ReduceMax) {
-                CHECK_ERROR(infiniopDestroyReduceMaxDescriptor(
-                    (infiniopReduceMaxDescriptor_t)opDesc));
-            } else {
-                IT_ASSERT(false, "Unsupported ReduceMax operator type "
-                                 "for infini op destroy");
-            }
-          } catch (const std::exception &e) {
-            std::cerr << "Error in ~ReduceMaxObj: " << e.what()
-                      << std::endl;
-        }
-      }
-    }
 };
 
 class ReduceMinObj : public ReduceBaseObj {
   public:
     ReduceMinObj(GraphObj *graph, Tensor input, Tensor output,
                   const optional<vector<int>> &axes, bool keepDims = true);
-    ~ReduceMinObj() override {
-      if (opDesc) {
-          try {
-            if (type == OpType::ReduceMin) {
-                CHECK_ERROR(infiniopDestroyReduceMinDescriptor(
-                    (infiniopReduceMinDescriptor_t)opDesc));
-            } else {
-                IT_ASSERT(false, "Unsupported ReduceMin operator type "
-                                 "for infini op destroy");
-            }
-          } catch (const std::exception &e) {
-            std::cerr << "Error in ~ReduceMinObj: " << e.what()
-                      << std::endl;
-        }
-      }
-    }
 };
 
 class ReduceSumObj : public ReduceBaseObj {
   public:
     ReduceSumObj(GraphObj *graph, Tensor input, Tensor output,
                  const optional<vector<int>> &axes, bool keepDims = true);
-    ~ReduceSumObj() override {
-      if (opDesc) {
-          try {
-            if (type == OpType::ReduceSum) {
-                CHECK_ERROR(infiniopDestroyReduceSumDescriptor(
-                    (infiniopReduceSumDescriptor_t)opDesc));
-            } else {
-                IT_ASSERT(false, "Unsupported ReduceSum operator type "
-                                 "for infini op destroy");
-            }
-          } catch (const std::exception &e) {
-            std::cerr << "Error in ~ReduceSumObj: " << e.what()
-                      << std::endl;
-        }
-      }
-    }
 };
 } // namespace infini
@@ -132,6 +132,7 @@ class ResizeObj : public OperatorObj {
     }
 
     vector<float> getScales() const { return scales; }
+    vector<int> getAxes() const { return axes; }
 
     float getRoi(int i) const {
         if (coMode == ECoordinateTransMode::tfCropAndResize) {
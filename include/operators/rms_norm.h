@@ -8,6 +8,7 @@ namespace infini {
  */
 class RMSNormObj : public OperatorObj {
     int dim;
+    float eps;
 
   public:
     /**
@@ -16,8 +17,10 @@ class RMSNormObj : public OperatorObj {
      * @param graph The computation graph that this operator belongs to.
      * @param input The input tensor.
      * @param output The output tensor.
+     * @param eps The epsilon added to the mean square.
      */
-    RMSNormObj(GraphObj *graph, Tensor input, Tensor weight, Tensor output);
+    RMSNormObj(GraphObj *graph, Tensor input, Tensor weight, Tensor output,
+               float eps = 1e-6);
     OP_CLONE(RMSNormObj);
 
     optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
@@ -26,6 +29,7 @@ class RMSNormObj : public OperatorObj {
     int numInputs() const override { return 2; }
     int numOutputs() const override { return 1; }
     int getDim() const { return dim; }
+    float getEps() const { return eps; }
 
   private:
     vector<int> getWorkloadVector() const override;
@@ -17,21 +17,6 @@ class UnaryObj : public OperatorObj {
      * @param output The output tensor.
      */
     UnaryObj(OpType type, GraphObj *graph, Tensor input, Tensor output);
-    ~UnaryObj() override {
-        if (opDesc) {
-            try {
-                if (type == OpType::Relu) {
-                    CHECK_ERROR(infiniopDestroyReluDescriptor(
-                        (infiniopReluDescriptor_t)opDesc));
-                } else {
-                    IT_ASSERT(false, "Unsupported unary operator type "
-                                     "for infini op destroy");
-                }
-            } catch (const std::exception &e) {
-                std::cerr << "Error in ~UnaryObj: " << e.what() << std::endl;
-            }
-        }
-    }
 
     void initInfiniOp(const Runtime context) override;
     optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
@@ -50,21 +35,6 @@ class ClipObj : public OperatorObj {
     ClipObj(GraphObj *graph, Tensor input, Tensor output,
             std::optional<float> min, std::optional<float> max);
     OP_CLONE(ClipObj);
-    ~ClipObj() override {
-      if (opDesc) {
-          try {
-              if(type == OpType::Clip){
-                  CHECK_ERROR(infiniopDestroyClipDescriptor(
-                  (infiniopClipDescriptor_t)opDesc));
-              } else {
-                  IT_ASSERT(false, "Unsupported clip operator type "
-                                   "for infini op destroy");
-              }
-          } catch (const std::exception &e) {
-              std::cerr << "Error in ~ClipObj: " << e.what() << std::endl;
-          }
-      }
-  }
     void initInfiniOp(const Runtime context) override;
     optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
 
@@ -257,6 +227,11 @@ class ShapeObj : public OperatorObj {
     ShapeObj(GraphObj *graph, Tensor input, Tensor output);
     OP_CLONE(ShapeObj);
     optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
+    // ONNX Shape always produces int64.
+    vector<DataType> inferDataType(const TensorVec &inputs) const override {
+        return {DataType::Int64};
+    }
+    vector<int> getOpAttrVector() const override;
 
     std::string toString() const override;
     int numInputs() const override { return 1; }
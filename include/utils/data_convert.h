@@ -1,6 +1,8 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
+#include <type_traits>
 
 namespace infini {
 union Uf32 {
@@ -11,4 +13,82 @@ uint16_t float_to_fp16(const float x);
 float fp16_to_float(const uint16_t x);
 uint16_t float_to_bfp16(const float x);
 float bfp16_to_float(const uint16_t x);
+
+// Bulk conversions. They use F16C / AVX512-BF16 when the host supports them
+// and fall back to the scalar routines above otherwise.
+void fp16_to_float(const uint16_t *src, float *dst, size_t n);
+void float_to_fp16(const float *src, uint16_t *dst, size_t n);
+void bfp16_to_float(const uint16_t *src, float *dst, size_t n);
+void float_to_bfp16(const float *src, uint16_t *dst, size_t n);
+
+/**
+ * @brief Storage types of Float16 and BFloat16 for CPU kernels. Both are
+ * stored as uint16_t, so they need distinct types to be told apart when a
+ * kernel is instantiated. Values are converted to float on load and back on
+ * store; all arithmetic happens in fp32.
+ */
+struct fp16_t {
+    uint16_t data;
+    fp16_t() = default;
+    explicit fp16_t(float x) : data(float_to_fp16(x)) {}
+    operator float() const { return fp16_to_float(data); }
+};
+
+struct bfp16_t {
+    uint16_t data;
+    bfp16_t() = default;
+    explicit bfp16_t(float x) : data(float_to_bfp16(x)) {}
+    operator float() const { return bfp16_to_float(data); }
+};
+
+static_assert(sizeof(fp16_t) == sizeof(uint16_t));
+static_assert(sizeof(bfp16_t) == sizeof(uint16_t));
+
+// The type in which a kernel computes values stored as T.
+template <typename T> struct ComputeType { using t = T; };
+template <> struct ComputeType<fp16_t> { using t = float; };
+template <> struct ComputeType<bfp16_t> { using t = float; };
+
+// Convert n elements stored as T to float, and back.
+template <typename T> void loadAsFloat(const T *src, float *dst, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        dst[i] = static_cast<float>(src[i]);
+}
+template <> inline void loadAsFloat(const fp16_t *src, float *dst, size_t n) {
+    fp16_to_float(reinterpret_cast<const uint16_t *>(src), dst, n);
+}
+template <> inline void loadAsFloat(const bfp16_t *src, float *dst, size_t n) {
+    bfp16_to_float(reinterpret_cast<const uint16_t *>(src), dst, n);
+}
+
+template <typename T> void storeFromFloat(const float *src, T *dst, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        dst[i] = static_cast<T>(src[i]);
+}
+template <>
+inline void storeFromFloat(const float *src, fp16_t *dst, size_t n) {
+    float_to_fp16(src, reinterpret_cast<uint16_t *>(dst), n);
+}
+template <>
+inline void storeFromFloat(const float *src, bfp16_t *dst, size_t n) {
+    float_to_bfp16(src, reinterpret_cast<uint16_t *>(dst), n);
+}
+
+// Convert n elements from S to D with C++ conversion semantics. Conversions
+// between float and half types go through the bulk routines above.
+template <typename S, typename D>
+void castData(const S *src, D *dst, size_t n) {
+    if constexpr (std::is_same_v<D, float> && !std::is_same_v<S, float> &&
+                  !std::is_arithmetic_v<S>) {
+        loadAsFloat(src, dst, n);
+    } else if constexpr (std::is_same_v<S, float> &&
+                         !std::is_same_v<D, float> &&
+                         !std::is_arithmetic_v<D>) {
+        storeFromFloat(src, dst, n);
+    } else {
+#pragma omp simd
+        for (size_t i = 0; i < n; ++i)
+            dst[i] = static_cast<D>(src[i]);
+    }
+}
 } // namespace infini
@@ -4,6 +4,21 @@
 
 namespace infini {
 
-void loadTensorData(TensorObj *tensor, std::string file_path);
+/**
+ * @brief Tensors are saved in the NumPy .npy format (version 1.0, or 2.0
+ * for long headers): a short text header padded to 64 bytes, then the raw
+ * little-endian elements in row-major order, written and read in bulk.
+ * BFloat16 is stored as 2-byte void ("|V2"), which NumPy reads as raw bits.
+ * String tensors are not supported.
+ */
 void saveTensorData(TensorObj *tensor, std::string file_path);
+
+/**
+ * @brief Load a file written by saveTensorData() or numpy.save() into a
+ * tensor of the same data type and shape. With `useMmap` the file is
+ * mapped and copied from the mapping, without buffered reads. Files in the
+ * old protobuf format are still read when built with USE_PROTOBUF.
+ */
+void loadTensorData(TensorObj *tensor, std::string file_path,
+                    bool useMmap = false);
 } // namespace infini
@@ -0,0 +1,32 @@
+#pragma once
+#include "core/common.h"
+
+namespace infini {
+
+/**
+ * @brief A whole file mapped into memory. Pages are read from disk on first
+ * access unless prefetch() reads them first. The mapping is private: writes
+ * stay in this process and never reach the file, and pages that are only
+ * read are shared with the page cache.
+ */
+class MappedFile {
+    uint8_t *ptr = nullptr;
+    size_t bytes = 0;
+
+  public:
+    explicit MappedFile(const string &path);
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    uint8_t *data() const { return ptr; }
+    size_t size() const { return bytes; }
+
+    /**
+     * @brief Read the pages of [offset, offset + length) with all OpenMP
+     * threads, so that later accesses do not fault.
+     */
+    void prefetch(size_t offset = 0, size_t length = SIZE_MAX) const;
+};
+
+} // namespace infini
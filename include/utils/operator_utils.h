@@ -29,6 +29,31 @@ void broadcastShape(const Shape &originShape, SmallArray &modifyShape,
                     int nDims, int size);
 void broadcastShape(const Shape &tempShape, Shape &modifyShape);
 
+// Apply a fused activation in place to n values, as operator epilogues do.
+// LeakyRelu carries no slope here and is not supported.
+template <typename T> void applyActivation(ActType act, T *x, size_t n) {
+#define ACT_LOOP(EXPR)                                                         \
+    _Pragma("omp simd") for (size_t i = 0; i < n; ++i) x[i] = EXPR;            \
+    break
+    switch (act) {
+    case ActType::None:
+        break;
+    case ActType::Relu:
+        ACT_LOOP(x[i] > T(0) ? x[i] : T(0));
+    case ActType::Sigmoid:
+        ACT_LOOP(T(1) / (T(1) + std::exp(-x[i])));
+    case ActType::Tanh:
+        ACT_LOOP(std::tanh(x[i]));
+    case ActType::Gelu:
+        ACT_LOOP(x[i] * (T(1) + std::erf(x[i] * T(M_SQRT1_2))) / T(2));
+    case ActType::Silu:
+        ACT_LOOP(x[i] / (T(1) + std::exp(-x[i])));
+    default:
+        IT_TODO_HALT();
+    }
+#undef ACT_LOOP
+}
+
 } // namespace infini
 
 #endif
@@ -28,6 +28,7 @@ from typing import Dict, List, Any, Tuple, Sequence, Union, Optional
 from functools import reduce
 from onnxsim import simplify
 import copy
+import os
 import warnings
 import numpy as np
 
@@ -44,13 +45,39 @@ class OnnxStub:
         runtime,
         use_naive_allocator: bool = False,
         matmul_compute_type: str = "default",
+        weight_quant: Optional[str] = None,
+        weight_quant_group_size: int = 128,
+        external_data_dir: Optional[str] = None,
+        prefetch_weights: bool = False,
     ):
+        """
+        Initializers stored as ONNX external data (load the model with
+        `onnx.load(path, load_external_data=False)`) are mapped from their
+        files under `external_data_dir` instead of being copied in. Their
+        pages are read on first use, or all at once with `prefetch_weights`.
+        Initializers whose values are needed while importing (shapes, axes,
+        weights to quantize) are read from those files instead.
+        """
+        external = any(
+            t.data_location == TensorProto.EXTERNAL for t in model.graph.initializer
+        )
+        if external and external_data_dir is None:
+            raise ValueError(
+                "model has initializers stored as external data; "
+                "pass external_data_dir to locate their files"
+            )
         # We use some user-defined operators for distributed inference
         try:
-            # onnx simplifier performs inplace simplify
-            model_simp, check = simplify(copy.deepcopy(model))
-            if check:
-                model = model_simp
+            # onnx simplifier performs inplace simplify; constant folding
+            # would turn the DequantizeLinear of QDQ weights back into float.
+            # It needs the data of external initializers, so they skip it.
+            qdq = any(n.op_type == "DequantizeLinear" for n in model.graph.node)
+            if not external:
+                model_simp, check = simplify(
+                    copy.deepcopy(model), skip_constant_folding=qdq
+                )
+                if check:
+                    model = model_simp
         except ValidationError:
             pass
         except RuntimeError:
@@ -62,6 +89,9 @@ class OnnxStub:
         self.tensor_node_map: Dict[str, str] = {}
         self.initializer: Dict[int, TensorProto] = {}
         self.use_naive_allocator: bool = use_naive_allocator
+        # Input dimensions, as (input name, axis), of each ONNX dim_param.
+        self.symbols: Dict[str, List[Tuple[str, int]]] = {}
+        self.specialized: bool = False
         # try:
         #     model = infer_shapes(model)
         # except:
@@ -99,11 +129,31 @@ class OnnxStub:
         tensors: Dict[str, backend.Tensor] = dict()
         data: Dict[str, TensorProto] = dict()
 
+        # Weight-only quantization of MatMul weights ("int8" or "int4")
+        quantized = (
+            _quantize_matmul_weights(
+                model, weight_quant, weight_quant_group_size, external_data_dir
+            )
+            if weight_quant is not None
+            else dict()
+        )
+
+        mapped = set()
         for initializer in model.graph.initializer:
+            if initializer.name in quantized:
+                continue
             dims = [d for d in initializer.dims]
             tensors[initializer.name] = self.handler.tensor(dims, initializer.data_type)
             data[initializer.name] = initializer
             tensors[initializer.name].set_weight()
+            if initializer.data_location == TensorProto.EXTERNAL:
+                info = {e.key: e.value for e in initializer.external_data}
+                self.handler.map_weight(
+                    tensors[initializer.name],
+                    os.path.join(external_data_dir, info["location"]),
+                    int(info.get("offset", 0)),
+                )
+                mapped.add(initializer.name)
 
         for input in model.graph.input:
             dims = _take_shape_dim(input.type.tensor_type.shape)
@@ -112,6 +162,11 @@ class OnnxStub:
                     dims, input.type.tensor_type.elem_type
                 )
                 tensors[input.name].set_input()
+                for axis, d in enumerate(input.type.tensor_type.shape.dim):
+                    if d.dim_param and d.dim_value <= 0:
+                        self.symbols.setdefault(d.dim_param, []).append(
+                            (input.name, axis)
+                        )
 
         for node_idx in sorted_nodes:
             node = model.graph.node[node_idx]
@@ -225,6 +280,28 @@ class OnnxStub:
                         op[0],
                         op[1],
                     )
+            elif node.op_type == "MatMul" and node.input[1] in quantized:
+                q, scale, zero_point, bits, group_size = quantized[node.input[1]]
+                weights = []
+                for suffix, array in [("q", q), ("scale", scale), ("zp", zero_point)]:
+                    name = "{}_{}".format(node.input[1], suffix)
+                    if array is not None and name not in tensors:
+                        proto = from_array(array, name)
+                        tensors[name] = self.handler.tensor(
+                            list(array.shape), proto.data_type
+                        )
+                        tensors[name].set_weight()
+                        data[name] = proto
+                    weights.append(tensors.get(name))
+                tensors[node.output[0]] = self.handler.quantizedMatmul(
+                    tensors[node.input[0]],
+                    weights[0],
+                    weights[1],
+                    weights[2],
+                    tensors.get(node.output[0]),
+                    bits,
+                    group_size,
+                )
             elif node.op_type == "MatMul":
                 tensors[node.output[0]] = self.handler.matmul(
                     tensors[node.input[0]],  # input
@@ -236,6 +313,26 @@ class OnnxStub:
                     backend.ActType.Linear,
                     matmul_compute_type,
                 )
+            elif node.op_type == "QuantizeLinear":
+                attributes = _parse_attribute(node, {"axis": 1, "block_size": 0})
+                tensors[node.output[0]] = self.handler.quantizeLinear(
+                    tensors[node.input[0]],
+                    tensors[node.input[1]],
+                    tensors[node.input[2]] if len(node.input) > 2 else None,
+                    tensors.get(node.output[0]),
+                    attributes["axis"],
+                    attributes["block_size"],
+                )
+            elif node.op_type == "DequantizeLinear":
+                attributes = _parse_attribute(node, {"axis": 1, "block_size": 0})
+                tensors[node.output[0]] = self.handler.dequantizeLinear(
+                    tensors[node.input[0]],
+                    tensors[node.input[1]],
+                    tensors[node.input[2]] if len(node.input) > 2 else None,
+                    tensors.get(node.output[0]),
+                    attributes["axis"],
+                    attributes["block_size"],
+                )
             elif node.op_type == "Gemm":
                 attributes = _parse_attribute(
                     node, {"alpha": 1.0, "beta": 1.0, "transA": 0, "transB": 0}
@@ -315,6 +412,10 @@ class OnnxStub:
                     tensors[node.input[0]],
                     tensors[node.input[1]],
                     tensors.get(node.output[0]),
+                    next(
+                        (attr.f for attr in node.attribute if attr.name == "epsilon"),
+                        1e-6,
+                    ),
                 )
             elif node.op_type == "MaxPool":
                 attributes = _parse_attribute(
@@ -576,12 +677,18 @@ class OnnxStub:
                     tensors[node.input[0]],
                     tensors.get(node.output[0]),
                     (
-                        next(_parse_data(data[node.input[1]]).__iter__(), None)
+                        next(
+                            _parse_data(data[node.input[1]], external_data_dir).__iter__(),
+                            None,
+                        )
                         if len(node.input) > 1
                         else None
                     ),
                     (
-                        next(_parse_data(data[node.input[2]]).__iter__(), None)
+                        next(
+                            _parse_data(data[node.input[2]], external_data_dir).__iter__(),
+                            None,
+                        )
                         if len(node.input) > 2
                         else None
                     ),
@@ -612,7 +719,7 @@ class OnnxStub:
                     mode,
                 )
             elif node.op_type == "Reshape":
-                shape = _parse_data(data[node.input[1]])
+                shape = _parse_data(data[node.input[1]], external_data_dir)
                 tensors[node.output[0]] = self.handler.reshape(
                     tensors[node.input[0]],
                     tensors.get(node.output[0]),
@@ -651,15 +758,15 @@ class OnnxStub:
                     ]
                 )
                 if len(node.input) > 1 and node.input[1] in data:
-                    roiVal = _parse_data(data[node.input[1]])
+                    roiVal = _parse_data(data[node.input[1]], external_data_dir)
                 else:
                     roiVal = []
                 if len(node.input) > 2 and node.input[2] in data:
-                    scalesVal = _parse_data(data[node.input[2]])
+                    scalesVal = _parse_data(data[node.input[2]], external_data_dir)
                 else:
                     scalesVal = []
                 if len(node.input) > 3 and node.input[3] in data:
-                    sizesVal = _parse_data(data[node.input[3]])
+                    sizesVal = _parse_data(data[node.input[3]], external_data_dir)
                 else:
                     sizesVal = []
                 tensors[node.output[0]] = self.handler.resize(
@@ -690,7 +797,11 @@ class OnnxStub:
                     coordinate_transformation_mode,
                 )
             elif node.op_type == "Squeeze":
-                axes = _parse_data(data[node.input[1]]) if len(node.input) > 1 else None
+                axes = (
+                    _parse_data(data[node.input[1]], external_data_dir)
+                    if len(node.input) > 1
+                    else None
+                )
                 if axes is None:
                     axes = next(
                         (attr.ints for attr in node.attribute if attr.name == "axes"),
@@ -702,7 +813,11 @@ class OnnxStub:
                     axes,
                 )
             elif node.op_type == "Unsqueeze":
-                axes = _parse_data(data[node.input[1]]) if len(node.input) > 1 else None
+                axes = (
+                    _parse_data(data[node.input[1]], external_data_dir)
+                    if len(node.input) > 1
+                    else None
+                )
                 if axes is None:
                     axes = next(
                         (attr.ints for attr in node.attribute if attr.name == "axes")
@@ -736,7 +851,9 @@ class OnnxStub:
                 )
             elif node.op_type == "Split":
                 split = (
-                    _parse_data(data[node.input[1]]) if (len(node.input) > 1) else None
+                    _parse_data(data[node.input[1]], external_data_dir)
+                    if (len(node.input) > 1)
+                    else None
                 )
                 if split is None:
                     split = next(
@@ -800,15 +917,15 @@ class OnnxStub:
                 tensors[node.output[0]] = self.handler.slice(
                     tensors[node.input[0]],
                     tensors.get(node.output[0]),
-                    clamp(_parse_data(data[node.input[1]])),
-                    clamp(_parse_data(data[node.input[2]])),
+                    clamp(_parse_data(data[node.input[1]], external_data_dir)),
+                    clamp(_parse_data(data[node.input[2]], external_data_dir)),
                     (
-                        clamp(_parse_data(data[node.input[3]]))
+                        clamp(_parse_data(data[node.input[3]], external_data_dir))
                         if len(node.input) > 3
                         else None
                     ),
                     (
-                        clamp(_parse_data(data[node.input[4]]))
+                        clamp(_parse_data(data[node.input[4]], external_data_dir))
                         if len(node.input) > 4
                         else None
                     ),
@@ -817,8 +934,12 @@ class OnnxStub:
                 tensors[node.output[0]] = self.handler.pad(
                     tensors[node.input[0]],
                     tensors.get(node.output[0]),
-                    _parse_data(data[node.input[1]]),
-                    _parse_data(data[node.input[3]]) if len(node.input) > 3 else None,
+                    _parse_data(data[node.input[1]], external_data_dir),
+                    (
+                        _parse_data(data[node.input[3]], external_data_dir)
+                        if len(node.input) > 3
+                        else None
+                    ),
                 )
             elif node.op_type == "Dropout":
                 for name, tensor in zip(
@@ -828,12 +949,12 @@ class OnnxStub:
                         tensors.get(node.output[0]),
                         tensors.get(node.output[1]) if len(node.output) > 1 else None,
                         (
-                            _parse_data(data[node.input[1]])[0]
+                            _parse_data(data[node.input[1]], external_data_dir)[0]
                             if len(node.input) > 1
                             else 0.5
                         ),
                         (
-                            _parse_data(data[node.input[2]])[0]
+                            _parse_data(data[node.input[2]], external_data_dir)[0]
                             if len(node.input) > 2
                             else False
                         ),
@@ -856,7 +977,7 @@ class OnnxStub:
                 else:
                     # NOTE: `axes` is an attribute until opset version 13.
                     if len(node.input) > 1:
-                        axis = _parse_data(data[node.input[1]])
+                        axis = _parse_data(data[node.input[1]], external_data_dir)
                     else:
                         axis = next(
                             (
@@ -973,7 +1094,7 @@ class OnnxStub:
                     None,
                 )
             elif node.op_type == "Expand":
-                shape = _parse_data(data[node.input[1]])
+                shape = _parse_data(data[node.input[1]], external_data_dir)
                 tensors[node.output[0]] = self.handler.expand(
                     tensors[node.input[0]],
                     tensors.get(node.output[0]),
@@ -988,8 +1109,8 @@ class OnnxStub:
                 ## If Y is single -inf, treat Where as Add
                 ## TODO: deal with cases where Y is single inf or 0
                 if node.input[0] in data and node.input[2] in data:
-                    where_condition = to_array(data[node.input[0]])
-                    where_alt = to_array(data[node.input[2]])
+                    where_condition = to_array(data[node.input[0]], external_data_dir)
+                    where_alt = to_array(data[node.input[2]], external_data_dir)
                     if where_alt.size == 1:
                         if np.isneginf(where_alt) or np.all(where_alt < -3e38):
                             node.input[0] = node.input[0] + "_alt"
@@ -1049,6 +1170,8 @@ class OnnxStub:
         # Allocate memory space for data
         ################################
         self.handler.data_malloc(self.use_naive_allocator)
+        if prefetch_weights:
+            self.handler.prefetch_weights()
 
         #################################
         # Copy in data to tensor objects
@@ -1060,6 +1183,8 @@ class OnnxStub:
                     self.inputs[name] = obj
             else:
                 self.initializer[obj.fuid()] = tensor
+                if name in mapped:
+                    continue
                 # TODO: delete these lines after copyin_numpy is stable
                 # if tensor.data_type == TensorProto.INT32:
                 #     obj.copyin_int32(_parse_data(tensor))
@@ -1426,11 +1551,46 @@ class OnnxStub:
 
         return ctx.build(name)
 
+    @classmethod
+    def load_compiled(cls, path: str, runtime) -> "OnnxStub":
+        """
+        Load a model written by `save_compiled`. The graph comes back
+        optimized, planned and tuned, with its weights; it is ready to `run`
+        without calling `init`.
+        """
+        stub = cls.__new__(cls)
+        stub.handler = backend.GraphHandler(runtime)
+        inputs, outputs = stub.handler.load_compiled(path)
+        stub.inputs = dict(inputs)
+        stub.outputs = dict(outputs)
+        stub.tensors = {**stub.inputs, **stub.outputs}
+        stub.tensor_node_map = {}
+        stub.initializer = {}
+        stub.use_naive_allocator = False
+        stub.symbols = {}
+        stub.specialized = False
+        return stub
+
+    def save_compiled(self, path: str) -> None:
+        """
+        Write the graph, its memory plan, the tuned kernels and the weights
+        to `path` for `load_compiled`. Call it after `init` (and `optimize`
+        and `tune` if wanted).
+        """
+        self.handler.save_compiled(
+            path, list(self.inputs.items()), list(self.outputs.items())
+        )
+
     def init(self) -> None:
         self.handler.data_malloc(self.use_naive_allocator)
 
-    def optimize(self) -> None:
-        self.handler.optimize()
+    def optimize(self, dump: bool = False) -> None:
+        self.handler.optimize(dump)
+
+    def pass_stats(self) -> List[Dict[str, Any]]:
+        """Per-pass statistics of the last `optimize` call."""
+        keys = ["name", "runs", "changes", "ops_removed", "time_ms", "note"]
+        return [dict(zip(keys, s)) for s in self.handler.get_pass_stats()]
 
     def clone_KV(self, tensor: backend.Tensor) -> backend.Tensor:
         return self.handler.clone_KV(tensor)
@@ -1438,7 +1598,114 @@ class OnnxStub:
     def free_heap(self) -> None:
         self.handler.free_heap()
 
+    def specialize(self) -> None:
+        """
+        Specialize the graph once for its symbolic input dimensions (the
+        ONNX `dim_param`s), so that `set_input` only binds their new values
+        instead of inferring shapes and planning memory again. Call it after
+        `init`.
+        """
+        names = list(self.symbols)
+        self.handler.specialize(
+            names,
+            [
+                [(self.inputs[name].fuid(), axis) for name, axis in self.symbols[n]]
+                for n in names
+            ],
+        )
+        self.specialized = True
+
+    def _symbol_values(self, inputShapes: List[List[int]]) -> Optional[List[int]]:
+        """Values of the symbols if `inputShapes` differ only in them."""
+        shapes = dict(zip(self.inputs, inputShapes))
+        symbolic = {dim for dims in self.symbols.values() for dim in dims}
+        for name, shape in shapes.items():
+            old = self.handler.getDims(self.inputs[name])
+            if len(shape) != len(old) or any(
+                n != o and (name, axis) not in symbolic
+                for axis, (n, o) in enumerate(zip(shape, old))
+            ):
+                return None
+        values = []
+        for dims in self.symbols.values():
+            sizes = {shapes[name][axis] for name, axis in dims}
+            if len(sizes) != 1:
+                return None
+            values.append(sizes.pop())
+        return values
+
+    def set_buckets(self, buckets: List[Dict[str, int]], tune: bool = False) -> None:
+        """
+        Prepare the graph for a few values of its symbols, e.g.
+        `[{"seq": 32}, {"seq": 64}, {"seq": 128}]`, so that `run_padded`
+        pads each request up to the smallest bucket that holds it instead of
+        planning its own shapes. With `tune`, each bucket is tuned once.
+        """
+        if not self.specialized:
+            self.specialize()
+        names = list(self.symbols)
+        self.handler.set_buckets([[b[n] for n in names] for b in buckets], tune)
+
+    def run_padded(
+        self, inputs: Dict[str, np.ndarray], pad_values: Dict[str, Any] = {}
+    ) -> Dict[str, np.ndarray]:
+        """
+        Run a request on its bucket (see `set_buckets`). Each input is
+        padded at the end of its symbolic axes with `pad_values[name]`
+        (0 by default, which also masks out padded positions of an
+        attention mask), and the outputs are cropped back to the request.
+        """
+        values = self._symbol_values([list(inputs[n].shape) for n in self.inputs])
+        if values is None:
+            raise ValueError("inputs differ from the model in more than its symbols")
+        self.handler.bind_bucket(values)
+        for name, array in inputs.items():
+            tensor = self.inputs[name]
+            pads = [(0, n - d) for n, d in zip(self.handler.getDims(tensor), array.shape)]
+            tensor.copyin_numpy(
+                np.ascontiguousarray(
+                    np.pad(array, pads, constant_values=pad_values.get(name, 0))
+                )
+            )
+        self.handler.run()
+        return {
+            name: tensor.copyout_numpy()[
+                tuple(slice(0, d) for d in self.handler.symbolic_shape(tensor, values))
+            ]
+            for name, tensor in self.outputs.items()
+        }
+
+    def bucket_stats(self) -> Dict[str, Any]:
+        """
+        Hits and padding waste of each bucket since `set_buckets`, and the
+        requests that fit no bucket and ran on their own shapes.
+        """
+        names = list(self.symbols)
+        buckets = []
+        for values, hits, used, padded in self.handler.get_bucket_stats():
+            buckets.append(
+                {
+                    "bucket": dict(zip(names, values)),
+                    "hits": hits,
+                    "padding_waste": padded / (used + padded) if hits else 0.0,
+                }
+            )
+        misses = self.handler.get_bucket_misses()
+        total = sum(b["hits"] for b in buckets) + misses
+        for b in buckets:
+            b["hit_rate"] = b["hits"] / total if total else 0.0
+        return {"buckets": buckets, "misses": misses}
+
+    def reset_bucket_stats(self) -> None:
+        self.handler.reset_bucket_stats()
+
     def set_input(self, inputShapes: List[int]) -> None:
+        if self.specialized:
+            values = self._symbol_values(inputShapes)
+            if values is not None:
+                self.handler.bind_symbols(values)
+                return
+            self.specialized = False
         for newInput, oldInput in zip(inputShapes, self.inputs):
             oldTensor = self.inputs[oldInput]
             self.handler.change_shape(newInput, oldTensor.fuid())
@@ -1452,8 +1719,33 @@ class OnnxStub:
             ans = self.handler.getDims(self.outputs[name])
         return ans
 
-    def tune(self) -> None:
-        self.handler.tune()
+    def calibrate(
+        self, samples: List[Dict[str, np.ndarray]]
+    ) -> Dict[str, Tuple[float, float]]:
+        """
+        Run the model on sample inputs and return the observed [min, max] of
+        every float activation, by tensor name. Feed the result to
+        `quantize_static`.
+        """
+        self.handler.clear_calibration()
+        for sample in samples:
+            for name, array in sample.items():
+                self.inputs[name].copyin_numpy(array)
+            self.handler.calibrate()
+        names = {tensor.fuid(): name for name, tensor in self.tensors.items()}
+        return {
+            names[fuid]: value
+            for fuid, value in self.handler.get_calibration().items()
+            if fuid in names
+        }
+
+    def tune(self, budget: float = 0, threads: int = 1) -> None:
+        """
+        Tune the kernels of the graph within `budget` milliseconds (0 for no
+        limit); operators left keep their default kernel. On CPU, `threads`
+        independent operators are tuned at once, each on its own cores.
+        """
+        self.handler.tune(budget, threads)
 
     def run(self) -> None:
         self.handler.run()
@@ -1470,6 +1762,171 @@ def from_onnx(model: ModelProto, runtime):
     return stub.inputs, stub.outputs, stub.handler
 
 
+def quantize_weight(
+    weight: np.ndarray, bits: int, group_size: int
+) -> Tuple[np.ndarray, np.ndarray, Optional[np.ndarray]]:
+    """
+    Quantize a [K, N] MatMul weight for `QuantizedMatMul`.
+    Returns the weight as [N, K] (int8) or [N, K / 2] packed nibbles (int4),
+    the [N, K / group_size] scales and the zero points (None for int8,
+    which is symmetric).
+    """
+    w = weight.astype(np.float32).T
+    n, k = w.shape
+    groups = w.reshape(n, k // group_size, group_size)
+    if bits == 8:
+        scale = np.abs(groups).max(axis=2) / 127.0
+        scale[scale == 0] = 1.0
+        q = np.clip(np.rint(groups / scale[..., None]), -127, 127)
+        return q.reshape(n, k).astype(np.int8), scale.astype(np.float32), None
+    lo = np.minimum(groups.min(axis=2), 0.0)
+    hi = np.maximum(groups.max(axis=2), 0.0)
+    scale = (hi - lo) / 15.0
+    scale[scale == 0] = 1.0
+    zero_point = np.clip(np.rint(-lo / scale), 0, 15)
+    q = np.clip(np.rint(groups / scale[..., None]) + zero_point[..., None], 0, 15)
+    q = q.reshape(n, k).astype(np.uint8)
+    packed = q[:, 0::2] | (q[:, 1::2] << 4)
+    return packed, scale.astype(np.float32), zero_point.astype(np.uint8)
+
+
+def quantize_static(
+    model: ModelProto, ranges: Dict[str, Tuple[float, float]]
+) -> ModelProto:
+    """
+    Quantize Conv and MatMul to int8 in QDQ form, using activation ranges
+    from `OnnxStub.calibrate`. Activations become uint8 with per-tensor
+    parameters, weights int8 with per-channel scales and biases int32.
+    `OnnxStub.optimize` folds the result into QLinearConv/QLinearMatMul.
+    Nodes whose input or output has no recorded range stay in float.
+    """
+    model = copy.deepcopy(model)
+    graph = model.graph
+    initializers = {t.name: t for t in graph.initializer}
+    new_initializers: List[TensorProto] = []
+    nodes: List[NodeProto] = []
+    # activations already available in dequantized form
+    dequantized: Dict[str, str] = dict()
+
+    def add_initializer(array: np.ndarray, name: str) -> str:
+        new_initializers.append(from_array(array, name))
+        return name
+
+    def activation_params(name: str) -> Tuple[float, int]:
+        lo, hi = ranges[name]
+        lo, hi = min(lo, 0.0), max(hi, 0.0)
+        scale = (hi - lo) / 255.0 if hi > lo else 1.0
+        return scale, int(np.clip(np.rint(-lo / scale), 0, 255))
+
+    def qdq_input(name: str) -> str:
+        if name not in dequantized:
+            scale, zero_point = activation_params(name)
+            s = add_initializer(np.array(scale, np.float32), name + "_scale")
+            z = add_initializer(np.array(zero_point, np.uint8), name + "_zp")
+            nodes.append(make_node("QuantizeLinear", [name, s, z], [name + "_q"]))
+            nodes.append(
+                make_node("DequantizeLinear", [name + "_q", s, z], [name + "_dq"])
+            )
+            dequantized[name] = name + "_dq"
+        return dequantized[name]
+
+    def dq_weight(name: str, axis: int) -> Tuple[str, np.ndarray]:
+        w = to_array(initializers[name]).astype(np.float32)
+        reduce_axes = tuple(i for i in range(w.ndim) if i != axis)
+        scale = np.abs(w).max(axis=reduce_axes) / 127.0
+        scale[scale == 0] = 1.0
+        shape = [1] * w.ndim
+        shape[axis] = -1
+        q = np.clip(np.rint(w / scale.reshape(shape)), -127, 127).astype(np.int8)
+        q_name = add_initializer(q, name + "_q")
+        s = add_initializer(scale.astype(np.float32), name + "_scale")
+        z = add_initializer(np.zeros(scale.shape, np.int8), name + "_zp")
+        nodes.append(
+            make_node("DequantizeLinear", [q_name, s, z], [name + "_dq"], axis=axis)
+        )
+        return name + "_dq", scale
+
+    for node in graph.node:
+        x = node.input[0] if len(node.input) > 0 else ""
+        quantizable = (
+            node.op_type in ["Conv", "MatMul"]
+            and len(node.input) > 1
+            and node.input[1] in initializers
+            and x in ranges
+            and node.output[0] in ranges
+            and (node.op_type == "Conv" or len(initializers[node.input[1]].dims) == 2)
+        )
+        if not quantizable:
+            nodes.append(node)
+            continue
+        x_dq = qdq_input(x)
+        axis = 0 if node.op_type == "Conv" else 1
+        w_dq, w_scale = dq_weight(node.input[1], axis)
+        inputs = [x_dq, w_dq]
+        if len(node.input) > 2 and node.input[2] in initializers:
+            x_scale, _ = activation_params(x)
+            b = to_array(initializers[node.input[2]]).astype(np.float32)
+            b_scale = (x_scale * w_scale).astype(np.float32)
+            b_q = np.rint(b / b_scale).astype(np.int32)
+            b_name = node.input[2]
+            add_initializer(b_q, b_name + "_q")
+            add_initializer(b_scale, b_name + "_scale")
+            nodes.append(
+                make_node(
+                    "DequantizeLinear",
+                    [b_name + "_q", b_name + "_scale"],
+                    [b_name + "_dq"],
+                    axis=0,
+                )
+            )
+            inputs.append(b_name + "_dq")
+        # The float result keeps its name after Q/DQ so consumers and graph
+        # outputs are unchanged.
+        y = node.output[0]
+        scale, zero_point = activation_params(y)
+        s = add_initializer(np.array(scale, np.float32), y + "_scale")
+        z = add_initializer(np.array(zero_point, np.uint8), y + "_zp")
+        new_node = copy.deepcopy(node)
+        del new_node.input[:]
+        new_node.input.extend(inputs)
+        new_node.output[0] = y + "_float"
+        nodes.append(new_node)
+        nodes.append(make_node("QuantizeLinear", [y + "_float", s, z], [y + "_q"]))
+        nodes.append(make_node("DequantizeLinear", [y + "_q", s, z], [y]))
+        dequantized[y] = y
+
+    del graph.node[:]
+    graph.node.extend(nodes)
+    graph.initializer.extend(new_initializers)
+    return model
+
+
+def _quantize_matmul_weights(
+    model: ModelProto, mode: str, group_size: int, base_dir: Optional[str] = None
+) -> Dict[str, Tuple[np.ndarray, np.ndarray, Optional[np.ndarray], int, int]]:
+    bits = {"int8": 8, "int4": 4}[mode]
+    initializers = {t.name: t for t in model.graph.initializer}
+    uses: Dict[str, List[Tuple[NodeProto, int]]] = dict()
+    for node in model.graph.node:
+        for i, name in enumerate(node.input):
+            uses.setdefault(name, []).append((node, i))
+    ans = dict()
+    for name, tensor in initializers.items():
+        if tensor.data_type != TensorProto.FLOAT or len(tensor.dims) != 2:
+            continue
+        if not all(n.op_type == "MatMul" and i == 1 for n, i in uses.get(name, [])):
+            continue
+        k = tensor.dims[0]
+        if bits == 4 and k % 2 != 0:
+            continue
+        group = group_size if k % group_size == 0 and group_size % 2 == 0 else k
+        q, scale, zero_point = quantize_weight(
+            to_array(tensor, base_dir or ""), bits, group
+        )
+        ans[name] = (q, scale, zero_point, bits, group)
+    return ans
+
+
 def _parse_attribute(node: NodeProto, attrs: Dict[str, Any] = dict()) -> Dict[str, Any]:
     for attr in node.attribute:
         if attr.type == AttributeProto.INT:
@@ -1487,8 +1944,8 @@ def _parse_attribute(node: NodeProto, attrs: Dict[str, Any] = dict()) -> Dict[st
     return attrs
 
 
-def _parse_data(tensor: TensorProto) -> List[Any]:
-    return to_array(tensor).flatten().tolist()
+def _parse_data(tensor: TensorProto, base_dir: Optional[str] = None) -> List[Any]:
+    return to_array(tensor, base_dir or "").flatten().tolist()
 
 
 def _parse_data_fp16(tensor: TensorProto):
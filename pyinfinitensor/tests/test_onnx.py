@@ -593,6 +593,31 @@ class TestStringMethods(unittest.TestCase):
         from_onnx(model, backend.cpu_runtime())
 
 
+class TestCompiledModel(unittest.TestCase):
+    def test_save_and_load(self):
+        x = make_tensor_value_info("x", TensorProto.FLOAT, [2, 3])
+        y = make_tensor_value_info("y", TensorProto.FLOAT, [2, 4])
+        w = make_tensor("w", TensorProto.FLOAT, [3, 4], list(range(12)))
+        matmul = make_node("MatMul", ["x", "w"], ["xw"], name="matmul")
+        neg = make_node("Neg", ["xw"], ["y"], name="neg")
+        graph = make_graph([matmul, neg], "compiled", [x], [y], [w])
+        stub = OnnxStub(make_model(graph), backend.cpu_runtime())
+        stub.optimize()
+        stub.init()
+        data = np.arange(6, dtype=np.float32).reshape(2, 3)
+        stub.inputs["x"].copyin_numpy(data)
+        stub.run()
+        expected = stub.outputs["y"].copyout_numpy()
+
+        path = "compiled_model.bin"
+        stub.save_compiled(path)
+        loaded = OnnxStub.load_compiled(path, backend.cpu_runtime())
+        os.remove(path)
+        loaded.inputs["x"].copyin_numpy(data)
+        loaded.run()
+        np.testing.assert_array_equal(loaded.outputs["y"].copyout_numpy(), expected)
+
+
 class TestDynamicTensor(unittest.TestCase):
     def test_dynamic_tensor(self):
         filename = r"resnet18-v2-7.onnx"
@@ -17,9 +17,9 @@ void ASCENDRuntimeObj::runWithoutSync(const Graph &graph, bool tune = false,
     for (auto &op : graph->getOperators()) {
         // HACK: set correct data type
         auto kernelAttrs = KernelAttrs{device, op->getOpType().underlying()};
-        Kernel *kernel = kernelRegistry.getKernel(kernelAttrs);
         auto perfKey = PerfEngine::Key{kernelAttrs, op->getOpPerfKey()};
         auto perfData = perfEngine.getPerfData(perfKey);
+        Kernel *kernel = kernelRegistry.getKernel(kernelAttrs, op, perfData);
         if (!perfData && !tune) {
             kernel->compute(op, this);
             continue;
@@ -27,7 +27,8 @@ void ASCENDRuntimeObj::runWithoutSync(const Graph &graph, bool tune = false,
 
         PerfRecord record;
         if (!perfData) {
-            record = kernel->tune(op, this);
+            record = kernelRegistry.tune(kernelAttrs, op, this);
+            kernel = kernelRegistry.getKernel(kernelAttrs, op, record);
             perfEngine.setPerfData(perfKey, record);
         } else
             record = perfData;
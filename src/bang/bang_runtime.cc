@@ -17,9 +17,9 @@ void BangRuntimeObj::runWithoutSync(const Graph &graph, bool tune = false,
     for (auto &op : graph->getOperators()) {
         // HACK: set correct data type
         auto kernelAttrs = KernelAttrs{device, op->getOpType().underlying()};
-        Kernel *kernel = kernelRegistry.getKernel(kernelAttrs);
         auto perfKey = PerfEngine::Key{kernelAttrs, op->getOpPerfKey()};
         auto perfData = perfEngine.getPerfData(perfKey);
+        Kernel *kernel = kernelRegistry.getKernel(kernelAttrs, op, perfData);
         if (!perfData && !tune) {
             kernel->compute(op, this);
             this->resetWorkspace();
@@ -28,7 +28,8 @@ void BangRuntimeObj::runWithoutSync(const Graph &graph, bool tune = false,
 
         PerfRecord record;
         if (!perfData) {
-            record = kernel->tune(op, this);
+            record = kernelRegistry.tune(kernelAttrs, op, this);
+            kernel = kernelRegistry.getKernel(kernelAttrs, op, record);
             this->resetWorkspace();
             perfEngine.setPerfData(perfKey, record);
         } else
@@ -0,0 +1,797 @@
+#include "core/compiled_model.h"
+#include "core/kernel.h"
+#include "core/perf_engine.h"
+#include "operators/attention_kvcache.h"
+#include "operators/batch_norm.h"
+#include "operators/concat.h"
+#include "operators/conv.h"
+#include "operators/element_wise.h"
+#include "operators/expand.h"
+#include "operators/fused_element_wise.h"
+#include "operators/gather.h"
+#include "operators/gemm.h"
+#include "operators/global_pool.h"
+#include "operators/instance_norm.h"
+#include "operators/layer_norm.h"
+#include "operators/lrn.h"
+#include "operators/matmul.h"
+#include "operators/pad.h"
+#include "operators/pooling.h"
+#include "operators/quantize.h"
+#include "operators/reduce.h"
+#include "operators/reshape.h"
+#include "operators/resize.h"
+#include "operators/rms_norm.h"
+#include "operators/rope.h"
+#include "operators/slice.h"
+#include "operators/softmax.h"
+#include "operators/split.h"
+#include "operators/squeeze.h"
+#include "operators/transpose.h"
+#include "operators/unary.h"
+#include "operators/unsqueeze.h"
+#include "operators/where.h"
+#include "utils/mapped_file.h"
+#include <fstream>
+#include <numeric>
+#include <nlohmann/json.hpp>
+
+namespace infini {
+
+namespace {
+
+constexpr char magic[8] = {'I', 'T', 'M', 'O', 'D', 'E', 'L', '\0'};
+// Bump when the layout below or the numbering of OpType changes.
+constexpr uint32_t version = 2;
+// Alignment of each weight inside the weight section.
+constexpr size_t weightAlignment = 64;
+
+size_t alignUp(size_t n, size_t alignment) {
+    return (n + alignment - 1) / alignment * alignment;
+}
+
+class Writer {
+    std::ofstream out;
+
+  public:
+    explicit Writer(const string &path)
+        : out(path, std::ios::out | std::ios::trunc | std::ios::binary) {
+        IT_ASSERT(out.is_open(), "Cannot open " + path);
+    }
+    void bytes(const void *data, size_t size) {
+        out.write(static_cast<const char *>(data), size);
+        IT_ASSERT(out.good(), "Failed to write the compiled model");
+    }
+    template <typename T> void pod(const T &value) {
+        bytes(&value, sizeof(T));
+    }
+    template <typename T> void vec(const vector<T> &values) {
+        pod<uint64_t>(values.size());
+        bytes(values.data(), values.size() * sizeof(T));
+    }
+    void str(const string &s) {
+        pod<uint64_t>(s.size());
+        bytes(s.data(), s.size());
+    }
+    size_t tell() { return out.tellp(); }
+    void padTo(size_t alignment) {
+        vector<char> zeros((alignment - tell() % alignment) % alignment);
+        bytes(zeros.data(), zeros.size());
+    }
+};
+
+class Reader {
+    std::ifstream in;
+
+  public:
+    explicit Reader(const string &path)
+        : in(path, std::ios::in | std::ios::binary) {
+        IT_ASSERT(in.is_open(), "Cannot open " + path);
+    }
+    void bytes(void *data, size_t size) {
+        in.read(static_cast<char *>(data), size);
+        IT_ASSERT(in.good(), "Truncated compiled model");
+    }
+    template <typename T> T pod() {
+        T value;
+        bytes(&value, sizeof(T));
+        return value;
+    }
+    template <typename T> vector<T> vec() {
+        vector<T> values(pod<uint64_t>());
+        bytes(values.data(), values.size() * sizeof(T));
+        return values;
+    }
+    string str() {
+        string s(pod<uint64_t>(), '\0');
+        bytes(s.data(), s.size());
+        return s;
+    }
+    size_t tell() { return in.tellg(); }
+};
+
+// Attributes of one operator. encodeAttrs() and addOperator() are the only
+// places that know the order of the values for each operator type.
+struct OpAttrs {
+    vector<int> ints;
+    vector<float> floats;
+    string str;
+};
+
+OpAttrs encodeAttrs(const Operator &op) {
+    OpAttrs a;
+    switch (op->getOpType().underlying()) {
+    case OpType::MatMul: {
+        auto matmul = as<MatmulObj>(op);
+        a.ints = {matmul->getTransA(), matmul->getTransB(),
+                  matmul->getBias() != nullptr,
+                  matmul->getResidual() != nullptr,
+                  static_cast<int>(matmul->getAct())};
+        for (int n : matmul->getSplitN())
+            a.ints.emplace_back(n);
+        a.str = matmul->getComputeType();
+        break;
+    }
+    case OpType::Conv: {
+        auto conv = as<ConvObj>(op);
+        auto [ph, pw, sh, sw, dh, dw] = conv->getPadStrideDilation();
+        a.ints = {ph, pw, sh, sw, dh, dw, static_cast<int>(conv->getAct())};
+        break;
+    }
+    case OpType::ConvTranspose: {
+        auto conv = as<ConvTransposed2dObj>(op);
+        auto [ph, pw, sh, sw, dh, dw] = conv->getPadStrideDilation();
+        auto [oph, opw] = conv->getOutputPadding();
+        a.ints = {ph, pw, sh, sw, dh, dw, oph, opw, conv->getNumGroups(),
+                  static_cast<int>(conv->getAct())};
+        break;
+    }
+    case OpType::QLinearMatMul:
+        a.ints = {as<QLinearMatmulObj>(op)->getTransB()};
+        break;
+    case OpType::QLinearConv: {
+        auto [ph, pw, sh, sw, dh, dw] =
+            as<QLinearConvObj>(op)->getPadStrideDilation();
+        a.ints = {ph, pw, sh, sw, dh, dw};
+        break;
+    }
+    case OpType::Gemm: {
+        auto gemm = as<GemmObj>(op);
+        a.ints = {gemm->getTransA(), gemm->getTransB()};
+        a.floats = {gemm->getAlpha(), gemm->getBeta()};
+        break;
+    }
+    case OpType::QuantizedMatMul: {
+        auto matmul = as<QuantizedMatmulObj>(op);
+        a.ints = {matmul->getBits(), matmul->getGroupSize()};
+        break;
+    }
+    case OpType::QuantizeLinear: {
+        auto quant = as<QuantizeLinearObj>(op);
+        a.ints = {quant->getAxis(), quant->getBlockSize()};
+        break;
+    }
+    case OpType::DequantizeLinear: {
+        auto dequant = as<DequantizeLinearObj>(op);
+        a.ints = {dequant->getAxis(), dequant->getBlockSize()};
+        break;
+    }
+    case OpType::FusedElementWise:
+        for (auto &instr : as<FusedElementWiseObj>(op)->getProgram())
+            a.ints.insert(a.ints.end(),
+                          {instr.type.underlying(), instr.a, instr.b});
+        break;
+    case OpType::Concat:
+        a.ints = {as<ConcatObj>(op)->getDim()};
+        break;
+    case OpType::Split: {
+        // The ratio is recovered from the output sizes along the axis.
+        int dim = as<SplitObj>(op)->getDim();
+        a.ints = {dim};
+        for (auto &output : op->getOutputs())
+            a.ints.emplace_back(output->getDims()[dim]);
+        break;
+    }
+    case OpType::Reshape:
+        a.ints = as<ReshapeObj>(op)->getDims();
+        break;
+    case OpType::Flatten:
+        a.ints = {as<FlattenObj>(op)->getAxis()};
+        break;
+    case OpType::Squeeze:
+        a.ints = as<SqueezeObj>(op)->getAxes();
+        break;
+    case OpType::Unsqueeze:
+        a.ints = as<UnsqueezeObj>(op)->getAxes();
+        break;
+    case OpType::Expand:
+        a.ints = as<ExpandObj>(op)->getShape();
+        break;
+    case OpType::Transpose:
+        a.ints = as<TransposeObj>(op)->getPermute();
+        break;
+    case OpType::Softmax:
+        a.ints = {as<SoftmaxObj>(op)->getAxis()};
+        break;
+    case OpType::Gather:
+    case OpType::GatherElements:
+        a.ints = {as<GatherBaseObj>(op)->getAxis()};
+        break;
+    case OpType::Slice: {
+        auto slice = as<SliceObj>(op);
+        a.ints = slice->getStarts();
+        auto ends = slice->getEnds(), steps = slice->getSteps();
+        a.ints.insert(a.ints.end(), ends.begin(), ends.end());
+        a.ints.insert(a.ints.end(), steps.begin(), steps.end());
+        break;
+    }
+    case OpType::ReduceMean:
+    case OpType::ReduceMax:
+    case OpType::ReduceMin:
+    case OpType::ReduceSum: {
+        auto reduce = as<ReduceBaseObj>(op);
+        a.ints = {reduce->getKeepDims()};
+        a.ints.insert(a.ints.end(), reduce->getAxes().begin(),
+                      reduce->getAxes().end());
+        break;
+    }
+    case OpType::Pad:
+        a.ints = as<PadObj>(op)->getPads();
+        break;
+    case OpType::DepthToSpace: {
+        auto d2s = as<DepthToSpaceObj>(op);
+        a.ints = {d2s->getBlockSize()};
+        a.str = d2s->getModeString();
+        break;
+    }
+    case OpType::Resize: {
+        // Sizes, scales and roi are read when the operator is built, so
+        // they must be weights.
+        auto resize = as<ResizeObj>(op);
+        for (int i = 1; i < op->numInputs(); ++i)
+            IT_ASSERT(op->getInputs(i)->isWeight(),
+                      "Compiled models need the sizes, scales and roi of "
+                      "Resize to be weights");
+        a.ints = {static_cast<int>(resize->getMode()),
+                  resize->getNearestMode(), resize->getKeepAxesRatioPolicy(),
+                  resize->getCoordinateTransMode(),
+                  resize->isResizeBySizes()};
+        auto axes = resize->getAxes();
+        a.ints.insert(a.ints.end(), axes.begin(), axes.end());
+        break;
+    }
+    case OpType::RMSNorm:
+        a.floats = {as<RMSNormObj>(op)->getEps()};
+        break;
+    case OpType::InstanceNormalization:
+        a.floats = {as<InstanceNormObj>(op)->getEps()};
+        break;
+    case OpType::LRN: {
+        auto lrn = as<LRNObj>(op);
+        auto [alpha, beta, bias] = lrn->getAlphaBetaBias();
+        a.ints = {lrn->getSize()};
+        a.floats = {alpha, beta, bias};
+        break;
+    }
+    case OpType::LayerNormalization: {
+        auto norm = as<LayerNormObj>(op);
+        a.ints = {norm->getAxis(), norm->getStashType()};
+        a.floats = {norm->getEps()};
+        break;
+    }
+    case OpType::BatchNormalization: {
+        auto norm = as<BatchNormObj>(op);
+        a.ints = {norm->getTrainingMode()};
+        a.floats = {norm->getMomentum(), norm->getEps()};
+        break;
+    }
+    case OpType::MaxPool:
+    case OpType::AveragePool: {
+        auto pool = as<PoolingObj>(op);
+        a.ints = {pool->getKh(), pool->getKw(), pool->getDh(),
+                  pool->getDw(), pool->getPh(), pool->getPw(),
+                  pool->getSh(), pool->getSw(), pool->getCeilMode()};
+        break;
+    }
+    case OpType::Cast:
+        a.ints = {static_cast<int>(as<CastObj>(op)->getType())};
+        break;
+    case OpType::Clip: {
+        auto clip = as<ClipObj>(op);
+        a.ints = {clip->getMin().has_value(), clip->getMax().has_value()};
+        a.floats = {clip->getMin().value_or(0), clip->getMax().value_or(0)};
+        break;
+    }
+    case OpType::LeakyRelu:
+        a.floats = {as<LeakyReluObj>(op)->getAlpha()};
+        break;
+    case OpType::Elu:
+        a.floats = {as<EluObj>(op)->getAlpha()};
+        break;
+    case OpType::Add:
+    case OpType::Sub:
+    case OpType::Mul:
+    case OpType::Div:
+    case OpType::Pow:
+    case OpType::Max:
+    case OpType::Min:
+    case OpType::Equal:
+    case OpType::Greater:
+    case OpType::GreaterOrEqual:
+    case OpType::Less:
+    case OpType::LessOrEqual:
+    case OpType::Relu:
+    case OpType::Silu:
+    case OpType::Gelu:
+    case OpType::Sigmoid:
+    case OpType::Tanh:
+    case OpType::Abs:
+    case OpType::HardSigmoid:
+    case OpType::HardSwish:
+    case OpType::Sin:
+    case OpType::Cos:
+    case OpType::Ceil:
+    case OpType::Floor:
+    case OpType::Erf:
+    case OpType::Exp:
+    case OpType::Neg:
+    case OpType::Reciprocal:
+    case OpType::Sqrt:
+    case OpType::Round:
+    case OpType::Shape:
+    case OpType::Where:
+    case OpType::PRelu:
+    case OpType::GlobalAveragePool:
+    case OpType::Identity:
+    case OpType::RoPE:
+    case OpType::AttentionKVCache:
+        // No attributes.
+        break;
+    default:
+        IT_TODO_HALT_MSG(string("Compiled models do not support ") +
+                         op->getOpType().toString());
+    }
+    return a;
+}
+
+// Rebuild an operator from its type, tensors and attributes. The outputs
+// exist already, so the constructors only check their shapes.
+Operator addOperator(const Graph &g, OpType type, const TensorVec &ins,
+                     const TensorVec &outs, const OpAttrs &a) {
+    auto &v = a.ints;
+    auto in = [&](size_t i) { return i < ins.size() ? ins[i] : nullptr; };
+    auto out = outs.empty() ? nullptr : outs[0];
+#define CASE_BINARY(TYPE, OBJ)                                                 \
+    case OpType::TYPE:                                                         \
+        return g->addOpWithOutputs<OBJ##Obj>(ins[0], ins[1], out)
+#define CASE_UNARY(TYPE, OBJ)                                                  \
+    case OpType::TYPE:                                                         \
+        return g->addOpWithOutputs<OBJ##Obj>(ins[0], out)
+
+    switch (type.underlying()) {
+    case OpType::MatMul: {
+        auto act = static_cast<ActType>(v[4]);
+        Tensor bias = v[2] ? ins[2] : nullptr;
+        if (v.size() > 5)
+            return g->addOpWithOutputs<MatmulObj>(
+                ins[0], ins[1], outs, vector<int>(v.begin() + 5, v.end()),
+                v[0], v[1], bias, act, a.str);
+        Tensor residual = v[3] ? ins.back() : nullptr;
+        return g->addOpWithOutputs<MatmulObj>(ins[0], ins[1], out, v[0], v[1],
+                                              bias, act, a.str, residual);
+    }
+    case OpType::Conv:
+        return g->addOpWithOutputs<ConvObj>(ins[0], ins[1], out, v[0], v[1],
+                                            in(2), v[2], v[3], v[4], v[5],
+                                            static_cast<ActType>(v[6]));
+    case OpType::ConvTranspose:
+        return g->addOpWithOutputs<ConvTransposed2dObj>(
+            ins[0], ins[1], out, v[0], v[1], v[2], v[3], v[4], v[5], v[6],
+            v[7], v[8], in(2), static_cast<ActType>(v[9]));
+    case OpType::QLinearConv:
+        return g->addOpWithOutputs<QLinearConvObj>(ins, out, v[0], v[1], v[2],
+                                                   v[3], v[4], v[5]);
+    case OpType::QLinearMatMul:
+        return g->addOpWithOutputs<QLinearMatmulObj>(ins, out, v[0]);
+    case OpType::Gemm:
+        return g->addOpWithOutputs<GemmObj>(ins[0], ins[1], out, in(2),
+                                            a.floats[0], a.floats[1], v[0],
+                                            v[1]);
+    case OpType::QuantizedMatMul:
+        return g->addOpWithOutputs<QuantizedMatmulObj>(
+            ins[0], ins[1], ins[2], in(3), out, v[0], v[1]);
+    case OpType::QuantizeLinear:
+        return g->addOpWithOutputs<QuantizeLinearObj>(ins[0], ins[1], in(2),
+                                                      out, v[0], v[1]);
+    case OpType::DequantizeLinear:
+        return g->addOpWithOutputs<DequantizeLinearObj>(ins[0], ins[1], in(2),
+                                                        out, v[0], v[1]);
+    case OpType::FusedElementWise: {
+        vector<FusedElementWiseObj::Instr> program;
+        for (size_t i = 0; i + 2 < v.size(); i += 3)
+            program.push_back({OpType(OpType::underlying_t(v[i])), v[i + 1],
+                               v[i + 2]});
+        return g->addOpWithOutputs<FusedElementWiseObj>(ins, out, program);
+    }
+    case OpType::Concat:
+        return g->addOpWithOutputs<ConcatObj>(ins, out, v[0]);
+    case OpType::Split:
+        return g->addOpWithOutputs<SplitObj>(
+            ins[0], outs, v[0], vector<int>(v.begin() + 1, v.end()));
+    case OpType::Reshape:
+        return g->addOpWithOutputs<ReshapeObj>(ins[0], out, v);
+    case OpType::Flatten:
+        return g->addOpWithOutputs<FlattenObj>(ins[0], out, v[0]);
+    case OpType::Squeeze:
+        return g->addOpWithOutputs<SqueezeObj>(ins[0], out, v);
+    case OpType::Unsqueeze:
+        return g->addOpWithOutputs<UnsqueezeObj>(ins[0], out, v);
+    case OpType::Expand:
+        return g->addOpWithOutputs<ExpandObj>(ins[0], out, v);
+    case OpType::Transpose:
+        return g->addOpWithOutputs<TransposeObj>(ins[0], out, v);
+    case OpType::Softmax:
+        return g->addOpWithOutputs<SoftmaxObj>(ins[0], out, v[0]);
+    case OpType::Gather:
+        return g->addOpWithOutputs<GatherObj>(ins[0], ins[1], out, v[0]);
+    case OpType::GatherElements:
+        return g->addOpWithOutputs<GatherElementsObj>(ins[0], ins[1], out,
+                                                      v[0]);
+    case OpType::Slice: {
+        size_t rank = v.size() / 3;
+        vector<int> axes(rank);
+        std::iota(axes.begin(), axes.end(), 0);
+        return g->addOpWithOutputs<SliceObj>(
+            ins[0], out, vector<int>(v.begin(), v.begin() + rank),
+            vector<int>(v.begin() + rank, v.begin() + 2 * rank), axes,
+            vector<int>(v.begin() + 2 * rank, v.end()));
+    }
+    case OpType::ReduceMean:
+    case OpType::ReduceMax:
+    case OpType::ReduceMin:
+    case OpType::ReduceSum: {
+        vector<int> axes(v.begin() + 1, v.end());
+        if (type == OpType::ReduceMean)
+            return g->addOpWithOutputs<ReduceMeanObj>(ins[0], out, axes, v[0]);
+        if (type == OpType::ReduceMax)
+            return g->addOpWithOutputs<ReduceMaxObj>(ins[0], out, axes, v[0]);
+        if (type == OpType::ReduceMin)
+            return g->addOpWithOutputs<ReduceMinObj>(ins[0], out, axes, v[0]);
+        return g->addOpWithOutputs<ReduceSumObj>(ins[0], out, axes, v[0]);
+    }
+    case OpType::LayerNormalization:
+        return g->addOpWithOutputs<LayerNormObj>(ins[0], ins[1], out, in(2),
+                                                 a.floats[0], v[0], v[1]);
+    case OpType::BatchNormalization:
+        return g->addOpWithOutputs<BatchNormObj>(
+            ins[0], out, ins[1], ins[2], ins[3], ins[4], a.floats[0],
+            a.floats[1], v[0]);
+    case OpType::MaxPool:
+        return g->addOpWithOutputs<MaxPoolObj>(ins[0], out, v[0], v[1], v[2],
+                                               v[3], v[4], v[5], v[6], v[7],
+                                               v[8]);
+    case OpType::AveragePool:
+        return g->addOpWithOutputs<AvgPoolObj>(ins[0], out, v[0], v[1], v[2],
+                                               v[3], v[4], v[5], v[6], v[7],
+                                               v[8]);
+    case OpType::Cast:
+        return g->addOpWithOutputs<CastObj>(ins[0], out,
+                                            static_cast<CastType>(v[0]));
+    case OpType::Clip:
+        return g->addOpWithOutputs<ClipObj>(
+            ins[0], out, v[0] ? std::optional(a.floats[0]) : std::nullopt,
+            v[1] ? std::optional(a.floats[1]) : std::nullopt);
+    case OpType::LeakyRelu:
+        return g->addOpWithOutputs<LeakyReluObj>(ins[0], out, a.floats[0]);
+    case OpType::Elu:
+        return g->addOpWithOutputs<EluObj>(ins[0], out, a.floats[0]);
+    case OpType::Where:
+        return g->addOpWithOutputs<WhereObj>(ins[0], ins[1], ins[2], out);
+    case OpType::PRelu:
+        return g->addOpWithOutputs<PReluObj>(ins[0], ins[1], out);
+    case OpType::Pad:
+        return g->addOpWithOutputs<PadObj>(ins[0], out, v, std::nullopt);
+    case OpType::DepthToSpace:
+        return g->addOpWithOutputs<DepthToSpaceObj>(ins[0], out, v[0], a.str);
+    case OpType::Resize: {
+        using R = ResizeObj;
+        auto mode = static_cast<R::ECoeffMode>(v[0]);
+        auto policy = static_cast<R::EKeepAspectRatioPolicy>(v[2]);
+        auto coMode = static_cast<R::ECoordinateTransMode>(v[3]);
+        vector<int> axes(v.begin() + 5, v.end());
+        // Inputs are x, then sizes or scales, then roi for tfCropAndResize.
+        bool hasRoi = coMode == R::ECoordinateTransMode::tfCropAndResize;
+        Tensor param = ins.size() > size_t(1 + hasRoi) ? ins[1] : nullptr;
+        Tensor sizes = v[4] ? param : nullptr, scales = v[4] ? nullptr : param;
+        Tensor roi = hasRoi ? ins.back() : nullptr;
+        if (mode == R::ECoeffMode::nearest)
+            return g->addOpWithOutputs<ResizeObj>(
+                ins[0], out, axes, sizes, scales, roi, policy,
+                static_cast<R::ENearestMode>(v[1]), coMode);
+        return g->addOpWithOutputs<ResizeObj>(ins[0], out, axes, sizes, scales,
+                                              roi, mode, policy, coMode);
+    }
+    case OpType::RMSNorm:
+        return g->addOpWithOutputs<RMSNormObj>(ins[0], ins[1], out,
+                                               a.floats[0]);
+    case OpType::InstanceNormalization:
+        return g->addOpWithOutputs<InstanceNormObj>(ins[0], out, ins[1], ins[2],
+                                                    a.floats[0]);
+    case OpType::LRN:
+        return g->addOpWithOutputs<LRNObj>(ins[0], out, a.floats[0],
+                                           a.floats[1], a.floats[2], v[0]);
+    case OpType::RoPE:
+        return g->addOpWithOutputs<RoPEObj>(ins[0], ins[1], out);
+    case OpType::AttentionKVCache:
+        return g->addOpWithOutputs<AttentionKVCacheObj>(
+            ins[0], ins[1], ins[2], ins[3], ins[4], ins[5], out);
+    case OpType::GlobalAveragePool:
+        return g->addOpWithOutputs<GlobalAvgPoolObj>(ins[0], out);
+    case OpType::Identity:
+        return g->addOpWithOutputs<IdentityObj>(ins[0], out);
+        CASE_BINARY(Add, Add);
+        CASE_BINARY(Sub, Sub);
+        CASE_BINARY(Mul, Mul);
+        CASE_BINARY(Div, Div);
+        CASE_BINARY(Pow, Pow);
+        CASE_BINARY(Max, Maximum);
+        CASE_BINARY(Min, Minimum);
+        CASE_BINARY(Equal, Equal);
+        CASE_BINARY(Greater, GreaterThan);
+        CASE_BINARY(GreaterOrEqual, GreaterEqual);
+        CASE_BINARY(Less, LessThan);
+        CASE_BINARY(LessOrEqual, LessEqual);
+        CASE_UNARY(Relu, Relu);
+        CASE_UNARY(Silu, Silu);
+        CASE_UNARY(Gelu, Gelu);
+        CASE_UNARY(Sigmoid, Sigmoid);
+        CASE_UNARY(Tanh, Tanh);
+        CASE_UNARY(Abs, Abs);
+        CASE_UNARY(HardSigmoid, HardSigmoid);
+        CASE_UNARY(HardSwish, HardSwish);
+        CASE_UNARY(Sin, Sin);
+        CASE_UNARY(Cos, Cos);
+        CASE_UNARY(Ceil, Ceil);
+        CASE_UNARY(Floor, Floor);
+        CASE_UNARY(Erf, Erf);
+        CASE_UNARY(Exp, Exp);
+        CASE_UNARY(Neg, Neg);
+        CASE_UNARY(Reciprocal, Reciprocal);
+        CASE_UNARY(Sqrt, Sqrt);
+        CASE_UNARY(Round, Round);
+        CASE_UNARY(Shape, Shape);
+    default:
+        IT_TODO_HALT_MSG(string("Compiled models do not support ") +
+                         type.toString());
+    }
+#undef CASE_UNARY
+#undef CASE_BINARY
+}
+
+PerfEngine::Key perfKeyOf(const Operator &op, Device device) {
+    return {KernelAttrs{device, op->getOpType().underlying()},
+            op->getOpPerfKey()};
+}
+
+} // namespace
+
+void saveCompiledModel(const Graph &graph, const string &path,
+                       const NamedTensors &inputs,
+                       const NamedTensors &outputs) {
+    auto runtime = graph->getRuntime();
+    auto &tensors = graph->getTensors();
+    // Weights are laid out again in the file, as some may be mapped from
+    // other files rather than held in the weight arena.
+    vector<size_t> offsets;
+    size_t weightBytes = 0;
+    for (auto &tensor : tensors) {
+        IT_ASSERT(tensor->hasData(),
+                  "Call dataMalloc() before saving a compiled model");
+        if (tensor->isWeight()) {
+            offsets.emplace_back(weightBytes);
+            weightBytes += alignUp(tensor->getBytes(), weightAlignment);
+        } else
+            offsets.emplace_back(graph->getArenaOffset(tensor));
+    }
+    std::unordered_map<TensorObj *, int> index;
+    for (size_t i = 0; i < tensors.size(); ++i)
+        index[tensors[i].get()] = i;
+    auto indicesOf = [&](const TensorVec &ts) {
+        vector<int> ret;
+        for (auto &t : ts)
+            ret.emplace_back(index.at(t.get()));
+        return ret;
+    };
+    auto writeNames = [&](Writer &w, const NamedTensors &names) {
+        w.pod<uint64_t>(names.size());
+        for (auto &[name, tensor] : names) {
+            w.str(name);
+            w.pod<int32_t>(index.at(tensor.get()));
+        }
+    };
+
+    // Encode every operator first, so that a graph with an unsupported
+    // operator is rejected before the file is touched.
+    auto &ops = graph->getOperators();
+    vector<OpAttrs> attrs;
+    for (auto &op : ops)
+        attrs.emplace_back(encodeAttrs(op));
+
+    Writer w(path);
+    w.bytes(magic, sizeof(magic));
+    w.pod<uint32_t>(version);
+    w.pod<uint64_t>(weightBytes);
+    w.pod<uint64_t>(graph->getActivationBytes());
+
+    w.pod<uint64_t>(tensors.size());
+    for (size_t i = 0; i < tensors.size(); ++i) {
+        auto &tensor = tensors[i];
+        w.vec(tensor->getDims());
+        w.pod<int32_t>(tensor->getDType().getIndex());
+        w.pod<int32_t>(tensor->isWeight()   ? int(TensorType::weight)
+                       : tensor->isInput()  ? int(TensorType::input)
+                       : tensor->isOutput() ? int(TensorType::output)
+                                            : int(TensorType::others));
+        w.pod<int32_t>(int(tensor->getLayout()));
+        w.pod<uint64_t>(offsets[i]);
+    }
+    writeNames(w, inputs);
+    writeNames(w, outputs);
+
+    auto &perfEngine = PerfEngine::getInstance();
+    w.pod<uint64_t>(ops.size());
+    for (size_t i = 0; i < ops.size(); ++i) {
+        auto &op = ops[i];
+        w.pod<uint32_t>(op->getOpType().underlying());
+        w.vec(indicesOf(op->getInputs()));
+        w.vec(indicesOf(op->getOutputs()));
+        w.vec(attrs[i].ints);
+        w.vec(attrs[i].floats);
+        w.str(attrs[i].str);
+        json record;
+        if (auto perf = perfEngine.getPerfData(
+                perfKeyOf(op, runtime->getDevice())))
+            to_json(record, perf);
+        w.str(record.is_null() ? "" : record.dump());
+    }
+
+    // The weights start on a page so they can be mapped directly.
+    w.padTo(compiledModelAlignment);
+    vector<uint8_t> staged;
+    for (auto &tensor : tensors) {
+        if (!tensor->isWeight())
+            continue;
+        auto data = tensor->getRawDataPtr<void *>();
+        if (!runtime->isCpu()) {
+            staged.resize(tensor->getBytes());
+            runtime->copyBlobToCPU(staged.data(), data, staged.size());
+            data = staged.data();
+        }
+        w.bytes(data, tensor->getBytes());
+        w.padTo(weightAlignment);
+    }
+}
+
+Graph loadCompiledModel(const Runtime &runtime, const string &path,
+                        NamedTensors *inputs, NamedTensors *outputs) {
+    Reader r(path);
+    char header[sizeof(magic)];
+    r.bytes(header, sizeof(header));
+    IT_ASSERT(std::equal(header, header + sizeof(magic), magic),
+              path + " is not a compiled model");
+    IT_ASSERT(r.pod<uint32_t>() == version,
+              path + " was written by another version");
+    auto weightBytes = r.pod<uint64_t>();
+    auto activationBytes = r.pod<uint64_t>();
+
+    Graph g = make_ref<GraphObj>(runtime);
+    TensorVec tensors(r.pod<uint64_t>());
+    vector<size_t> offsets;
+    for (auto &tensor : tensors) {
+        auto dims = r.vec<int>();
+        tensor = g->addTensor(dims, DataType(r.pod<int32_t>()));
+        switch (TensorType(r.pod<int32_t>())) {
+        case TensorType::weight:
+            tensor->setWeight();
+            break;
+        case TensorType::input:
+            tensor->setInput();
+            break;
+        case TensorType::output:
+            tensor->setOutput();
+            break;
+        case TensorType::others:
+            break;
+        }
+        tensor->setLayout(TensorLayout(r.pod<int32_t>()));
+        offsets.emplace_back(r.pod<uint64_t>());
+    }
+    for (auto names : {inputs, outputs}) {
+        NamedTensors read(r.pod<uint64_t>());
+        for (auto &[name, tensor] : read) {
+            name = r.str();
+            tensor = tensors.at(r.pod<int32_t>());
+        }
+        if (names)
+            *names = std::move(read);
+    }
+
+    auto &perfEngine = PerfEngine::getInstance();
+    auto tensorsOf = [&](const vector<int> &indices) {
+        TensorVec ret;
+        for (int i : indices)
+            ret.emplace_back(tensors.at(i));
+        return ret;
+    };
+    struct OpRecord {
+        OpType type = OpType::Unknown;
+        TensorVec ins, outs;
+        OpAttrs attrs;
+        string perf;
+    };
+    vector<OpRecord> records(r.pod<uint64_t>());
+    for (auto &rec : records) {
+        rec.type = OpType(OpType::underlying_t(r.pod<uint32_t>()));
+        rec.ins = tensorsOf(r.vec<int>());
+        rec.outs = tensorsOf(r.vec<int>());
+        rec.attrs.ints = r.vec<int>();
+        rec.attrs.floats = r.vec<float>();
+        rec.attrs.str = r.str();
+        rec.perf = r.str();
+    }
+
+    size_t weightSection = alignUp(r.tell(), compiledModelAlignment);
+    auto file = std::make_shared<MappedFile>(path);
+    IT_ASSERT(weightSection + weightBytes <= file->size(),
+              "Truncated compiled model");
+    // Tensors were added in the saved order, so the offsets line up with
+    // getTensors(). On CPU, weights point into the file and are read on
+    // first use.
+    if (runtime->isCpu())
+        for (size_t i = 0; i < tensors.size(); ++i)
+            if (tensors[i]->isWeight())
+                IT_ASSERT(g->mapWeight(tensors[i], file,
+                                       weightSection + offsets[i]),
+                          "Misaligned weight in compiled model");
+    // Resize reads its parameters when it is built, before the weight arena
+    // exists on other devices; stage them in temporary device buffers.
+    vector<void *> staged;
+    if (!runtime->isCpu())
+        for (auto &rec : records) {
+            if (rec.type != OpType::Resize)
+                continue;
+            for (size_t j = 1; j < rec.ins.size(); ++j) {
+                auto &t = rec.ins[j];
+                size_t i = std::find(tensors.begin(), tensors.end(), t) -
+                           tensors.begin();
+                void *ptr = runtime->alloc(t->getBytes());
+                runtime->copyBlobFromCPU(
+                    ptr, file->data() + weightSection + offsets[i],
+                    t->getBytes());
+                t->setDataBlob(make_ref<BlobObj>(runtime, ptr));
+                staged.emplace_back(ptr);
+            }
+        }
+
+    for (auto &rec : records) {
+        auto op = addOperator(g, rec.type, rec.ins, rec.outs, rec.attrs);
+        op->initInfiniOp(runtime);
+        if (rec.perf.empty())
+            continue;
+        auto key = perfKeyOf(op, runtime->getDevice());
+        if (!perfEngine.getPerfData(key))
+            perfEngine.setPerfData(key,
+                                   json::parse(rec.perf).get<PerfRecord>());
+    }
+
+    if (runtime->isCpu())
+        g->dataMallocWithPlan(0, activationBytes, offsets, nullptr);
+    else
+        g->dataMallocWithPlan(weightBytes, activationBytes, offsets,
+                              file->data() + weightSection);
+    for (auto ptr : staged)
+        runtime->dealloc(ptr);
+    return g;
+}
+
+} // namespace infini
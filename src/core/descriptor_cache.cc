@@ -0,0 +1,65 @@
+#include "core/descriptor_cache.h"
+
+namespace infini {
+
+size_t DescriptorCache::KeyHash::operator()(const Key &key) const {
+    size_t hash = key.size();
+    for (auto v : key)
+        hash ^= std::hash<int64_t>()(v) + 0x9e3779b97f4a7c15 + (hash << 6) +
+                (hash >> 2);
+    return hash;
+}
+
+optional<InfiniopDesc> DescriptorCache::lookup(const Key &key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it == index.end())
+        return std::nullopt;
+    entries.splice(entries.begin(), entries, it->second);
+    ++hits;
+    return it->second->second;
+}
+
+void DescriptorCache::insert(const Key &key, const InfiniopDesc &desc) {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++misses;
+    if (capacity == 0)
+        return;
+    auto it = index.find(key);
+    if (it != index.end()) {
+        it->second->second = desc;
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+    entries.emplace_front(key, desc);
+    index.emplace(key, entries.begin());
+    evict();
+}
+
+void DescriptorCache::setCapacity(size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->capacity = capacity;
+    evict();
+}
+
+size_t DescriptorCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+void DescriptorCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    index.clear();
+    entries.clear();
+    hits = misses = evictions = 0;
+}
+
+void DescriptorCache::evict() {
+    while (entries.size() > capacity) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+        ++evictions;
+    }
+}
+
+} // namespace infini
@@ -1,5 +1,14 @@
 #include "core/graph.h"
+#include "core/kernel.h"
+#include "operators/batch_norm.h"
+#include "operators/conv.h"
+#include "operators/element_wise.h"
+#include "operators/gemm.h"
+#include "operators/matmul.h"
+#include "operators/quantize.h"
 #include "operators/reshape.h"
+#include "operators/unary.h"
+#include "utils/mapped_file.h"
 #include <algorithm>
 #include <numeric>
 #include <queue>
@@ -44,6 +53,9 @@ GraphObj::GraphObj(Runtime runtime, OpVec ops_in)
 
 void GraphObj::addOperatorAndConnect(const Operator &op) {
     sorted = false;
+    scheduled = false;
+    opSlot[op.get()] = ops.size();
+    guidIndex[op->getGuid()] = op.get();
     ops.push_back(op);
     for (auto &input : op->getInputs()) {
         if (input) {
@@ -66,6 +78,7 @@ void GraphObj::addOperatorAndConnect(const Operator &op) {
 }
 
 string GraphObj::toString() const {
+    compact();
     std::ostringstream oss;
     oss << "Graph Tensors:\n";
     for (const auto &tensor : tensors)
@@ -87,47 +100,265 @@ string GraphObj::toString() const {
 }
 
 bool GraphObj::topo_sort() {
+    compact();
     if (this->sorted) {
         return true;
     }
-    std::vector<Operator> sorted;
-    std::unordered_set<OperatorObj *> flags;
-    sorted.reserve(ops.size());
-    flags.reserve(ops.size());
-    while (sorted.size() < ops.size()) {
-        // Any node is move to sorted in this loop.
-        auto modified = false;
-        for (auto const &op : ops) {
-            if (auto const &inputs = op->getInputs();
-                flags.find(op.get()) == flags.end() &&
-                std::all_of(inputs.begin(), inputs.end(),
-                            [&flags](auto const &input) {
-                                auto ptr = input->getSource().get();
-                                return !ptr || flags.find(ptr) != flags.end();
-                            })) {
-                modified = true;
-                sorted.emplace_back(op);
-                flags.insert(op.get());
-            }
-        }
-        if (!modified) {
-            return false;
+    // Kahn's algorithm over producer -> consumer edges in adjacency arrays.
+    // Ready operators keep their relative order.
+    size_t n = ops.size();
+    vector<size_t> indegree(n, 0), edgeBegin(n + 1, 0);
+    vector<std::pair<size_t, size_t>> edges;
+    for (size_t v = 0; v < n; ++v) {
+        for (auto &input : ops[v]->getInputs()) {
+            auto src = input ? input->getSource() : nullptr;
+            if (!src)
+                continue;
+            auto it = opSlot.find(src.get());
+            // A producer outside the graph never runs.
+            if (it == opSlot.end())
+                return false;
+            edges.emplace_back(it->second, v);
+            edgeBegin[it->second + 1]++;
+            indegree[v]++;
         }
     }
+    for (size_t u = 0; u < n; ++u)
+        edgeBegin[u + 1] += edgeBegin[u];
+    vector<size_t> consumers(edges.size()), fill(edgeBegin.begin(),
+                                                 edgeBegin.end() - 1);
+    for (auto &[u, v] : edges)
+        consumers[fill[u]++] = v;
+
+    std::vector<Operator> sorted;
+    sorted.reserve(n);
+    std::queue<size_t> ready;
+    for (size_t v = 0; v < n; ++v)
+        if (!indegree[v])
+            ready.push(v);
+    while (!ready.empty()) {
+        size_t u = ready.front();
+        ready.pop();
+        sorted.emplace_back(ops[u]);
+        for (size_t e = edgeBegin[u]; e < edgeBegin[u + 1]; ++e)
+            if (--indegree[consumers[e]] == 0)
+                ready.push(consumers[e]);
+    }
+    // Operators left over are on a cycle.
+    if (sorted.size() < n) {
+        return false;
+    }
     this->ops = std::move(sorted);
+    reindexOperators();
     return this->sorted = true;
 }
 
-void GraphObj::optimize() {
-    for (auto &op : ops) {
-        switch (op->getOpType().underlying()) {
-        default:
-            break;
+void GraphObj::compact() const {
+    if (removedOps) {
+        ops.erase(std::remove(ops.begin(), ops.end(), nullptr), ops.end());
+        for (size_t i = 0; i < ops.size(); ++i)
+            opSlot[ops[i].get()] = i;
+        removedOps = 0;
+    }
+    if (removedTensors) {
+        tensors.erase(std::remove(tensors.begin(), tensors.end(), nullptr),
+                      tensors.end());
+        for (size_t i = 0; i < tensors.size(); ++i)
+            tensorSlot[tensors[i].get()] = i;
+        removedTensors = 0;
+    }
+}
+
+void GraphObj::reindexOperators() {
+    for (size_t i = 0; i < ops.size(); ++i)
+        opSlot[ops[i].get()] = i;
+}
+
+void GraphObj::removeOperator(Operator op) {
+    auto it = opSlot.find(op.get());
+    if (it == opSlot.end())
+        return;
+    ops[it->second] = nullptr;
+    opSlot.erase(it);
+    guidIndex.erase(op->getGuid());
+    removedOps++;
+}
+
+void GraphObj::removeTensor(Tensor tensor) {
+    auto it = tensorSlot.find(tensor.get());
+    if (it == tensorSlot.end())
+        return;
+    tensors[it->second] = nullptr;
+    tensorSlot.erase(it);
+    mappedWeights.erase(tensor.get());
+    if (auto f = fuidIndex.find(tensor->getFuid());
+        f != fuidIndex.end() && f->second == tensor.get())
+        fuidIndex.erase(f);
+    removedTensors++;
+}
+
+void GraphObj::optimize(bool dump) {
+    PassManager manager;
+    manager.dump = dump;
+    manager.run(this);
+    passStats = manager.getStats();
+}
+
+// A DequantizeLinear with a per-tensor or per-axis int8 input and an
+// explicit zero point, as QLinear operators require.
+static Ref<DequantizeLinearObj> int8DequantizeOf(const Tensor &t) {
+    auto src = t->getSource();
+    if (!src || src->getOpType() != OpType::DequantizeLinear)
+        return nullptr;
+    auto dq = as<DequantizeLinearObj>(src);
+    auto dtype = dq->getInputs(0)->getDType();
+    if (dq->getBlockSize() > 0 || !dq->getZeroPoint() ||
+        !(dq->getOutput()->getDType() == DataType::Float32) ||
+        !(dtype == DataType::UInt8 || dtype == DataType::Int8))
+        return nullptr;
+    return dq;
+}
+
+// Whether `dq` dequantizes an Int32 bias with scale xScale * wScale (per
+// channel, within a relative tolerance) and zero point 0, which is what
+// QLinear operators assume. The parameters must hold data to be checked.
+static bool isQLinearBias(const Ref<DequantizeLinearObj> &dq,
+                          const Tensor &xScale, const Tensor &wScale) {
+    auto scale = dq->getInputs(1), zeroPoint = dq->getZeroPoint();
+    if (!(dq->getInputs(0)->getDType() == DataType::Int32) ||
+        !(scale->getDType() == DataType::Float32) || !scale->hasData() ||
+        !xScale->hasData() || !wScale->hasData() ||
+        (zeroPoint && !zeroPoint->hasData()))
+        return false;
+    if (zeroPoint) {
+        auto zp = zeroPoint->copyout<int32_t>();
+        if (std::any_of(zp.begin(), zp.end(), [](int32_t z) { return z; }))
+            return false;
+    }
+    auto bs = scale->copyout<float>(), ws = wScale->copyout<float>();
+    float xs = xScale->copyout<float>()[0];
+    if (bs.size() != 1 && ws.size() != 1 && bs.size() != ws.size())
+        return false;
+    for (size_t i = 0; i < std::max(bs.size(), ws.size()); ++i) {
+        float expect = xs * ws[ws.size() == 1 ? 0 : i];
+        float actual = bs[bs.size() == 1 ? 0 : i];
+        if (std::abs(actual - expect) > 1e-5f * std::abs(expect))
+            return false;
+    }
+    return true;
+}
+
+bool GraphObj::foldQuantizeDequantize() {
+    compact();
+    bool changed = false;
+    vector<Blob> folded;
+    for (auto op : OpVec(ops)) {
+        auto type = op->getOpType();
+        if ((type != OpType::Conv && type != OpType::MatMul) ||
+            op->numOutputs() != 1)
+            continue;
+        auto targets = op->getOutput()->getTargets();
+        if (targets.size() != 1 ||
+            targets[0]->getOpType() != OpType::QuantizeLinear)
+            continue;
+        auto q = as<QuantizeLinearObj>(targets[0]);
+        auto dqX = int8DequantizeOf(op->getInputs(0));
+        auto dqW = int8DequantizeOf(op->getInputs(1));
+        if (!dqX || !dqW || !q->getZeroPoint() ||
+            dqX->getInputs(1)->size() != 1 || q->getInputs(1)->size() != 1)
+            continue;
+        bool perChannelW = dqW->getInputs(1)->size() != 1;
+        TensorVec inputs{dqX->getInputs(0), dqX->getInputs(1),
+                         dqX->getInputs(2), dqW->getInputs(0),
+                         dqW->getInputs(1), dqW->getInputs(2),
+                         q->getInputs(1),   q->getInputs(2)};
+        Ref<DequantizeLinearObj> dqBias;
+        if (type == OpType::Conv) {
+            auto conv = as<ConvObj>(op);
+            if (conv->getAct() != ActType::None ||
+                (perChannelW && dqW->getAxis() != 0))
+                continue;
+            if (op->numInputs() > 2) {
+                // The bias must already be Int32 with scale xScale * wScale
+                // and no zero point.
+                auto src = op->getInputs(2)->getSource();
+                if (!src || src->getOpType() != OpType::DequantizeLinear)
+                    continue;
+                dqBias = as<DequantizeLinearObj>(src);
+                if (!isQLinearBias(dqBias, dqX->getInputs(1),
+                                   dqW->getInputs(1)))
+                    continue;
+                inputs.emplace_back(dqBias->getInputs(0));
+            }
+        } else {
+            auto matmul = as<MatmulObj>(op);
+            if (matmul->getTransA() || matmul->getTransB() ||
+                matmul->getBias() || matmul->getAct() != ActType::None ||
+                op->getInputs(1)->getRank() != 2 ||
+                (perChannelW && dqW->getAxis() != 1))
+                continue;
+        }
+
+        auto y = q->getOutput();
+        auto floatOutput = op->getOutput();
+        eraseOperator(q);
+        eraseOperator(op);
+        removeTensor(floatOutput);
+        if (type == OpType::Conv) {
+            auto [ph, pw, sh, sw, dh, dw] =
+                as<ConvObj>(op)->getPadStrideDilation();
+            addOpWithOutputs<QLinearConvObj>(inputs, y, ph, pw, sh, sw, dh,
+                                             dw);
+        } else {
+            // A constant B is transposed here, once, so that the kernel
+            // computes int8 dot products of contiguous rows.
+            auto b = inputs[3];
+            bool transB = weightAllocated && b->isWeight() && b->hasData();
+            if (transB) {
+                size_t K = b->getDims()[0], N = b->getDims()[1];
+                vector<uint8_t> data(b->getBytes()), packed(data.size());
+                b->copyout(data.data(), data.size());
+                for (size_t k = 0; k < K; ++k)
+                    for (size_t j = 0; j < N; ++j)
+                        packed[j * K + k] = data[k * N + j];
+                auto t = addTensor({int(N), int(K)}, b->getDType());
+                t->setWeight();
+                t->setDataBlob(runtime->allocBlob(t->getBytes()));
+                t->copyin(packed.data(), packed.size());
+                folded.emplace_back(t->getDataBlob());
+                inputs[3] = t;
+            }
+            addOpWithOutputs<QLinearMatmulObj>(inputs, y, transB);
         }
+        // Drop dequantizations that are no longer used.
+        for (auto &dq : {dqX, dqW, dqBias}) {
+            if (dq && !dq->getOutput()->hasTarget() &&
+                !dq->getOutput()->isOutput()) {
+                auto t = dq->getOutput();
+                eraseOperator(dq);
+                removeTensor(t);
+                for (auto &input : dq->getInputs())
+                    if (!input->hasTarget() && !input->getSource())
+                        removeTensor(input);
+            }
+        }
+        changed = true;
     }
+    if (changed)
+        IT_ASSERT(topo_sort());
+    if (!folded.empty()) {
+        repackWeights();
+        for (auto &blob : folded)
+            runtime->dealloc(blob->getPtr<void *>());
+    }
+    return changed;
 }
 
 Tensor GraphObj::getTensor(int fuid) const {
+    compact();
+    if (auto it = fuidIndex.find(fuid); it != fuidIndex.end())
+        return tensors[tensorSlot.at(it->second)];
+    // The first tensor with this FUID was removed; look for a clone.
     for (auto tensor : tensors) {
         if (tensor->getFuid() == fuid) {
             return tensor;
@@ -136,7 +367,14 @@ Tensor GraphObj::getTensor(int fuid) const {
     return nullptr;
 }
 
+Operator GraphObj::getOperator(int guid) const {
+    compact();
+    auto it = guidIndex.find(guid);
+    return it == guidIndex.end() ? nullptr : ops[opSlot.at(it->second)];
+}
+
 void GraphObj::shape_infer() {
+    compact();
     for (auto &op : ops) {
         auto ans = op->inferShape();
         IT_ASSERT(ans.has_value());
@@ -152,6 +390,69 @@ void GraphObj::shape_infer() {
                 tensor->setShape(newShape);
             }
         }
+        // Take the descriptor for the new shapes from DescriptorCache or
+        // create it; unchanged operators return at once.
+        if (op->hasInfiniOpDesc())
+            op->initInfiniOp(runtime);
+    }
+}
+
+// Replays the activation allocation of dataMalloc for `order` and records
+// the offset of every tensor that is not a weight. Inputs, outputs and
+// tensors without a source are never freed; other tensors live from their
+// producer to their last consumer.
+static void
+planActivations(LazyAllocator &allocator, const TensorVec &tensors,
+                const OpVec &order,
+                std::unordered_map<TensorObj *, size_t> &tensorToOffset) {
+    // count the number of times all tensors are used
+    std::unordered_map<TensorObj *, size_t> tensorToRefCount;
+    for (auto &tensor : tensors) {
+        if (tensor->isWeight())
+            continue;
+        if (tensor->isInput() || tensor->isOutput()) {
+            // allocate memory for all input and output tensors, and this
+            // memory will not be reused later
+            tensorToOffset[tensor.get()] = allocator.alloc(tensor->getBytes());
+        } else {
+            tensorToRefCount[tensor.get()] = tensor->getTargets().size();
+            // allocate memory for all user-created tensors
+            if (tensor.get()->getSource() == nullptr) {
+                tensorToOffset[tensor.get()] =
+                    allocator.alloc(tensor->getBytes());
+            }
+        }
+    }
+    // traverse in topological order and simulate memory allocation
+    for (auto &op : order) {
+        // memory should be allocated for the op's output first
+        auto outputs = op->getOutputs();
+        for (auto &tensor : outputs) {
+            if (tensor) {
+                if (tensor->isOthers()) {
+                    tensorToOffset[tensor.get()] =
+                        allocator.alloc(tensor->getBytes());
+                }
+            }
+        }
+        auto inputs = op->getInputs();
+        for (auto &tensor : inputs) {
+            if (tensor) {
+                if (tensor->isOthers()) {
+                    auto tensorIter = tensorToRefCount.find(tensor.get());
+                    IT_ASSERT(tensorIter != tensorToRefCount.end());
+                    IT_ASSERT(tensorToRefCount[tensor.get()] > 0);
+                    tensorToRefCount[tensor.get()] -= 1;
+                    if (tensorToRefCount[tensor.get()] == 0) {
+                        // indicate that this tensor will no longer be used and
+                        // perform memory free
+                        tensorToRefCount.erase(tensor.get());
+                        allocator.free(tensorToOffset[tensor.get()],
+                                       tensor->getBytes());
+                    }
+                }
+            }
+        }
     }
 }
 
@@ -168,17 +469,17 @@ void GraphObj::dataMalloc(bool useNaiveAllocator, size_t memPoolSize) {
         // not reproduce the bug
         for (auto &tensor : tensors) {
             if (!tensor->isWeight() ||
-                (tensor->isWeight() && !weightAllocated)) {
+                (!weightAllocated && !isMappedWeight(tensor))) {
                 tensor->dataMalloc();
             }
         }
         return;
     }
+    if (!scheduled)
+        scheduleForMemory();
     if (memPoolSize > 0) {
         allocator.setMemPool(memPoolSize);
     }
-    // count the number of times all tensors are used
-    std::unordered_map<TensorObj *, size_t> tensorToRefCount;
     // record the memory address offsets of all tensors to be allocated
     std::unordered_map<TensorObj *, size_t> tensorToOffset;
 
@@ -189,7 +490,7 @@ void GraphObj::dataMalloc(bool useNaiveAllocator, size_t memPoolSize) {
     // tensors
     std::unordered_set<TensorObj *> weightTensors;
     for (auto &tensor : tensors) {
-        if (tensor->isWeight()) {
+        if (tensor->isWeight() && !isMappedWeight(tensor)) {
             // allocate memory for all weight tensors first, and this memory
             // will not be freed until the graph is destroyed
             weightTensors.insert(tensor.get());
@@ -197,17 +498,6 @@ void GraphObj::dataMalloc(bool useNaiveAllocator, size_t memPoolSize) {
                 tensorToOffset[tensor.get()] =
                     allocator.allocWeight(tensor->getBytes());
             }
-        } else if (tensor->isInput() || tensor->isOutput()) {
-            // allocate memory for all input and output tensors, and this memory
-            // will not be reused later
-            tensorToOffset[tensor.get()] = allocator.alloc(tensor->getBytes());
-        } else {
-            tensorToRefCount[tensor.get()] = tensor->getTargets().size();
-            // allocate memory for all user-created tensors
-            if (tensor.get()->getSource() == nullptr) {
-                tensorToOffset[tensor.get()] =
-                    allocator.alloc(tensor->getBytes());
-            }
         }
     }
     // if memory has not yet been allocated for weight tensors,
@@ -223,37 +513,7 @@ void GraphObj::dataMalloc(bool useNaiveAllocator, size_t memPoolSize) {
                     tensorToOffset[tensor]));
         }
     }
-    // traverse in topological order and simulate memory allocation
-    for (auto &op : ops) {
-        // memory should be allocated for the op's output first
-        auto outputs = op->getOutputs();
-        for (auto &tensor : outputs) {
-            if (tensor) {
-                if (tensor->isOthers()) {
-                    tensorToOffset[tensor.get()] =
-                        allocator.alloc(tensor->getBytes());
-                }
-            }
-        }
-        auto inputs = op->getInputs();
-        for (auto &tensor : inputs) {
-            if (tensor) {
-                if (tensor->isOthers()) {
-                    auto tensorIter = tensorToRefCount.find(tensor.get());
-                    IT_ASSERT(tensorIter != tensorToRefCount.end());
-                    IT_ASSERT(tensorToRefCount[tensor.get()] > 0);
-                    tensorToRefCount[tensor.get()] -= 1;
-                    if (tensorToRefCount[tensor.get()] == 0) {
-                        // indicate that this tensor will no longer be used and
-                        // perform memory free
-                        tensorToRefCount.erase(tensor.get());
-                        allocator.free(tensorToOffset[tensor.get()],
-                                       tensor->getBytes());
-                    }
-                }
-            }
-        }
-    }
+    planActivations(allocator, tensors, ops, tensorToOffset);
 
     // perform actual memory allocation for non-weight tensors
     for (auto &tensor : tensors) {
@@ -267,6 +527,566 @@ void GraphObj::dataMalloc(bool useNaiveAllocator, size_t memPoolSize) {
     }
 }
 
+void GraphObj::dataMallocWithPlan(size_t weightBytes, size_t activationBytes,
+                                  const vector<size_t> &offsets,
+                                  const void *weights) {
+    compact();
+    IT_ASSERT(offsets.size() == tensors.size());
+    IT_ASSERT(!weightAllocated, "Weights are already allocated");
+    allocator.init();
+    allocator.allocWeight(weightBytes);
+    allocator.alloc(activationBytes);
+    auto weightPtr = static_cast<uint8_t *>(allocator.getWeightPtr());
+    if (weightBytes)
+        runtime->copyBlobFromCPU(weightPtr, weights, weightBytes);
+    auto activationPtr = static_cast<uint8_t *>(allocator.getPtr());
+    for (size_t i = 0; i < tensors.size(); ++i) {
+        auto &tensor = tensors[i];
+        if (isMappedWeight(tensor))
+            continue;
+        size_t arena = tensor->isWeight() ? weightBytes : activationBytes;
+        IT_ASSERT(offsets[i] + tensor->getBytes() <= arena);
+        auto base = tensor->isWeight() ? weightPtr : activationPtr;
+        tensor->setDataBlob(
+            make_ref<BlobObj>(tensor->runtime, base + offsets[i]));
+    }
+    weightAllocated = sorted = scheduled = true;
+}
+
+bool GraphObj::mapWeight(const Tensor &tensor,
+                         const std::shared_ptr<MappedFile> &file,
+                         size_t offset) {
+    IT_ASSERT(runtime->isCpu(), "Only CPU weights can be mapped");
+    IT_ASSERT(tensor->isWeight() && hasTensor(tensor));
+    IT_ASSERT(offset + tensor->getBytes() <= file->size(),
+              "Weight is out of the mapped file");
+    // ONNX external data does not promise aligned offsets.
+    auto ptr = file->data() + offset;
+    if (reinterpret_cast<uintptr_t>(ptr) % tensor->getDType().getSize())
+        return false;
+    tensor->setDataBlob(make_ref<BlobObj>(runtime, ptr));
+    mappedWeights.insert(tensor.get());
+    if (std::find(mappedFiles.begin(), mappedFiles.end(), file) ==
+        mappedFiles.end())
+        mappedFiles.emplace_back(file);
+    return true;
+}
+
+void GraphObj::prefetchWeights() const {
+    for (auto &file : mappedFiles)
+        file->prefetch();
+}
+
+size_t GraphObj::getArenaOffset(const Tensor &tensor) {
+    IT_ASSERT(tensor->hasData() && !isMappedWeight(tensor));
+    auto base = static_cast<uint8_t *>(tensor->isWeight()
+                                           ? allocator.getWeightPtr()
+                                           : allocator.getPtr());
+    auto ptr = tensor->getRawDataPtr<uint8_t *>();
+    size_t arena = tensor->isWeight() ? allocator.getWeightPeak()
+                                      : allocator.getPeak();
+    IT_ASSERT(ptr >= base && ptr + tensor->getBytes() <= base + arena,
+              "Tensor is not in an arena planned by dataMalloc");
+    return ptr - base;
+}
+
+// Exact search over the sets of executed operators, visited by size. The
+// live bytes only depend on the set, so each set keeps the lowest peak
+// that reaches it. Returns an empty order if there are too many sets.
+static vector<int> scheduleExactly(const vector<uint64_t> &predMask,
+                                   const vector<size_t> &outBytes,
+                                   const vector<vector<int>> &consumed,
+                                   const vector<uint64_t> &consumerMask,
+                                   const vector<size_t> &actBytes) {
+    constexpr size_t maxStates = 1 << 16;
+    struct State {
+        size_t peak, live;
+    };
+    int n = predMask.size();
+    size_t states = 0;
+    // For every set, the set before it and the operator that was added.
+    vector<std::unordered_map<uint64_t, std::pair<uint64_t, int>>> from(n + 1);
+    std::unordered_map<uint64_t, State> layer{{0, {0, 0}}};
+    for (int step = 0; step < n; ++step) {
+        std::unordered_map<uint64_t, State> next;
+        // Sets are expanded in a fixed order, so ties break the same way
+        // on every platform.
+        vector<uint64_t> sets;
+        for (auto &[done, state] : layer)
+            sets.emplace_back(done);
+        std::sort(sets.begin(), sets.end());
+        for (uint64_t done : sets) {
+            auto state = layer.at(done);
+            for (int v = 0; v < n; ++v) {
+                uint64_t bit = uint64_t(1) << v;
+                if ((done & bit) || (predMask[v] & ~done))
+                    continue;
+                size_t peak = std::max(state.peak, state.live + outBytes[v]);
+                size_t live = state.live + outBytes[v];
+                for (int a : consumed[v])
+                    if ((consumerMask[a] & ~done) == bit)
+                        live -= actBytes[a];
+                auto [it, inserted] =
+                    next.emplace(done | bit, State{peak, live});
+                if (!inserted && it->second.peak <= peak)
+                    continue;
+                it->second = {peak, live};
+                from[step + 1][done | bit] = {done, v};
+            }
+        }
+        states += next.size();
+        if (states > maxStates)
+            return {};
+        layer = std::move(next);
+    }
+    vector<int> order(n);
+    uint64_t done = n == 64 ? ~uint64_t(0) : (uint64_t(1) << n) - 1;
+    for (int step = n; step > 0; --step) {
+        auto [prev, v] = from[step].at(done);
+        order[step - 1] = v;
+        done = prev;
+    }
+    return order;
+}
+
+// Greedy list scheduling: among the ready operators, run the one that
+// grows the live bytes least, preferring small outputs and then the
+// original order.
+static vector<int> scheduleGreedily(const vector<vector<int>> &preds,
+                                    const vector<size_t> &outBytes,
+                                    const vector<vector<int>> &consumed,
+                                    const vector<int> &consumerCount,
+                                    const vector<size_t> &actBytes) {
+    int n = preds.size();
+    vector<int> waiting(n), remaining = consumerCount, order;
+    vector<vector<int>> succs(n);
+    for (int v = 0; v < n; ++v) {
+        waiting[v] = preds[v].size();
+        for (int p : preds[v])
+            succs[p].emplace_back(v);
+    }
+    std::set<int> ready;
+    for (int v = 0; v < n; ++v)
+        if (!waiting[v])
+            ready.insert(v);
+    while (!ready.empty()) {
+        int best = -1;
+        long long bestDelta = 0;
+        for (int v : ready) {
+            long long delta = outBytes[v];
+            for (int a : consumed[v])
+                if (remaining[a] == 1)
+                    delta -= actBytes[a];
+            if (best < 0 || delta < bestDelta ||
+                (delta == bestDelta && outBytes[v] < outBytes[best])) {
+                best = v;
+                bestDelta = delta;
+            }
+        }
+        ready.erase(best);
+        order.emplace_back(best);
+        for (int a : consumed[best])
+            remaining[a]--;
+        for (int s : succs[best])
+            if (--waiting[s] == 0)
+                ready.insert(s);
+    }
+    return order;
+}
+
+bool GraphObj::scheduleForMemory() {
+    IT_ASSERT(topo_sort());
+    scheduled = true;
+    int n = ops.size();
+    if (n < 2)
+        return false;
+    std::unordered_map<OperatorObj *, int> position;
+    for (int i = 0; i < n; ++i)
+        position[ops[i].get()] = i;
+    // Activations are the tensors planned between their producer and last
+    // consumer; the others stay allocated in any order.
+    std::unordered_map<TensorObj *, int> actIndex;
+    vector<size_t> actBytes;
+    vector<vector<int>> preds(n), consumed(n), actConsumers;
+    vector<size_t> outBytes(n, 0);
+    for (int v = 0; v < n; ++v) {
+        for (auto &t : ops[v]->getOutputs()) {
+            if (!t || !t->isOthers())
+                continue;
+            outBytes[v] += t->getBytes();
+            actIndex[t.get()] = actBytes.size();
+            actBytes.emplace_back(t->getBytes());
+            actConsumers.emplace_back();
+        }
+    }
+    for (int v = 0; v < n; ++v) {
+        for (auto &t : ops[v]->getInputs()) {
+            if (!t)
+                continue;
+            if (auto src = t->getSource(); src && position.count(src.get()))
+                preds[v].emplace_back(position[src.get()]);
+            if (auto it = actIndex.find(t.get()); it != actIndex.end())
+                consumed[v].emplace_back(it->second);
+        }
+        for (auto *list : {&preds[v], &consumed[v]}) {
+            std::sort(list->begin(), list->end());
+            list->erase(std::unique(list->begin(), list->end()), list->end());
+        }
+        for (int a : consumed[v])
+            actConsumers[a].emplace_back(v);
+    }
+
+    vector<int> order;
+    if (n <= 64) {
+        vector<uint64_t> predMask(n, 0), consumerMask;
+        for (int v = 0; v < n; ++v)
+            for (int p : preds[v])
+                predMask[v] |= uint64_t(1) << p;
+        for (auto &consumers : actConsumers) {
+            consumerMask.emplace_back(0);
+            for (int v : consumers)
+                consumerMask.back() |= uint64_t(1) << v;
+        }
+        order = scheduleExactly(predMask, outBytes, consumed, consumerMask,
+                                actBytes);
+    }
+    if (order.empty()) {
+        vector<int> consumerCount;
+        for (auto &consumers : actConsumers)
+            consumerCount.emplace_back(consumers.size());
+        order = scheduleGreedily(preds, outBytes, consumed, consumerCount,
+                                 actBytes);
+    }
+    IT_ASSERT(int(order.size()) == n);
+
+    // Keep the new order only if the allocator, which also sees alignment
+    // and fragmentation, agrees that it lowers the peak.
+    OpVec scheduledOps;
+    for (int v : order)
+        scheduledOps.emplace_back(ops[v]);
+    auto peakOf = [&](const OpVec &order) {
+        LazyAllocator planner(runtime);
+        std::unordered_map<TensorObj *, size_t> offsets;
+        planActivations(planner, tensors, order, offsets);
+        return planner.getPeak();
+    };
+    size_t before = peakOf(ops), after = peakOf(scheduledOps);
+    if (after >= before)
+        return false;
+    ops = std::move(scheduledOps);
+    reindexOperators();
+    allocator.setUnscheduledPeak(before);
+    return true;
+}
+
+// Operators whose output holds the input bytes unchanged.
+static bool isDataCopy(OpType type) {
+    return type == OpType::Reshape || type == OpType::Flatten ||
+           type == OpType::Identity || type == OpType::Squeeze ||
+           type == OpType::Unsqueeze;
+}
+
+// Copy the 4-D `src` into `dst`, which is in the other of the NCHW and NHWC
+// layouts.
+static void convertLayout(const Tensor &src, const Tensor &dst) {
+    auto dims = src->getDims();
+    size_t n = dims[0], c = dims[1], hw = dims[2] * dims[3];
+    size_t size = src->getDType().getSize();
+    bool toNHWC = dst->getLayout() == TensorLayout::NHWC;
+    auto in = src->getRawDataPtr<uint8_t *>();
+    auto out = dst->getRawDataPtr<uint8_t *>();
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < c; ++j)
+            for (size_t p = 0; p < hw; ++p) {
+                size_t nchw = (i * c + j) * hw + p, nhwc = (i * hw + p) * c + j;
+                std::memcpy(out + size * (toNHWC ? nhwc : nchw),
+                            in + size * (toNHWC ? nchw : nhwc), size);
+            }
+}
+
+// Evaluate `op` on CPU copies of its inputs and return the outputs.
+static TensorVec evaluateOnCpu(const Operator &op) {
+    Runtime cpu = NativeCpuRuntimeObj::getInstance();
+    TensorVec inputs, outputs;
+    for (auto &t : op->getOutputs()) {
+        auto c = make_ref<TensorObj>(t->getDims(), t->getDType(), cpu);
+        c->setLayout(t->getLayout());
+        c->dataMalloc();
+        outputs.emplace_back(c);
+    }
+    // Shape only depends on the static input shape.
+    if (op->getOpType() == OpType::Shape) {
+        auto dims = op->getInputs(0)->getDims();
+        if (outputs[0]->getDType() == DataType::Int64)
+            outputs[0]->copyin(vector<int64_t>(dims.begin(), dims.end()));
+        else
+            outputs[0]->copyin(dims);
+        return outputs;
+    }
+    for (auto &t : op->getInputs()) {
+        auto c = make_ref<TensorObj>(t->getDims(), t->getDType(), cpu);
+        c->setLayout(t->getLayout());
+        c->dataMalloc();
+        t->copyout(c->getRawDataPtr<void *>(), t->getBytes());
+        inputs.emplace_back(c);
+    }
+    auto type = op->getOpType();
+    // The Identity inserted by LayoutAssignment reorders the elements.
+    if (type == OpType::Identity &&
+        inputs[0]->getLayout() != outputs[0]->getLayout()) {
+        convertLayout(inputs[0], outputs[0]);
+    } else if (isDataCopy(type)) {
+        std::memcpy(outputs[0]->getRawDataPtr<void *>(),
+                    inputs[0]->getRawDataPtr<void *>(), inputs[0]->getBytes());
+    } else {
+        // The clone shares the descriptor of `op`, which may belong to
+        // another device, or not exist.
+        auto clone = op->clone(inputs, outputs);
+        clone->initInfiniOp(cpu);
+        KernelRegistry::getInstance()
+            .getKernel({Device::CPU, type.underlying()}, clone)
+            ->compute(clone, cpu.get());
+    }
+    return outputs;
+}
+
+bool GraphObj::foldConstants() {
+    // Weights only hold data once they are allocated.
+    if (!weightAllocated)
+        return false;
+    IT_ASSERT(topo_sort());
+    const auto &registry = KernelRegistry::getInstance();
+    vector<Blob> folded;
+    // Ops are visited in topological order, so chains fold in one sweep.
+    for (auto op : OpVec(ops)) {
+        auto type = op->getOpType();
+        const auto &inputs = op->getInputs();
+        const auto &outputs = op->getOutputs();
+        // Folding a DequantizeLinear would expand compressed weights.
+        if (inputs.empty() || type == OpType::DequantizeLinear)
+            continue;
+        bool foldable = type == OpType::Shape ||
+                        std::all_of(inputs.begin(), inputs.end(),
+                                    [](const Tensor &t) {
+                                        return t && t->isWeight() &&
+                                               t->hasData();
+                                    });
+        foldable = foldable && (isDataCopy(type) || type == OpType::Shape ||
+                                registry.hasKernel({Device::CPU,
+                                                    type.underlying()}));
+        // A result much larger than its inputs (e.g. Expand) is cheaper
+        // to recompute than to keep.
+        size_t inBytes = 0, outBytes = 0;
+        for (auto &t : inputs)
+            inBytes += t->getBytes();
+        for (auto &t : outputs) {
+            outBytes += t->getBytes();
+            foldable = foldable && !t->isOutput();
+        }
+        if (!foldable || (outBytes > 4 * inBytes && outBytes > (1 << 20)))
+            continue;
+        if (type == OpType::Shape &&
+            !(outputs[0]->getDType() == DataType::Int64 ||
+              outputs[0]->getDType() == DataType::Int32))
+            continue;
+
+        auto values = evaluateOnCpu(op);
+        auto oldInputs = inputs;
+        eraseOperator(op);
+        for (size_t i = 0; i < outputs.size(); ++i) {
+            auto &t = outputs[i];
+            t->setWeight();
+            t->setDataBlob(runtime->allocBlob(t->getBytes()));
+            t->copyin(values[i]->getRawDataPtr<void *>(), t->getBytes());
+            folded.emplace_back(t->getDataBlob());
+        }
+        for (auto &t : oldInputs)
+            if (t->getTargets().empty() && !t->getSource() && !t->isInput())
+                removeTensor(t);
+    }
+    if (folded.empty())
+        return false;
+    repackWeights();
+    for (auto &blob : folded)
+        runtime->dealloc(blob->getPtr<void *>());
+    return true;
+}
+
+// Reads a weight tensor as fp32 values, or returns an empty vector.
+static vector<float> weightData(const Tensor &t) {
+    if (!t || !t->isWeight() || !t->hasData() ||
+        !(t->getDType() == DataType::Float32))
+        return {};
+    return t->copyout<float>();
+}
+
+bool GraphObj::foldBatchNorm() {
+    if (!weightAllocated)
+        return false;
+    compact();
+    vector<Blob> folded;
+    auto newWeight = [&](const Shape &dims, const vector<float> &data) {
+        auto t = addTensor(dims, DataType::Float32);
+        t->setWeight();
+        t->setDataBlob(runtime->allocBlob(t->getBytes()));
+        t->copyin(data);
+        folded.emplace_back(t->getDataBlob());
+        return t;
+    };
+    for (auto bn : OpVec(ops)) {
+        if (bn->getOpType() != OpType::BatchNormalization ||
+            as<BatchNormObj>(bn)->getTrainingMode() || bn->numOutputs() != 1)
+            continue;
+        auto mid = bn->getInputs(0), out = bn->getOutput();
+        auto op = mid->getSource();
+        if (!op || op->numOutputs() != 1 || mid->isOutput() ||
+            mid->getTargets().size() != 1)
+            continue;
+        auto type = op->getOpType();
+        if (type != OpType::Conv && type != OpType::ConvTranspose &&
+            type != OpType::MatMul && type != OpType::Gemm)
+            continue;
+        // The channel axis of BatchNorm is 1, which is the column axis of
+        // a 2-D MatMul or Gemm output.
+        if ((type == OpType::MatMul || type == OpType::Gemm) &&
+            (mid->getRank() != 2 || op->getInputs(1)->getRank() != 2))
+            continue;
+        if ((type == OpType::Conv || type == OpType::ConvTranspose) &&
+            as<ConvBaseObj>(op)->getAct() != ActType::None)
+            continue;
+        auto mm = type == OpType::MatMul ? as<MatmulObj>(op) : nullptr;
+        if (mm && (mm->getAct() != ActType::None || mm->getResidual()))
+            continue;
+
+        // y = (x - mean) * a + beta with a = scale / sqrt(var + eps), so
+        // the producer's weight is scaled by a per output channel and its
+        // bias becomes (bias - mean) * a + beta.
+        size_t f = mid->getDims()[1];
+        auto mean = weightData(bn->getInputs(1));
+        auto var = weightData(bn->getInputs(2));
+        auto scale = weightData(bn->getInputs(3));
+        auto beta = weightData(bn->getInputs(4));
+        auto weight = op->getInputs(1);
+        auto w = weightData(weight);
+        Tensor bias = type == OpType::MatMul ? mm->getBias()
+                      : op->numInputs() > 2  ? op->getInputs(2)
+                                             : nullptr;
+        auto b = bias ? weightData(bias) : vector<float>(f, 0.f);
+        // Gemm scales its bias by beta; the folded Gemm uses beta = 1.
+        if (type == OpType::Gemm)
+            for (auto &v : b)
+                v *= as<GemmObj>(op)->getBeta();
+        if (mean.size() != f || var.size() != f || scale.size() != f ||
+            beta.size() != f || w.empty() || b.size() != f)
+            continue;
+        float eps = as<BatchNormObj>(bn)->getEps();
+        vector<float> a(f);
+        for (size_t i = 0; i < f; ++i) {
+            a[i] = scale[i] / std::sqrt(var[i] + eps);
+            b[i] = (b[i] - mean[i]) * a[i] + beta[i];
+        }
+        const auto &dims = weight->getDims();
+        if (type == OpType::Conv) {
+            // [F, C/g, R, S]
+            size_t inner = w.size() / f;
+            for (size_t i = 0; i < w.size(); ++i)
+                w[i] *= a[i / inner];
+        } else if (type == OpType::ConvTranspose) {
+            // [C, F/g, R, S], where input channel c of group c / (C/g)
+            // writes output channels (c / (C/g)) * F/g + [0, F/g).
+            int g = as<ConvBaseObj>(op)->getNumGroups();
+            size_t inner = dims[2] * dims[3], fg = dims[1], cg = dims[0] / g;
+            for (size_t i = 0; i < w.size(); ++i) {
+                size_t c = i / (fg * inner), j = i / inner % fg;
+                w[i] *= a[c / cg * fg + j];
+            }
+        } else {
+            // B is [K, N], or [N, K] when transposed.
+            bool transB = mm ? mm->getTransB() : as<GemmObj>(op)->getTransB();
+            size_t cols = dims[1];
+            for (size_t i = 0; i < w.size(); ++i)
+                w[i] *= a[transB ? i / cols : i % cols];
+        }
+
+        // Every check is done above, before the graph is changed.
+        // ConvTranspose has no bias input, so its bias becomes a per-channel
+        // Add.
+        auto newW = newWeight(dims, w);
+        auto newB = type == OpType::ConvTranspose
+                        ? newWeight({1, int(f), 1, 1}, b)
+                        : newWeight({int(f)}, b);
+        auto inputs = op->getInputs();
+        eraseOperator(bn);
+        eraseOperator(op);
+        removeTensor(mid);
+        Operator fused;
+        if (type == OpType::ConvTranspose) {
+            auto conv = as<ConvTransposed2dObj>(op);
+            auto [ph, pw, sh, sw, dh, dw] = conv->getPadStrideDilation();
+            auto [oph, opw] = conv->getOutputPadding();
+            auto convOut = addTensor(out->getDims(), out->getDType());
+            addOpWithOutputs<ConvTransposed2dObj>(
+                inputs[0], newW, convOut, ph, pw, sh, sw, dh, dw, oph, opw,
+                conv->getNumGroups())
+                ->initInfiniOp(runtime);
+            fused = addOpWithOutputs<AddObj>(convOut, newB, out);
+        } else if (type == OpType::Conv) {
+            auto [ph, pw, sh, sw, dh, dw] =
+                as<ConvObj>(op)->getPadStrideDilation();
+            fused = addOpWithOutputs<ConvObj>(inputs[0], newW, out, ph, pw,
+                                              newB, sh, sw, dh, dw);
+        } else if (mm) {
+            fused = addOpWithOutputs<MatmulObj>(
+                inputs[0], newW, out, mm->getTransA(), mm->getTransB(), newB,
+                ActType::None, mm->getComputeType());
+        } else {
+            auto gemm = as<GemmObj>(op);
+            fused = addOpWithOutputs<GemmObj>(
+                inputs[0], newW, out, newB, gemm->getAlpha(), 1.f,
+                gemm->getTransA(), gemm->getTransB());
+        }
+        // Operators added without a graph have no backend descriptor yet.
+        fused->initInfiniOp(runtime);
+        for (auto &t : inputs)
+            if (t->getTargets().empty() && !t->getSource() && !t->isInput())
+                removeTensor(t);
+        for (int i = 1; i < bn->numInputs(); ++i)
+            if (auto t = bn->getInputs(i);
+                t->getTargets().empty() && !t->getSource() && !t->isInput())
+                removeTensor(t);
+    }
+    if (folded.empty())
+        return false;
+    IT_ASSERT(topo_sort());
+    repackWeights();
+    for (auto &blob : folded)
+        runtime->dealloc(blob->getPtr<void *>());
+    return true;
+}
+
+void GraphObj::repackWeights() {
+    compact();
+    // Stage the weights on the host, as the new arena may overlap the old.
+    vector<std::pair<Tensor, vector<uint8_t>>> staged;
+    for (auto &t : tensors) {
+        if (!t->isWeight() || !t->hasData() || isMappedWeight(t))
+            continue;
+        vector<uint8_t> data(t->getBytes());
+        t->copyout(data.data(), data.size());
+        staged.emplace_back(t, std::move(data));
+    }
+    allocator.resetWeight();
+    vector<size_t> offsets;
+    for (auto &[t, data] : staged)
+        offsets.emplace_back(allocator.allocWeight(data.size()));
+    auto base = static_cast<uint8_t *>(allocator.getWeightPtr());
+    for (size_t i = 0; i < staged.size(); ++i) {
+        auto &[t, data] = staged[i];
+        t->setDataBlob(make_ref<BlobObj>(runtime, base + offsets[i]));
+        t->copyin(data.data(), data.size());
+    }
+}
+
 Tensor GraphObj::cloneKV(Tensor &tensor) {
     auto obj = tensor->clone();
     if (allocator.getMemPoolStatus()) {
@@ -289,7 +1109,7 @@ Tensor GraphObj::cloneKV(Tensor &tensor) {
 void GraphObj::freeHeap() { this->allocator.freeHeap(); }
 
 Tensor GraphObj::addTensor(Shape dim, DataType dtype) {
-    return tensors.emplace_back(make_ref<TensorObj>(dim, dtype, runtime));
+    return addTensor(make_ref<TensorObj>(dim, dtype, runtime));
 }
 
 Tensor GraphObj::addTensor(const Tensor &tensor) {
@@ -297,6 +1117,8 @@ Tensor GraphObj::addTensor(const Tensor &tensor) {
               std::string("Tensor runtime mismatch: cannot add a tenosr in ") +
                   tensor->getRuntime()->toString() + " to " +
                   runtime->toString());
+    tensorSlot[tensor.get()] = tensors.size();
+    fuidIndex.emplace(tensor->getFuid(), tensor.get());
     tensors.emplace_back(tensor);
     return tensor;
 }
@@ -308,6 +1130,7 @@ TensorVec GraphObj::addTensor(const TensorVec &tensors) {
 }
 
 OpVec GraphObj::getComputeOps() const {
+    compact();
     OpVec opList;
     for (auto op : ops)
         if (op->getOpType().isMatMulOrConv())
@@ -315,6 +1138,20 @@ OpVec GraphObj::getComputeOps() const {
     return opList;
 }
 
+void GraphObj::eraseOperator(const Operator &op) {
+    for (auto &input : op->getInputs())
+        if (input)
+            input->removeTarget(op);
+    for (auto &output : op->getOutputs())
+        if (output && output->getSource() == op)
+            output->setSource(nullptr);
+    for (auto &pred : op->getPredecessors())
+        pred->removeSuccessors(op);
+    for (auto &succ : op->getSuccessors())
+        succ->removePredecessors(op);
+    removeOperator(op);
+}
+
 void GraphObj::deleteConnection(Tensor tensor, Operator op) {
     // if op is target
     IT_ASSERT(std::find(tensor->getTargets().begin(),
@@ -352,37 +1189,35 @@ void GraphObj::replaceConnection(Tensor oldTensor, Tensor newTensor,
 // "inputs" or "outputs" of operators must be in "tensors"
 // "predecessors" and "successors" of an operator of "ops" must be in "ops".
 bool GraphObj::checkValid() const {
+    compact();
     for (auto tensor : tensors) {
         IT_ASSERT(!(tensor->getTargets().size() == 0 &&
                     nullptr == tensor->getSource()));
         for (auto op : tensor->getTargets()) {
-            IT_ASSERT(std::find(ops.begin(), ops.end(), op) != ops.end());
+            IT_ASSERT(opSlot.count(op.get()));
         }
         auto op = tensor->getSource();
-        IT_ASSERT(!(op && std::find(ops.begin(), ops.end(), op) == ops.end()));
+        IT_ASSERT(!(op && !opSlot.count(op.get())));
     }
     for (auto op : ops) {
         for (auto tensor : op->getInputs()) {
-            IT_ASSERT(std::find(tensors.begin(), tensors.end(), tensor) !=
-                      tensors.end());
+            IT_ASSERT(tensorSlot.count(tensor.get()));
         }
         for (auto tensor : op->getOutputs()) {
-            IT_ASSERT(std::find(tensors.begin(), tensors.end(), tensor) !=
-                      tensors.end());
+            IT_ASSERT(tensorSlot.count(tensor.get()));
         }
         for (auto pre : op->getPredecessors()) {
-            IT_ASSERT(std::find(ops.begin(), ops.end(), pre) != ops.end());
+            IT_ASSERT(opSlot.count(pre.get()));
         }
         for (auto suc : op->getSuccessors()) {
-            IT_ASSERT(std::find(ops.begin(), ops.end(), suc) != ops.end());
+            IT_ASSERT(opSlot.count(suc.get()));
         }
     }
-    std::set<UidBaseType> s;
+    std::unordered_set<UidBaseType> s;
     // check whether two tensors with the same FUID exist
     for (auto tensor : tensors) {
-        int cnt = s.count(tensor->getFuid());
-        IT_ASSERT(cnt == 0, std::to_string(tensor->getFuid()));
-        s.insert(tensor->getFuid());
+        IT_ASSERT(s.insert(tensor->getFuid()).second,
+                  std::to_string(tensor->getFuid()));
     }
     return true;
 }
@@ -1,4 +1,5 @@
 #include "core/graph_handler.h"
+#include "core/kernel.h"
 #include "operators/all_gather.h"
 #include "operators/all_reduce.h"
 #include "operators/attention_kvcache.h"
@@ -17,6 +18,7 @@
 #include "operators/matmul.h"
 #include "operators/pad.h"
 #include "operators/pooling.h"
+#include "operators/quantize.h"
 #include "operators/recv.h"
 #include "operators/reduce.h"
 #include "operators/reshape.h"
@@ -119,6 +121,57 @@ Tensor GraphHandlerObj::gemm(Tensor a, Tensor b, Tensor y, Tensor c,
     }
 }
 
+Tensor GraphHandlerObj::quantizedMatmul(Tensor a, Tensor b, Tensor scale,
+                                        Tensor zeroPoint, Tensor y, int bits,
+                                        int groupSize) {
+    if (y) {
+        g->addOpWithOutputs<QuantizedMatmulObj>(
+            std::move(a), std::move(b), std::move(scale), std::move(zeroPoint),
+            y, bits, groupSize);
+        return y;
+    } else {
+        return g
+            ->addOp<QuantizedMatmulObj>(std::move(a), std::move(b),
+                                        std::move(scale), std::move(zeroPoint),
+                                        y, bits, groupSize)
+            ->getOutput();
+    }
+}
+
+Tensor GraphHandlerObj::quantizeLinear(Tensor input, Tensor scale,
+                                       Tensor zeroPoint, Tensor output,
+                                       int axis, int blockSize) {
+    if (output) {
+        g->addOpWithOutputs<QuantizeLinearObj>(
+            std::move(input), std::move(scale), std::move(zeroPoint), output,
+            axis, blockSize);
+        return output;
+    } else {
+        return g
+            ->addOp<QuantizeLinearObj>(std::move(input), std::move(scale),
+                                       std::move(zeroPoint), output, axis,
+                                       blockSize)
+            ->getOutput();
+    }
+}
+
+Tensor GraphHandlerObj::dequantizeLinear(Tensor input, Tensor scale,
+                                         Tensor zeroPoint, Tensor output,
+                                         int axis, int blockSize) {
+    if (output) {
+        g->addOpWithOutputs<DequantizeLinearObj>(
+            std::move(input), std::move(scale), std::move(zeroPoint), output,
+            axis, blockSize);
+        return output;
+    } else {
+        return g
+            ->addOp<DequantizeLinearObj>(std::move(input), std::move(scale),
+                                         std::move(zeroPoint), output, axis,
+                                         blockSize)
+            ->getOutput();
+    }
+}
+
 Tensor GraphHandlerObj::batchNormalization(Tensor input, Tensor output,
                                            Tensor mean, Tensor var,
                                            Tensor scale, Tensor bias,
@@ -170,13 +223,16 @@ Tensor GraphHandlerObj::instanceNormalization(Tensor input, Tensor output,
     }
 }
 
-Tensor GraphHandlerObj::rmsNorm(Tensor input, Tensor weight, Tensor output) {
+Tensor GraphHandlerObj::rmsNorm(Tensor input, Tensor weight, Tensor output,
+                                float eps) {
     if (output) {
         g->addOpWithOutputs<RMSNormObj>(std::move(input), std::move(weight),
-                                        output);
+                                        output, eps);
         return output;
     } else {
-        return g->addOp<RMSNormObj>(std::move(input), std::move(weight), output)
+        return g
+            ->addOp<RMSNormObj>(std::move(input), std::move(weight), output,
+                                eps)
             ->getOutput();
     }
 }
@@ -782,6 +838,52 @@ static CastType inferCastType(Tensor input, int to) {
     }
 }
 
+vector<std::tuple<string, int, int, int, double, string>>
+GraphHandlerObj::get_pass_stats() const {
+    vector<std::tuple<string, int, int, int, double, string>> ans;
+    for (auto &s : g->getPassStats())
+        ans.emplace_back(s.name, s.runs, s.changes, s.opsRemoved, s.timeMs,
+                         s.note);
+    return ans;
+}
+
+void GraphHandlerObj::tune(double budget, int threads) {
+    auto &options = Tuner::getInstance().getOptions();
+    options.graphBudget = budget;
+    options.threads = threads;
+    g->getRuntime()->run(g, true);
+}
+
+void GraphHandlerObj::calibrate() {
+    // Intermediate tensors share memory, so each output is observed right
+    // after the operator producing it has run.
+    auto observe = [this](const Tensor &t) {
+        if (t->isWeight() || !(t->getDType() == DataType::Float32) ||
+            t->size() == 0)
+            return;
+        auto data = t->copyout<float>();
+        auto [lo, hi] = std::minmax_element(data.begin(), data.end());
+        auto it = calibrationRanges.find(t->getFuid());
+        if (it == calibrationRanges.end())
+            calibrationRanges[t->getFuid()] = {*lo, *hi};
+        else
+            it->second = {std::min(it->second.first, *lo),
+                          std::max(it->second.second, *hi)};
+    };
+    IT_ASSERT(g->topo_sort());
+    auto runtime = g->getRuntime();
+    const auto &registry = KernelRegistry::getInstance();
+    for (auto &t : g->getInputs())
+        observe(t);
+    for (auto &op : g->getOperators()) {
+        auto kernelAttrs =
+            KernelAttrs{runtime->getDevice(), op->getOpType().underlying()};
+        registry.getKernel(kernelAttrs, op)->compute(op, runtime.get());
+        for (auto &t : op->getOutputs())
+            observe(t);
+    }
+}
+
 static DataType dtype_repr_convert(int dtype) {
     switch (dtype) {
     case 0:
@@ -826,4 +928,70 @@ void GraphHandlerObj::change_shape(const vector<int> &shape, int tensorId) {
     tensor->setShape(shape);
 }
 
+void GraphHandlerObj::data_malloc(bool useNaiveAllocator,
+                                  size_t memPoolSize) {
+    g->dataMalloc(useNaiveAllocator, memPoolSize);
+    for (auto &[tensor, file, offset] : pendingWeights) {
+        IT_ASSERT(offset + tensor->getBytes() <= file->size(),
+                  "Weight is out of the mapped file");
+        tensor->copyin(file->data() + offset, tensor->getBytes());
+    }
+    pendingWeights.clear();
+}
+
+void GraphHandlerObj::map_weight(Tensor tensor, const string &path,
+                                 size_t offset) {
+    auto &file = mappedFiles[path];
+    if (!file)
+        file = std::make_shared<MappedFile>(path);
+    if (!g->getRuntime()->isCpu() || !g->mapWeight(tensor, file, offset))
+        pendingWeights.emplace_back(tensor, file, offset);
+}
+
+std::pair<NamedTensors, NamedTensors>
+GraphHandlerObj::load_compiled(const string &path) {
+    NamedTensors inputs, outputs;
+    g = loadCompiledModel(g->getRuntime(), path, &inputs, &outputs);
+    calibrationRanges.clear();
+    pendingWeights.clear();
+    buckets.reset();
+    symbolic.reset();
+    return {inputs, outputs};
+}
+
+void GraphHandlerObj::specialize(
+    const vector<string> &names,
+    const vector<vector<std::pair<int, int>>> &dims) {
+    IT_ASSERT(names.size() == dims.size());
+    vector<SymbolicGraph::Symbol> symbols;
+    for (size_t i = 0; i < names.size(); ++i) {
+        symbols.push_back({names[i], {}});
+        for (auto &[fuid, axis] : dims[i]) {
+            auto tensor = g->getTensor(fuid);
+            IT_ASSERT(tensor != nullptr);
+            symbols.back().dims.emplace_back(tensor, axis);
+        }
+    }
+    buckets.reset();
+    symbolic.reset();
+    symbolic = std::make_unique<SymbolicGraph>(g, std::move(symbols));
+}
+
+void GraphHandlerObj::set_buckets(const vector<vector<int>> &values,
+                                  bool tune) {
+    IT_ASSERT(symbolic, "The graph is not specialized");
+    buckets.reset();
+    buckets = std::make_unique<SequenceBuckets>(*symbolic, values, tune);
+}
+
+vector<std::tuple<vector<int>, size_t, size_t, size_t>>
+GraphHandlerObj::get_bucket_stats() const {
+    vector<std::tuple<vector<int>, size_t, size_t, size_t>> ret;
+    if (buckets)
+        for (auto &stat : buckets->getStats())
+            ret.emplace_back(stat.values, stat.hits, stat.usedElements,
+                             stat.paddedElements);
+    return ret;
+}
+
 } // namespace infini
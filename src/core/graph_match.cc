@@ -69,7 +69,7 @@ void GraphMatchObj::recordOutsideTensorMap(const Operator &patternOp,
 SubGraphObj::SubGraphObj(Runtime runtime, const TensorVec &inputs)
     : GraphObj(runtime), ins(inputs) {
     for (auto t : ins)
-        tensors.push_back(t);
+        addTensor(t);
 }
 
 vector<MatchGraph> SubGraphRewriter::findMatch(const SubGraph &pattern) {
@@ -0,0 +1,1199 @@
+#include "core/graph_pass.h"
+#include "core/graph.h"
+#include "core/graph_match.h"
+#include "core/hash.h"
+#include "core/kernel.h"
+#include "operators/concat.h"
+#include "operators/conv.h"
+#include "operators/element_wise.h"
+#include "operators/fused_element_wise.h"
+#include "operators/gemm.h"
+#include "operators/matmul.h"
+#include "operators/reshape.h"
+#include "operators/transpose.h"
+#include "operators/unary.h"
+#include <chrono>
+
+namespace infini {
+
+bool GraphPassRegistry::registerPass(int order, GraphPass *pass) {
+    for (auto &[o, p] : passes)
+        IT_ASSERT(p->getName() != pass->getName(),
+                  "Graph pass already registered: " + pass->getName());
+    auto it = std::upper_bound(
+        passes.begin(), passes.end(), order,
+        [](int order, const PassRecord &r) { return order < r.first; });
+    passes.emplace(it, order, pass);
+    return true;
+}
+
+bool PassManager::run(GraphObj *graph) {
+    const auto &passes = GraphPassRegistry::getInstance().getPasses();
+    stats.clear();
+    for (auto &[order, pass] : passes)
+        stats.push_back(PassStat{pass->getName()});
+    bool changed = false, iterChanged = true;
+    for (iterations = 0; iterChanged && iterations < maxIterations;
+         ++iterations) {
+        iterChanged = false;
+        for (size_t i = 0; i < passes.size(); ++i) {
+            auto pass = passes[i].second;
+            int opsBefore = graph->getOperators().size();
+            auto begin = std::chrono::high_resolution_clock::now();
+            bool passChanged = pass->run(graph);
+            auto end = std::chrono::high_resolution_clock::now();
+            auto &stat = stats[i];
+            stat.runs++;
+            stat.timeMs +=
+                std::chrono::duration<double, std::milli>(end - begin).count();
+            if (!passChanged)
+                continue;
+            stat.changes++;
+            stat.opsRemoved += opsBefore - int(graph->getOperators().size());
+            if (auto note = pass->report(); !note.empty())
+                stat.note = note;
+            iterChanged = true;
+            if (verify)
+                IT_ASSERT(graph->checkValid(),
+                          "Invalid graph after pass " + pass->getName());
+            if (dump)
+                std::cout << "==== After " << pass->getName()
+                          << " (iteration " << iterations << ")\n"
+                          << graph->toString() << std::endl;
+        }
+        changed |= iterChanged;
+    }
+    return changed;
+}
+
+string PassManager::statsToString() const {
+    std::ostringstream oss;
+    oss << "Graph passes: " << iterations << " iteration(s)\n";
+    for (auto &s : stats)
+        oss << s.name << ": runs " << s.runs << ", changes " << s.changes
+            << ", ops removed " << s.opsRemoved << ", " << s.timeMs << " ms"
+            << (s.note.empty() ? "" : ", " + s.note) << "\n";
+    return oss.str();
+}
+
+class FoldQuantizeDequantizePass : public GraphPass {
+  public:
+    string getName() const override { return "FoldQuantizeDequantize"; }
+    bool run(GraphObj *graph) override {
+        return graph->foldQuantizeDequantize();
+    }
+};
+
+class ConstantFoldingPass : public GraphPass {
+    size_t weightsBefore = 0, weightsAfter = 0;
+
+  public:
+    string getName() const override { return "ConstantFolding"; }
+    bool run(GraphObj *graph) override {
+        weightsBefore = graph->getWeightBytes();
+        bool changed = graph->foldConstants();
+        weightsAfter = graph->getWeightBytes();
+        return changed;
+    }
+    string report() const override {
+        return "weight arena " + std::to_string(weightsBefore) + " -> " +
+               std::to_string(weightsAfter) + " bytes";
+    }
+};
+
+// Runs after constant folding, which turns BatchNorm parameters computed
+// from weights into weights with data.
+class BatchNormFoldingPass : public GraphPass {
+  public:
+    string getName() const override { return "BatchNormFolding"; }
+    bool run(GraphObj *graph) override { return graph->foldBatchNorm(); }
+};
+
+// Operators whose getOpAttrVector() covers every attribute, so that equal
+// attribute vectors mean equal semantics.
+static bool isCseCandidate(OpType type) {
+    switch (type.underlying()) {
+    case OpType::Shape:
+    case OpType::Cast:
+    case OpType::Reshape:
+    case OpType::Flatten:
+    case OpType::Identity:
+    case OpType::Squeeze:
+    case OpType::Unsqueeze:
+    case OpType::Transpose:
+    case OpType::Gather:
+    case OpType::Concat:
+    case OpType::Slice:
+    case OpType::Expand:
+    case OpType::Split:
+    case OpType::Where:
+    case OpType::Softmax:
+    case OpType::MatMul:
+    case OpType::Conv:
+    case OpType::Clip:
+    case OpType::Log:
+    case OpType::ReduceMean:
+    case OpType::ReduceSum:
+    case OpType::ReduceMax:
+    case OpType::ReduceMin:
+        return true;
+    default:
+        return type.isUnary() || type.isBinary();
+    }
+}
+
+static bool sameOutputs(const Operator &a, const Operator &b) {
+    if (a->numOutputs() != b->numOutputs())
+        return false;
+    for (int i = 0; i < a->numOutputs(); ++i) {
+        auto x = a->getOutput(i), y = b->getOutput(i);
+        if (x->getDims() != y->getDims() || !(x->getDType() == y->getDType()) ||
+            x->getLayout() != y->getLayout())
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Merges operators of the same type and attributes that read the same
+ * tensors. Operators are visited in topological order, so the consumers of a
+ * merged tensor are matched again in the same sweep.
+ */
+class CommonSubexpressionEliminationPass : public GraphPass {
+  public:
+    string getName() const override { return "CommonSubexpressionElimination"; }
+    bool run(GraphObj *graph) override {
+        IT_ASSERT(graph->topo_sort());
+        std::unordered_map<HashType, OpVec> seen;
+        bool changed = false;
+        for (auto op : OpVec(graph->getOperators())) {
+            if (!isCseCandidate(op->getOpType()))
+                continue;
+            HashType key = op->hash();
+            for (auto &t : op->getInputs())
+                key = hashAppend(key, t ? t->getFuid() : 0);
+            auto &bucket = seen[key];
+            auto it = std::find_if(
+                bucket.begin(), bucket.end(), [&](const Operator &other) {
+                    return other->getInputs() == op->getInputs() &&
+                           other->hasSameAttrs(*op) && sameOutputs(other, op);
+                });
+            const auto &outputs = op->getOutputs();
+            if (it == bucket.end() ||
+                std::any_of(outputs.begin(), outputs.end(),
+                            [](const Tensor &t) { return t->isOutput(); })) {
+                bucket.emplace_back(op);
+                continue;
+            }
+            for (size_t i = 0; i < outputs.size(); ++i) {
+                auto kept = (*it)->getOutput(i);
+                auto targets = outputs[i]->getTargets();
+                targets.erase(std::unique(targets.begin(), targets.end()),
+                              targets.end());
+                for (auto &target : targets)
+                    graph->replaceConnection(outputs[i], kept, target);
+            }
+            graph->eraseOperator(op);
+            for (auto &t : outputs)
+                graph->removeTensor(t);
+            changed = true;
+        }
+        return changed;
+    }
+};
+
+/**
+ * @brief Canonicalizes layout operators. Consecutive Transposes are
+ * composed and identities dropped, chains of Reshape-like operators become
+ * one Reshape, and Transposes are sunk through element-wise operators and
+ * unit-dimension Reshapes until they cancel or fold into the transA/transB
+ * flags of MatMul and Gemm.
+ */
+class TransposeCanonicalizationPass : public GraphPass {
+    int composed = 0, sunk = 0, folded = 0, reshapes = 0;
+
+    // Operators added without a graph have no backend descriptor yet.
+    template <typename T, typename... Args>
+    static Ref<T> add(GraphObj *graph, Args &&...args) {
+        auto op = graph->addOpWithOutputs<T>(std::forward<Args>(args)...);
+        op->initInfiniOp(graph->getRuntime());
+        return op;
+    }
+
+    static bool isReshapeLike(OpType type) {
+        return type == OpType::Reshape || type == OpType::Squeeze ||
+               type == OpType::Unsqueeze || type == OpType::Flatten ||
+               type == OpType::Identity;
+    }
+
+    static bool isIdentity(const vector<int> &perm) {
+        for (size_t i = 0; i < perm.size(); ++i)
+            if (perm[i] != int(i))
+                return false;
+        return true;
+    }
+
+    // The Transpose producing `t`, if `t` is read only by one operator.
+    static Ref<TransposeObj> soleTranspose(const Tensor &t) {
+        auto src = t->getSource();
+        if (!src || src->getOpType() != OpType::Transpose || t->isOutput() ||
+            t->getTargets().size() != 1)
+            return nullptr;
+        return as<TransposeObj>(src);
+    }
+
+    static Operator addElementWise(GraphObj *graph, OpType type,
+                                   const TensorVec &ins, Tensor out) {
+#define CASE_BINARY(TYPE)                                                      \
+    case OpType::TYPE:                                                         \
+        return add<TYPE##Obj>(graph, ins[0], ins[1], out)
+#define CASE_UNARY(TYPE)                                                       \
+    case OpType::TYPE:                                                         \
+        return add<TYPE##Obj>(graph, ins[0], out)
+
+        switch (type.underlying()) {
+            CASE_BINARY(Add);
+            CASE_BINARY(Sub);
+            CASE_BINARY(Mul);
+            CASE_BINARY(Div);
+            CASE_UNARY(Relu);
+            CASE_UNARY(Sigmoid);
+            CASE_UNARY(Tanh);
+            CASE_UNARY(Gelu);
+            CASE_UNARY(Silu);
+            CASE_UNARY(HardSigmoid);
+            CASE_UNARY(HardSwish);
+            CASE_UNARY(Abs);
+            CASE_UNARY(Neg);
+            CASE_UNARY(Sqrt);
+            CASE_UNARY(Exp);
+            CASE_UNARY(Erf);
+        default:
+            IT_TODO_HALT();
+        }
+#undef CASE_UNARY
+#undef CASE_BINARY
+    }
+
+    // Reads of `op`'s output are redirected to `t`, then `op` is removed.
+    static void bypass(GraphObj *graph, const Operator &op, const Tensor &t) {
+        auto out = op->getOutput();
+        auto targets = out->getTargets();
+        targets.erase(std::unique(targets.begin(), targets.end()),
+                      targets.end());
+        for (auto &target : targets)
+            graph->replaceConnection(out, t, target);
+        graph->eraseOperator(op);
+        graph->removeTensor(out);
+    }
+
+    bool rewriteTranspose(GraphObj *graph, const Ref<TransposeObj> &op) {
+        auto in = op->getInputs(0), out = op->getOutput();
+        auto perm = op->getPermute();
+        auto src = in->getSource();
+        if (src && src->getOpType() == OpType::Transpose) {
+            // Transpose(Transpose(x, p), q) = Transpose(x, p[q[i]]).
+            auto inner = as<TransposeObj>(src)->getPermute();
+            for (auto &p : perm)
+                p = inner[p];
+            in = src->getInputs(0);
+        } else if (!isIdentity(perm)) {
+            return false;
+        }
+        composed++;
+        if (isIdentity(perm) && !out->isOutput()) {
+            bypass(graph, op, in);
+            return true;
+        }
+        graph->eraseOperator(op);
+        // A graph output keeps its tensor; a Reshape then merges with the
+        // Reshapes around it.
+        if (isIdentity(perm))
+            add<ReshapeObj>(graph, in, out, out->getDims());
+        else
+            add<TransposeObj>(graph, in, out, perm);
+        return true;
+    }
+
+    bool rewriteReshape(GraphObj *graph, const Operator &op) {
+        auto in = op->getInputs(0), out = op->getOutput();
+        // An Identity between layouts converts the data.
+        if (in->getLayout() != out->getLayout())
+            return false;
+        auto src = in->getSource();
+        if (src && isReshapeLike(src->getOpType()) &&
+            src->getInputs(0)->getLayout() == in->getLayout()) {
+            // Only the final shape of a chain matters.
+            reshapes++;
+            graph->eraseOperator(op);
+            add<ReshapeObj>(graph, src->getInputs(0), out, out->getDims());
+            return true;
+        }
+        if (in->getDims() == out->getDims() && !out->isOutput()) {
+            reshapes++;
+            bypass(graph, op, in);
+            return true;
+        }
+        // A Reshape that only inserts or removes unit dimensions commutes
+        // with a Transpose of the non-unit dimensions.
+        auto t = soleTranspose(in);
+        if (!t)
+            return false;
+        auto x = t->getInputs(0);
+        auto perm = t->getPermute();
+        Shape nonUnitIn, nonUnitOut;
+        for (auto d : in->getDims())
+            if (d != 1)
+                nonUnitIn.emplace_back(d);
+        for (auto d : out->getDims())
+            if (d != 1)
+                nonUnitOut.emplace_back(d);
+        if (nonUnitIn != nonUnitOut)
+            return false;
+        // The non-unit axes of x, in the order the transposed view reads
+        // them, and in their own order.
+        vector<int> order;
+        for (auto p : perm)
+            if (x->getDims()[p] != 1)
+                order.emplace_back(p);
+        vector<int> sorted = order;
+        std::sort(sorted.begin(), sorted.end());
+        // x is reshaped to the unit dimensions of the output, with its
+        // non-unit dimensions in their own order, then transposed.
+        const auto &dims = out->getDims();
+        Shape shape = dims;
+        vector<int> slots, newPerm(dims.size());
+        for (size_t i = 0; i < dims.size(); ++i) {
+            newPerm[i] = i;
+            if (dims[i] != 1)
+                slots.emplace_back(i);
+        }
+        for (size_t k = 0; k < slots.size(); ++k) {
+            shape[slots[k]] = x->getDims()[sorted[k]];
+            auto pos = std::find(sorted.begin(), sorted.end(), order[k]);
+            newPerm[slots[k]] = slots[pos - sorted.begin()];
+        }
+        sunk++;
+        graph->eraseOperator(op);
+        graph->eraseOperator(t);
+        graph->removeTensor(in);
+        auto mid = graph->addTensor(shape, x->getDType());
+        add<ReshapeObj>(graph, x, mid, shape);
+        add<TransposeObj>(graph, mid, out, newPerm);
+        return true;
+    }
+
+    bool rewriteElementWise(GraphObj *graph, const Operator &op) {
+        auto out = op->getOutput();
+        auto ins = op->getInputs();
+        vector<Ref<TransposeObj>> ts;
+        for (auto &t : ins)
+            ts.emplace_back(soleTranspose(t));
+        Ref<TransposeObj> t = ts[0] ? ts[0] : ts.back();
+        if (!t)
+            return false;
+        auto perm = t->getPermute();
+        // Every operand is transposed alike, or is a broadcast scalar.
+        vector<Ref<TransposeObj>> used;
+        for (size_t i = 0; i < ins.size(); ++i) {
+            if (ts[i] && ts[i]->getPermute() == perm &&
+                ts[i]->getInputs(0)->getDims() == t->getInputs(0)->getDims()) {
+                ins[i] = ts[i]->getInputs(0);
+                used.emplace_back(ts[i]);
+            } else if (ins[i]->size() != 1) {
+                return false;
+            }
+        }
+        sunk++;
+        graph->eraseOperator(op);
+        for (auto &x : used) {
+            graph->eraseOperator(x);
+            graph->removeTensor(x->getOutput());
+        }
+        auto mid =
+            graph->addTensor(t->getInputs(0)->getDims(), out->getDType());
+        addElementWise(graph, op->getOpType(), ins, mid);
+        add<TransposeObj>(graph, mid, out, perm);
+        return true;
+    }
+
+    bool rewriteMatmul(GraphObj *graph, const Operator &op) {
+        auto ins = op->getInputs();
+        bool trans[2];
+        if (op->getOpType() == OpType::MatMul) {
+            trans[0] = as<MatmulObj>(op)->getTransA();
+            trans[1] = as<MatmulObj>(op)->getTransB();
+        } else {
+            trans[0] = as<GemmObj>(op)->getTransA();
+            trans[1] = as<GemmObj>(op)->getTransB();
+        }
+        bool changed = false;
+        for (int i = 0; i < 2; ++i) {
+            auto src = ins[i]->getSource();
+            if (!src || src->getOpType() != OpType::Transpose)
+                continue;
+            // Only a swap of the last two axes is a matrix transpose.
+            auto perm = as<TransposeObj>(src)->getPermute();
+            int rank = perm.size();
+            if (rank < 2)
+                continue;
+            std::swap(perm[rank - 1], perm[rank - 2]);
+            if (!isIdentity(perm))
+                continue;
+            ins[i] = src->getInputs(0);
+            trans[i] = !trans[i];
+            changed = true;
+        }
+        if (!changed)
+            return false;
+        folded++;
+        auto out = op->getOutput();
+        graph->eraseOperator(op);
+        if (op->getOpType() == OpType::MatMul) {
+            auto mm = as<MatmulObj>(op);
+            add<MatmulObj>(graph, ins[0], ins[1], out, trans[0], trans[1],
+                           mm->getBias(), mm->getAct(), mm->getComputeType(),
+                           mm->getResidual());
+        } else {
+            auto gemm = as<GemmObj>(op);
+            add<GemmObj>(graph, ins[0], ins[1], out,
+                         ins.size() > 2 ? ins[2] : nullptr, gemm->getAlpha(),
+                         gemm->getBeta(), trans[0], trans[1]);
+        }
+        return true;
+    }
+
+  public:
+    string getName() const override { return "TransposeCanonicalization"; }
+    bool run(GraphObj *graph) override {
+        composed = sunk = folded = reshapes = 0;
+        bool changed = false;
+        for (bool progress = true; progress;) {
+            progress = false;
+            IT_ASSERT(graph->topo_sort());
+            // A rewrite removes only the visited operator and its producers,
+            // which were visited before it; new operators wait for the next
+            // sweep.
+            for (auto op : OpVec(graph->getOperators())) {
+                auto type = op->getOpType();
+                bool rewritten = false;
+                if (type == OpType::Transpose)
+                    rewritten = rewriteTranspose(graph, as<TransposeObj>(op));
+                else if (isReshapeLike(type))
+                    rewritten = rewriteReshape(graph, op);
+                else if (FusedElementWiseObj::isSupported(type))
+                    rewritten = rewriteElementWise(graph, op);
+                else if ((type == OpType::MatMul || type == OpType::Gemm) &&
+                         op->numOutputs() == 1)
+                    rewritten = rewriteMatmul(graph, op);
+                progress |= rewritten;
+            }
+            changed |= progress;
+        }
+        return changed;
+    }
+    string report() const override {
+        return "transposes composed " + std::to_string(composed) + ", sunk " +
+               std::to_string(sunk) + ", folded into MatMul " +
+               std::to_string(folded) + ", reshapes merged " +
+               std::to_string(reshapes);
+    }
+};
+
+/**
+ * @brief Folds a bias or residual Add and a following activation into the
+ * epilogue of MatMul and Conv, so the native CPU kernels apply them while
+ * each output row is still in cache.
+ *
+ * Candidates are found with SubGraphRewriter::findMatch on two-operator
+ * patterns producer -> epilogue. The producer of a pattern copies the
+ * attributes of an operator in the graph, since matching compares operator
+ * hashes. The rewrite itself is done here: replaceSubGraph would clone the
+ * pattern tensors and so only works for one fixed shape.
+ */
+class EpilogueFusionPass : public GraphPass {
+    static ActType activationOf(OpType type) {
+        switch (type.underlying()) {
+        case OpType::Relu:
+            return ActType::Relu;
+        case OpType::Sigmoid:
+            return ActType::Sigmoid;
+        case OpType::Tanh:
+            return ActType::Tanh;
+        case OpType::Gelu:
+            return ActType::Gelu;
+        case OpType::Silu:
+            return ActType::Silu;
+        default:
+            return ActType::None;
+        }
+    }
+
+    // Adds `op` with its epilogue replaced to `g`. `inputs` follow the
+    // input layout of `op`.
+    static Operator addProducer(GraphObj *g, const Operator &op,
+                                const TensorVec &inputs, Tensor output,
+                                Tensor bias, ActType act, Tensor residual) {
+        if (op->getOpType() == OpType::MatMul) {
+            auto mm = as<MatmulObj>(op);
+            return g->addOpWithOutputs<MatmulObj>(
+                inputs[0], inputs[1], output, mm->getTransA(), mm->getTransB(),
+                bias, act, mm->getComputeType(), residual);
+        }
+        auto conv = as<ConvObj>(op);
+        auto [ph, pw, sh, sw, dh, dw] = conv->getPadStrideDilation();
+        return g->addOpWithOutputs<ConvObj>(inputs[0], inputs[1], output, ph,
+                                            pw, bias, sh, sw, dh, dw, act);
+    }
+
+    static Tensor biasOf(const Operator &op, const TensorVec &inputs) {
+        if (op->getOpType() == OpType::MatMul)
+            return as<MatmulObj>(op)->getBias() ? inputs[2] : nullptr;
+        return inputs.size() > 2 ? inputs[2] : nullptr;
+    }
+
+    static Tensor residualOf(const Operator &op, const TensorVec &inputs) {
+        if (op->getOpType() == OpType::MatMul &&
+            as<MatmulObj>(op)->getResidual())
+            return inputs.back();
+        return nullptr;
+    }
+
+    static ActType actOf(const Operator &op) {
+        if (op->getOpType() == OpType::MatMul)
+            return as<MatmulObj>(op)->getAct();
+        return as<ConvObj>(op)->getAct();
+    }
+
+    struct Pattern {
+        SubGraph graph;
+        Operator producer, epilogue;
+    };
+
+    // producer -> epilogue, where the producer has the attributes of
+    // `anchor`. For Add the producer output feeds input `addSlot` and the
+    // other input comes from outside.
+    static Pattern makePattern(const Runtime &runtime, const Operator &anchor,
+                               OpType epilogue, int addSlot) {
+        auto clone = [&](const Tensor &t) {
+            return make_ref<TensorObj>(t->getDims(), t->getDType(), runtime);
+        };
+        // Only the data input and the other Add operand come from outside;
+        // a pattern operator reached from two outside inputs is not matched.
+        TensorVec ins{clone(anchor->getInputs(0))};
+        if (epilogue == OpType::Add)
+            ins.emplace_back(clone(anchor->getOutput()));
+        Pattern p{make_ref<SubGraphObj>(runtime, ins)};
+        TensorVec producerIns{ins[0]};
+        for (int i = 1; i < anchor->numInputs(); ++i)
+            producerIns.emplace_back(
+                p.graph->addTensor(clone(anchor->getInputs(i))));
+        auto mid = p.graph->addTensor(clone(anchor->getOutput()));
+        auto out = p.graph->addTensor(clone(anchor->getOutput()));
+        p.producer = addProducer(p.graph.get(), anchor, producerIns, mid,
+                                 biasOf(anchor, producerIns), actOf(anchor),
+                                 residualOf(anchor, producerIns));
+        // Operators are built without a graph, so no backend descriptors
+        // are created for the pattern.
+        auto g = p.graph.get();
+        switch (epilogue.underlying()) {
+        case OpType::Add: {
+            TensorVec operands{mid, ins.back()};
+            if (addSlot)
+                std::swap(operands[0], operands[1]);
+            p.epilogue =
+                g->addOpWithOutputs<AddObj>(operands[0], operands[1], out);
+            break;
+        }
+        case OpType::Relu:
+            p.epilogue = g->addOpWithOutputs<ReluObj>(mid, out);
+            break;
+        case OpType::Sigmoid:
+            p.epilogue = g->addOpWithOutputs<SigmoidObj>(mid, out);
+            break;
+        case OpType::Tanh:
+            p.epilogue = g->addOpWithOutputs<TanhObj>(mid, out);
+            break;
+        case OpType::Gelu:
+            p.epilogue = g->addOpWithOutputs<GeluObj>(mid, out);
+            break;
+        case OpType::Silu:
+            p.epilogue = g->addOpWithOutputs<SiluObj>(mid, out);
+            break;
+        default:
+            IT_TODO_HALT();
+        }
+        p.graph->setOutputs({out});
+        return p;
+    }
+
+    // Rebuilds `producer` with the epilogue `epi` folded in, or returns
+    // false if the epilogue does not fit.
+    static bool fuse(GraphObj *graph, const Operator &producer,
+                     const Operator &epi, int addSlot) {
+        auto mid = producer->getOutput(), out = epi->getOutput();
+        if (mid->isOutput() || !(mid->getDType() == DataType::Float32) ||
+            actOf(producer) != ActType::None)
+            return false;
+        const auto &inputs = producer->getInputs();
+        Tensor bias = biasOf(producer, inputs);
+        Tensor residual = residualOf(producer, inputs);
+        ActType act = activationOf(epi->getOpType());
+        if (epi->getOpType() == OpType::Add) {
+            auto other = epi->getInputs(1 - addSlot);
+            auto dims = other->getDims();
+            if (!(other->getDType() == mid->getDType()))
+                return false;
+            if (producer->getOpType() == OpType::MatMul) {
+                int n = mid->getDims().back();
+                if (!bias && dims.size() <= mid->getDims().size() &&
+                    other->size() == size_t(n) && dims.back() == n)
+                    bias = other;
+                else if (!residual && dims == mid->getDims())
+                    residual = other;
+                else
+                    return false;
+            } else {
+                // A per-channel bias: [F], [F, 1, 1] or [1, F, 1, 1].
+                int f = mid->getDims()[1];
+                if (bias || other->size() != size_t(f) ||
+                    (dims.size() != 1 && dims.size() != 3 &&
+                     dims.size() != 4) ||
+                    dims[dims.size() == 4] != f)
+                    return false;
+                bias = other;
+            }
+        }
+
+        graph->eraseOperator(epi);
+        graph->eraseOperator(producer);
+        graph->removeTensor(mid);
+        addProducer(graph, producer, inputs, out, bias, act, residual);
+        return true;
+    }
+
+  public:
+    string getName() const override { return "EpilogueFusion"; }
+    bool run(GraphObj *graph) override {
+        // Only the native CPU kernels implement the epilogue.
+        auto runtime = graph->getRuntime();
+        if (runtime->getDevice() != Device::CPU)
+            return false;
+        bool changed = false;
+        for (bool progress = true; progress;) {
+            progress = false;
+            // One pattern producer per distinct attribute hash.
+            std::unordered_map<HashType, Operator> anchors;
+            for (auto &op : graph->getOperators())
+                if ((op->getOpType() == OpType::MatMul ||
+                     op->getOpType() == OpType::Conv) &&
+                    op->numOutputs() == 1)
+                    anchors.emplace(op->hash(), op);
+            SubGraphRewriter rewriter(Ref<GraphObj>(graph, [](GraphObj *) {}));
+            for (auto &[hash, anchor] : anchors) {
+                for (OpType epilogue :
+                     {OpType::Add, OpType::Relu, OpType::Sigmoid,
+                      OpType::Tanh, OpType::Gelu, OpType::Silu}) {
+                    for (int slot = 0; slot < 2; ++slot) {
+                        if (slot && epilogue != OpType::Add)
+                            break;
+                        auto p = makePattern(runtime, anchor, epilogue, slot);
+                        for (auto &match : rewriter.findMatch(p.graph)) {
+                            auto producer =
+                                match->getAnchorByPattern(p.producer);
+                            auto epi = match->getAnchorByPattern(p.epilogue);
+                            if (fuse(graph, producer, epi, slot))
+                                progress = changed = true;
+                        }
+                    }
+                }
+                // The graph changed: look for the anchors again.
+                if (progress)
+                    break;
+            }
+        }
+        if (changed)
+            IT_ASSERT(graph->topo_sort());
+        return changed;
+    }
+};
+
+/**
+ * @brief Fuses MatMuls that read the same input with constant weights, such
+ * as the Q, K and V projections of attention or the gate and up projections
+ * of an FFN, into one wider MatMul. The input is read once and the fused
+ * MatMul writes each result in place to the original output tensor.
+ *
+ * Weights and biases are joined by Concat operators, which constant folding
+ * turns into new weights on the next iteration. Runs after epilogue fusion;
+ * siblings with different activations are fused without one, and those
+ * with an activation get it back as a unary operator.
+ */
+class HorizontalMatmulFusionPass : public GraphPass {
+    int groups = 0, fused = 0;
+
+    static bool isConstant(const Tensor &t) {
+        return t->isWeight() && t->hasData() && !t->getSource();
+    }
+
+    static bool isCandidate(const Ref<MatmulObj> &mm) {
+        auto weight = mm->getInputs(1), bias = mm->getBias();
+        return mm->numOutputs() == 1 && !mm->getResidual() &&
+               mm->getAct() != ActType::LeakyRelu && weight->getRank() == 2 &&
+               isConstant(weight) &&
+               (!bias || (bias->getRank() == 1 && isConstant(bias)));
+    }
+
+    template <typename T, typename... Args>
+    static Ref<T> add(GraphObj *graph, Args &&...args) {
+        auto op = graph->addOpWithOutputs<T>(std::forward<Args>(args)...);
+        op->initInfiniOp(graph->getRuntime());
+        return op;
+    }
+
+    static void addActivation(GraphObj *graph, ActType act, Tensor in,
+                              Tensor out) {
+        switch (act) {
+        case ActType::Relu:
+            add<ReluObj>(graph, in, out);
+            break;
+        case ActType::Sigmoid:
+            add<SigmoidObj>(graph, in, out);
+            break;
+        case ActType::Tanh:
+            add<TanhObj>(graph, in, out);
+            break;
+        case ActType::Gelu:
+            add<GeluObj>(graph, in, out);
+            break;
+        case ActType::Silu:
+            add<SiluObj>(graph, in, out);
+            break;
+        default:
+            IT_TODO_HALT();
+        }
+    }
+
+    // Concatenates constant tensors along `axis` with a Concat operator.
+    static Tensor concat(GraphObj *graph, const TensorVec &ins, int axis) {
+        auto dims = ins[0]->getDims();
+        dims[axis] = 0;
+        for (auto &t : ins)
+            dims[axis] += t->getDims()[axis];
+        auto out = graph->addTensor(dims, ins[0]->getDType());
+        add<ConcatObj>(graph, ins, out, axis);
+        return out;
+    }
+
+    void fuse(GraphObj *graph, const vector<Ref<MatmulObj>> &group) {
+        auto first = group[0];
+        ActType act = first->getAct();
+        for (auto &mm : group)
+            if (mm->getAct() != act)
+                act = ActType::None;
+        TensorVec weights, biases, outputs;
+        vector<int> splitN;
+        for (auto &mm : group) {
+            weights.emplace_back(mm->getInputs(1));
+            if (auto bias = mm->getBias())
+                biases.emplace_back(bias);
+            splitN.emplace_back(mm->getN());
+            auto out = mm->getOutput();
+            graph->eraseOperator(mm);
+            if (mm->getAct() != act) {
+                // The activation leaves the epilogue.
+                auto mid = graph->addTensor(out->getDims(), out->getDType());
+                addActivation(graph, mm->getAct(), mid, out);
+                out = mid;
+            }
+            outputs.emplace_back(out);
+        }
+        // B is [K, N] or [N, K] with transB.
+        auto weight = concat(graph, weights, first->getTransB() ? 0 : 1);
+        auto bias = biases.empty() ? nullptr : concat(graph, biases, 0);
+        add<MatmulObj>(graph, first->getInputs(0), weight, outputs, splitN,
+                       first->getTransA(), first->getTransB(), bias, act,
+                       first->getComputeType());
+        groups++;
+        fused += group.size();
+    }
+
+  public:
+    string getName() const override { return "HorizontalMatmulFusion"; }
+    bool run(GraphObj *graph) override {
+        // Only the native CPU kernel writes several outputs.
+        if (graph->getRuntime()->getDevice() != Device::CPU)
+            return false;
+        groups = fused = 0;
+        // Siblings share the input and every attribute but the weights and
+        // the activation.
+        using Key = std::tuple<TensorObj *, bool, bool, bool, string>;
+        std::map<Key, size_t> index;
+        vector<vector<Ref<MatmulObj>>> siblings;
+        for (auto &op : graph->getOperators()) {
+            if (op->getOpType() != OpType::MatMul)
+                continue;
+            auto mm = as<MatmulObj>(op);
+            if (!isCandidate(mm))
+                continue;
+            Key key{mm->getInputs(0).get(), mm->getTransA(), mm->getTransB(),
+                    mm->getBias() != nullptr, mm->getComputeType()};
+            auto [it, inserted] = index.emplace(key, siblings.size());
+            if (inserted)
+                siblings.emplace_back();
+            siblings[it->second].emplace_back(mm);
+        }
+        for (auto &group : siblings)
+            if (group.size() > 1)
+                fuse(graph, group);
+        if (groups)
+            IT_ASSERT(graph->topo_sort());
+        return groups > 0;
+    }
+    string report() const override {
+        return std::to_string(fused) + " MatMuls fused into " +
+               std::to_string(groups);
+    }
+};
+
+/**
+ * @brief Groups connected element-wise operators into FusedElementWiseObj.
+ * Groups grow from a consumer towards its producers; a producer joins when
+ * every consumer of its output is already in the group, so only the result
+ * of the last operator leaves the group and the intermediate tensors drop
+ * out of the memory plan.
+ */
+class ElementWiseFusionPass : public GraphPass {
+    static bool isFusible(const Operator &op) {
+        if (!FusedElementWiseObj::isSupported(op->getOpType()) ||
+            op->numOutputs() != 1)
+            return false;
+        auto dtype = op->getOutput()->getDType();
+        if (!(dtype == DataType::Float32 || dtype == DataType::Float16 ||
+              dtype == DataType::BFloat16))
+            return false;
+        const auto &inputs = op->getInputs();
+        return std::all_of(inputs.begin(), inputs.end(), [&](const Tensor &t) {
+            return t->getDType() == dtype;
+        });
+    }
+
+  public:
+    string getName() const override { return "ElementWiseFusion"; }
+    bool run(GraphObj *graph) override {
+        auto device = graph->getRuntime()->getDevice();
+        if (!KernelRegistry::getInstance().hasKernel(
+                {device, OpType(OpType::FusedElementWise).underlying()}))
+            return false;
+        IT_ASSERT(graph->topo_sort());
+        OpVec ops = graph->getOperators();
+        std::unordered_map<OperatorObj *, size_t> position;
+        for (size_t i = 0; i < ops.size(); ++i)
+            position[ops[i].get()] = i;
+        std::unordered_set<OperatorObj *> visited;
+        bool changed = false;
+        for (auto it = ops.rbegin(); it != ops.rend(); ++it) {
+            auto root = *it;
+            if (visited.count(root.get()) || !isFusible(root))
+                continue;
+            OpVec group{root};
+            std::unordered_set<OperatorObj *> members{root.get()};
+            // A producer may qualify only after another of its consumers
+            // has joined, so scan until the group stops growing.
+            for (bool grown = true; grown;) {
+                grown = false;
+                for (size_t i = 0; i < group.size(); ++i) {
+                    for (auto &t : group[i]->getInputs()) {
+                        auto src = t->getSource();
+                        if (!src || members.count(src.get()) ||
+                            visited.count(src.get()) || !isFusible(src) ||
+                            t->isOutput())
+                            continue;
+                        auto targets = t->getTargets();
+                        if (std::all_of(targets.begin(), targets.end(),
+                                        [&](const Operator &op) {
+                                            return members.count(op.get());
+                                        })) {
+                            group.emplace_back(src);
+                            members.insert(src.get());
+                            grown = true;
+                        }
+                    }
+                }
+            }
+            for (auto &op : group)
+                visited.insert(op.get());
+            if (group.size() < 2)
+                continue;
+
+            std::sort(group.begin(), group.end(),
+                      [&](const Operator &a, const Operator &b) {
+                          return position[a.get()] < position[b.get()];
+                      });
+            TensorVec inputs;
+            for (auto &op : group)
+                for (auto &t : op->getInputs())
+                    if (!members.count(t->getSource().get()) &&
+                        std::find(inputs.begin(), inputs.end(), t) ==
+                            inputs.end())
+                        inputs.emplace_back(t);
+            std::unordered_map<TensorObj *, int> reg;
+            for (size_t i = 0; i < inputs.size(); ++i)
+                reg[inputs[i].get()] = i;
+            vector<FusedElementWiseObj::Instr> program;
+            for (auto &op : group) {
+                bool binary = op->getOpType().isBinary();
+                program.push_back({op->getOpType(), reg[op->getInputs(0).get()],
+                                   binary ? reg[op->getInputs(1).get()] : -1});
+                reg[op->getOutput().get()] = inputs.size() + program.size() - 1;
+            }
+
+            auto output = root->getOutput();
+            for (auto &op : group) {
+                graph->eraseOperator(op);
+                if (op != root)
+                    graph->removeTensor(op->getOutput());
+            }
+            graph->addOpWithOutputs<FusedElementWiseObj>(inputs, output,
+                                                         program);
+            changed = true;
+        }
+        if (changed)
+            IT_ASSERT(graph->topo_sort());
+        return changed;
+    }
+};
+
+/**
+ * @brief Stores the tensors of conv-heavy regions as NHWC on CPU, where
+ * the native Conv kernel vectorizes over contiguous channels.
+ *
+ * A region is a set of 4-D tensors joined by layout-agnostic operators,
+ * i.e. element-wise operators without broadcasting and Concat, which read
+ * and write one layout. Conv reads and writes any layout, converting on the
+ * fly. Where a region tensor meets any other operator or leaves the graph,
+ * an Identity between tensors of different layouts converts it. A region is
+ * converted if it feeds at least as many Convs as it needs conversions.
+ */
+class LayoutAssignmentPass : public GraphPass {
+    int regions = 0, tensors = 0, conversions = 0;
+
+    static bool isConv(const Operator &op) {
+        return op->getOpType() == OpType::Conv &&
+               op->getDType() == DataType::Float32 &&
+               as<ConvObj>(op)->getNumGroups() == 1;
+    }
+
+    static bool isAgnostic(const Operator &op) {
+        auto type = op->getOpType();
+        if (op->numOutputs() != 1 || op->getOutput()->getRank() != 4)
+            return false;
+        const auto &inputs = op->getInputs();
+        if (type == OpType::Concat)
+            return std::all_of(
+                inputs.begin(), inputs.end(),
+                [](const Tensor &t) { return t->getRank() == 4; });
+        if (!type.isElementWise() && type != OpType::FusedElementWise)
+            return false;
+        auto dims = op->getOutput()->getDims();
+        return std::all_of(inputs.begin(), inputs.end(), [&](const Tensor &t) {
+            return t->getDims() == dims || t->size() == 1;
+        });
+    }
+
+    // Tensors that may be stored as NHWC.
+    static bool isCandidate(const Tensor &t) {
+        auto src = t->getSource();
+        return t->getRank() == 4 && t->size() > 1 && !t->isInput() &&
+               !t->isOutput() && !t->isWeight() && !t->getTargets().empty() &&
+               src && (isConv(src) || isAgnostic(src));
+    }
+
+    static bool isConversion(const Operator &op) {
+        return op->getOpType() == OpType::Identity &&
+               op->getInputs(0)->getLayout() != op->getOutput()->getLayout();
+    }
+
+    // The layout `op` must read `t` in, if it cares.
+    static optional<TensorLayout> requiredLayout(const Operator &op,
+                                                 const Tensor &t) {
+        if (isConv(op) || t->getRank() != 4 || t->size() == 1 ||
+            isConversion(op))
+            return {};
+        if (isAgnostic(op))
+            return op->getOutput()->getLayout();
+        return TensorLayout::NCHW;
+    }
+
+  public:
+    string getName() const override { return "LayoutAssignment"; }
+    bool run(GraphObj *graph) override {
+        regions = tensors = conversions = 0;
+        if (graph->getRuntime()->getDevice() != Device::CPU)
+            return false;
+        // Union-find over candidate tensors.
+        std::unordered_map<TensorObj *, TensorObj *> parent;
+        std::function<TensorObj *(TensorObj *)> find = [&](TensorObj *t) {
+            auto &p = parent[t];
+            return p == t ? t : p = find(p);
+        };
+        for (auto &t : graph->getTensors())
+            if (isCandidate(t))
+                parent[t.get()] = t.get();
+        auto isMember = [&](const Tensor &t) { return parent.count(t.get()); };
+        for (auto &op : graph->getOperators()) {
+            if (!isAgnostic(op) || !isMember(op->getOutput()))
+                continue;
+            auto out = op->getOutput();
+            for (auto &t : op->getInputs())
+                if (isMember(t))
+                    parent[find(t.get())] = find(out.get());
+        }
+
+        // Per region: Convs fed, conversions needed, and whether an earlier
+        // run already converted it.
+        struct Region {
+            int convs = 0, conversions = 0;
+            bool assigned = false;
+        };
+        std::unordered_map<TensorObj *, Region> info;
+        for (auto &[t, p] : parent) {
+            auto &r = info[find(t)];
+            r.assigned |= t->getLayout() == TensorLayout::NHWC;
+            bool exits = false;
+            for (auto &op : t->getTargets()) {
+                if (isConv(op) && op->getInputs(0).get() == t)
+                    r.convs++;
+                else if (!isConv(op) &&
+                         (!isAgnostic(op) || !isMember(op->getOutput()) ||
+                          find(op->getOutput().get()) != find(t)))
+                    exits = true;
+            }
+            r.conversions += exits;
+        }
+        std::unordered_set<TensorObj *> entries;
+        for (auto &op : graph->getOperators()) {
+            if (!isAgnostic(op) || !isMember(op->getOutput()))
+                continue;
+            auto out = op->getOutput();
+            for (auto &t : op->getInputs())
+                if (!isMember(t) && t->size() > 1 &&
+                    entries.insert(t.get()).second)
+                    info[find(out.get())].conversions++;
+        }
+
+        for (auto &[root, r] : info)
+            regions += !r.assigned && r.convs > 0 &&
+                       r.convs >= r.conversions;
+        for (auto &[t, p] : parent) {
+            auto &r = info[find(t)];
+            if (t->getLayout() == TensorLayout::NCHW && !r.assigned &&
+                r.convs > 0 && r.convs >= r.conversions) {
+                t->setLayout(TensorLayout::NHWC);
+                tensors++;
+            }
+        }
+
+        // Insert the conversions, reusing those of earlier runs.
+        for (auto op : OpVec(graph->getOperators())) {
+            auto inputs = op->getInputs();
+            inputs.erase(std::unique(inputs.begin(), inputs.end()),
+                         inputs.end());
+            for (auto &t : inputs) {
+                auto layout = requiredLayout(op, t);
+                if (!layout || *layout == t->getLayout())
+                    continue;
+                Tensor converted;
+                for (auto &target : t->getTargets())
+                    if (target->getOpType() == OpType::Identity &&
+                        target->getOutput()->getLayout() == *layout)
+                        converted = target->getOutput();
+                if (!converted) {
+                    converted = graph->addTensor(t->getDims(), t->getDType());
+                    converted->setLayout(*layout);
+                    graph->addOpWithOutputs<IdentityObj>(t, converted)
+                        ->initInfiniOp(graph->getRuntime());
+                    conversions++;
+                }
+                graph->replaceConnection(t, converted, op);
+            }
+        }
+        if (conversions)
+            IT_ASSERT(graph->topo_sort());
+        return tensors > 0 || conversions > 0;
+    }
+    string report() const override {
+        return std::to_string(regions) + " region(s), " +
+               std::to_string(tensors) + " tensor(s) to NHWC, " +
+               std::to_string(conversions) + " conversion(s)";
+    }
+};
+
+/**
+ * @brief Removes operators whose outputs are neither used nor marked as
+ * graph outputs. Graphs without marked outputs are left untouched, as every
+ * tensor without targets is then an output.
+ *
+ * Only operators without consumers are scanned; removing one re-examines
+ * the producers of its inputs, so a dead chain goes in one run.
+ */
+class DeadCodeEliminationPass : public GraphPass {
+    static bool isDead(const Operator &op) {
+        const auto &outputs = op->getOutputs();
+        return std::all_of(outputs.begin(), outputs.end(),
+                           [](const Tensor &t) {
+                               return !t->hasTarget() && !t->isOutput();
+                           });
+    }
+
+  public:
+    string getName() const override { return "DeadCodeElimination"; }
+    bool run(GraphObj *graph) override {
+        const auto &tensors = graph->getTensors();
+        if (std::none_of(tensors.begin(), tensors.end(),
+                         [](const Tensor &t) { return t->isOutput(); }))
+            return false;
+        OpVec worklist;
+        for (auto &op : graph->getOperators())
+            if (!op->hasSuccessors() && isDead(op))
+                worklist.emplace_back(op);
+        bool changed = false;
+        while (!worklist.empty()) {
+            auto op = worklist.back();
+            worklist.pop_back();
+            // A producer may be queued twice through two of its outputs.
+            if (!isDead(op) || op->hasSuccessors() || !graph->hasOperator(op))
+                continue;
+            auto inputs = op->getInputs();
+            auto outputs = op->getOutputs();
+            graph->eraseOperator(op);
+            for (auto &t : outputs)
+                graph->removeTensor(t);
+            for (auto &t : inputs) {
+                if (!t)
+                    continue;
+                if (auto src = t->getSource()) {
+                    if (isDead(src))
+                        worklist.emplace_back(src);
+                } else if (!t->hasTarget() && !t->isInput()) {
+                    graph->removeTensor(t);
+                }
+            }
+            changed = true;
+        }
+        return changed;
+    }
+};
+
+} // namespace infini
+
+REGISTER_GRAPH_PASS(100, FoldQuantizeDequantizePass);
+REGISTER_GRAPH_PASS(200, ConstantFoldingPass);
+REGISTER_GRAPH_PASS(300, CommonSubexpressionEliminationPass);
+REGISTER_GRAPH_PASS(400, BatchNormFoldingPass);
+REGISTER_GRAPH_PASS(450, TransposeCanonicalizationPass);
+REGISTER_GRAPH_PASS(500, EpilogueFusionPass);
+REGISTER_GRAPH_PASS(550, HorizontalMatmulFusionPass);
+REGISTER_GRAPH_PASS(600, ElementWiseFusionPass);
+REGISTER_GRAPH_PASS(700, LayoutAssignmentPass);
+REGISTER_GRAPH_PASS(900, DeadCodeEliminationPass);
@@ -0,0 +1,100 @@
+#include "core/kernel.h"
+#include <cstdlib>
+
+namespace infini {
+
+bool KernelConstraints::accepts(const Operator &op) const {
+    if (!dtypes.empty() && std::find(dtypes.begin(), dtypes.end(),
+                                     op->getDType()) == dtypes.end())
+        return false;
+    if (!layouts.empty())
+        for (auto &tensors : {op->getInputs(), op->getOutputs()})
+            for (auto &tensor : tensors)
+                if (tensor && std::find(layouts.begin(), layouts.end(),
+                                        tensor->getLayout()) == layouts.end())
+                    return false;
+    return !check || check(op);
+}
+
+KernelRegistry::KernelRegistry() {
+    if (auto names = std::getenv("INFINI_FORCE_KERNEL")) {
+        std::istringstream is(names);
+        for (string name; std::getline(is, name, ',');)
+            if (!name.empty())
+                forced.insert(name);
+    }
+}
+
+bool KernelRegistry::registerKernel(const KernelAttrs &key, Kernel *kernel,
+                                    string name, int priority,
+                                    KernelConstraints constraints) {
+    auto &candidates = kernels[key];
+    for (auto &candidate : candidates)
+        IT_ASSERT(candidate.name != name, "Kernel already registered");
+    Candidate candidate{kernel, std::move(name), ++nKernels, priority,
+                        std::move(constraints)};
+    auto pos = std::find_if(
+        candidates.begin(), candidates.end(),
+        [&](const Candidate &c) { return c.priority < candidate.priority; });
+    candidates.insert(pos, std::move(candidate));
+    return true;
+}
+
+Kernel *KernelRegistry::getKernel(const KernelAttrs &kernelAttrs) const {
+    auto it = kernels.find(kernelAttrs);
+    IT_ASSERT(it != kernels.end(), "Kernel not found for key {" +
+                                       get_kernel_attrs_str(kernelAttrs) +
+                                       "}");
+    for (auto &candidate : it->second)
+        if (forced.count(candidate.name))
+            return candidate.kernel;
+    return it->second.front().kernel;
+}
+
+Kernel *KernelRegistry::getKernel(const KernelAttrs &kernelAttrs,
+                                  const Operator &op,
+                                  const PerfRecord &record) const {
+    auto candidates = getCandidates(kernelAttrs, op);
+    IT_ASSERT(!candidates.empty(), "No kernel accepts " + op->toString());
+    if (record && !record->kernel.empty())
+        for (auto candidate : candidates)
+            if (candidate->name == record->kernel)
+                return candidate->kernel;
+    return candidates.front()->kernel;
+}
+
+vector<const KernelRegistry::Candidate *>
+KernelRegistry::getCandidates(const KernelAttrs &kernelAttrs,
+                              const Operator &op) const {
+    auto it = kernels.find(kernelAttrs);
+    IT_ASSERT(it != kernels.end(), "Kernel not found for key {" +
+                                       get_kernel_attrs_str(kernelAttrs) +
+                                       "}");
+    vector<const Candidate *> ret;
+    for (auto &candidate : it->second) {
+        if (forced.count(candidate.name))
+            return {&candidate};
+        if (candidate.constraints.accepts(op))
+            ret.emplace_back(&candidate);
+    }
+    return ret;
+}
+
+PerfRecord KernelRegistry::tune(const KernelAttrs &kernelAttrs,
+                                const Operator &op,
+                                const RuntimeObj *context) const {
+    PerfRecord best;
+    for (auto candidate : getCandidates(kernelAttrs, op)) {
+        auto record = candidate->kernel->tune(op, context);
+        if (!record)
+            record = make_ref<PerfRecordObj>(Tuner::getInstance().measure(
+                [&]() { candidate->kernel->compute(op, context); }));
+        record->kernel = candidate->name;
+        if (!best || record->time < best->time)
+            best = record;
+    }
+    IT_ASSERT(best, "No kernel accepts " + op->toString());
+    return best;
+}
+
+} // namespace infini
@@ -199,6 +199,13 @@ void *LazyAllocator::getWeightPtr() {
     }
 }
 
+void LazyAllocator::resetWeight() {
+    if (!hasMemPool && this->weightPtr != nullptr)
+        runtime->dealloc(this->weightPtr);
+    this->weightPtr = nullptr;
+    this->weightPeak = 0;
+}
+
 void *LazyAllocator::getHeapPtr() {
     IT_ASSERT(hasMemPool);
     return this->memPoolPtr;
@@ -210,8 +217,11 @@ size_t LazyAllocator::getAlignedSize(size_t size) {
 
 void LazyAllocator::info() {
     std::cout << "Used memory: " << this->used + this->weightPeak
-              << ", peak memory: " << this->peak + this->weightPeak
-              << std::endl;
+              << ", peak memory: " << this->peak + this->weightPeak;
+    if (this->unscheduledPeak)
+        std::cout << " (" << this->unscheduledPeak + this->weightPeak
+                  << " before memory-aware scheduling)";
+    std::cout << std::endl;
 }
 
 } // namespace infini
@@ -225,6 +225,9 @@ const char *OpType::toString() const {
         CASE(AllReduceAvg);
         CASE(AllGather);
         CASE(Broadcast);
+
+        CASE(QuantizedMatMul);
+        CASE(FusedElementWise);
     default:
         return "Unknown";
     }
@@ -279,8 +282,9 @@ bool OpType::isGlobalPool() const {
 
 bool OpType::isMatMulOrConv() const {
     static const std::unordered_set<decltype(type)> set{
-        Conv,        Conv3d, ConvInteger,   ConvTranspose, DeformConv,
-        QLinearConv, MatMul, MatMulInteger, QLinearMatMul,
+        Conv,          Conv3d,        ConvInteger,     ConvTranspose,
+        DeformConv,    QLinearConv,   MatMul,          MatMulInteger,
+        QLinearMatMul, QuantizedMatMul,
     };
 
     return set.find(type) != set.end();
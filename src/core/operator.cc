@@ -1,4 +1,5 @@
 #include "core/operator.h"
+#include "core/descriptor_cache.h"
 #include "core/graph.h"
 #include "core/hash.h"
 
@@ -56,6 +57,10 @@ HashType OperatorObj::hash() const {
     return hash;
 }
 
+bool OperatorObj::hasSameAttrs(const OperatorObj &rhs) const {
+    return type == rhs.type && getOpAttrVector() == rhs.getOpAttrVector();
+}
+
 bool OperatorObj::checkValid(GraphObj *graph) {
     auto optShapes = inferShape();
     if (!optShapes) // shape inference failed
@@ -86,6 +91,44 @@ void OperatorObj::initInfiniOp(const Runtime context) {
     opDesc = nullptr;
 }
 
+bool OperatorObj::reuseInfiniOpDesc(const Runtime &context) {
+    DescriptorCache::Key key{reinterpret_cast<int64_t>(context.get())};
+    for (auto attr : getOpAttrVector())
+        key.emplace_back(attr);
+    for (auto &tensors : {inputs, outputs})
+        for (auto &tensor : tensors) {
+            auto dims = tensor->getDims();
+            key.emplace_back(tensor->getDType().getIndex());
+            key.emplace_back(dims.size());
+            key.insert(key.end(), dims.begin(), dims.end());
+        }
+    if (key == descKey)
+        return true;
+    descKey = std::move(key);
+    auto cached = DescriptorCache::getInstance().lookup(descKey);
+    descHolder = cached ? cached->desc : nullptr;
+    descWorkspaceSize = cached ? cached->workspaceSize : 0;
+    opDesc = descHolder.get();
+    return cached.has_value();
+}
+
+void OperatorObj::cacheInfiniOpDesc(void (*destroy)(void *),
+                                    size_t workspaceSize) {
+    descHolder = std::shared_ptr<void>(opDesc, [destroy](void *desc) {
+        if (!desc)
+            return;
+        try {
+            destroy(desc);
+        } catch (const std::exception &e) {
+            std::cerr << "Error in destroying an infiniop descriptor: "
+                      << e.what() << std::endl;
+        }
+    });
+    descWorkspaceSize = workspaceSize;
+    DescriptorCache::getInstance().insert(descKey,
+                                          {descHolder, workspaceSize});
+}
+
 optional<vector<Shape>> OperatorObj::inferShape() { return inferShape(inputs); }
 
 vector<DataType> OperatorObj::inferDataType(const TensorVec &inputs) const {
@@ -1,26 +1,15 @@
 #include "core/perf_engine.h"
+#include <cstdio>
+#include <fcntl.h>
 #include <fstream>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
 namespace infini {
 
 REGISTER_CONSTRUCTOR(0, PerfRecordObj::from_json);
 
-void PerfEngine::savePerfEngineData(std::string file_path) {
-    std::ofstream fileout(file_path,
-                          std::ios::out | std::ios::trunc | std::ios::binary);
-    json t = this->getInstance();
-    fileout << t << std::endl;
-    fileout.close();
-}
-
-void PerfEngine::loadPerfEngineData(std::string file_path) {
-    std::ifstream filein(file_path, std::ios::in | std::ios::binary);
-    string t;
-    filein >> t;
-    json j = json::parse(t);
-    from_json(j, this->getInstance());
-    filein.close();
-}
-
 /* json register should in the common namespace with corresponding type*/
 void to_json(json &j, const OpPerfKey &p) {
     j = json{{"hashType", p.hash}, {"opType", p.opType}, {"attrs", p.attrs}};
@@ -32,16 +21,242 @@ void from_json(const json &j, OpPerfKey &p) {
 }
 void to_json(json &j, const DataType &p) { j = p.getIndex(); }
 void from_json(const json &j, DataType &p) { p = DataType(j.get<int>()); }
-void to_json(json &j, const PerfRecord &p) { p->to_json(j); }
+void to_json(json &j, const PerfRecord &p) {
+    p->to_json(j);
+    if (!p->kernel.empty())
+        j["kernel"] = p->kernel;
+}
 void from_json(const json &j, PerfRecord &p) {
     int type = j["type"].get<int>();
     p = PerfRecordRegistry::getInstance().getConstructor(type)(j);
+    p->kernel = j.value("kernel", "");
+}
+
+namespace {
+
+const char *formatName = "InfiniTensor PerfEngine";
+
+// An advisory lock on a whole file, shared between processes. Writers
+// replace the file by renaming over it, so the lock is taken again if the
+// path no longer names the locked file.
+class FileLock {
+    int fd;
+
+  public:
+    FileLock(const string &path, bool exclusive) {
+        for (;;) {
+            fd = exclusive ? open(path.c_str(), O_RDWR | O_CREAT | O_APPEND,
+                                  0644)
+                           : open(path.c_str(), O_RDONLY);
+            IT_ASSERT(fd >= 0, "Cannot open " + path);
+            IT_ASSERT(flock(fd, exclusive ? LOCK_EX : LOCK_SH) == 0,
+                      "Cannot lock " + path);
+            struct stat locked, named;
+            IT_ASSERT(fstat(fd, &locked) == 0, "Cannot stat " + path);
+            if (stat(path.c_str(), &named) == 0 &&
+                named.st_dev == locked.st_dev && named.st_ino == locked.st_ino)
+                break;
+            close(fd);
+        }
+    }
+    ~FileLock() { close(fd); }
+    FileLock(const FileLock &) = delete;
+    FileLock &operator=(const FileLock &) = delete;
+
+    // Whether the file is empty or its last line is complete.
+    bool endsWithNewline() const {
+        struct stat st;
+        IT_ASSERT(fstat(fd, &st) == 0);
+        char last = '\n';
+        if (st.st_size > 0)
+            IT_ASSERT(pread(fd, &last, 1, st.st_size - 1) == 1,
+                      "Cannot read the tuning database");
+        return last == '\n';
+    }
+
+    void write(const string &text) {
+        for (size_t done = 0; done < text.size();) {
+            auto n = ::write(fd, text.data() + done, text.size() - done);
+            IT_ASSERT(n > 0, "Cannot write the tuning database");
+            done += n;
+        }
+    }
+};
+
+json header(const string &fingerprint) {
+    return json{{"format", formatName},
+                {"version", PerfEngine::formatVersion},
+                {"fingerprint", fingerprint}};
+}
+
+string recordLine(const PerfEngine::Key &key, const PerfRecord &record) {
+    return json{{"key", key}, {"record", record}}.dump() + "\n";
+}
+
+} // namespace
+
+size_t PerfEngine::KeyHash::operator()(const Key &key) const {
+    auto &[attrs, opKey] = key;
+    size_t ret = std::hash<OpPerfKey>()(opKey);
+    auto combine = [&](size_t v) {
+        ret ^= v + 0x9e3779b97f4a7c15ull + (ret << 6) + (ret >> 2);
+    };
+    combine(size_t(std::get<0>(attrs)));
+    combine(std::get<1>(attrs));
+    for (auto a : opKey.attrs)
+        combine(std::hash<int>()(a));
+    return ret;
+}
+
+PerfRecord PerfEngine::getPerfData(const Key &key) const {
+    std::shared_lock lock(mutex);
+    auto it = data.find(key);
+    return it == data.end() ? nullptr : it->second;
+}
+
+void PerfEngine::setPerfData(const Key &key, PerfRecord record) {
+    std::unique_lock lock(mutex);
+    data[key] = std::move(record);
+    unsaved.insert(key);
+}
+
+bool PerfEngine::mergePerfData(const Key &key, PerfRecord record) {
+    std::unique_lock lock(mutex);
+    auto [it, inserted] = data.try_emplace(key, record);
+    if (!inserted) {
+        if (it->second->time <= record->time)
+            return false;
+        it->second = std::move(record);
+    }
+    return true;
+}
+
+size_t PerfEngine::size() const {
+    std::shared_lock lock(mutex);
+    return data.size();
+}
+
+map<PerfEngine::Key, PerfRecord> PerfEngine::get_data() const {
+    std::shared_lock lock(mutex);
+    return map<Key, PerfRecord>(data.begin(), data.end());
+}
+
+void PerfEngine::set_data(map<Key, PerfRecord> records) {
+    std::unique_lock lock(mutex);
+    data = {records.begin(), records.end()};
+    unsaved.clear();
+}
+
+string PerfEngine::getFingerprint() const {
+    std::shared_lock lock(mutex);
+    return fingerprint;
+}
+
+void PerfEngine::setFingerprint(string fingerprint) {
+    std::unique_lock lock(mutex);
+    this->fingerprint = std::move(fingerprint);
 }
 
-void to_json(json &j, const PerfEngine &p) {
-    auto &x = p.getInstance();
-    j["data"] = x.get_data();
+string PerfEngine::hostFingerprint() {
+    string model = "unknown";
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    for (string line; std::getline(cpuinfo, line);)
+        if (line.rfind("model name", 0) == 0) {
+            model = line.substr(line.find(':') + 2);
+            break;
+        }
+    return "cpu=" + model +
+           ";threads=" + std::to_string(std::thread::hardware_concurrency());
 }
+
+void PerfEngine::savePerfEngineData(std::string file_path) {
+    string text;
+    {
+        std::unique_lock lock(mutex);
+        text = header(fingerprint).dump() + "\n";
+        for (auto &[key, record] : data)
+            text += recordLine(key, record);
+        unsaved.clear();
+    }
+    // Appenders hold the same lock, so none of them writes to the file
+    // being replaced.
+    FileLock file(file_path, true);
+    auto tmp = file_path + ".tmp." + std::to_string(getpid());
+    std::ofstream fileout(tmp,
+                          std::ios::out | std::ios::trunc | std::ios::binary);
+    fileout << text;
+    fileout.close();
+    IT_ASSERT(fileout && std::rename(tmp.c_str(), file_path.c_str()) == 0,
+              "Cannot write " + file_path);
+}
+
+void PerfEngine::appendPerfEngineData(std::string file_path) {
+    FileLock file(file_path, true);
+    std::ifstream filein(file_path, std::ios::in | std::ios::binary);
+    string first;
+    std::getline(filein, first);
+    std::unique_lock lock(mutex);
+    string text;
+    if (first.empty())
+        text = header(fingerprint).dump() + "\n";
+    else {
+        auto j = json::parse(first, nullptr, false);
+        IT_ASSERT(!j.is_discarded() && j.value("format", "") == formatName &&
+                      j.value("version", 0) == formatVersion,
+                  file_path + " is not a tuning database of this version");
+        IT_ASSERT(j.value("fingerprint", "") == fingerprint,
+                  file_path + " was tuned on other hardware");
+        // Finish a line cut short by a crashed writer; the loader skips it.
+        if (!file.endsWithNewline())
+            text = "\n";
+    }
+    for (auto &key : unsaved)
+        text += recordLine(key, data.at(key));
+    file.write(text);
+    unsaved.clear();
+}
+
+size_t PerfEngine::loadPerfEngineData(std::string file_path) {
+    FileLock file(file_path, false);
+    std::ifstream filein(file_path, std::ios::in | std::ios::binary);
+    string first;
+    std::getline(filein, first);
+    auto j = json::parse(first, nullptr, false);
+    size_t ret = 0;
+    if (j.is_discarded() || !j.contains("format")) {
+        // The single-object format of version 1, without a fingerprint.
+        filein.clear();
+        filein.seekg(0);
+        j = json::parse(filein);
+        for (auto &[key, record] :
+             j["data"].get<map<PerfEngine::Key, PerfRecord>>()) {
+            mergePerfData(key, record);
+            ++ret;
+        }
+        return ret;
+    }
+    IT_ASSERT(j.value("format", "") == formatName &&
+                  j.value("version", 0) == formatVersion,
+              file_path + " is not a tuning database of this version");
+    if (j.value("fingerprint", "") != getFingerprint())
+        return 0;
+    for (string line; std::getline(filein, line);) {
+        Key key;
+        PerfRecord record;
+        try {
+            auto entry = json::parse(line);
+            entry.at("key").get_to(key);
+            entry.at("record").get_to(record);
+        } catch (const std::exception &) {
+            continue;
+        }
+        mergePerfData(key, record);
+        ++ret;
+    }
+    return ret;
+}
+
+void to_json(json &j, const PerfEngine &p) { j["data"] = p.get_data(); }
 void from_json(const json &j, PerfEngine &p) {
     auto tmp = j["data"].get<map<PerfEngine::Key, PerfRecord>>();
     p.set_data(tmp);
@@ -2,6 +2,7 @@
 #include "core/blob.h"
 #include "core/kernel.h"
 #include "core/perf_engine.h"
+#include "core/tuner.h"
 #include "utils/data_generator.h"
 #include <chrono>
 #include <cstring>
@@ -29,28 +30,25 @@ void CpuRuntimeObj::run(const Graph &graph, bool tune, bool profiling) const {
     std::map<OpType, double> opTime;
     std::map<OpType, int> opCnt;
 
+    // Tune the candidate kernels of the operators without a record
+    if (tune)
+        Tuner::getInstance().tuneGraph(graph, this);
+
     for (auto &op : graph->getOperators()) {
         auto kernelAttrs = KernelAttrs{device, op->getOpType().underlying()};
-        Kernel *kernel = kernelRegistry.getKernel(kernelAttrs);
         auto perfKey = PerfEngine::Key{kernelAttrs, op->getOpPerfKey()};
         auto perfData = perfEngine.getPerfData(perfKey);
 
-        // If no record and disable tuning, run with the default argument
-        if (!perfData && !tune) {
-            kernel->compute(op, this);
+        // If no record, e.g. tuning is disabled or out of budget, run with
+        // the default argument
+        if (!perfData) {
+            kernelRegistry.getKernel(kernelAttrs, op)->compute(op, this);
             continue;
         }
 
         // TODO: The copy of record should be eliminated
-        PerfRecord record;
-        // Tune the kernel if there is no record
-        if (!perfData) {
-            // TODO: record is not used
-            // printf("no record data\n");
-            record = kernel->tune(op, this);
-            perfEngine.setPerfData(perfKey, record);
-        } else
-            record = perfData;
+        PerfRecord record = perfData;
+        Kernel *kernel = kernelRegistry.getKernel(kernelAttrs, op, record);
 
         kernel->computeFuncTune(perfKey, op, record, this);
         ComputeFuncPtr funcPtr = kernel->getComputeFunc(perfKey);
@@ -82,7 +80,6 @@ double RuntimeObj::getPerfTime(const Graph &graph, bool profiling) const {
 
     for (auto &op : graph->getOperators()) {
         auto kernelAttrs = KernelAttrs{device, op->getOpType().underlying()};
-        Kernel *kernel = kernelRegistry.getKernel(kernelAttrs);
         auto perfKey = PerfEngine::Key{kernelAttrs, op->getOpPerfKey()};
         auto perfData = perfEngine.getPerfData(perfKey);
 
@@ -104,7 +101,7 @@ double RuntimeObj::getPerfTime(const Graph &graph, bool profiling) const {
             }
 
             // Profile operators and record the results
-            record = kernel->tune(op, this);
+            record = kernelRegistry.tune(kernelAttrs, op, this);
             perfEngine.setPerfData(perfKey, record);
 
             // Free allocated memory
@@ -175,4 +172,32 @@ void CpuRuntimeObj::copyBlobInsideRuntime(void *dst, const void *src,
 
 string NativeCpuRuntimeObj::toString() const { return "CPU Runtime"; }
 
+namespace {
+thread_local NativeCpuRuntimeObj::ThreadWorkspace *threadWorkspace = nullptr;
+}
+
+void *NativeCpuRuntimeObj::getWorkspace(size_t size) const {
+    IT_ASSERT(size <= workspaceSize);
+    return threadWorkspace ? threadWorkspace->get(size) : workspace;
+}
+
+NativeCpuRuntimeObj::ThreadWorkspace::ThreadWorkspace() {
+    IT_ASSERT(!threadWorkspace, "The thread already has a workspace");
+    threadWorkspace = this;
+}
+
+NativeCpuRuntimeObj::ThreadWorkspace::~ThreadWorkspace() {
+    threadWorkspace = nullptr;
+}
+
+void *NativeCpuRuntimeObj::ThreadWorkspace::get(size_t size) {
+    // Grown on demand, as the shared workspace is far larger than kernels
+    // need.
+    size_t words = std::max<size_t>(
+        1, (size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    if (buffer.size() < words)
+        buffer.resize(words);
+    return buffer.data();
+}
+
 } // namespace infini
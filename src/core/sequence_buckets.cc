@@ -0,0 +1,81 @@
+#include "core/sequence_buckets.h"
+#include "core/runtime.h"
+
+namespace infini {
+
+SequenceBuckets::SequenceBuckets(SymbolicGraph &graph,
+                                 vector<vector<int>> buckets, bool tune)
+    : graph(graph) {
+    IT_ASSERT(!buckets.empty(), "No buckets are given");
+    for (auto &symbol : graph.getSymbols())
+        for (auto &[tensor, axis] : symbol.dims)
+            if (std::find(inputs.begin(), inputs.end(), tensor) ==
+                inputs.end())
+                inputs.emplace_back(tensor);
+    vector<std::pair<size_t, vector<int>>> sized;
+    for (auto &values : buckets) {
+        IT_ASSERT(values.size() == graph.getSymbols().size(),
+                  "A bucket needs a value for every symbol");
+        sized.emplace_back(graph.getActivationBytes(values),
+                           std::move(values));
+    }
+    std::sort(sized.begin(), sized.end());
+    sized.erase(std::unique(sized.begin(), sized.end()), sized.end());
+    for (auto &[bytes, values] : sized)
+        stats.push_back({values});
+
+    auto runtime = graph.getGraph()->getRuntime();
+    for (auto it = stats.rbegin(); it != stats.rend(); ++it) {
+        graph.bind(it->values);
+        if (tune)
+            runtime->run(graph.getGraph(), true);
+    }
+}
+
+int SequenceBuckets::find(const vector<int> &values) const {
+    IT_ASSERT(values.size() == graph.getSymbols().size());
+    for (size_t i = 0; i < stats.size(); ++i) {
+        auto &bucket = stats[i].values;
+        bool holds = true;
+        for (size_t s = 0; s < values.size(); ++s)
+            holds = holds && values[s] <= bucket[s];
+        if (holds)
+            return int(i);
+    }
+    return -1;
+}
+
+int SequenceBuckets::bind(const vector<int> &values) {
+    int index = find(values);
+    if (index < 0) {
+        ++misses;
+        graph.bind(values);
+        return index;
+    }
+    auto &stat = stats[index];
+    auto used = inputElements(values);
+    ++stat.hits;
+    stat.usedElements += used;
+    stat.paddedElements += inputElements(stat.values) - used;
+    graph.bind(stat.values);
+    return index;
+}
+
+void SequenceBuckets::resetStats() {
+    for (auto &stat : stats)
+        stat.hits = stat.usedElements = stat.paddedElements = 0;
+    misses = 0;
+}
+
+size_t SequenceBuckets::inputElements(const vector<int> &values) const {
+    size_t ret = 0;
+    for (auto &tensor : inputs) {
+        size_t size = 1;
+        for (auto d : graph.getShape(tensor, values))
+            size *= d;
+        ret += size;
+    }
+    return ret;
+}
+
+} // namespace infini
@@ -0,0 +1,327 @@
+#include "core/symbolic_shape.h"
+#include "core/blob.h"
+#include "core/runtime.h"
+
+namespace infini {
+
+// Slot offsets are multiples of this, which satisfies every runtime.
+constexpr size_t slotAlignment = 256;
+
+int64_t AffineExpr::eval(const vector<int> &values) const {
+    int64_t ret = constant;
+    for (size_t i = 0; i < coeffs.size(); ++i)
+        ret += coeffs[i] * values[i];
+    return ret;
+}
+
+bool AffineExpr::isConstant() const {
+    return std::all_of(coeffs.begin(), coeffs.end(),
+                       [](int64_t c) { return c == 0; });
+}
+
+string AffineExpr::toString(const vector<string> &names) const {
+    std::ostringstream os;
+    bool first = true;
+    for (size_t i = 0; i < coeffs.size(); ++i) {
+        if (coeffs[i] == 0)
+            continue;
+        if (!first)
+            os << (coeffs[i] > 0 ? "+" : "-");
+        else if (coeffs[i] < 0)
+            os << "-";
+        if (std::abs(coeffs[i]) != 1)
+            os << std::abs(coeffs[i]) << "*";
+        os << names[i];
+        first = false;
+    }
+    if (first)
+        os << constant;
+    else if (constant != 0)
+        os << (constant > 0 ? "+" : "-") << std::abs(constant);
+    return os.str();
+}
+
+Polynomial::Polynomial(int64_t constant) {
+    if (constant != 0)
+        terms[{}] = constant;
+}
+
+Polynomial::Polynomial(const AffineExpr &expr) : Polynomial(expr.constant) {
+    for (size_t i = 0; i < expr.coeffs.size(); ++i)
+        if (expr.coeffs[i] != 0)
+            terms[{int(i)}] = expr.coeffs[i];
+}
+
+Polynomial Polynomial::operator*(const Polynomial &rhs) const {
+    Polynomial ret;
+    for (auto &[a, ca] : terms)
+        for (auto &[b, cb] : rhs.terms) {
+            vector<int> monomial(a.size() + b.size());
+            std::merge(a.begin(), a.end(), b.begin(), b.end(),
+                       monomial.begin());
+            if ((ret.terms[monomial] += ca * cb) == 0)
+                ret.terms.erase(monomial);
+        }
+    return ret;
+}
+
+Polynomial Polynomial::upperBound(const Polynomial &rhs) const {
+    Polynomial ret = *this;
+    for (auto &[monomial, c] : ret.terms)
+        if (!rhs.terms.count(monomial))
+            c = std::max<int64_t>(c, 0);
+    for (auto &[monomial, c] : rhs.terms) {
+        auto it = ret.terms.find(monomial);
+        if (it == ret.terms.end())
+            ret.terms[monomial] = std::max<int64_t>(c, 0);
+        else
+            it->second = std::max(it->second, c);
+    }
+    for (auto it = ret.terms.begin(); it != ret.terms.end();)
+        it = it->second == 0 ? ret.terms.erase(it) : std::next(it);
+    return ret;
+}
+
+int64_t Polynomial::eval(const vector<int> &values) const {
+    int64_t ret = 0;
+    for (auto &[monomial, c] : terms) {
+        int64_t term = c;
+        for (auto i : monomial)
+            term *= values[i];
+        ret += term;
+    }
+    return ret;
+}
+
+string Polynomial::toString(const vector<string> &names) const {
+    if (terms.empty())
+        return "0";
+    std::ostringstream os;
+    bool first = true;
+    for (auto &[monomial, c] : terms) {
+        os << (c < 0 ? "-" : first ? "" : "+");
+        if (std::abs(c) != 1 || monomial.empty())
+            os << std::abs(c) << (monomial.empty() ? "" : "*");
+        for (size_t i = 0; i < monomial.size(); ++i)
+            os << (i ? "*" : "") << names[monomial[i]];
+        first = false;
+    }
+    return os.str();
+}
+
+SymbolicGraph::SymbolicGraph(Graph graph, vector<Symbol> symbols)
+    : graph(std::move(graph)), symbols(std::move(symbols)) {
+    IT_ASSERT(this->graph->topo_sort());
+    tensors = this->graph->getTensors();
+    for (auto &tensor : tensors)
+        IT_ASSERT(!tensor->isWeight() || tensor->hasData(),
+                  "Weights must be allocated by dataMalloc() first");
+    vector<int> base;
+    for (auto &symbol : this->symbols) {
+        IT_ASSERT(!symbol.dims.empty(), "Symbol " + symbol.name + " is unused");
+        auto &[tensor, axis] = symbol.dims[0];
+        base.emplace_back(tensor->getDims().at(axis));
+        for (auto &[t, a] : symbol.dims) {
+            IT_ASSERT(!t->getSource() && !t->isWeight(),
+                      "Symbol " + symbol.name + " is not on a graph input");
+            IT_ASSERT(t->getDims().at(a) == base.back(),
+                      "Dimensions of symbol " + symbol.name + " differ");
+        }
+    }
+
+    // One probe per symbol gives the coefficients, one more checks them.
+    size_t n = base.size();
+    auto shapes = probe(base);
+    vector<vector<Shape>> steps;
+    for (size_t i = 0; i < n; ++i) {
+        auto values = base;
+        ++values[i];
+        steps.emplace_back(probe(values));
+    }
+    vector<int> check = base;
+    for (size_t i = 0; i < n; ++i)
+        check[i] = base[i] * 2 + int(i) + 3;
+    auto checked = probe(check);
+
+    for (size_t t = 0; t < tensors.size(); ++t) {
+        vector<AffineExpr> exprs(shapes[t].size());
+        for (size_t d = 0; d < exprs.size(); ++d) {
+            auto &expr = exprs[d];
+            expr.constant = shapes[t][d];
+            for (size_t i = 0; i < n; ++i) {
+                IT_ASSERT(steps[i][t].size() == shapes[t].size(),
+                          "Rank of tensor " +
+                              std::to_string(tensors[t]->getFuid()) +
+                              " depends on the symbols");
+                expr.coeffs.emplace_back(steps[i][t][d] - shapes[t][d]);
+                expr.constant -= expr.coeffs[i] * base[i];
+            }
+            IT_ASSERT(checked[t].size() == shapes[t].size() &&
+                          expr.eval(check) == checked[t][d],
+                      "Dimension " + std::to_string(d) + " of tensor " +
+                          std::to_string(tensors[t]->getFuid()) +
+                          " is not affine in the symbols");
+            IT_ASSERT(!tensors[t]->isWeight() || expr.isConstant(),
+                      "Weight " + std::to_string(tensors[t]->getFuid()) +
+                          " depends on the symbols");
+        }
+        dims.emplace(tensors[t].get(), std::move(exprs));
+    }
+    probe(base);
+    planSlots(base);
+    bind(base);
+}
+
+SymbolicGraph::~SymbolicGraph() {
+    if (arena)
+        graph->getRuntime()->dealloc(arena);
+}
+
+vector<Shape> SymbolicGraph::probe(const vector<int> &values) {
+    for (size_t i = 0; i < symbols.size(); ++i)
+        for (auto &[tensor, axis] : symbols[i].dims) {
+            auto shape = tensor->getDims();
+            shape[axis] = values[i];
+            tensor->setShape(shape);
+        }
+    for (auto &op : graph->getOperators()) {
+        auto shapes = op->inferShape(op->getInputs());
+        IT_ASSERT(shapes.has_value(),
+                  "Shape inference failed for " + op->toString());
+        for (size_t i = 0; i < shapes->size(); ++i)
+            if (op->getOutput(i)->getDims() != shapes->at(i))
+                op->getOutput(i)->setShape(shapes->at(i));
+    }
+    vector<Shape> ret;
+    for (auto &tensor : tensors)
+        ret.emplace_back(tensor->getDims());
+    return ret;
+}
+
+const vector<AffineExpr> &SymbolicGraph::getDims(const Tensor &tensor) const {
+    auto it = dims.find(tensor.get());
+    IT_ASSERT(it != dims.end(), "Tensor is not in the specialized graph");
+    return it->second;
+}
+
+Shape SymbolicGraph::getShape(const Tensor &tensor,
+                               const vector<int> &values) const {
+    Shape ret;
+    for (auto &expr : getDims(tensor))
+        ret.emplace_back(expr.eval(values));
+    return ret;
+}
+
+Polynomial SymbolicGraph::getBytes(const Tensor &tensor) const {
+    Polynomial ret(tensor->getDType().getSize());
+    for (auto &expr : getDims(tensor))
+        ret = ret * Polynomial(expr);
+    return ret;
+}
+
+// Follows planActivations() in graph.cc: inputs, outputs and tensors
+// without a source keep their slot; other tensors take a free slot from
+// their producer to their last consumer. Of the free slots, the one that
+// grows least at `values` is taken.
+void SymbolicGraph::planSlots(const vector<int> &values) {
+    vector<size_t> freeSlots;
+    std::unordered_map<TensorObj *, size_t> slots, refCounts;
+    auto place = [&](const Tensor &tensor, bool reuse) {
+        auto bytes = getBytes(tensor);
+        size_t best = slotBytes.size();
+        int64_t bestGrowth = 0;
+        for (auto slot : reuse ? freeSlots : vector<size_t>{}) {
+            int64_t growth = slotBytes[slot].upperBound(bytes).eval(values) -
+                             slotBytes[slot].eval(values);
+            if (best == slotBytes.size() || growth < bestGrowth)
+                best = slot, bestGrowth = growth;
+        }
+        if (best == slotBytes.size())
+            slotBytes.emplace_back(bytes);
+        else {
+            slotBytes[best] = slotBytes[best].upperBound(bytes);
+            freeSlots.erase(
+                std::find(freeSlots.begin(), freeSlots.end(), best));
+        }
+        slots[tensor.get()] = best;
+        slotOf.emplace_back(tensor, best);
+    };
+    for (auto &tensor : tensors) {
+        if (tensor->isWeight())
+            continue;
+        if (tensor->isInput() || tensor->isOutput())
+            place(tensor, false);
+        else {
+            refCounts[tensor.get()] = tensor->getTargets().size();
+            if (!tensor->getSource())
+                place(tensor, false);
+        }
+    }
+    for (auto &op : graph->getOperators()) {
+        for (auto &tensor : op->getOutputs())
+            if (tensor && tensor->isOthers())
+                place(tensor, true);
+        for (auto &tensor : op->getInputs())
+            if (tensor && tensor->isOthers() && --refCounts[tensor.get()] == 0)
+                freeSlots.emplace_back(slots[tensor.get()]);
+    }
+    slotOffsets.resize(slotBytes.size() + 1);
+}
+
+size_t SymbolicGraph::getActivationBytes(const vector<int> &values) const {
+    size_t ret = 0;
+    for (auto &bytes : slotBytes)
+        ret += (bytes.eval(values) + slotAlignment - 1) / slotAlignment *
+               slotAlignment;
+    return ret;
+}
+
+void SymbolicGraph::bind(const vector<int> &values) {
+    IT_ASSERT(values.size() == symbols.size());
+    for (auto v : values)
+        IT_ASSERT(v > 0, "Symbol values must be positive");
+    auto runtime = graph->getRuntime();
+    std::unordered_set<TensorObj *> changed;
+    for (auto &tensor : tensors) {
+        auto &exprs = dims.at(tensor.get());
+        Shape shape(exprs.size());
+        for (size_t d = 0; d < shape.size(); ++d)
+            shape[d] = exprs[d].eval(values);
+        if (shape != tensor->getDims()) {
+            tensor->setShape(shape);
+            changed.insert(tensor.get());
+        }
+    }
+    // Operators such as Matmul keep sizes derived from their inputs, which
+    // inferShape() refreshes; its results must match the closed forms.
+    for (auto &op : graph->getOperators()) {
+        auto &inputs = op->getInputs();
+        if (std::none_of(inputs.begin(), inputs.end(), [&](const Tensor &t) {
+                return changed.count(t.get());
+            }))
+            continue;
+        auto shapes = op->inferShape(inputs);
+        for (size_t i = 0; i < op->getOutputs().size(); ++i)
+            IT_ASSERT(shapes && shapes->at(i) == op->getOutput(i)->getDims(),
+                      "Shape of " + op->toString() +
+                          " differs from its closed form");
+        if (op->hasInfiniOpDesc())
+            op->initInfiniOp(runtime);
+    }
+
+    for (size_t k = 0; k < slotBytes.size(); ++k)
+        slotOffsets[k + 1] =
+            slotOffsets[k] + (slotBytes[k].eval(values) + slotAlignment - 1) /
+                                 slotAlignment * slotAlignment;
+    if (slotOffsets.back() > arenaBytes) {
+        if (arena)
+            runtime->dealloc(arena);
+        arenaBytes = slotOffsets.back();
+        arena = runtime->alloc(arenaBytes);
+    }
+    for (auto &[tensor, slot] : slotOf)
+        tensor->setDataBlob(make_ref<BlobObj>(
+            runtime, static_cast<uint8_t *>(arena) + slotOffsets[slot]));
+}
+
+} // namespace infini
@@ -22,8 +22,10 @@ string TensorObj::toString() const {
         ss << "nullptr data";
     string ret = "Tensor " + std::to_string(guid) + ", Fuid " +
                  std::to_string(fuid) + ", shape " + vecToString(shape) +
-                 ", dtype " + dtype.toString() + ", " + runtime->toString() +
-                 ", " + ss.str() + ", " + tensorTypeToString() + "\n";
+                 ", dtype " + dtype.toString() +
+                 (layout == TensorLayout::NHWC ? ", NHWC" : "") + ", " +
+                 runtime->toString() + ", " + ss.str() + ", " +
+                 tensorTypeToString() + "\n";
     vector<UidBaseType> targetGuids;
     for (const auto &op : targets)
         targetGuids.emplace_back(op.lock()->getGuid());
@@ -66,6 +68,17 @@ void TensorObj::setShape(Shape shape_) {
     _size = size;
 }
 
+void TensorObj::setLayout(TensorLayout layout_) {
+    IT_ASSERT(layout_ == TensorLayout::NCHW || shape.size() == 4);
+    layout = layout_;
+}
+
+Shape TensorObj::getPhysicalDims() const {
+    if (layout == TensorLayout::NHWC)
+        return {shape[0], shape[2], shape[3], shape[1]};
+    return shape;
+}
+
 void TensorObj::dumpData(std::ofstream &ofs) const {
     IT_ASSERT(data != nullptr);
     if (!runtime->isCpu())
@@ -189,7 +202,9 @@ void TensorObj::setData(
 
 void TensorObj::setDataBlob(const Blob &blob) { this->data = blob; }
 
-void TensorObj::load(std::string file_path) { loadTensorData(this, file_path); }
+void TensorObj::load(std::string file_path, bool useMmap) {
+    loadTensorData(this, file_path, useMmap);
+}
 
 void TensorObj::save(std::string file_path) { saveTensorData(this, file_path); }
 
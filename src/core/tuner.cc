@@ -0,0 +1,283 @@
+#include "core/tuner.h"
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/perf_engine.h"
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace infini {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double msSince(Clock::time_point begin) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - begin)
+        .count();
+}
+
+double median(vector<double> values) {
+    auto mid = values.begin() + values.size() / 2;
+    std::nth_element(values.begin(), mid, values.end());
+    if (values.size() % 2)
+        return *mid;
+    return (*mid + *std::max_element(values.begin(), mid)) / 2;
+}
+
+// Samples within three scaled median absolute deviations of the median.
+vector<double> rejectOutliers(const vector<double> &samples) {
+    double m = median(samples);
+    vector<double> deviations;
+    for (auto x : samples)
+        deviations.emplace_back(std::abs(x - m));
+    double limit = 3 * 1.4826 * median(deviations);
+    if (limit == 0)
+        return samples;
+    vector<double> ret;
+    for (auto x : samples)
+        if (std::abs(x - m) <= limit)
+            ret.emplace_back(x);
+    return ret;
+}
+
+// Whether the 95% confidence interval of the median, from the order
+// statistics of the samples, is within `relativeError` of it.
+bool converged(vector<double> samples, double relativeError) {
+    std::sort(samples.begin(), samples.end());
+    double n = samples.size(), half = 1.96 * std::sqrt(n) / 2;
+    auto lo = size_t(std::max(0.0, std::floor(n / 2 - half)));
+    auto hi = size_t(std::min(n - 1, std::ceil(n / 2 + half)));
+    return samples[hi] - samples[lo] <= relativeError * median(samples);
+}
+
+// Evict the caches by writing a buffer larger than them. The buffer outlives
+// the call, so the writes are not optimized away.
+void flush(size_t bytes) {
+    thread_local vector<uint8_t> buffer;
+    buffer.resize(bytes);
+    std::memset(buffer.data(), buffer[0] + 1, bytes);
+}
+
+using Range = std::pair<uintptr_t, uintptr_t>;
+
+bool overlaps(const vector<Range> &a, const vector<Range> &b) {
+    for (auto &x : a)
+        for (auto &y : b)
+            if (x.first < y.second && y.first < x.second)
+                return true;
+    return false;
+}
+
+struct Task {
+    Operator op;
+    KernelAttrs attrs;
+    PerfEngine::Key key;
+    vector<Range> reads, writes;
+
+    bool conflicts(const Task &other) const {
+        return overlaps(writes, other.reads) ||
+               overlaps(writes, other.writes) || overlaps(reads, other.writes);
+    }
+};
+
+// The cores the calling thread may run on.
+vector<int> allowedCores() {
+    vector<int> ret;
+#ifdef __linux__
+    cpu_set_t cores;
+    if (pthread_getaffinity_np(pthread_self(), sizeof(cores), &cores) == 0)
+        for (int c = 0; c < CPU_SETSIZE; ++c)
+            if (CPU_ISSET(c, &cores))
+                ret.emplace_back(c);
+#endif
+    if (ret.empty())
+        for (unsigned c = 0; c < std::thread::hardware_concurrency(); ++c)
+            ret.emplace_back(c);
+    return ret;
+}
+
+// Pin the calling thread to slice `index` of `slices` disjoint slices of
+// `cores`, and give it as many OpenMP threads as the slice has cores.
+void pinToSlice(const vector<int> &cores, int index, int slices) {
+    int count = std::max(1, int(cores.size()) / slices);
+    if (int(cores.size()) >= slices) {
+#ifdef __linux__
+        cpu_set_t slice;
+        CPU_ZERO(&slice);
+        for (int c = index * count; c < (index + 1) * count; ++c)
+            CPU_SET(cores[c], &slice);
+        pthread_setaffinity_np(pthread_self(), sizeof(slice), &slice);
+#endif
+    }
+#ifdef _OPENMP
+    omp_set_num_threads(count);
+#endif
+}
+
+} // namespace
+
+double Tuner::measure(const std::function<void()> &func,
+                      const std::function<void()> &sync,
+                      bool flushCache) const {
+    auto begin = Clock::now();
+    auto run = [&](int repeats) {
+        auto start = Clock::now();
+        for (int i = 0; i < repeats; ++i)
+            func();
+        if (sync)
+            sync();
+        return msSince(start) / repeats;
+    };
+    double warm = 0;
+    for (int i = 0; i < options.warmupRounds; ++i)
+        warm = run(1);
+    int repeats = 1;
+    if (warm > 0 && warm < options.minTrialTime)
+        repeats = std::min(1000, int(std::ceil(options.minTrialTime / warm)));
+
+    vector<double> samples;
+    while (true) {
+        if (flushCache && options.flushBytes)
+            flush(options.flushBytes);
+        samples.emplace_back(run(repeats));
+        int n = samples.size();
+        if (n >= options.maxRounds || msSince(begin) >= options.maxTime)
+            break;
+        if (n >= options.minRounds &&
+            converged(rejectOutliers(samples), options.relativeError))
+            break;
+    }
+    return median(rejectOutliers(samples));
+}
+
+Tuner::GraphStats Tuner::tuneGraph(const Graph &graph,
+                                   const RuntimeObj *runtime) const {
+    IT_ASSERT(graph->topo_sort());
+    auto begin = Clock::now();
+    auto &registry = KernelRegistry::getInstance();
+    auto &perfEngine = PerfEngine::getInstance();
+    GraphStats stats;
+
+    vector<Task> tasks;
+    std::set<PerfEngine::Key> keys;
+    bool allocated = true;
+    for (auto &op : graph->getOperators()) {
+        KernelAttrs attrs{runtime->getDevice(), op->getOpType().underlying()};
+        PerfEngine::Key key{attrs, op->getOpPerfKey()};
+        if (perfEngine.getPerfData(key) || !keys.insert(key).second) {
+            ++stats.reused;
+            continue;
+        }
+        Task task{op, attrs, key, {}, {}};
+        for (auto [tensors, ranges] :
+             {std::make_pair(&op->getInputs(), &task.reads),
+              std::make_pair(&op->getOutputs(), &task.writes)})
+            for (auto &tensor : *tensors) {
+                if (!tensor)
+                    continue;
+                allocated = allocated && tensor->hasData();
+                if (tensor->hasData()) {
+                    auto ptr = reinterpret_cast<uintptr_t>(
+                        tensor->getRawDataPtr<void *>());
+                    ranges->emplace_back(ptr, ptr + tensor->getBytes());
+                }
+            }
+        tasks.emplace_back(std::move(task));
+    }
+    auto outOfBudget = [&] {
+        return options.graphBudget > 0 && msSince(begin) >= options.graphBudget;
+    };
+    auto tune = [&](const Task &task) {
+        perfEngine.setPerfData(task.key,
+                               registry.tune(task.attrs, task.op, runtime));
+    };
+
+    int threads = runtime->isCpu() && allocated ? options.threads : 1;
+    threads = std::max(1, std::min(threads, int(tasks.size())));
+    if (threads == 1) {
+        for (auto &task : tasks) {
+            if (outOfBudget()) {
+                ++stats.skipped;
+                continue;
+            }
+            tune(task);
+            ++stats.tuned;
+        }
+        stats.time = msSince(begin);
+        return stats;
+    }
+
+    // A task may start once it overlaps neither a running task nor an
+    // earlier one that is not done. Only a window of the first pending
+    // tasks is searched.
+    enum Status { pending, running, done };
+    vector<Status> status(tasks.size(), pending);
+    size_t first = 0;
+    const size_t window = 4 * threads;
+    std::mutex mutex;
+    std::condition_variable cv;
+    auto ready = [&](size_t i) {
+        for (size_t j = first; j < tasks.size(); ++j)
+            if (j != i &&
+                (status[j] == running || (j < i && status[j] != done)) &&
+                tasks[i].conflicts(tasks[j]))
+                return false;
+        return true;
+    };
+    auto cores = allowedCores();
+    auto worker = [&](int w) {
+        pinToSlice(cores, w, threads);
+        // Kernels that take the runtime workspace must not share it.
+        NativeCpuRuntimeObj::ThreadWorkspace workspace;
+        std::unique_lock lock(mutex);
+        while (true) {
+            while (first < tasks.size() && status[first] == done)
+                ++first;
+            if (first == tasks.size())
+                break;
+            if (outOfBudget())
+                for (auto &s : status)
+                    if (s == pending) {
+                        s = done;
+                        ++stats.skipped;
+                    }
+            size_t next = tasks.size();
+            for (size_t i = first; i < std::min(first + window, tasks.size());
+                 ++i)
+                if (status[i] == pending && ready(i)) {
+                    next = i;
+                    break;
+                }
+            if (next == tasks.size()) {
+                cv.wait(lock);
+                continue;
+            }
+            status[next] = running;
+            lock.unlock();
+            tune(tasks[next]);
+            lock.lock();
+            status[next] = done;
+            ++stats.tuned;
+            cv.notify_all();
+        }
+    };
+    vector<std::thread> workers;
+    for (int w = 0; w < threads; ++w)
+        workers.emplace_back(worker, w);
+    for (auto &thread : workers)
+        thread.join();
+    stats.time = msSince(begin);
+    return stats;
+}
+
+} // namespace infini
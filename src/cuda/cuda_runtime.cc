@@ -25,9 +25,9 @@ void CudaRuntimeObj::runWithoutSync(const Graph &graph) const {
     for (auto &op : graph->getOperators()) {
         // HACK: set correct data type
         auto kernelAttrs = KernelAttrs{device, op->getOpType().underlying()};
-        Kernel *kernel = kernelRegistry.getKernel(kernelAttrs);
         auto perfKey = PerfEngine::Key{kernelAttrs, op->getOpPerfKey()};
         auto perfData = perfEngine.getPerfData(perfKey);
+        Kernel *kernel = kernelRegistry.getKernel(kernelAttrs, op, perfData);
         // IT_ASSERT(perfData, "No perf data for OP " + op->toString());
         if (perfData) {
             ComputeFuncPtr funcPtr = kernel->getComputeFunc(perfKey);
@@ -69,12 +69,13 @@ void CudaRuntimeObj::tune(const Graph &graph, bool profiling = false) const {
     for (auto &op : graph->getOperators()) {
         // HACK: set correct data type
         auto kernelAttrs = KernelAttrs{device, op->getOpType().underlying()};
-        Kernel *kernel = kernelRegistry.getKernel(kernelAttrs);
         auto perfKey = PerfEngine::Key{kernelAttrs, op->getOpPerfKey()};
         auto perfData = perfEngine.getPerfData(perfKey);
+        Kernel *kernel = kernelRegistry.getKernel(kernelAttrs, op, perfData);
         PerfRecord record;
         if (!perfData) {
-            record = kernel->tune(op, this);
+            record = kernelRegistry.tune(kernelAttrs, op, this);
+            kernel = kernelRegistry.getKernel(kernelAttrs, op, record);
             perfEngine.setPerfData(perfKey, record);
         } else
             record = perfData;
@@ -1,5 +1,7 @@
 #include "core/data_type.h"
+#include "core/descriptor_cache.h"
 #include "core/graph_handler.h"
+#include "core/perf_engine.h"
 #include "operators/batch_norm.h"
 #include "operators/concat.h"
 #include "operators/conv.h"
@@ -72,6 +74,8 @@ void export_values(py::module &m) {
         .VALUE(ActType, LeakyRelu)
         .VALUE(ActType, Sigmoid)
         .VALUE(ActType, Tanh)
+        .VALUE(ActType, Gelu)
+        .VALUE(ActType, Silu)
         .export_values();
 
     py::class_<OpType>(m, "OpType")
@@ -80,6 +84,12 @@ void export_values(py::module &m) {
     py::enum_<decltype(OpType::type)>(m, "OpTypeId")
         .VALUE(OpType, Conv)
         .VALUE(OpType, MatMul)
+        .VALUE(OpType, QuantizedMatMul)
+        .VALUE(OpType, FusedElementWise)
+        .VALUE(OpType, DequantizeLinear)
+        .VALUE(OpType, QuantizeLinear)
+        .VALUE(OpType, QLinearMatMul)
+        .VALUE(OpType, QLinearConv)
         .VALUE(OpType, ConvTranspose)
         .VALUE(OpType, Pad)
         .VALUE(OpType, Clip)
@@ -347,6 +357,29 @@ static std::tuple<float, float, float, int> lrn_attrs_of(Operator op) {
     return std::make_tuple(alpha, beta, bias, size);
 }
 
+// Hits, misses, evictions and size of DescriptorCache.
+static std::tuple<size_t, size_t, size_t, size_t> descriptor_cache_stats() {
+    auto &cache = DescriptorCache::getInstance();
+    return std::make_tuple(cache.getHits(), cache.getMisses(),
+                           cache.getEvictions(), cache.size());
+}
+
+static void set_descriptor_cache_capacity(size_t capacity) {
+    DescriptorCache::getInstance().setCapacity(capacity);
+}
+
+static size_t load_perf_data(const string &path) {
+    return PerfEngine::getInstance().loadPerfEngineData(path);
+}
+
+static void save_perf_data(const string &path) {
+    PerfEngine::getInstance().savePerfEngineData(path);
+}
+
+static void append_perf_data(const string &path) {
+    PerfEngine::getInstance().appendPerfEngineData(path);
+}
+
 void export_functions(py::module &m) {
 #define FUNCTION(NAME) def(#NAME, &NAME)
     m.def("cpu_runtime", &NativeCpuRuntimeObj::getInstance)
@@ -391,7 +424,12 @@ void export_functions(py::module &m) {
         .FUNCTION(squeeze_axes_of)
         .FUNCTION(unsqueeze_axes_of)
         .FUNCTION(lrn_attrs_of)
-        .FUNCTION(elu_alpha_of);
+        .FUNCTION(elu_alpha_of)
+        .FUNCTION(descriptor_cache_stats)
+        .FUNCTION(set_descriptor_cache_capacity)
+        .FUNCTION(load_perf_data)
+        .FUNCTION(save_perf_data)
+        .FUNCTION(append_perf_data);
 #undef FUNCTION
 }
 
@@ -538,6 +576,9 @@ void init_graph_builder(py::module &m) {
         .def("convTransposed2d", &Handler::convTransposed2d, policy::move)
         .def("matmul", &Handler::matmul, policy::move)
         .def("gemm", &Handler::gemm, policy::move)
+        .def("quantizedMatmul", &Handler::quantizedMatmul, policy::move)
+        .def("quantizeLinear", &Handler::quantizeLinear, policy::move)
+        .def("dequantizeLinear", &Handler::dequantizeLinear, policy::move)
         .def("batchNormalization", &Handler::batchNormalization, policy::move)
         .def("layerNormalization", &Handler::layerNormalization, policy::move)
         .def("instanceNormalization", &Handler::instanceNormalization,
@@ -602,7 +643,24 @@ void init_graph_builder(py::module &m) {
         .def("where", &Handler::where, policy::move)
         .def("lrn", &Handler::lrn, policy::move)
         .def("topo_sort", &Handler::topo_sort, policy::automatic)
-        .def("optimize", &Handler::optimize, policy::automatic)
+        .def("optimize", &Handler::optimize, py::arg("dump") = false,
+             policy::automatic)
+        .def("get_pass_stats", &Handler::get_pass_stats, policy::move)
+        .def("map_weight", &Handler::map_weight, policy::automatic)
+        .def("prefetch_weights", &Handler::prefetch_weights, policy::automatic)
+        .def("save_compiled", &Handler::save_compiled, policy::automatic)
+        .def("load_compiled", &Handler::load_compiled, policy::move)
+        .def("specialize", &Handler::specialize, policy::automatic)
+        .def("bind_symbols", &Handler::bind_symbols, policy::automatic)
+        .def("symbolic_shape", &Handler::symbolic_shape, policy::move)
+        .def("set_buckets", &Handler::set_buckets, py::arg("values"),
+             py::arg("tune") = false, policy::automatic)
+        .def("bind_bucket", &Handler::bind_bucket, policy::automatic)
+        .def("get_bucket_stats", &Handler::get_bucket_stats, policy::move)
+        .def("get_bucket_misses", &Handler::get_bucket_misses,
+             policy::automatic)
+        .def("reset_bucket_stats", &Handler::reset_bucket_stats,
+             policy::automatic)
         .def("operators", &Handler::operators, policy::move)
         .def("data_malloc", &Handler::data_malloc,
              py::arg("useNaiveAllocator") = false, py::arg("memPoolSize") = 0,
@@ -610,7 +668,12 @@ void init_graph_builder(py::module &m) {
         .def("clone_KV", &Handler::clone_KV, policy::move)
         .def("free_heap", &Handler::free_heap, policy::move)
         .def("get_perf_time", &Handler::get_perf_time, policy::automatic)
-        .def("tune", &Handler::tune, policy::automatic)
+        .def("tune", &Handler::tune, py::arg("budget") = 0,
+             py::arg("threads") = 1, policy::automatic)
+        .def("calibrate", &Handler::calibrate, policy::automatic)
+        .def("get_calibration", &Handler::get_calibration, policy::move)
+        .def("clear_calibration", &Handler::clear_calibration,
+             policy::automatic)
         .def("run", &Handler::run, policy::automatic)
 #ifdef USE_CUDA
         .def("run_with_cudagraph", &Handler::run_with_cudagraph,
@@ -0,0 +1,58 @@
+#include "operators/batch_norm.h"
+#include "core/kernel.h"
+
+namespace infini {
+
+class NaiveBatchNorm : public CpuKernelWithoutConfig {
+    template <typename T>
+    void doCompute(const Operator &_op, const RuntimeObj *context) const {
+        using CT = typename ComputeType<T>::t;
+        auto op = as<BatchNormObj>(_op);
+        IT_ASSERT(!op->getTrainingMode(), "Only inference is supported.");
+        T *input = op->getInputs(0)->getRawDataPtr<T *>();
+        T *mean = op->getInputs(1)->getRawDataPtr<T *>();
+        T *var = op->getInputs(2)->getRawDataPtr<T *>();
+        T *scale = op->getInputs(3)->getRawDataPtr<T *>();
+        T *bias = op->getInputs(4)->getRawDataPtr<T *>();
+        T *output = op->getOutput()->getRawDataPtr<T *>();
+
+        auto dims = op->getInputs(0)->getDims();
+        IT_ASSERT(dims.size() >= 2);
+        size_t N = dims[0], C = dims[1];
+        size_t spatial = op->getInputs(0)->size() / (N * C);
+        CT eps = op->getEps();
+#pragma omp parallel for collapse(2)
+        for (size_t n = 0; n < N; ++n) {
+            for (size_t c = 0; c < C; ++c) {
+                CT a = CT(scale[c]) / std::sqrt(CT(var[c]) + eps);
+                CT b = CT(bias[c]) - CT(mean[c]) * a;
+                size_t offset = (n * C + c) * spatial;
+                for (size_t i = 0; i < spatial; ++i)
+                    output[offset + i] =
+                        static_cast<T>(CT(input[offset + i]) * a + b);
+            }
+        }
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        switch (_op->getDType().getIndex()) {
+        case 1: // DataType::Float32
+            doCompute<float>(_op, context);
+            break;
+        case 10: // DataType::Float16
+            doCompute<fp16_t>(_op, context);
+            break;
+        case 16: // DataType::BFloat16
+            doCompute<bfp16_t>(_op, context);
+            break;
+        default:
+            IT_TODO_HALT();
+        }
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::BatchNormalization, NaiveBatchNorm,
+                "BatchNormNaive_CPU");
+
+} // namespace infini
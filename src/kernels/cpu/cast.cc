@@ -0,0 +1,66 @@
+#include "core/kernel.h"
+#include "operators/unary.h"
+
+namespace infini {
+
+class NaiveCast : public CpuKernelWithoutConfig {
+    // Elements converted by one task; large tensors are split across threads.
+    static constexpr size_t chunk = 1 << 16;
+
+    template <typename S, typename D>
+    void doCompute(const Operator &_op, const RuntimeObj *context) const {
+        auto op = as<CastObj>(_op);
+        S *inptr = op->getInputs(0)->getRawDataPtr<S *>();
+        D *outptr = op->getOutput()->getRawDataPtr<D *>();
+        const size_t n = op->getOutput()->size();
+        const size_t tasks = (n + chunk - 1) / chunk;
+#pragma omp parallel for if (tasks > 1)
+        for (size_t t = 0; t < tasks; ++t) {
+            size_t begin = t * chunk, len = std::min(chunk, n - begin);
+            castData(inptr + begin, outptr + begin, len);
+        }
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+#define CASE(TYPE, S, D)                                                       \
+    case CastType::TYPE:                                                       \
+        doCompute<S, D>(_op, context);                                         \
+        break
+
+        switch (as<CastObj>(_op)->getType()) {
+            CASE(Float2Float16, float, fp16_t);
+            CASE(Float2Int64, float, int64_t);
+            CASE(Float2Int32, float, int32_t);
+            CASE(Float2Int16, float, int16_t);
+            CASE(Float2Int8, float, int8_t);
+            CASE(Float2BFloat16, float, bfp16_t);
+            CASE(Int322Float, int32_t, float);
+            CASE(Int322Int8, int32_t, int8_t);
+            CASE(Int322Int16, int32_t, int16_t);
+            CASE(Int322Int64, int32_t, int64_t);
+            CASE(Int162Float, int16_t, float);
+            CASE(Int162Int32, int16_t, int32_t);
+            CASE(Int82Float, int8_t, float);
+            CASE(Int82Int16, int8_t, int16_t);
+            CASE(Int82Int32, int8_t, int32_t);
+            CASE(Uint82Float, uint8_t, float);
+            CASE(Uint82Int32, uint8_t, int32_t);
+            CASE(Uint82Int64, uint8_t, int64_t);
+            CASE(Int642Int32, int64_t, int32_t);
+            CASE(Int642Uint32, int64_t, uint32_t);
+            CASE(Int642Float, int64_t, float);
+            CASE(Uint322Int64, uint32_t, int64_t);
+            CASE(Float162Float, fp16_t, float);
+            CASE(BFloat162Float, bfp16_t, float);
+            CASE(Float2Float, float, float);
+        default:
+            IT_TODO_HALT();
+        }
+#undef CASE
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::Cast, NaiveCast, "CastNaive_CPU");
+
+} // namespace infini
@@ -10,10 +10,13 @@ class NaiveConcat : public CpuKernelWithoutConfig {
         auto inputs = op->getInputs(), outputs = op->getOutputs();
         auto dim = op->getDim();
         auto output = outputs[0];
+        // All tensors share the layout; concatenate along the axis in memory.
+        if (output->getLayout() == TensorLayout::NHWC)
+            dim = vector<int>{0, 3, 1, 2}[dim];
         std::vector<Shape> iDims;
         for (auto input : inputs)
-            iDims.emplace_back(input->getDims());
-        const auto &outDim = output->getDims();
+            iDims.emplace_back(input->getPhysicalDims());
+        const auto outDim = output->getPhysicalDims();
         size_t blockOffsetInner = 1;
         for (size_t i = outDim.size() - 1; i > (size_t)dim; --i)
             blockOffsetInner *= outDim[i];
@@ -1,15 +1,90 @@
 #include "operators/conv.h"
 #include "core/kernel.h"
+#include "utils/operator_utils.h"
 
 namespace infini {
 
 class NaiveConv : public CpuKernelWithoutConfig {
+    // Memory strides of the N, C, H and W axes.
+    static std::array<size_t, 4> stridesOf(const Tensor &t) {
+        auto d = t->getDims();
+        size_t c = d[1], h = d[2], w = d[3];
+        if (t->getLayout() == TensorLayout::NHWC)
+            return {h * w * c, 1, w * c, c};
+        return {c * h * w, h * w, w, 1};
+    }
+
+    // With an NHWC input the channels of a pixel are contiguous: the
+    // weights are repacked to [R, S, C, F] and every input value updates a
+    // contiguous vector of output channels.
+    template <typename T>
+    void computeNHWC(const Ref<ConvObj> &op, const T *iptr, const T *wptr,
+                     const T *bptr, T *optr) const {
+        int n, c, h, w, f, r, s;
+        std::tie(n, c, h, w, f, r, s) = op->getNCHWFRS();
+        int ph, pw, sh, sw, dh, dw;
+        std::tie(ph, pw, sh, sw, dh, dw) = op->getPadStrideDilation();
+        auto outDim = op->getOutput()->getDims();
+        int oh = outDim[2], ow = outDim[3];
+        auto si = stridesOf(op->getInputs(0));
+        auto so = stridesOf(op->getOutput());
+        ActType act = op->getAct();
+        std::vector<T> wt(size_t(r) * s * c * f);
+#pragma omp parallel for collapse(2)
+        for (int ff = 0; ff < f; ff++)
+            for (int cc = 0; cc < c; cc++)
+                for (int rr = 0; rr < r; rr++)
+                    for (int ss = 0; ss < s; ss++)
+                        wt[((size_t(rr) * s + ss) * c + cc) * f + ff] =
+                            wptr[((size_t(ff) * c + cc) * r + rr) * s + ss];
+#pragma omp parallel
+        {
+            std::vector<T> acc(f);
+#pragma omp for collapse(3)
+            for (int nn = 0; nn < n; nn++)
+                for (int hh = 0; hh < oh; hh++)
+                    for (int ww = 0; ww < ow; ww++) {
+                        for (int ff = 0; ff < f; ff++)
+                            acc[ff] = bptr ? bptr[ff] : T(0);
+                        for (int rr = 0; rr < r; rr++) {
+                            int posH = hh * sh + rr * dh - ph;
+                            if (posH < 0 || posH >= h)
+                                continue;
+                            for (int ss = 0; ss < s; ss++) {
+                                int posW = ww * sw + ss * dw - pw;
+                                if (posW < 0 || posW >= w)
+                                    continue;
+                                const T *ip = iptr + nn * si[0] +
+                                              posH * si[2] + posW * si[3];
+                                const T *wp =
+                                    wt.data() + (size_t(rr) * s + ss) * c * f;
+                                for (int cc = 0; cc < c; cc++) {
+                                    T x = ip[cc];
+                                    const T *wrow = wp + size_t(cc) * f;
+#pragma omp simd
+                                    for (int ff = 0; ff < f; ff++)
+                                        acc[ff] += x * wrow[ff];
+                                }
+                            }
+                        }
+                        applyActivation(act, acc.data(), f);
+                        T *o = optr + nn * so[0] + hh * so[2] + ww * so[3];
+                        for (int ff = 0; ff < f; ff++)
+                            o[ff * so[1]] = acc[ff];
+                    }
+        }
+    }
+
     template <typename T>
     void doCompute(const Operator &_op, const RuntimeObj *context) const {
         auto op = as<ConvObj>(_op);
         T *iptr = op->getInputs(0)->getRawDataPtr<T *>();
         T *wptr = op->getInputs(1)->getRawDataPtr<T *>();
         T *optr = op->getOutput()->getRawDataPtr<T *>();
+        // Epilogue: a per-channel bias and an activation.
+        T *bptr = op->numInputs() > 2 ? op->getBias()->getRawDataPtr<T *>()
+                                      : nullptr;
+        ActType act = op->getAct();
         //  Clang will give an error of " reference to local binding 'sh'
         //  declared in enclosing function" if we write like this:
         //        auto [n, c, h, w, f, r, s] = op->getNCHWFRS();
@@ -22,13 +97,22 @@ class NaiveConv : public CpuKernelWithoutConfig {
         IT_ASSERT(f % g == 0, "Illegal number of channel");
         auto outDim = op->getOutput()->getDims();
         int oh = outDim[2], ow = outDim[3];
+        if (bptr)
+            IT_ASSERT(op->getBias()->size() == size_t(f));
+        if (g == 1 && op->getInputs(0)->getLayout() == TensorLayout::NHWC) {
+            computeNHWC(op, iptr, wptr, bptr, optr);
+            return;
+        }
+        auto si = stridesOf(op->getInputs(0));
+        auto so = stridesOf(op->getOutput());
+        bool rowMajor = op->getOutput()->getLayout() == TensorLayout::NCHW;
         for (int nn = 0; nn < n; nn++) {
 #pragma omp parallel for
             for (int ff = 0; ff < f; ff++) {
-                for (int hh = 0; hh < oh; hh++)
+                for (int hh = 0; hh < oh; hh++) {
                     for (int ww = 0; ww < ow; ww++) {
                         int gidx = ff / (f / g);
-                        T val = 0;
+                        T val = bptr ? bptr[ff] : T(0);
                         for (int cc = 0; cc < cpg; cc++)
                             for (int rr = 0; rr < r; rr++)
                                 for (int ss = 0; ss < s; ss++) {
@@ -37,16 +121,24 @@ class NaiveConv : public CpuKernelWithoutConfig {
                                 int posW = ww * sw + ss * dw - pw;
                                 if (posH < 0 || posH >= h || posW < 0 || posW >= w)
                                     continue;
-                                auto iOffset = posW + w * (posH + h * ((cc + gidx * cpg) + c * nn)),
-                                    wOffset = ss + s * (rr + r * (cc + cpg * ff));
+                                size_t iOffset = nn * si[0] + (cc + gidx * cpg) * si[1] +
+                                                 posH * si[2] + posW * si[3];
+                                auto wOffset = ss + s * (rr + r * (cc + cpg * ff));
                                 auto inputVal = iptr[iOffset], weightVal = wptr[wOffset];
                                 val += weightVal * inputVal;
                                     // clang-format on
                                 }
-                        // TODO: check correctness, oh & ow or h & w?
-                        auto oOffset = ww + ow * (hh + oh * (ff + f * nn));
+                        if (!rowMajor)
+                            applyActivation(act, &val, 1);
+                        auto oOffset =
+                            nn * so[0] + ff * so[1] + hh * so[2] + ww * so[3];
                         optr[oOffset] = val;
                     }
+                    if (rowMajor)
+                        applyActivation(act,
+                                        optr + ow * (hh + oh * (ff + f * nn)),
+                                        ow);
+                }
             }
         }
     }
@@ -69,6 +161,6 @@ class NaiveConv : public CpuKernelWithoutConfig {
     }
 };
 
-// REGISTER_KERNEL(Device::CPU, OpType::Conv, NaiveConv, "ConvNaive_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Conv, NaiveConv, "ConvNaive_CPU");
 
 } // namespace infini
@@ -3,42 +3,121 @@
 #include "utils/operator_utils.h"
 
 namespace infini {
-class NativeElementWise : public CpuKernelWithoutConfig {
-    template <typename T> static T addCompute(T val0, T val1) {
+
+namespace {
+struct AddOp {
+    template <typename T> T operator()(T val0, T val1) const {
         return val0 + val1;
     }
+};
 
-    template <typename T> static T subCompute(T val0, T val1) {
+struct SubOp {
+    template <typename T> T operator()(T val0, T val1) const {
         return val0 - val1;
     }
+};
 
-    template <typename T> static T mulCompute(T val0, T val1) {
+struct MulOp {
+    template <typename T> T operator()(T val0, T val1) const {
         return val0 * val1;
     }
+};
 
-    template <typename T> static T divCompute(T val0, T val1) {
+struct DivOp {
+    template <typename T> T operator()(T val0, T val1) const {
         return (T)(val0 / val1);
     }
+};
 
-    template <typename T> static T equalCompute(T val0, T val1) {
+struct EqualOp {
+    template <typename T> T operator()(T val0, T val1) const {
         return (T)(val0 == val1);
     }
+};
 
-    template <typename T> static T greaterOrEqualCompute(T val0, T val1) {
+struct GreaterOrEqualOp {
+    template <typename T> T operator()(T val0, T val1) const {
         return (T)(val0 >= val1);
     }
+};
 
-    template <typename T> static T greaterCompute(T val0, T val1) {
+struct GreaterOp {
+    template <typename T> T operator()(T val0, T val1) const {
         return (T)(val0 > val1);
     }
+};
 
-    template <typename T> static T lessOrEqualCompute(T val0, T val1) {
+struct LessOrEqualOp {
+    template <typename T> T operator()(T val0, T val1) const {
         return (T)(val0 <= val1);
     }
+};
 
-    template <typename T> static T lessCompute(T val0, T val1) {
+struct LessOp {
+    template <typename T> T operator()(T val0, T val1) const {
         return (T)(val0 < val1);
     }
+};
+} // namespace
+
+// One instantiation per (Op, dtype, broadcast pattern): the functor is
+// inlined into the inner loop, which the compiler can then vectorize.
+template <typename Op> class NativeElementWise : public CpuKernelWithoutConfig {
+    // Elements of a row processed per parallel task.
+    static constexpr size_t chunk = 1 << 14;
+    // Half-precision rows are widened to fp32 in blocks of this size.
+    static constexpr size_t block = 256;
+
+    // Inner loop over `len` elements. StepA/StepB are 0 when the input is
+    // broadcast along the row and 1 when it is contiguous.
+    template <typename T, int StepA, int StepB>
+    static void row(const T *a, const T *b, T *c, size_t len) {
+        using CT = typename ComputeType<T>::t;
+        if constexpr (std::is_same_v<CT, T>) {
+#pragma omp simd
+            for (size_t i = 0; i < len; ++i)
+                c[i] = Op()(a[i * StepA], b[i * StepB]);
+        } else {
+            CT bufA[block], bufB[block], bufC[block];
+            for (size_t i = 0; i < len; i += block) {
+                size_t m = std::min(block, len - i);
+                loadAsFloat(a + i * StepA, bufA, StepA ? m : 1);
+                loadAsFloat(b + i * StepB, bufB, StepB ? m : 1);
+#pragma omp simd
+                for (size_t j = 0; j < m; ++j)
+                    bufC[j] = Op()(bufA[j * StepA], bufB[j * StepB]);
+                storeFromFloat(bufC, c + i, m);
+            }
+        }
+    }
+
+    template <typename T, int StepA, int StepB>
+    static void run(const T *a, const T *b, T *c, size_t outer, size_t len,
+                    const Shape &outerShape, const Shape &strideA,
+                    const Shape &strideB) {
+        if (outer == 1) {
+            size_t tasks = (len + chunk - 1) / chunk;
+#pragma omp parallel for if (tasks > 1)
+            for (size_t t = 0; t < tasks; ++t) {
+                size_t begin = t * chunk;
+                row<T, StepA, StepB>(a + begin * StepA, b + begin * StepB,
+                                     c + begin, std::min(chunk, len - begin));
+            }
+            return;
+        }
+        int rank = outerShape.size();
+#pragma omp parallel for if (outer * len > chunk)
+        for (size_t r = 0; r < outer; ++r) {
+            size_t offA = 0, offB = 0, rem = r;
+            for (int d = rank - 1; d >= 0; --d) {
+                size_t idx = rem % outerShape[d];
+                rem /= outerShape[d];
+                offA += idx * strideA[d];
+                offB += idx * strideB[d];
+            }
+            row<T, StepA, StepB>(a + offA, b + offB, c + r * len, len);
+        }
+    }
 
     template <typename T>
     void doCompute(const Operator &_op, const RuntimeObj *context) const {
@@ -57,58 +136,44 @@ class NativeElementWise : public CpuKernelWithoutConfig {
                   a.begin() + (rank - shapeA.size()));
         std::copy(shapeB.begin(), shapeB.end(),
                   b.begin() + (rank - shapeB.size()));
-        auto getStride = [&](const Shape &shape) {
-            int p = 1;
-            Shape stride(rank);
-            for (auto i = rank; i > 0; --i) {
-                stride[i - 1] = p;
-                p = p * shape[i - 1];
+
+        // Fold the trailing dimensions that share one broadcast pattern
+        // into a single row; the leading dimensions index the rows.
+        size_t len = 1;
+        int stepA = 1, stepB = 1, split = rank;
+        bool patternSet = false;
+        for (; split > 0; --split) {
+            int d = split - 1;
+            if (shapeC[d] == 1)
+                continue;
+            int sa = a[d] != 1, sb = b[d] != 1;
+            if (!patternSet) {
+                stepA = sa, stepB = sb, patternSet = true;
+            } else if (sa != stepA || sb != stepB) {
+                break;
             }
-            return stride;
-        };
-        Shape strideA = getStride(a);
-        Shape strideB = getStride(b);
-
-        auto n = op->getOutput()->size();
-        T (*_doCompute)(T val0, T val1);
-        switch (op->getOpType().underlying()) {
-        case OpType::Add:
-            _doCompute = addCompute<T>;
-            break;
-        case OpType::Sub:
-            _doCompute = subCompute<T>;
-            break;
-        case OpType::Mul:
-            _doCompute = mulCompute<T>;
-            break;
-        case OpType::Div:
-            _doCompute = divCompute<T>;
-            break;
-        case OpType::Equal:
-            _doCompute = equalCompute<T>;
-            break;
-        case OpType::GreaterOrEqual:
-            _doCompute = greaterOrEqualCompute<T>;
-            break;
-        case OpType::Greater:
-            _doCompute = greaterCompute<T>;
-            break;
-        case OpType::LessOrEqual:
-            _doCompute = lessOrEqualCompute<T>;
-            break;
-        case OpType::Less:
-            _doCompute = lessCompute<T>;
-            break;
-        default:
-            IT_TODO_HALT();
+            len *= shapeC[d];
         }
-
-        for (size_t i = 0; i < n; ++i) {
-            auto shapeIndexC = locate_index(i, shapeC);
-            auto indexA = delocate_index(shapeIndexC, a, strideA);
-            auto indexB = delocate_index(shapeIndexC, b, strideB);
-            outptr[i] = _doCompute(inptr0[indexA], inptr1[indexB]);
+        Shape outerShape(shapeC.begin(), shapeC.begin() + split);
+        Shape strideA(split), strideB(split);
+        size_t pa = stepA ? len : 1, pb = stepB ? len : 1, outer = 1;
+        for (int d = split - 1; d >= 0; --d) {
+            strideA[d] = a[d] == 1 ? 0 : pa;
+            strideB[d] = b[d] == 1 ? 0 : pb;
+            pa *= a[d], pb *= b[d], outer *= shapeC[d];
         }
+
+#define RUN(SA, SB)                                                            \
+    run<T, SA, SB>(inptr0, inptr1, outptr, outer, len, outerShape, strideA,    \
+                   strideB)
+        // Both steps are 0 only for a single-element output.
+        if (stepA == stepB)
+            RUN(1, 1);
+        else if (stepA)
+            RUN(1, 0);
+        else
+            RUN(0, 1);
+#undef RUN
     }
 
     void compute(const Operator &_op,
@@ -121,26 +186,56 @@ class NativeElementWise : public CpuKernelWithoutConfig {
         switch (dataTypeIdx) {
             CASE(1); // DataType::Float32
             break;
+            CASE(2); // DataType::UInt8
+            break;
+            CASE(3); // DataType::Int8
+            break;
+            CASE(4); // DataType::UInt16
+            break;
+            CASE(5); // DataType::Int16
+            break;
+            CASE(6); // DataType::Int32
+            break;
+            CASE(7); // DataType::Int64
+            break;
+            CASE(9); // DataType::Bool
+            break;
+            CASE(11); // DataType::Double
+            break;
             CASE(12); // DataType::UInt32
             break;
+            CASE(13); // DataType::UInt64
+            break;
+        case 10: // DataType::Float16
+            doCompute<fp16_t>(_op, context);
+            break;
+        case 16: // DataType::BFloat16
+            doCompute<bfp16_t>(_op, context);
+            break;
         default:
             IT_TODO_HALT();
         }
+#undef CASE
     }
 };
 
-// REGISTER_KERNEL(Device::CPU, OpType::Add, NativeElementWise, "addNaive_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::Sub, NativeElementWise, "subNaive_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::Mul, NativeElementWise, "mulNaive_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::Div, NativeElementWise, "divNaive_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::Equal, NativeElementWise,
+REGISTER_KERNEL_CANDIDATE(Device::CPU, OpType::Add, NativeElementWise<AddOp>,
+                          "addNaive_CPU", nativeKernelPriority,
+                          KernelConstraints());
+REGISTER_KERNEL(Device::CPU, OpType::Sub, NativeElementWise<SubOp>,
+                "subNaive_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Mul, NativeElementWise<MulOp>,
+                "mulNaive_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Div, NativeElementWise<DivOp>,
+                "divNaive_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Equal, NativeElementWise<EqualOp>,
                 "equalNaive_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::GreaterOrEqual, NativeElementWise,
-                "greaterEqualNaive_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::Greater, NativeElementWise,
+REGISTER_KERNEL(Device::CPU, OpType::GreaterOrEqual,
+                NativeElementWise<GreaterOrEqualOp>, "greaterEqualNaive_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Greater, NativeElementWise<GreaterOp>,
                 "greaterThanNaive_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::LessOrEqual, NativeElementWise,
-                "lessEqualNaive_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::Less, NativeElementWise,
+REGISTER_KERNEL(Device::CPU, OpType::LessOrEqual,
+                NativeElementWise<LessOrEqualOp>, "lessEqualNaive_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Less, NativeElementWise<LessOp>,
                 "lessEqualNaive_CPU");
 }; // namespace infini
@@ -0,0 +1,171 @@
+#include "operators/fused_element_wise.h"
+#include "core/kernel.h"
+
+namespace infini {
+
+// Interprets the instruction list of a FusedElementWiseObj. The output is
+// processed in blocks; every instruction runs over a whole block, so the
+// dispatch is paid once per block and the inner loops vectorize. Registers
+// are fp32 blocks that stay in cache, and intermediate results are never
+// written to memory.
+class NativeFusedElementWise : public CpuKernelWithoutConfig {
+    using Instr = FusedElementWiseObj::Instr;
+    // Elements per block, i.e. per register.
+    static constexpr size_t block = 256;
+
+    static void exec(const Instr &instr, const float *a, const float *b,
+                     float *c, size_t m) {
+#define BINARY(TYPE, EXPR)                                                     \
+    case OpType::TYPE:                                                         \
+        _Pragma("omp simd") for (size_t i = 0; i < m; ++i) c[i] = EXPR;        \
+        break
+#define UNARY(TYPE, EXPR) BINARY(TYPE, EXPR)
+
+        switch (instr.type.underlying()) {
+            BINARY(Add, a[i] + b[i]);
+            BINARY(Sub, a[i] - b[i]);
+            BINARY(Mul, a[i] * b[i]);
+            BINARY(Div, a[i] / b[i]);
+            UNARY(Relu, std::max(0.f, a[i]));
+            UNARY(Sigmoid, 1.f / (1.f + std::exp(-a[i])));
+            UNARY(Tanh, std::tanh(a[i]));
+            UNARY(Gelu,
+                  a[i] * (1.f + std::erf(a[i] * float(M_SQRT1_2))) / 2.f);
+            UNARY(Silu, a[i] / (1.f + std::exp(-a[i])));
+            UNARY(HardSigmoid,
+                  std::max(0.f, std::min(1.f, 0.2f * a[i] + 0.5f)));
+            UNARY(HardSwish,
+                  a[i] * std::max(0.f, std::min(1.f, a[i] / 6.f + 0.5f)));
+            UNARY(Abs, std::abs(a[i]));
+            UNARY(Neg, -a[i]);
+            UNARY(Sqrt, std::sqrt(a[i]));
+            UNARY(Exp, std::exp(a[i]));
+            UNARY(Erf, std::erf(a[i]));
+        default:
+            IT_TODO_HALT();
+        }
+#undef UNARY
+#undef BINARY
+    }
+
+    template <typename T>
+    void doCompute(const Operator &_op, const RuntimeObj *context) const {
+        auto op = as<FusedElementWiseObj>(_op);
+        const auto &program = op->getProgram();
+        int nInputs = op->numInputs(), nRegs = nInputs + program.size();
+        auto shapeC = op->getOutput()->getDims();
+        int rank = shapeC.size();
+        T *outptr = op->getOutput()->getRawDataPtr<T *>();
+        vector<const T *> inptrs(nInputs);
+        vector<Shape> shapes(nInputs, Shape(rank, 1));
+        for (int i = 0; i < nInputs; ++i) {
+            auto input = op->getInputs(i);
+            inptrs[i] = input->getRawDataPtr<T *>();
+            auto dims = input->getDims();
+            std::copy(dims.begin(), dims.end(),
+                      shapes[i].begin() + (rank - dims.size()));
+        }
+
+        // Fold the trailing dimensions in which every input is either
+        // contiguous or broadcast into one row, as in the binary kernel.
+        size_t len = 1;
+        vector<int> steps(nInputs, 1);
+        int split = rank;
+        bool patternSet = false;
+        for (; split > 0; --split) {
+            int d = split - 1;
+            if (shapeC[d] == 1)
+                continue;
+            bool same = true;
+            for (int i = 0; i < nInputs; ++i)
+                same &= !patternSet || int(shapes[i][d] != 1) == steps[i];
+            if (!same)
+                break;
+            for (int i = 0; i < nInputs; ++i)
+                steps[i] = shapes[i][d] != 1;
+            patternSet = true;
+            len *= shapeC[d];
+        }
+        vector<Shape> strides(nInputs, Shape(split));
+        size_t outer = 1;
+        for (int i = 0; i < nInputs; ++i) {
+            size_t p = steps[i] ? len : 1;
+            for (int d = split - 1; d >= 0; --d) {
+                strides[i][d] = shapes[i][d] == 1 ? 0 : p;
+                p *= shapes[i][d];
+            }
+        }
+        for (int d = 0; d < split; ++d)
+            outer *= shapeC[d];
+
+        size_t blocksPerRow = (len + block - 1) / block;
+        size_t tasks = outer * blocksPerRow;
+#pragma omp parallel if (outer * len > (1 << 14))
+        {
+            vector<float> buf(nRegs * block);
+            vector<const float *> regs(nRegs);
+#pragma omp for
+            for (size_t t = 0; t < tasks; ++t) {
+                size_t r = t / blocksPerRow, begin = t % blocksPerRow * block;
+                size_t m = std::min(block, len - begin);
+                for (int i = 0; i < nInputs; ++i) {
+                    size_t off = 0, rem = r;
+                    for (int d = split - 1; d >= 0; --d) {
+                        off += rem % shapeC[d] * strides[i][d];
+                        rem /= shapeC[d];
+                    }
+                    const T *src = inptrs[i] + off + begin * steps[i];
+                    float *dst = buf.data() + i * block;
+                    if (!steps[i]) {
+                        float v;
+                        loadAsFloat(src, &v, 1);
+                        std::fill_n(dst, m, v);
+                    } else if constexpr (std::is_same_v<T, float>) {
+                        // Read contiguous fp32 inputs in place.
+                        regs[i] = src;
+                        continue;
+                    } else {
+                        loadAsFloat(src, dst, m);
+                    }
+                    regs[i] = dst;
+                }
+                T *out = outptr + r * len + begin;
+                for (size_t k = 0; k < program.size(); ++k) {
+                    int reg = nInputs + k;
+                    float *dst = buf.data() + reg * block;
+                    if constexpr (std::is_same_v<T, float>)
+                        if (k + 1 == program.size())
+                            dst = out;
+                    auto &instr = program[k];
+                    exec(instr, regs[instr.a],
+                         instr.b >= 0 ? regs[instr.b] : nullptr, dst, m);
+                    regs[reg] = dst;
+                }
+                if constexpr (!std::is_same_v<T, float>)
+                    storeFromFloat(regs[nRegs - 1], out, m);
+            }
+        }
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        int dataTypeIdx = _op->getDType().getIndex();
+        switch (dataTypeIdx) {
+        case 1: // DataType::Float32
+            doCompute<float>(_op, context);
+            break;
+        case 10: // DataType::Float16
+            doCompute<fp16_t>(_op, context);
+            break;
+        case 16: // DataType::BFloat16
+            doCompute<bfp16_t>(_op, context);
+            break;
+        default:
+            IT_TODO_HALT();
+        }
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::FusedElementWise, NativeFusedElementWise,
+                "FusedElementWise_CPU");
+}; // namespace infini
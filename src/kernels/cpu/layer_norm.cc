@@ -0,0 +1,66 @@
+#include "operators/layer_norm.h"
+#include "core/kernel.h"
+
+namespace infini {
+
+class NaiveLayerNorm : public CpuKernelWithoutConfig {
+    template <typename T>
+    void doCompute(const Operator &_op, const RuntimeObj *context) const {
+        using CT = typename ComputeType<T>::t;
+        auto op = as<LayerNormObj>(_op);
+        T *input = op->getInputs(0)->getRawDataPtr<T *>();
+        T *scale = op->getInputs(1)->getRawDataPtr<T *>();
+        T *bias = op->getBias() ? op->getBias()->getRawDataPtr<T *>() : nullptr;
+        T *output = op->getOutput()->getRawDataPtr<T *>();
+
+        // Normalize over all dimensions starting at `axis`.
+        auto dims = op->getInputs(0)->getDims();
+        size_t inner = 1;
+        for (size_t i = op->getAxis(); i < dims.size(); ++i)
+            inner *= dims[i];
+        size_t outer = op->getInputs(0)->size() / inner;
+        size_t scaleSize = op->getInputs(1)->size();
+        size_t biasSize = bias ? op->getBias()->size() : 0;
+        CT eps = op->getEps();
+#pragma omp parallel for
+        for (size_t o = 0; o < outer; ++o) {
+            const T *x = input + o * inner;
+            T *y = output + o * inner;
+            CT mean = 0, var = 0;
+            for (size_t i = 0; i < inner; ++i)
+                mean += CT(x[i]);
+            mean /= inner;
+            for (size_t i = 0; i < inner; ++i)
+                var += (CT(x[i]) - mean) * (CT(x[i]) - mean);
+            CT rstd = 1 / std::sqrt(var / inner + eps);
+            for (size_t i = 0; i < inner; ++i) {
+                CT v = (CT(x[i]) - mean) * rstd * CT(scale[i % scaleSize]);
+                if (bias)
+                    v += CT(bias[i % biasSize]);
+                y[i] = static_cast<T>(v);
+            }
+        }
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        switch (_op->getDType().getIndex()) {
+        case 1: // DataType::Float32
+            doCompute<float>(_op, context);
+            break;
+        case 10: // DataType::Float16
+            doCompute<fp16_t>(_op, context);
+            break;
+        case 16: // DataType::BFloat16
+            doCompute<bfp16_t>(_op, context);
+            break;
+        default:
+            IT_TODO_HALT();
+        }
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::LayerNormalization, NaiveLayerNorm,
+                "LayerNormNaive_CPU");
+
+} // namespace infini
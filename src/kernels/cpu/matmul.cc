@@ -1,29 +1,148 @@
 #include "operators/matmul.h"
 #include "core/kernel.h"
+#include "utils/operator_utils.h"
 
 namespace infini {
 
 class NaiveMatmul : public CpuKernelWithoutConfig {
     template <typename T>
     void doCompute(const Operator &_op, const RuntimeObj *context) const {
+        using CT = typename ComputeType<T>::t;
         auto op = as<MatmulObj>(_op);
-        IT_ASSERT(op->getInputs().size() == 2, "Bias is not supported yet.");
         T *A = op->getInputs(0)->getRawDataPtr<T *>();
         T *B = op->getInputs(1)->getRawDataPtr<T *>();
-        T *C = op->getOutput()->getRawDataPtr<T *>();
-        IT_ASSERT(op->getTransA() == false && op->getTransB() == false);
-        IT_ASSERT(op->getAct() == ActType::None);
-        const int M = op->getM(), N = op->getN(), K = op->getK();
-        for (int i = 0; i < M; i++) {
-            for (int j = 0; j < N; j++) {
-                C[i * N + j] = 0;
-                for (int k = 0; k < K; k++) {
-                    C[i * N + j] += A[i * K + k] * B[k * N + j];
+        // Epilogue: a bias of N elements is shared by every row, otherwise
+        // bias and residual have the shape of C.
+        auto bias = op->getBias(), residual = op->getResidual();
+        T *biasPtr = bias ? bias->getRawDataPtr<T *>() : nullptr;
+        T *resPtr = residual ? residual->getRawDataPtr<T *>() : nullptr;
+        ActType act = op->getAct();
+        const int Batch = op->getB(), M = op->getM(), N = op->getN(),
+                  K = op->getK();
+        // Batch dimensions broadcast independently, so each input's matrix
+        // for an output batch is found through its own broadcast strides.
+        const Shape &outDims = op->getOutput(0)->getDims();
+        const Shape outBatch(outDims.begin(), outDims.end() - 2);
+        const vector<size_t> offA = batchOffsets(
+            outBatch, op->getInputs(0)->getDims(), size_t(M) * K, Batch);
+        const vector<size_t> offB = batchOffsets(
+            outBatch, op->getInputs(1)->getDims(), size_t(K) * N, Batch);
+        const bool rowBias = bias && bias->size() == size_t(N);
+        IT_ASSERT(!bias || rowBias || bias->size() == size_t(Batch) * M * N);
+        // A horizontally fused Matmul stores consecutive column ranges of
+        // each row to its outputs.
+        vector<int> widths = op->getSplitN();
+        if (widths.empty())
+            widths = {N};
+        vector<T *> outs;
+        for (auto &output : op->getOutputs())
+            outs.emplace_back(output->getRawDataPtr<T *>());
+        // A row of A is gathered once (strided when transA). Without transB
+        // the i-k-j order keeps the inner loop contiguous; with transB each
+        // output is a dot product of two contiguous rows. Each output row is
+        // accumulated in CT (fp32 for half types) and stored once.
+        const bool transA = op->getTransA(), transB = op->getTransB();
+#pragma omp parallel
+        {
+            // Per-thread scratch rows, reused across every (batch, row).
+            std::vector<CT> a(K), acc(N), row(std::max(K, N));
+#pragma omp for collapse(2)
+            for (int b = 0; b < Batch; b++) {
+                for (int i = 0; i < M; i++) {
+                    const T *am = A + offA[b];
+                    const T *bm = B + offB[b];
+                    const size_t r = size_t(b) * M + i;
+                    std::fill(acc.begin(), acc.end(), CT(0));
+                    for (int k = 0; k < K; k++)
+                        a[k] = CT(transA ? am[size_t(k) * M + i]
+                                         : am[size_t(i) * K + k]);
+                    if (transB) {
+                        for (int j = 0; j < N; j++) {
+                            const T *brow = bm + size_t(j) * K;
+                            CT sum = 0;
+                            if constexpr (std::is_same_v<CT, T>) {
+#pragma omp simd reduction(+ : sum)
+                                for (int k = 0; k < K; k++)
+                                    sum += a[k] * brow[k];
+                            } else {
+                                loadAsFloat(brow, row.data(), K);
+                                for (int k = 0; k < K; k++)
+                                    sum += a[k] * row[k];
+                            }
+                            acc[j] = sum;
+                        }
+                    } else {
+                        for (int k = 0; k < K; k++) {
+                            CT aik = a[k];
+                            if constexpr (std::is_same_v<CT, T>) {
+                                const T *brow = bm + size_t(k) * N;
+                                for (int j = 0; j < N; j++)
+                                    acc[j] += aik * brow[j];
+                            } else {
+                                loadAsFloat(bm + size_t(k) * N, row.data(), N);
+                                for (int j = 0; j < N; j++)
+                                    acc[j] += aik * row[j];
+                            }
+                        }
+                    }
+                    // Apply the epilogue while the row is still in cache.
+                    size_t offC = r * N;
+                    if (biasPtr)
+                        addRow(acc.data(), biasPtr + (rowBias ? 0 : offC), N,
+                               row.data());
+                    if (resPtr)
+                        addRow(acc.data(), resPtr + offC, N, row.data());
+                    applyActivation(act, acc.data(), N);
+                    for (size_t s = 0, j = 0; s < outs.size(); j += widths[s++])
+                        storeFromFloatOrCopy(acc.data() + j,
+                                             outs[s] + r * widths[s],
+                                             widths[s]);
                 }
             }
         }
     }
 
+    // Element offset of an input's matrix for each output batch. Missing
+    // leading dimensions and dimensions of 1 are broadcast.
+    static vector<size_t> batchOffsets(const Shape &outBatch,
+                                       const Shape &dims, size_t matSize,
+                                       int batch) {
+        const size_t rank = dims.size() - 2;
+        Shape shape(outBatch.size(), 1), stride(outBatch.size());
+        std::copy(dims.begin(), dims.begin() + rank, shape.end() - rank);
+        for (int i = int(shape.size()) - 1, s = 1; i >= 0; --i) {
+            stride[i] = s;
+            s *= shape[i];
+        }
+        vector<size_t> offsets(batch);
+        for (int b = 0; b < batch; ++b)
+            offsets[b] =
+                delocate_index(locate_index(b, outBatch), shape, stride) *
+                matSize;
+        return offsets;
+    }
+
+    template <typename CT, typename T>
+    static void addRow(CT *acc, const T *src, size_t n, CT *scratch) {
+        if constexpr (std::is_same_v<CT, T>) {
+#pragma omp simd
+            for (size_t j = 0; j < n; ++j)
+                acc[j] += src[j];
+        } else {
+            loadAsFloat(src, scratch, n);
+            for (size_t j = 0; j < n; ++j)
+                acc[j] += scratch[j];
+        }
+    }
+
+    template <typename CT, typename T>
+    static void storeFromFloatOrCopy(const CT *src, T *dst, size_t n) {
+        if constexpr (std::is_same_v<CT, T>)
+            std::copy(src, src + n, dst);
+        else
+            storeFromFloat(src, dst, n);
+    }
+
     void compute(const Operator &_op,
                  const RuntimeObj *context) const override {
 #define CASE(N)                                                                \
@@ -36,6 +155,12 @@ class NaiveMatmul : public CpuKernelWithoutConfig {
             break;
             CASE(12); // DataType::UInt32
             break;
+        case 10: // DataType::Float16
+            doCompute<fp16_t>(_op, context);
+            break;
+        case 16: // DataType::BFloat16
+            doCompute<bfp16_t>(_op, context);
+            break;
         default:
             IT_TODO_HALT();
         }
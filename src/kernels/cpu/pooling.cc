@@ -100,8 +100,20 @@ class NativePooling : public CpuKernelWithoutConfig {
     }
 };
 
-// REGISTER_KERNEL(Device::CPU, OpType::MaxPool, NativePooling,
-//                 "maxPoolNaive_CPU");
-// REGISTER_KERNEL(Device::CPU, OpType::AveragePool, NativePooling,
-//                 "avgPoolNaive_CPU");
+static KernelConstraints nativePooling() {
+    return {{DataType::Float32, DataType::UInt32},
+            {TensorLayout::NCHW},
+            [](const Operator &op) {
+                auto [ph, pw, sh, sw, dh, dw] =
+                    as<PoolingObj>(op)->getPadStrideDilation();
+                return dh == 1 && dw == 1;
+            }};
+}
+
+REGISTER_KERNEL_CANDIDATE(Device::CPU, OpType::MaxPool, NativePooling,
+                          "maxPoolNaive_CPU", nativeKernelPriority,
+                          nativePooling());
+REGISTER_KERNEL_CANDIDATE(Device::CPU, OpType::AveragePool, NativePooling,
+                          "avgPoolNaive_CPU", nativeKernelPriority,
+                          nativePooling());
 } // namespace infini
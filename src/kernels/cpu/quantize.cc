@@ -0,0 +1,502 @@
+#include "operators/quantize.h"
+#include "core/kernel.h"
+#include <cmath>
+#include <limits>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define INFINI_X86 1
+#endif
+
+namespace infini {
+
+// Maps an element offset of a Quantize/DequantizeLinear input to the index
+// of its scale and zero point.
+struct QuantParamIndex {
+    bool perTensor;
+    size_t blockSize, inner = 1, dimAxis, blocks;
+
+    QuantParamIndex(const Shape &dims, int axis, int blockSize,
+                    size_t scaleSize)
+        : perTensor(scaleSize == 1), blockSize(blockSize),
+          dimAxis(perTensor ? 1 : dims[axis]) {
+        // A per-tensor axis may not name a dimension of a 0-D input.
+        for (size_t i = axis + 1; !perTensor && i < dims.size(); ++i)
+            inner *= dims[i];
+        blocks = blockSize > 0 ? (dimAxis + blockSize - 1) / blockSize : 1;
+    }
+
+    size_t operator()(size_t i) const {
+        if (perTensor)
+            return 0;
+        size_t coord = (i / inner) % dimAxis;
+        if (blockSize == 0)
+            return coord;
+        size_t outer = i / (inner * dimAxis);
+        return (outer * blocks + coord / blockSize) * inner + i % inner;
+    }
+};
+
+template <typename Q> static Q saturate(float v) {
+    v = std::nearbyint(v);
+    v = std::max(v, float(std::numeric_limits<Q>::min()));
+    v = std::min(v, float(std::numeric_limits<Q>::max()));
+    return static_cast<Q>(v);
+}
+
+class NaiveQuantizeLinear : public CpuKernelWithoutConfig {
+    template <typename T, typename Q>
+    void doCompute(const Operator &_op, const RuntimeObj *context) const {
+        using CT = typename ComputeType<T>::t;
+        auto op = as<QuantizeLinearObj>(_op);
+        T *input = op->getInputs(0)->getRawDataPtr<T *>();
+        T *scale = op->getInputs(1)->getRawDataPtr<T *>();
+        Q *zeroPoint = op->getZeroPoint()
+                           ? op->getZeroPoint()->getRawDataPtr<Q *>()
+                           : nullptr;
+        Q *output = op->getOutput()->getRawDataPtr<Q *>();
+
+        QuantParamIndex index(op->getInputs(0)->getDims(), op->getAxis(),
+                              op->getBlockSize(), op->getInputs(1)->size());
+        const size_t n = op->getInputs(0)->size();
+#pragma omp parallel for
+        for (size_t i = 0; i < n; ++i) {
+            size_t idx = index(i);
+            CT zp = zeroPoint ? CT(zeroPoint[idx]) : CT(0);
+            output[i] = saturate<Q>(
+                std::nearbyint(CT(input[i]) / CT(scale[idx])) + zp);
+        }
+    }
+
+    template <typename T>
+    void dispatchOutput(const Operator &_op, const RuntimeObj *context) const {
+        if (_op->getOutDType() == DataType::Int8)
+            doCompute<T, int8_t>(_op, context);
+        else
+            doCompute<T, uint8_t>(_op, context);
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        switch (_op->getDType().getIndex()) {
+        case 1: // DataType::Float32
+            dispatchOutput<float>(_op, context);
+            break;
+        case 10: // DataType::Float16
+            dispatchOutput<fp16_t>(_op, context);
+            break;
+        case 16: // DataType::BFloat16
+            dispatchOutput<bfp16_t>(_op, context);
+            break;
+        default:
+            IT_TODO_HALT();
+        }
+    }
+};
+
+class NaiveDequantizeLinear : public CpuKernelWithoutConfig {
+    template <typename Q, typename T>
+    void doCompute(const Operator &_op, const RuntimeObj *context) const {
+        using CT = typename ComputeType<T>::t;
+        auto op = as<DequantizeLinearObj>(_op);
+        Q *input = op->getInputs(0)->getRawDataPtr<Q *>();
+        T *scale = op->getInputs(1)->getRawDataPtr<T *>();
+        Q *zeroPoint = op->getZeroPoint()
+                           ? op->getZeroPoint()->getRawDataPtr<Q *>()
+                           : nullptr;
+        T *output = op->getOutput()->getRawDataPtr<T *>();
+
+        QuantParamIndex index(op->getInputs(0)->getDims(), op->getAxis(),
+                              op->getBlockSize(), op->getInputs(1)->size());
+        const size_t n = op->getInputs(0)->size();
+#pragma omp parallel for
+        for (size_t i = 0; i < n; ++i) {
+            size_t idx = index(i);
+            CT zp = zeroPoint ? CT(zeroPoint[idx]) : CT(0);
+            output[i] = static_cast<T>((CT(input[i]) - zp) * CT(scale[idx]));
+        }
+    }
+
+    template <typename Q>
+    void dispatchOutput(const Operator &_op, const RuntimeObj *context) const {
+        switch (_op->getOutDType().getIndex()) {
+        case 1: // DataType::Float32
+            doCompute<Q, float>(_op, context);
+            break;
+        case 10: // DataType::Float16
+            doCompute<Q, fp16_t>(_op, context);
+            break;
+        case 16: // DataType::BFloat16
+            doCompute<Q, bfp16_t>(_op, context);
+            break;
+        default:
+            IT_TODO_HALT();
+        }
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        switch (_op->getDType().getIndex()) {
+        case 2: // DataType::UInt8
+            dispatchOutput<uint8_t>(_op, context);
+            break;
+        case 3: // DataType::Int8
+            dispatchOutput<int8_t>(_op, context);
+            break;
+        case 6: // DataType::Int32
+            dispatchOutput<int32_t>(_op, context);
+            break;
+        default:
+            IT_TODO_HALT();
+        }
+    }
+};
+
+class NaiveQuantizedMatmul : public CpuKernelWithoutConfig {
+    // Dequantize `count` weights of one group into `dst`.
+    template <int Bits>
+    static void dequantizeGroup(const uint8_t *src, size_t offset,
+                                size_t count, float scale, float zp,
+                                float *dst) {
+        if constexpr (Bits == 8) {
+            auto q = reinterpret_cast<const int8_t *>(src) + offset;
+#pragma omp simd
+            for (size_t i = 0; i < count; ++i)
+                dst[i] = (float(q[i]) - zp) * scale;
+        } else {
+            auto q = src + offset / 2;
+            const float bias = -zp * scale;
+#pragma omp simd
+            for (size_t i = 0; i < count / 2; ++i) {
+                int lo = q[i] & 0xF, hi = q[i] >> 4;
+                dst[2 * i] = float(lo) * scale + bias;
+                dst[2 * i + 1] = float(hi) * scale + bias;
+            }
+        }
+    }
+
+    template <typename T, int Bits>
+    void doCompute(const Operator &_op, const RuntimeObj *context) const {
+        auto op = as<QuantizedMatmulObj>(_op);
+        T *A = op->getInputs(0)->getRawDataPtr<T *>();
+        uint8_t *B = op->getInputs(1)->getRawDataPtr<uint8_t *>();
+        T *scale = op->getScale()->getRawDataPtr<T *>();
+        uint8_t *zeroPoint =
+            op->getZeroPoint() ? op->getZeroPoint()->getRawDataPtr<uint8_t *>()
+                               : nullptr;
+        T *C = op->getOutput()->getRawDataPtr<T *>();
+        const size_t M = op->getM(), N = op->getN(), K = op->getK();
+        const size_t G = op->getGroupSize(), groups = K / G;
+
+        // Activations are small next to the weights; convert them once.
+        std::vector<float> bufA;
+        const float *a = reinterpret_cast<const float *>(A);
+        if constexpr (!std::is_same_v<T, float>) {
+            bufA.resize(M * K);
+            loadAsFloat(A, bufA.data(), M * K);
+            a = bufA.data();
+        }
+        // Each output channel dequantizes its weights group by group and
+        // applies them to every row of A, so the weights are read once.
+#pragma omp parallel for
+        for (size_t n = 0; n < N; ++n) {
+            std::vector<float> w(G), acc(M, 0.f);
+            for (size_t g = 0; g < groups; ++g) {
+                size_t idx = n * groups + g;
+                float zp = 0.f;
+                if (zeroPoint)
+                    zp = Bits == 8
+                             ? float(reinterpret_cast<int8_t *>(zeroPoint)[idx])
+                             : float(zeroPoint[idx]);
+                else if (Bits == 4)
+                    zp = 8.f;
+                dequantizeGroup<Bits>(B, n * K + g * G, G, float(scale[idx]),
+                                      zp, w.data());
+                for (size_t m = 0; m < M; ++m) {
+                    const float *row = a + m * K + g * G;
+                    float sum = 0.f;
+#pragma omp simd reduction(+ : sum)
+                    for (size_t i = 0; i < G; ++i)
+                        sum += row[i] * w[i];
+                    acc[m] += sum;
+                }
+            }
+            for (size_t m = 0; m < M; ++m)
+                C[m * N + n] = static_cast<T>(acc[m]);
+        }
+    }
+
+    template <typename T>
+    void dispatchBits(const Operator &_op, const RuntimeObj *context) const {
+        if (as<QuantizedMatmulObj>(_op)->getBits() == 8)
+            doCompute<T, 8>(_op, context);
+        else
+            doCompute<T, 4>(_op, context);
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        switch (_op->getDType().getIndex()) {
+        case 1: // DataType::Float32
+            dispatchBits<float>(_op, context);
+            break;
+        case 10: // DataType::Float16
+            dispatchBits<fp16_t>(_op, context);
+            break;
+        case 16: // DataType::BFloat16
+            dispatchBits<bfp16_t>(_op, context);
+            break;
+        default:
+            IT_TODO_HALT();
+        }
+    }
+};
+
+// Integer dot product of two int8 vectors.
+template <typename TA, typename TB>
+static int32_t dotInt8Ref(const TA *a, const TB *b, size_t n) {
+    int32_t sum = 0;
+#pragma omp simd reduction(+ : sum)
+    for (size_t i = 0; i < n; ++i)
+        sum += int32_t(a[i]) * int32_t(b[i]);
+    return sum;
+}
+
+#ifdef INFINI_X86
+__attribute__((target("avx512f,avx512bw,avx512vnni"))) static int32_t
+dotU8S8Vnni(const uint8_t *a, const int8_t *b, size_t n) {
+    __m512i acc = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64)
+        acc = _mm512_dpbusd_epi32(acc, _mm512_loadu_si512(a + i),
+                                  _mm512_loadu_si512(b + i));
+    alignas(64) int32_t lanes[16];
+    _mm512_store_si512(lanes, acc);
+    int32_t sum = 0;
+    for (int j = 0; j < 16; ++j)
+        sum += lanes[j];
+    for (; i < n; ++i)
+        sum += int32_t(a[i]) * int32_t(b[i]);
+    return sum;
+}
+
+static const bool hasVNNI = __builtin_cpu_supports("avx512vnni");
+#endif
+
+// uint8 x int8 is the combination VNNI multiplies natively; it is what the
+// Q/DQ folding pass produces for activations and weights.
+template <typename TA, typename TB>
+static int32_t dotInt8(const TA *a, const TB *b, size_t n) {
+#ifdef INFINI_X86
+    if constexpr (std::is_same_v<TA, uint8_t> && std::is_same_v<TB, int8_t>)
+        if (hasVNNI)
+            return dotU8S8Vnni(a, b, n);
+#endif
+    return dotInt8Ref(a, b, n);
+}
+
+template <typename T> static int32_t sumInt8(const T *a, size_t n) {
+    int32_t sum = 0;
+#pragma omp simd reduction(+ : sum)
+    for (size_t i = 0; i < n; ++i)
+        sum += a[i];
+    return sum;
+}
+
+// Calls f(TA*, TB*, TY*) with null pointers of the storage types of the
+// quantized A, B and Y tensors.
+template <typename F>
+static void dispatchInt8(DataType a, DataType b, DataType y, F &&f) {
+    auto pick = [](DataType t, auto g) {
+        if (t == DataType::UInt8)
+            g(static_cast<uint8_t *>(nullptr));
+        else
+            g(static_cast<int8_t *>(nullptr));
+    };
+    pick(a, [&](auto pa) {
+        pick(b, [&](auto pb) { pick(y, [&](auto py) { f(pa, pb, py); }); });
+    });
+}
+
+class NaiveQLinearMatmul : public CpuKernelWithoutConfig {
+    template <typename TA, typename TB, typename TY>
+    void doCompute(const Operator &_op, const RuntimeObj *context) const {
+        auto op = as<QLinearMatmulObj>(_op);
+        const auto &in = op->getInputs();
+        TA *A = in[0]->getRawDataPtr<TA *>();
+        TB *B = in[3]->getRawDataPtr<TB *>();
+        TY *Y = op->getOutput()->getRawDataPtr<TY *>();
+        float *bScale = in[4]->getRawDataPtr<float *>();
+        TB *bZero = in[5]->getRawDataPtr<TB *>();
+        const int32_t aZero = in[2]->getRawDataPtr<TA *>()[0];
+        const int32_t yZero = in[7]->getRawDataPtr<TY *>()[0];
+        const float aScale = in[1]->getRawDataPtr<float *>()[0];
+        const float yScale = in[6]->getRawDataPtr<float *>()[0];
+        const size_t M = op->getM(), N = op->getN(), K = op->getK();
+        const bool perColumn = in[4]->size() != 1;
+        auto multiplier = [&](size_t c) { return aScale * bScale[c] / yScale; };
+
+        if (op->getTransB()) {
+            // B is [N, K], transposed once by the Q/DQ folding pass, so each
+            // output is an int8 dot product of two contiguous rows.
+            std::vector<int32_t> colSum(N);
+#pragma omp parallel for
+            for (size_t j = 0; j < N; ++j)
+                colSum[j] = sumInt8(B + j * K, K);
+#pragma omp parallel for
+            for (size_t i = 0; i < M; ++i) {
+                const TA *a = A + i * K;
+                const int32_t rowSum = sumInt8(a, K);
+                for (size_t j = 0; j < N; ++j) {
+                    const size_t c = perColumn ? j : 0;
+                    const int32_t bz = bZero[c];
+                    int32_t acc = dotInt8(a, B + j * K, K) - bz * rowSum -
+                                  aZero * colSum[j] + int32_t(K) * aZero * bz;
+                    Y[i * N + j] = saturate<TY>(acc * multiplier(c) + yZero);
+                }
+            }
+            return;
+        }
+
+        // B is read in place, row by row. With a' = a - aZero,
+        // sum((a - aZero) * (b - bZero)) is sum(a' * b) - bZero * sum(a'),
+        // which needs no column sums of B.
+#pragma omp parallel
+        {
+            std::vector<int32_t> a(K), acc(N);
+#pragma omp for
+            for (size_t i = 0; i < M; ++i) {
+                int32_t rowSum = 0;
+                for (size_t k = 0; k < K; ++k) {
+                    a[k] = int32_t(A[i * K + k]) - aZero;
+                    rowSum += a[k];
+                }
+                std::fill(acc.begin(), acc.end(), 0);
+                for (size_t k = 0; k < K; ++k) {
+                    const int32_t aik = a[k];
+                    const TB *brow = B + k * N;
+#pragma omp simd
+                    for (size_t j = 0; j < N; ++j)
+                        acc[j] += aik * int32_t(brow[j]);
+                }
+                for (size_t j = 0; j < N; ++j) {
+                    const size_t c = perColumn ? j : 0;
+                    Y[i * N + j] = saturate<TY>(
+                        (acc[j] - int32_t(bZero[c]) * rowSum) * multiplier(c) +
+                        yZero);
+                }
+            }
+        }
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        dispatchInt8(_op->getInputs(0)->getDType(),
+                     _op->getInputs(3)->getDType(), _op->getOutDType(),
+                     [&](auto a, auto b, auto y) {
+                         doCompute<std::remove_pointer_t<decltype(a)>,
+                                   std::remove_pointer_t<decltype(b)>,
+                                   std::remove_pointer_t<decltype(y)>>(
+                             _op, context);
+                     });
+    }
+};
+
+class NaiveQLinearConv : public CpuKernelWithoutConfig {
+    template <typename TA, typename TB, typename TY>
+    void doCompute(const Operator &_op, const RuntimeObj *context) const {
+        auto op = as<QLinearConvObj>(_op);
+        const auto &in = op->getInputs();
+        TA *X = in[0]->getRawDataPtr<TA *>();
+        TB *W = in[3]->getRawDataPtr<TB *>();
+        TY *Y = op->getOutput()->getRawDataPtr<TY *>();
+        float *wScale = in[4]->getRawDataPtr<float *>();
+        TB *wZero = in[5]->getRawDataPtr<TB *>();
+        int32_t *bias =
+            op->getBias() ? op->getBias()->getRawDataPtr<int32_t *>() : nullptr;
+        const TA xZero = in[2]->getRawDataPtr<TA *>()[0];
+        const int32_t yZero = in[7]->getRawDataPtr<TY *>()[0];
+        const float xScale = in[1]->getRawDataPtr<float *>()[0];
+        const float yScale = in[6]->getRawDataPtr<float *>()[0];
+        const bool perChannel = in[4]->size() != 1;
+
+        auto x = in[0]->getDims(), w = in[3]->getDims();
+        auto y = op->getOutput()->getDims();
+        const int N = x[0], C = x[1], H = x[2], Wd = x[3];
+        const int F = w[0], Cg = w[1], R = w[2], S = w[3];
+        const int OH = y[2], OW = y[3];
+        const int G = op->getNumGroups(), Fg = F / G;
+        const auto [ph, pw, sh, sw, dh, dw] = op->getPadStrideDilation();
+        const size_t K = size_t(Cg) * R * S, P = size_t(OH) * OW;
+
+        std::vector<int32_t> wSum(F);
+        for (int f = 0; f < F; ++f)
+            wSum[f] = sumInt8(W + f * K, K);
+        // im2col with one contiguous row per output pixel; padding takes the
+        // zero point so it contributes nothing after the correction terms.
+        std::vector<TA> col(P * K);
+        std::vector<int32_t> colSum(P);
+        for (int n = 0; n < N; ++n) {
+            for (int g = 0; g < G; ++g) {
+                const TA *xg = X + (size_t(n) * C + g * Cg) * H * Wd;
+#pragma omp parallel for
+                for (size_t p = 0; p < P; ++p) {
+                    int oh = p / OW, ow = p % OW;
+                    TA *row = col.data() + p * K;
+                    for (int c = 0; c < Cg; ++c)
+                        for (int r = 0; r < R; ++r)
+                            for (int s = 0; s < S; ++s) {
+                                int ih = oh * sh - ph + r * dh;
+                                int iw = ow * sw - pw + s * dw;
+                                *row++ = ih < 0 || ih >= H || iw < 0 ||
+                                                 iw >= Wd
+                                             ? xZero
+                                             : xg[(c * H + ih) * Wd + iw];
+                            }
+                    colSum[p] = sumInt8(col.data() + p * K, K);
+                }
+#pragma omp parallel for collapse(2)
+                for (int fg = 0; fg < Fg; ++fg) {
+                    for (size_t p = 0; p < P; ++p) {
+                        const int f = g * Fg + fg;
+                        const int32_t wz = wZero[perChannel ? f : 0];
+                        int32_t acc =
+                            dotInt8(col.data() + p * K, W + f * K, K) -
+                            wz * colSum[p] - int32_t(xZero) * wSum[f] +
+                            int32_t(K) * xZero * wz;
+                        if (bias)
+                            acc += bias[f];
+                        float multiplier =
+                            xScale * wScale[perChannel ? f : 0] / yScale;
+                        Y[(size_t(n) * F + f) * P + p] =
+                            saturate<TY>(acc * multiplier + yZero);
+                    }
+                }
+            }
+        }
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        dispatchInt8(_op->getInputs(0)->getDType(),
+                     _op->getInputs(3)->getDType(), _op->getOutDType(),
+                     [&](auto a, auto b, auto y) {
+                         doCompute<std::remove_pointer_t<decltype(a)>,
+                                   std::remove_pointer_t<decltype(b)>,
+                                   std::remove_pointer_t<decltype(y)>>(
+                             _op, context);
+                     });
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::QuantizeLinear, NaiveQuantizeLinear,
+                "QuantizeLinearNaive_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::DequantizeLinear, NaiveDequantizeLinear,
+                "DequantizeLinearNaive_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::QuantizedMatMul, NaiveQuantizedMatmul,
+                "QuantizedMatmulNaive_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::QLinearMatMul, NaiveQLinearMatmul,
+                "QLinearMatmulNaive_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::QLinearConv, NaiveQLinearConv,
+                "QLinearConvNaive_CPU");
+
+} // namespace infini
@@ -15,15 +15,28 @@ class NaiveIdentity : public CpuKernelWithoutConfig {
     }
 };
 
-// REGISTER_KERNEL(Device::CPU, OpType::Reshape, NaiveIdentity,
-//                 "ReshapeNaive_CPU");
-// REGISTER_KERNEL(Device::CPU, OpType::Identity, NaiveIdentity,
-//                 "IdentityNaive_CPU");
-// REGISTER_KERNEL(Device::CPU, OpType::Unsqueeze, NaiveIdentity,
-//                 "UnsqueezeNaive_CPU");
-// REGISTER_KERNEL(Device::CPU, OpType::Squeeze, NaiveIdentity,
-//                 "SqueezeNaive_CPU");
-// REGISTER_KERNEL(Device::CPU, OpType::Flatten, NaiveIdentity,
-//                 "FlattenNaive_CPU");
+// A plain copy cannot convert between layouts.
+static KernelConstraints sameLayout() {
+    return {{}, {}, [](const Operator &op) {
+                return op->getInputs(0)->getLayout() ==
+                       op->getOutput()->getLayout();
+            }};
+}
+
+REGISTER_KERNEL_CANDIDATE(Device::CPU, OpType::Reshape, NaiveIdentity,
+                          "ReshapeNaive_CPU", nativeKernelPriority,
+                          sameLayout());
+REGISTER_KERNEL_CANDIDATE(Device::CPU, OpType::Identity, NaiveIdentity,
+                          "IdentityNaive_CPU", nativeKernelPriority,
+                          sameLayout());
+REGISTER_KERNEL_CANDIDATE(Device::CPU, OpType::Unsqueeze, NaiveIdentity,
+                          "UnsqueezeNaive_CPU", nativeKernelPriority,
+                          sameLayout());
+REGISTER_KERNEL_CANDIDATE(Device::CPU, OpType::Squeeze, NaiveIdentity,
+                          "SqueezeNaive_CPU", nativeKernelPriority,
+                          sameLayout());
+REGISTER_KERNEL_CANDIDATE(Device::CPU, OpType::Flatten, NaiveIdentity,
+                          "FlattenNaive_CPU", nativeKernelPriority,
+                          sameLayout());
 
 } // namespace infini
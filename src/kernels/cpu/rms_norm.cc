@@ -0,0 +1,53 @@
+#include "operators/rms_norm.h"
+#include "core/kernel.h"
+
+namespace infini {
+
+class NaiveRMSNorm : public CpuKernelWithoutConfig {
+    template <typename T>
+    void doCompute(const Operator &_op, const RuntimeObj *context) const {
+        using CT = typename ComputeType<T>::t;
+        auto op = as<RMSNormObj>(_op);
+        T *input = op->getInputs(0)->getRawDataPtr<T *>();
+        T *weight = op->getInputs(1)->getRawDataPtr<T *>();
+        T *output = op->getOutput()->getRawDataPtr<T *>();
+
+        auto dims = op->getInputs(0)->getDims();
+        size_t hidden = dims.back();
+        size_t tokens = op->getInputs(0)->size() / hidden;
+        IT_ASSERT(hidden == op->getInputs(1)->size());
+        const CT eps = op->getEps();
+#pragma omp parallel for
+        for (size_t t = 0; t < tokens; ++t) {
+            const T *x = input + t * hidden;
+            T *y = output + t * hidden;
+            CT sum = 0;
+            for (size_t i = 0; i < hidden; ++i)
+                sum += CT(x[i]) * CT(x[i]);
+            CT rms = 1 / std::sqrt(sum / hidden + eps);
+            for (size_t i = 0; i < hidden; ++i)
+                y[i] = static_cast<T>(CT(x[i]) * rms * CT(weight[i]));
+        }
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        switch (_op->getDType().getIndex()) {
+        case 1: // DataType::Float32
+            doCompute<float>(_op, context);
+            break;
+        case 10: // DataType::Float16
+            doCompute<fp16_t>(_op, context);
+            break;
+        case 16: // DataType::BFloat16
+            doCompute<bfp16_t>(_op, context);
+            break;
+        default:
+            IT_TODO_HALT();
+        }
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::RMSNorm, NaiveRMSNorm, "RMSNormNaive_CPU");
+
+} // namespace infini
@@ -1,75 +1,148 @@
 #include "operators/unary.h"
-#include "core/constants.h"
 #include "core/kernel.h"
 #include "operators/softmax.h"
 
 namespace infini {
-class NativeUnary : public CpuKernelWithoutConfig {
-    template <typename T> static T reluCompute(T val) {
+namespace {
+// Integers narrower than int are computed as int, so the expressions below
+// do not mix promoted and unpromoted operands.
+template <typename T>
+using UnaryComputeType =
+    std::conditional_t<std::is_integral_v<T> && sizeof(T) < sizeof(int), int,
+                       typename ComputeType<T>::t>;
+
+struct ReluOp {
+    template <typename T> T operator()(T val) const {
         return std::max(T(0), val);
     }
+};
 
-    template <typename T> static T sigmoidCompute(T val) {
-        return 1 / (1 + pow(E_CONSTANT, -val));
+struct SigmoidOp {
+    template <typename T> T operator()(T val) const {
+        return T(1) / (T(1) + std::exp(-val));
     }
+};
 
-    template <typename T> static T hardSigmoidCompute(T val) {
+struct HardSigmoidOp {
+    template <typename T> T operator()(T val) const {
         return std::max(T(0), std::min(T(1), T(0.2) * val + T(0.5)));
     }
+};
 
-    template <typename T> static T hardSwishCompute(T val) {
+struct HardSwishOp {
+    template <typename T> T operator()(T val) const {
         return val *
                std::max(T(0), std::min(T(1), val * T(1.0 / 6.0) + T(0.5)));
     }
+};
 
-    template <typename T> static T tanhCompute(T val) {
-        return (pow(E_CONSTANT, val) - pow(E_CONSTANT, -val)) /
-               (pow(E_CONSTANT, val) + pow(E_CONSTANT, -val));
-    }
+struct TanhOp {
+    template <typename T> T operator()(T val) const { return std::tanh(val); }
+};
 
-    template <typename T> static T absCompute(T val) {
+struct AbsOp {
+    template <typename T> T operator()(T val) const {
         return val < 0 ? -val : val;
     }
+};
 
-    template <typename T> static T sqrtCompute(T val) { return std::sqrt(val); }
+struct SqrtOp {
+    template <typename T> T operator()(T val) const { return std::sqrt(val); }
+};
 
-    template <typename T> static T cosCompute(T val) { return std::cos(val); }
+struct CosOp {
+    template <typename T> T operator()(T val) const { return std::cos(val); }
+};
 
-    template <typename T> static T sinCompute(T val) { return std::sin(val); }
+struct SinOp {
+    template <typename T> T operator()(T val) const { return std::sin(val); }
+};
 
-    template <typename T> static T tanCompute(T val) { return std::tan(val); }
+struct TanOp {
+    template <typename T> T operator()(T val) const { return std::tan(val); }
+};
 
-    template <typename T> static T sinhCompute(T val) { return std::sinh(val); }
+struct SinhOp {
+    template <typename T> T operator()(T val) const { return std::sinh(val); }
+};
 
-    template <typename T> static T coshCompute(T val) { return std::cosh(val); }
+struct CoshOp {
+    template <typename T> T operator()(T val) const { return std::cosh(val); }
+};
 
-    template <typename T> static T geluCompute(T val) {
-        return 0.5 * val * (1 + std::erf(val / std::sqrt(2)));
+struct GeluOp {
+    template <typename T> T operator()(T val) const {
+        return val * (T(1) + std::erf(val * T(M_SQRT1_2))) / T(2);
     }
+};
 
-    template <typename T> static T siluCompute(T val) {
-        return val / (1 + pow(E_CONSTANT, -val));
+struct SiluOp {
+    template <typename T> T operator()(T val) const {
+        return val / (T(1) + std::exp(-val));
     }
+};
 
-    template <typename T> static T erfCompute(T val) { return std::erf(val); }
+struct ErfOp {
+    template <typename T> T operator()(T val) const { return std::erf(val); }
+};
 
-    template <typename T> static T aCosCompute(T val) { return std::acos(val); }
+struct AcosOp {
+    template <typename T> T operator()(T val) const { return std::acos(val); }
+};
 
-    template <typename T> static T aCoshCompute(T val) {
-        return std::acosh(val);
-    }
+struct AcoshOp {
+    template <typename T> T operator()(T val) const { return std::acosh(val); }
+};
 
-    template <typename T> static T aSinCompute(T val) { return std::asin(val); }
+struct AsinOp {
+    template <typename T> T operator()(T val) const { return std::asin(val); }
+};
 
-    template <typename T> static T aSinhCompute(T val) {
-        return std::asinh(val);
-    }
-    template <typename T> static T aTanCompute(T val) { return std::atan(val); }
+struct AsinhOp {
+    template <typename T> T operator()(T val) const { return std::asinh(val); }
+};
+
+struct AtanOp {
+    template <typename T> T operator()(T val) const { return std::atan(val); }
+};
 
-    template <typename T> static T aTanhCompute(T val) {
-        return std::atanh(val);
+struct AtanhOp {
+    template <typename T> T operator()(T val) const { return std::atanh(val); }
+};
+
+struct NegOp {
+    template <typename T> T operator()(T val) const { return -val; }
+};
+
+} // namespace
+
+// Instantiated per (Op, dtype) so that the functor is inlined into a
+// vectorizable loop instead of being called through a function pointer.
+template <typename Op> class NativeUnary : public CpuKernelWithoutConfig {
+    // Elements processed per parallel task.
+    static constexpr size_t chunk = 1 << 14;
+    // Half-precision data is widened to fp32 in blocks of this size.
+    static constexpr size_t block = 256;
+
+    template <typename T>
+    static void apply(const T *inptr, T *outptr, size_t len) {
+        using CT = UnaryComputeType<T>;
+        if constexpr (std::is_same_v<typename ComputeType<T>::t, T>) {
+#pragma omp simd
+            for (size_t i = 0; i < len; ++i)
+                outptr[i] = static_cast<T>(Op()(CT(inptr[i])));
+        } else {
+            float buf[block];
+            for (size_t i = 0; i < len; i += block) {
+                size_t m = std::min(block, len - i);
+                loadAsFloat(inptr + i, buf, m);
+#pragma omp simd
+                for (size_t j = 0; j < m; ++j)
+                    buf[j] = Op()(buf[j]);
+                storeFromFloat(buf, outptr + i, m);
+            }
+        }
     }
-    template <typename T> static T negCompute(T val) { return -val; }
 
     template <typename T>
     void doCompute(const Operator &_op, const RuntimeObj *context) const {
@@ -77,83 +150,12 @@ class NativeUnary : public CpuKernelWithoutConfig {
         T *inptr = op->getInputs(0)->getRawDataPtr<T *>();
         T *outptr = op->getOutput()->getRawDataPtr<T *>();
 
-        auto outDim = op->getOutput()->getDims();
         auto n = op->getOutput()->size();
-
-        T (*_doCompute)(T val);
-        switch (op->getOpType().underlying()) {
-        case OpType::Relu:
-            _doCompute = reluCompute<T>;
-            break;
-        case OpType::Gelu:
-            _doCompute = geluCompute<T>;
-            break;
-        case OpType::Silu:
-            _doCompute = siluCompute<T>;
-            break;
-        case OpType::Sigmoid:
-            _doCompute = sigmoidCompute<T>;
-            break;
-        case OpType::HardSigmoid:
-            _doCompute = hardSigmoidCompute<T>;
-            break;
-        case OpType::HardSwish:
-            _doCompute = hardSwishCompute<T>;
-            break;
-        case OpType::Tanh:
-            _doCompute = tanhCompute<T>;
-            break;
-        case OpType::Abs:
-            _doCompute = absCompute<T>;
-            break;
-        case OpType::Sqrt:
-            _doCompute = sqrtCompute<T>;
-            break;
-        case OpType::Erf:
-            _doCompute = erfCompute<T>;
-            break;
-        case OpType::Neg:
-            _doCompute = negCompute<T>;
-            break;
-        case OpType::Cos:
-            _doCompute = cosCompute<T>;
-            break;
-        case OpType::Sin:
-            _doCompute = sinCompute<T>;
-            break;
-        case OpType::Tan:
-            _doCompute = tanCompute<T>;
-            break;
-        case OpType::Sinh:
-            _doCompute = sinhCompute<T>;
-            break;
-        case OpType::Cosh:
-            _doCompute = coshCompute<T>;
-            break;
-        case OpType::Acos:
-            _doCompute = aCosCompute<T>;
-            break;
-        case OpType::Asin:
-            _doCompute = aSinCompute<T>;
-            break;
-        case OpType::Asinh:
-            _doCompute = aSinhCompute<T>;
-            break;
-        case OpType::Atan:
-            _doCompute = aTanCompute<T>;
-            break;
-        case OpType::Atanh:
-            _doCompute = aTanhCompute<T>;
-            break;
-        case OpType::Acosh:
-            _doCompute = aCoshCompute<T>;
-            break;
-        default:
-            IT_TODO_HALT();
-        }
-
-        for (size_t offset = 0; offset < n; offset++) {
-            outptr[offset] = _doCompute(inptr[offset]);
+        size_t tasks = (n + chunk - 1) / chunk;
+#pragma omp parallel for if (tasks > 1)
+        for (size_t t = 0; t < tasks; ++t) {
+            size_t begin = t * chunk;
+            apply(inptr + begin, outptr + begin, std::min(chunk, n - begin));
         }
     }
 
@@ -167,29 +169,71 @@ class NativeUnary : public CpuKernelWithoutConfig {
         switch (dataTypeIdx) {
             CASE(1); // DataType::Float32
             break;
+            CASE(2); // DataType::UInt8
+            break;
+            CASE(3); // DataType::Int8
+            break;
+            CASE(4); // DataType::UInt16
+            break;
+            CASE(5); // DataType::Int16
+            break;
+            CASE(6); // DataType::Int32
+            break;
+            CASE(7); // DataType::Int64
+            break;
+            CASE(9); // DataType::Bool
+            break;
+            CASE(11); // DataType::Double
+            break;
             CASE(12); // DataType::UInt32
             break;
+            CASE(13); // DataType::UInt64
+            break;
+        case 10: // DataType::Float16
+            doCompute<fp16_t>(_op, context);
+            break;
+        case 16: // DataType::BFloat16
+            doCompute<bfp16_t>(_op, context);
+            break;
         default:
             IT_TODO_HALT();
         }
+#undef CASE
     }
 };
 
 class NaiveSoftmax : public CpuKernelWithoutConfig {
     template <typename T>
     void doCompute(const Operator &_op, const RuntimeObj *context) const {
+        using CT = typename ComputeType<T>::t;
         auto op = as<SoftmaxObj>(_op);
         T *inptr = op->getInputs(0)->getRawDataPtr<T *>();
         T *outptr = op->getOutput()->getRawDataPtr<T *>();
 
         auto outDim = op->getOutput()->getDims();
         auto n = op->getOutput()->size();
-        auto sum = T(0);
-        for (size_t offset = 0; offset < n; offset++) {
-            sum += pow(E_CONSTANT, inptr[offset]);
-        }
-        for (size_t offset = 0; offset < n; offset++) {
-            outptr[offset] = pow(E_CONSTANT, inptr[offset]) / sum;
+        int axis = op->getAxis();
+        size_t dimSize = outDim[axis];
+        size_t inner = 1;
+        for (size_t i = axis + 1; i < outDim.size(); ++i)
+            inner *= outDim[i];
+        size_t outer = n / (dimSize * inner);
+        // Normalize along `axis`; the maximum is subtracted for stability.
+#pragma omp parallel for collapse(2)
+        for (size_t o = 0; o < outer; ++o) {
+            for (size_t i = 0; i < inner; ++i) {
+                size_t base = o * dimSize * inner + i;
+                CT maxVal = CT(inptr[base]);
+                for (size_t j = 1; j < dimSize; ++j)
+                    maxVal = std::max(maxVal, CT(inptr[base + j * inner]));
+                CT sum = CT(0);
+                for (size_t j = 0; j < dimSize; ++j)
+                    sum += static_cast<CT>(
+                        std::exp(CT(inptr[base + j * inner]) - maxVal));
+                for (size_t j = 0; j < dimSize; ++j)
+                    outptr[base + j * inner] = static_cast<T>(
+                        std::exp(CT(inptr[base + j * inner]) - maxVal) / sum);
+            }
         }
     }
 
@@ -205,6 +249,12 @@ class NaiveSoftmax : public CpuKernelWithoutConfig {
             break;
             CASE(12); // DataType::UInt32
             break;
+        case 10: // DataType::Float16
+            doCompute<fp16_t>(_op, context);
+            break;
+        case 16: // DataType::BFloat16
+            doCompute<bfp16_t>(_op, context);
+            break;
         default:
             IT_TODO_HALT();
         }
@@ -214,6 +264,7 @@ class NaiveSoftmax : public CpuKernelWithoutConfig {
 class Clip : public CpuKernelWithoutConfig {
     template <typename T>
     void doCompute(const Operator &_op, const RuntimeObj *context) const {
+        using CT = typename ComputeType<T>::t;
         auto op = as<ClipObj>(_op);
         T *inptr = op->getInputs(0)->getRawDataPtr<T *>();
         T *outptr = op->getOutput()->getRawDataPtr<T *>();
@@ -222,10 +273,11 @@ class Clip : public CpuKernelWithoutConfig {
 
         auto n = op->getOutput()->size();
         for (size_t offset = 0; offset < n; offset++) {
-            auto val = *inptr++;
-            *outptr++ = (minValue && val < *minValue)   ? *minValue
-                        : (maxValue && val > *maxValue) ? *maxValue
-                                                        : val;
+            CT val = CT(*inptr++);
+            *outptr++ = static_cast<T>((minValue && val < *minValue) ? *minValue
+                                       : (maxValue && val > *maxValue)
+                                           ? *maxValue
+                                           : val);
         }
     }
 
@@ -241,6 +293,12 @@ class Clip : public CpuKernelWithoutConfig {
             break;
             CASE(12); // DataType::UInt32
             break;
+        case 10: // DataType::Float16
+            doCompute<fp16_t>(_op, context);
+            break;
+        case 16: // DataType::BFloat16
+            doCompute<bfp16_t>(_op, context);
+            break;
         default:
             IT_TODO_HALT();
         }
@@ -250,6 +308,7 @@ class Clip : public CpuKernelWithoutConfig {
 class Log : public CpuKernelWithoutConfig {
     template <typename T>
     void doCompute(const Operator &_op, const RuntimeObj *context) const {
+        using CT = typename ComputeType<T>::t;
         auto op = as<LogObj>(_op);
         T *inptr = op->getInputs(0)->getRawDataPtr<T *>();
         T *outptr = op->getOutput()->getRawDataPtr<T *>();
@@ -258,18 +317,18 @@ class Log : public CpuKernelWithoutConfig {
         auto len = op->getOutput()->size();
         for (size_t offset = 0; offset < len; offset++) {
             T res;
-            auto val = *inptr++;
+            CT val = CT(*inptr++);
             switch (logType) {
             case LogObj::LogE:
-                res = std::log(val);
+                res = static_cast<T>(std::log(val));
                 *outptr++ = res;
                 break;
             case LogObj::Log2:
-                res = std::log2(val);
+                res = static_cast<T>(std::log2(val));
                 *outptr++ = res;
                 break;
             case LogObj::Log10:
-                res = std::log10(val);
+                res = static_cast<T>(std::log10(val));
                 *outptr++ = res;
                 break;
             default:
@@ -291,38 +350,62 @@ class Log : public CpuKernelWithoutConfig {
             break;
             CASE(12); // DataType::UInt32
             break;
+        case 10: // DataType::Float16
+            doCompute<fp16_t>(_op, context);
+            break;
+        case 16: // DataType::BFloat16
+            doCompute<bfp16_t>(_op, context);
+            break;
         default:
             IT_TODO_HALT();
         }
     }
 };
 
-// REGISTER_KERNEL(Device::CPU, OpType::Relu, NativeUnary, "reluNaive_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::Gelu, NativeUnary, "geluNaive_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::Silu, NativeUnary, "siluNaive_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::Sigmoid, NativeUnary, "sigmoidNaive_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::HardSigmoid, NativeUnary,
+static KernelConstraints nativeUnary() {
+    return {{DataType::Float32, DataType::UInt8, DataType::Int8,
+             DataType::UInt16, DataType::Int16, DataType::Int32,
+             DataType::Int64, DataType::Bool, DataType::Double,
+             DataType::UInt32, DataType::UInt64, DataType::Float16,
+             DataType::BFloat16}};
+}
+REGISTER_KERNEL_CANDIDATE(Device::CPU, OpType::Relu, NativeUnary<ReluOp>,
+                          "reluNaive_CPU", nativeKernelPriority, nativeUnary());
+REGISTER_KERNEL(Device::CPU, OpType::Gelu, NativeUnary<GeluOp>,
+                "geluNaive_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Silu, NativeUnary<SiluOp>,
+                "siluNaive_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Sigmoid, NativeUnary<SigmoidOp>,
+                "sigmoidNaive_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::HardSigmoid, NativeUnary<HardSigmoidOp>,
                 "hardSigmoidNaive_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::HardSwish, NativeUnary,
+REGISTER_KERNEL(Device::CPU, OpType::HardSwish, NativeUnary<HardSwishOp>,
                 "hardSwishNaive_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::Tanh, NativeUnary, "tanhNaive_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::Abs, NativeUnary, "absNaive_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::Sqrt, NativeUnary, "sqrtNaive_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::Erf, NativeUnary, "erfNaive_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::Neg, NativeUnary, "negNaive_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::Cos, NativeUnary, "Cos_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::Sin, NativeUnary, "Sin_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::Tan, NativeUnary, "Tan_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::Sinh, NativeUnary, "Sinh_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::Cosh, NativeUnary, "Cosh_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::Acos, NativeUnary, "ACos_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::Acosh, NativeUnary, "ACosh_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::Asin, NativeUnary, "ASin_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::Asinh, NativeUnary, "ASinh_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::Atan, NativeUnary, "Atan_CPU");
-REGISTER_KERNEL(Device::CPU, OpType::Atanh, NativeUnary, "ATanh_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Tanh, NativeUnary<TanhOp>,
+                "tanhNaive_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Abs, NativeUnary<AbsOp>, "absNaive_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Sqrt, NativeUnary<SqrtOp>,
+                "sqrtNaive_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Erf, NativeUnary<ErfOp>, "erfNaive_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Neg, NativeUnary<NegOp>, "negNaive_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Cos, NativeUnary<CosOp>, "Cos_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Sin, NativeUnary<SinOp>, "Sin_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Tan, NativeUnary<TanOp>, "Tan_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Sinh, NativeUnary<SinhOp>, "Sinh_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Cosh, NativeUnary<CoshOp>, "Cosh_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Acos, NativeUnary<AcosOp>, "ACos_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Acosh, NativeUnary<AcoshOp>, "ACosh_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Asin, NativeUnary<AsinOp>, "ASin_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Asinh, NativeUnary<AsinhOp>, "ASinh_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Atan, NativeUnary<AtanOp>, "Atan_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Atanh, NativeUnary<AtanhOp>, "ATanh_CPU");
 
 REGISTER_KERNEL(Device::CPU, OpType::Softmax, NaiveSoftmax, "softmaxNaive_CPU");
-//REGISTER_KERNEL(Device::CPU, OpType::Clip, Clip, "Clip_CPU");
+static KernelConstraints nativeClip() {
+    return {{DataType::Float32, DataType::UInt32, DataType::Float16,
+             DataType::BFloat16}};
+}
+REGISTER_KERNEL_CANDIDATE(Device::CPU, OpType::Clip, Clip, "Clip_CPU",
+                          nativeKernelPriority, nativeClip());
 REGISTER_KERNEL(Device::CPU, OpType::Log, Log, "Log_CPU");
 }; // namespace infini
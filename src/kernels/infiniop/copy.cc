@@ -4,7 +4,49 @@
 namespace infini {
 
 class CopyOp : public Kernel {
+    // Copies a 4-D tensor between the NCHW and NHWC memory orders.
+    template <typename T>
+    static void convertLayout(const Tensor &in, const Tensor &out) {
+        auto dims = in->getDims();
+        size_t n = dims[0], c = dims[1], hw = size_t(dims[2]) * dims[3];
+        bool toNHWC = out->getLayout() == TensorLayout::NHWC;
+        T *src = in->getRawDataPtr<T *>(), *dst = out->getRawDataPtr<T *>();
+#pragma omp parallel for collapse(2)
+        for (size_t i = 0; i < n; ++i)
+            for (size_t p = 0; p < hw; ++p)
+                for (size_t j = 0; j < c; ++j) {
+                    size_t nchw = (i * c + j) * hw + p;
+                    size_t nhwc = (i * hw + p) * c + j;
+                    if (toNHWC)
+                        dst[nhwc] = src[nchw];
+                    else
+                        dst[nchw] = src[nhwc];
+                }
+    }
+
     void compute(const Operator &op, const RuntimeObj *context) const override {
+        auto in = op->getInputs(0), out = op->getOutput();
+        // An Identity between tensors of different layouts converts.
+        if (in->getLayout() != out->getLayout()) {
+            IT_ASSERT(context->isCpu());
+            switch (in->getDType().getSize()) {
+            case 1:
+                convertLayout<uint8_t>(in, out);
+                break;
+            case 2:
+                convertLayout<uint16_t>(in, out);
+                break;
+            case 4:
+                convertLayout<uint32_t>(in, out);
+                break;
+            case 8:
+                convertLayout<uint64_t>(in, out);
+                break;
+            default:
+                IT_TODO_HALT();
+            }
+            return;
+        }
         auto inData = (op->getInputs(0)->getRawDataPtr<void *>());
         auto outData = (op->getOutput()->getRawDataPtr<void *>());
         // 此处应使用 async 拷贝
@@ -15,10 +15,7 @@ class GemmOp : public Kernel {
                                 ? (op->getInputs(2)->getRawDataPtr<void *>())
                                 : nullptr;
 
-        // get workspace size and allocate workspace
-        uint64_t workspace_size = 0;
-        CHECK_ERROR(infiniopGetGEMMWorkspaceSize(
-            (infiniopGEMMDescriptor_t)op->getOpDesc(), &workspace_size));
+        uint64_t workspace_size = op->getDescWorkspaceSize();
         IT_ASSERT(workspace_size <= context->getWorkspaceSize());
         void *workspace = context->getWorkspace(workspace_size);
         CHECK_ERROR(infiniopGEMM((infiniopGEMMDescriptor_t)op->getOpDesc(),
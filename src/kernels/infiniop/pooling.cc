@@ -12,10 +12,7 @@ class PoolingOp : public Kernel {
         void *const yData = (op->getOutput()->getRawDataPtr<void *>());
 
         if (op->getOpType() == OpType::MaxPool) {
-            // get workspace
-            uint64_t workspace_size = 0;
-            CHECK_ERROR(infiniopGetMaxPoolWorkspaceSize(
-                (infiniopMaxPoolDescriptor_t)op->getOpDesc(), &workspace_size));
+            uint64_t workspace_size = op->getDescWorkspaceSize();
             IT_ASSERT(workspace_size <= context->getWorkspaceSize());
             void *workspace = context->getWorkspace(workspace_size);
 
@@ -24,10 +21,7 @@ class PoolingOp : public Kernel {
                 (infiniopMaxPoolDescriptor_t)op->getOpDesc(), workspace,
                 workspace_size, yData, xData, context->getCurrentStream()));
         } else if (op->getOpType() == OpType::AveragePool) {
-            // get workspace
-            uint64_t workspace_size = 0;
-            CHECK_ERROR(infiniopGetAvgPoolWorkspaceSize(
-                (infiniopAvgPoolDescriptor_t)op->getOpDesc(), &workspace_size));
+            uint64_t workspace_size = op->getDescWorkspaceSize();
             IT_ASSERT(workspace_size <= context->getWorkspaceSize());
             void *workspace = context->getWorkspace(workspace_size);
 
@@ -12,9 +12,7 @@ class ReduceOp : public Kernel {
         void *const dst = (op->getOutput()->getRawDataPtr<void *>());
         
         if (op->getOpType() == OpType::ReduceMax) {
-            uint64_t workspace_size = 0;
-            CHECK_ERROR(infiniopGetReduceMaxWorkspaceSize(
-                (infiniopReduceMaxDescriptor_t)op->getOpDesc(), &workspace_size));
+            uint64_t workspace_size = op->getDescWorkspaceSize();
             IT_ASSERT(workspace_size <= context->getWorkspaceSize());
             void *workspace = context->getWorkspace(workspace_size);
             CHECK_ERROR(infiniopReduceMax(
@@ -22,9 +20,7 @@ class ReduceOp : public Kernel {
                 dst, xData, context->getCurrentStream()));
         } 
         else if (op->getOpType() == OpType::ReduceMin) {
-            uint64_t workspace_size = 0;
-            CHECK_ERROR(infiniopGetReduceMinWorkspaceSize(
-                (infiniopReduceMinDescriptor_t)op->getOpDesc(), &workspace_size));
+            uint64_t workspace_size = op->getDescWorkspaceSize();
             IT_ASSERT(workspace_size <= context->getWorkspaceSize());
             void *workspace = context->getWorkspace(workspace_size);
             CHECK_ERROR(infiniopReduceMin(
@@ -32,9 +28,7 @@ class ReduceOp : public Kernel {
                 dst, xData, context->getCurrentStream()));
         }         
         else if (op->getOpType() == OpType::ReduceMean) {
-            uint64_t workspace_size = 0;
-            CHECK_ERROR(infiniopGetReduceMeanWorkspaceSize(
-                (infiniopReduceMeanDescriptor_t)op->getOpDesc(), &workspace_size));
+            uint64_t workspace_size = op->getDescWorkspaceSize();
             IT_ASSERT(workspace_size <= context->getWorkspaceSize());
             void *workspace = context->getWorkspace(workspace_size);
             CHECK_ERROR(infiniopReduceMean(
@@ -42,9 +36,7 @@ class ReduceOp : public Kernel {
                 dst, xData, context->getCurrentStream()));
         }         
         else if (op->getOpType() == OpType::ReduceSum) {
-            uint64_t workspace_size = 0;
-            CHECK_ERROR(infiniopGetReduceSumWorkspaceSize(
-                (infiniopReduceSumDescriptor_t)op->getOpDesc(), &workspace_size));
+            uint64_t workspace_size = op->getDescWorkspaceSize();
             IT_ASSERT(workspace_size <= context->getWorkspaceSize());
             void *workspace = context->getWorkspace(workspace_size);
             CHECK_ERROR(infiniopReduceSum(
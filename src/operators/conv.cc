@@ -41,7 +41,8 @@ vector<int> ConvBaseObj::getWorkloadVector() const {
 
 vector<int> ConvBaseObj::getOpAttrVector() const {
     // IT_TODO_HALT(); // should padding mode / ph+pw be in attrs?
-    return {type.underlying(), c, f, r, s, ph, pw, sh, sw, dh, dw};
+    return {type.underlying(), c, f, r, s, ph, pw, sh, sw, dh, dw,
+            enum_to_underlying(act)};
 }
 
 void ConvObj::setAuxilaryAttributes(PaddingMode mode) {
@@ -14,6 +14,8 @@ void ElementWiseObj::initInfiniOp(const Runtime context) {
     auto c_dim = outputs[0]->getDims();
 
     if (type == OpType::Add) {
+        if (reuseInfiniOpDesc(context))
+            return;
         auto a_shape = toInfiniopShape(a_dim);
         auto b_shape = toInfiniopShape(b_dim);
         auto c_shape = toInfiniopShape(c_dim);
@@ -39,6 +41,10 @@ void ElementWiseObj::initInfiniOp(const Runtime context) {
         CHECK_ERROR(infiniopDestroyTensorDescriptor(a_tensor));
         CHECK_ERROR(infiniopDestroyTensorDescriptor(b_tensor));
         CHECK_ERROR(infiniopDestroyTensorDescriptor(c_tensor));
+        cacheInfiniOpDesc([](void *desc) {
+            CHECK_ERROR(infiniopDestroyAddDescriptor(
+                (infiniopAddDescriptor_t)desc));
+        });
     } else {
         opDesc = nullptr;
     }
@@ -0,0 +1,86 @@
+#include "operators/fused_element_wise.h"
+#include "utils/operator_utils.h"
+
+namespace infini {
+FusedElementWiseObj::FusedElementWiseObj(GraphObj *graph, TensorVec inputs,
+                                         Tensor output, vector<Instr> program)
+    : OperatorObj(OpType::FusedElementWise, inputs, {output}),
+      program(std::move(program)) {
+    IT_ASSERT(!this->program.empty());
+    int reg = inputs.size();
+    for (auto &instr : this->program) {
+        IT_ASSERT(isSupported(instr.type));
+        IT_ASSERT(instr.a >= 0 && instr.a < reg && instr.b < reg);
+        IT_ASSERT((instr.b >= 0) == instr.type.isBinary());
+        ++reg;
+    }
+    IT_ASSERT(checkValid(graph));
+}
+
+bool FusedElementWiseObj::isSupported(OpType type) {
+    switch (type.underlying()) {
+    case OpType::Add:
+    case OpType::Sub:
+    case OpType::Mul:
+    case OpType::Div:
+    case OpType::Relu:
+    case OpType::Sigmoid:
+    case OpType::Tanh:
+    case OpType::Gelu:
+    case OpType::Silu:
+    case OpType::HardSigmoid:
+    case OpType::HardSwish:
+    case OpType::Abs:
+    case OpType::Neg:
+    case OpType::Sqrt:
+    case OpType::Exp:
+    case OpType::Erf:
+        return true;
+    default:
+        return false;
+    }
+}
+
+optional<vector<Shape>>
+FusedElementWiseObj::inferShape(const TensorVec &inputs) {
+    Shape res = inputs[0]->getDims();
+    for (size_t i = 1; i < inputs.size(); ++i)
+        res = infer_broadcast(res, inputs[i]->getDims());
+    return {{res}};
+}
+
+std::string FusedElementWiseObj::toString() const {
+    std::ostringstream os;
+    os << "FusedElementWise[" << getGuid() << "](";
+    for (size_t i = 0; i < program.size(); ++i) {
+        auto &instr = program[i];
+        os << "r" << inputs.size() + i << "=" << instr.type.toString() << "(r"
+           << instr.a;
+        if (instr.b >= 0)
+            os << ",r" << instr.b;
+        os << "),";
+    }
+    for (size_t i = 0; i < inputs.size(); ++i)
+        os << "input" << i << "=" << inputs[i]->getGuid() << ",";
+    os << "output=" << outputs[0]->getGuid() << ")";
+    return os.str();
+}
+
+vector<int> FusedElementWiseObj::getWorkloadVector() const {
+    vector<int> ret = getOpAttrVector();
+    auto dims = outputs[0]->getDims();
+    ret.insert(ret.end(), dims.begin(), dims.end());
+    return ret;
+}
+
+vector<int> FusedElementWiseObj::getOpAttrVector() const {
+    vector<int> ret{type.underlying()};
+    for (auto &instr : program) {
+        ret.emplace_back(instr.type.underlying());
+        ret.emplace_back(instr.a);
+        ret.emplace_back(instr.b);
+    }
+    return ret;
+}
+
+} // namespace infini
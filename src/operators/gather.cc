@@ -10,6 +10,8 @@ GatherObj::GatherObj(GraphObj *graph, Tensor input, Tensor indices,
     IT_ASSERT(checkValid(graph));
 }
 void GatherObj::initInfiniOp(const Runtime context) {
+    if (reuseInfiniOpDesc(context))
+        return;
     auto x_dim = inputs[0]->getDims();
     auto indice_dim = inputs[1]->getDims();
     auto y_dim = outputs[0]->getDims();
@@ -36,6 +38,10 @@ void GatherObj::initInfiniOp(const Runtime context) {
         CHECK_ERROR(infiniopCreateGatherDescriptor(
             context->opHandle(), (infiniopGatherDescriptor_t *)&opDesc,
             y_tensor, x_tensor, indice_tensor, this->axis));
+        cacheInfiniOpDesc([](void *desc) {
+            CHECK_ERROR(infiniopDestroyGatherDescriptor(
+                (infiniopGatherDescriptor_t)desc));
+        });
     }else {
         opDesc = nullptr;
     }
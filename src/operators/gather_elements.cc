@@ -11,6 +11,8 @@ GatherElementsObj::GatherElementsObj(GraphObj *graph, Tensor input,
 }
 
 void GatherElementsObj::initInfiniOp(const Runtime context) {
+    if (reuseInfiniOpDesc(context))
+        return;
     auto x_dim = inputs[0]->getDims();
     auto indice_dim = inputs[1]->getDims();
     auto y_dim = outputs[0]->getDims();
@@ -38,6 +40,10 @@ void GatherElementsObj::initInfiniOp(const Runtime context) {
         CHECK_ERROR(infiniopCreateGatherElementsDescriptor(
             context->opHandle(), (infiniopGatherElementsDescriptor_t *)&opDesc,
             y_tensor, x_tensor, indice_tensor, this->axis));
+        cacheInfiniOpDesc([](void *desc) {
+            CHECK_ERROR(infiniopDestroyGatherElementsDescriptor(
+                (infiniopGatherElementsDescriptor_t)desc));
+        });
     }else {
         opDesc = nullptr;
     }
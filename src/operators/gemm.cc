@@ -1,5 +1,6 @@
 #include "operators/gemm.h"
 #include "utils/operator_utils.h"
+#include <cstring>
 #include <numeric>
 
 namespace infini {
@@ -22,6 +23,8 @@ string GemmObj::toString() const {
 }
 
 void GemmObj::initInfiniOp(const Runtime context) {
+    if (reuseInfiniOpDesc(context))
+        return;
     auto a_dim = inputs[0]->getDims();
     auto b_dim = inputs[1]->getDims();
     auto c_dim = inputs.size() == 3 ? inputs[2]->getDims() : Shape{};
@@ -61,6 +64,16 @@ void GemmObj::initInfiniOp(const Runtime context) {
     CHECK_ERROR(infiniopDestroyTensorDescriptor(a_tensor));
     CHECK_ERROR(infiniopDestroyTensorDescriptor(b_tensor));
     CHECK_ERROR(infiniopDestroyTensorDescriptor(c_tensor));
+
+    uint64_t workspace_size = 0;
+    CHECK_ERROR(infiniopGetGEMMWorkspaceSize((infiniopGEMMDescriptor_t)opDesc,
+                                             &workspace_size));
+    cacheInfiniOpDesc(
+        [](void *desc) {
+            CHECK_ERROR(
+                infiniopDestroyGEMMDescriptor((infiniopGEMMDescriptor_t)desc));
+        },
+        workspace_size);
 }
 
 optional<vector<Shape>> GemmObj::inferShape(const TensorVec &inputs) {
@@ -78,7 +91,11 @@ vector<int> GemmObj::getWorkloadVector() const {
 }
 
 vector<int> GemmObj::getOpAttrVector() const {
-    return {type.underlying(), transA, transB};
+    // alpha and beta are kept by bit pattern.
+    int alphaBits, betaBits;
+    std::memcpy(&alphaBits, &alpha, sizeof(alphaBits));
+    std::memcpy(&betaBits, &beta, sizeof(betaBits));
+    return {type.underlying(), transA, transB, alphaBits, betaBits};
 }
 
 } // namespace infini
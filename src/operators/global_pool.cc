@@ -13,6 +13,8 @@ void GlobalPoolObj::initInfiniOp(const Runtime context) {
     auto y_dim = outputs[0]->getDims();
 
     if (type == OpType::GlobalAveragePool) {
+        if (reuseInfiniOpDesc(context))
+            return;
         auto x_shape = toInfiniopShape(x_dim);
         auto y_shape = toInfiniopShape(y_dim);
         // create tensor descriptor
@@ -28,6 +30,10 @@ void GlobalPoolObj::initInfiniOp(const Runtime context) {
         CHECK_ERROR(infiniopCreateGlobalAvgPoolDescriptor(
             context->opHandle(), (infiniopGlobalAvgPoolDescriptor_t *)&opDesc,
             y_tensor, x_tensor));
+        cacheInfiniOpDesc([](void *desc) {
+            CHECK_ERROR(infiniopDestroyGlobalAvgPoolDescriptor(
+                (infiniopGlobalAvgPoolDescriptor_t)desc));
+        });
 
         // 销毁
         CHECK_ERROR(infiniopDestroyTensorDescriptor(x_tensor));
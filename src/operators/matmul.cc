@@ -6,10 +6,25 @@ namespace infini {
 
 MatmulObj::MatmulObj(GraphObj *graph, Tensor A, Tensor B, Tensor C, bool transA,
                      bool transB, [[maybe_unused]] Tensor bias, ActType act,
-                     std::string computeType)
+                     std::string computeType, Tensor residual)
     : OperatorObj(OpType::MatMul,
                   bias ? TensorVec{A, B, bias} : TensorVec{A, B}, {C}),
-      transA(transA), transB(transB), act(act), b(1), computeType(computeType) {
+      transA(transA), transB(transB), act(act), hasResidual(residual), b(1),
+      computeType(computeType) {
+    if (residual)
+        inputs.emplace_back(residual);
+    IT_ASSERT(checkValid(graph));
+}
+
+MatmulObj::MatmulObj(GraphObj *graph, Tensor A, Tensor B, TensorVec outputs,
+                     vector<int> splitN, bool transA, bool transB, Tensor bias,
+                     ActType act, std::string computeType)
+    : OperatorObj(OpType::MatMul,
+                  bias ? TensorVec{A, B, bias} : TensorVec{A, B},
+                  outputs.empty() ? TensorVec(splitN.size()) : outputs),
+      transA(transA), transB(transB), act(act), hasResidual(false), b(1),
+      computeType(computeType), splitN(splitN) {
+    IT_ASSERT(!splitN.empty());
     IT_ASSERT(checkValid(graph));
 }
 
@@ -17,8 +32,15 @@ string MatmulObj::toString() const {
     std::ostringstream os;
     os << "Matmul([" << (transA ? "A^T" : "A") << "," << (transB ? "B^T" : "B")
        << ",act=" << enum_to_underlying(act) << "],A=" << inputs[0]->getGuid()
-       << ",B=" << inputs[1]->getGuid() << ",C=" << outputs[0]->getGuid()
-       << ",bmnk=[" << b << "," << m << "," << n << "," << k << "])"
+       << ",B=" << inputs[1]->getGuid();
+    if (auto bias = getBias())
+        os << ",bias=" << bias->getGuid();
+    if (auto residual = getResidual())
+        os << ",residual=" << residual->getGuid();
+    os << ",C=" << outputs[0]->getGuid();
+    for (size_t i = 1; i < outputs.size(); ++i)
+        os << "|" << outputs[i]->getGuid();
+    os << ",bmnk=[" << b << "," << m << "," << n << "," << k << "])"
        << ",computeType=" << computeType;
     return os.str();
 }
@@ -45,7 +67,18 @@ optional<vector<Shape>> MatmulObj::inferShape(const TensorVec &inputs) {
     k = kA;
     ret.emplace_back(m);
     ret.emplace_back(n);
-    return {{ret}};
+    if (hasResidual && inputs.back()->getDims() != ret)
+        return {};
+    if (splitN.empty())
+        return {{ret}};
+    if (std::accumulate(splitN.begin(), splitN.end(), 0) != n)
+        return {};
+    vector<Shape> shapes;
+    for (int cols : splitN) {
+        ret.back() = cols;
+        shapes.emplace_back(ret);
+    }
+    return shapes;
 }
 
 vector<int> MatmulObj::getWorkloadVector() const {
@@ -54,7 +87,14 @@ vector<int> MatmulObj::getWorkloadVector() const {
 }
 
 vector<int> MatmulObj::getOpAttrVector() const {
-    return {type.underlying(), transA, transB, enum_to_underlying(act)};
+    vector<int> ret{type.underlying(), transA, transB,
+                    enum_to_underlying(act), hasResidual};
+    // The compute type changes the arithmetic, so MatMuls that differ only
+    // in it must not be merged. It is stored length-prefixed before splitN.
+    ret.emplace_back(computeType.size());
+    ret.insert(ret.end(), computeType.begin(), computeType.end());
+    ret.insert(ret.end(), splitN.begin(), splitN.end());
+    return ret;
 }
 
 } // namespace infini
@@ -15,6 +15,8 @@ PoolingObj::PoolingObj(GraphObj *graph, OpType optype, Tensor input,
 }
 
 void PoolingObj::initInfiniOp(const Runtime context) {
+    if (reuseInfiniOpDesc(context))
+        return;
     auto x_dim = inputs[0]->getDims();
     auto y_dim = outputs[0]->getDims();
 
@@ -40,10 +42,28 @@ void PoolingObj::initInfiniOp(const Runtime context) {
         CHECK_ERROR(infiniopCreateMaxPoolDescriptor(
             context->opHandle(), (infiniopMaxPoolDescriptor_t *)&opDesc,
             y_tensor, x_tensor, kernel_shape, pads, strides, 2));
+        uint64_t workspace_size = 0;
+        CHECK_ERROR(infiniopGetMaxPoolWorkspaceSize(
+            (infiniopMaxPoolDescriptor_t)opDesc, &workspace_size));
+        cacheInfiniOpDesc(
+            [](void *desc) {
+                CHECK_ERROR(infiniopDestroyMaxPoolDescriptor(
+                    (infiniopMaxPoolDescriptor_t)desc));
+            },
+            workspace_size);
     } else if (type == OpType::AveragePool) {
         CHECK_ERROR(infiniopCreateAvgPoolDescriptor(
             context->opHandle(), (infiniopAvgPoolDescriptor_t *)&opDesc,
             y_tensor, x_tensor, kernel_shape, pads, strides, 2));
+        uint64_t workspace_size = 0;
+        CHECK_ERROR(infiniopGetAvgPoolWorkspaceSize(
+            (infiniopAvgPoolDescriptor_t)opDesc, &workspace_size));
+        cacheInfiniOpDesc(
+            [](void *desc) {
+                CHECK_ERROR(infiniopDestroyAvgPoolDescriptor(
+                    (infiniopAvgPoolDescriptor_t)desc));
+            },
+            workspace_size);
     } else {
         opDesc = nullptr;
     }
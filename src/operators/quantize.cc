@@ -0,0 +1,298 @@
+#include "operators/quantize.h"
+#include "utils/operator_utils.h"
+
+namespace infini {
+// Check that the scale of a Quantize/DequantizeLinear is a scalar, a 1-D
+// tensor along `axis`, or a blocked tensor along `axis`.
+static bool checkQuantParams(const Shape &dims, const Tensor &scale, int axis,
+                             int blockSize) {
+    auto shape = scale->getDims();
+    if (blockSize > 0) {
+        if (shape.size() != dims.size())
+            return false;
+        for (size_t i = 0; i < dims.size(); ++i) {
+            int expect = int(i) == axis
+                             ? (dims[i] + blockSize - 1) / blockSize
+                             : dims[i];
+            if (shape[i] != expect)
+                return false;
+        }
+        return true;
+    }
+    return scale->size() == 1 || (shape.size() == 1 && shape[0] == dims[axis]);
+}
+
+// ONNX ignores `axis` for a per-tensor scale, where it may be out of range
+// (the default axis 1 of a 1-D bias); such operators store axis 0.
+static int realAxis(int axis, const Tensor &input, const Tensor &scale,
+                    int blockSize) {
+    if (blockSize == 0 && scale->size() == 1)
+        return 0;
+    return get_real_axis(axis, input->getRank());
+}
+
+QuantizeLinearObj::QuantizeLinearObj(GraphObj *graph, Tensor input,
+                                     Tensor scale, Tensor zeroPoint,
+                                     Tensor output, int axis_, int blockSize)
+    : OperatorObj(OpType::QuantizeLinear,
+                  zeroPoint ? TensorVec{input, scale, zeroPoint}
+                            : TensorVec{input, scale},
+                  {output}),
+      blockSize(blockSize) {
+    axis = realAxis(axis_, input, scale, blockSize);
+    if (zeroPoint)
+        IT_ASSERT(zeroPoint->getDims() == scale->getDims());
+    IT_ASSERT(checkValid(graph));
+}
+
+optional<vector<Shape>> QuantizeLinearObj::inferShape(const TensorVec &inputs) {
+    auto dims = inputs[0]->getDims();
+    if (!checkQuantParams(dims, inputs[1], axis, blockSize))
+        return {};
+    return {{dims}};
+}
+
+vector<DataType>
+QuantizeLinearObj::inferDataType(const TensorVec &inputs) const {
+    return {inputs.size() > 2 ? inputs[2]->getDType() : DataType::UInt8};
+}
+
+std::string QuantizeLinearObj::toString() const {
+    std::ostringstream os;
+    os << type.toString() << "[" << getGuid() << "]";
+    os << "(";
+    os << vecToString(inputs[0]->getDims()) << ",";
+    os << "axis=" << axis << ",";
+    os << "blockSize=" << blockSize << ",";
+    os << "input=" << inputs[0]->getGuid() << ",";
+    os << "scale=" << inputs[1]->getGuid() << ",";
+    os << "output=" << outputs[0]->getGuid() << ")";
+    return os.str();
+}
+
+vector<int> QuantizeLinearObj::getWorkloadVector() const {
+    vector<int> ret = inputs[0]->getDims();
+    ret.emplace(ret.begin(), type.underlying());
+    ret.emplace_back(axis);
+    ret.emplace_back(blockSize);
+    return ret;
+}
+
+vector<int> QuantizeLinearObj::getOpAttrVector() const {
+    return {type.underlying(), axis, blockSize};
+}
+
+DequantizeLinearObj::DequantizeLinearObj(GraphObj *graph, Tensor input,
+                                         Tensor scale, Tensor zeroPoint,
+                                         Tensor output, int axis_,
+                                         int blockSize)
+    : OperatorObj(OpType::DequantizeLinear,
+                  zeroPoint ? TensorVec{input, scale, zeroPoint}
+                            : TensorVec{input, scale},
+                  {output}),
+      blockSize(blockSize) {
+    axis = realAxis(axis_, input, scale, blockSize);
+    if (zeroPoint)
+        IT_ASSERT(zeroPoint->getDims() == scale->getDims());
+    IT_ASSERT(checkValid(graph));
+}
+
+optional<vector<Shape>>
+DequantizeLinearObj::inferShape(const TensorVec &inputs) {
+    auto dims = inputs[0]->getDims();
+    if (!checkQuantParams(dims, inputs[1], axis, blockSize))
+        return {};
+    return {{dims}};
+}
+
+vector<DataType>
+DequantizeLinearObj::inferDataType(const TensorVec &inputs) const {
+    return {inputs[1]->getDType()};
+}
+
+std::string DequantizeLinearObj::toString() const {
+    std::ostringstream os;
+    os << type.toString() << "[" << getGuid() << "]";
+    os << "(";
+    os << vecToString(inputs[0]->getDims()) << ",";
+    os << "axis=" << axis << ",";
+    os << "blockSize=" << blockSize << ",";
+    os << "input=" << inputs[0]->getGuid() << ",";
+    os << "scale=" << inputs[1]->getGuid() << ",";
+    os << "output=" << outputs[0]->getGuid() << ")";
+    return os.str();
+}
+
+vector<int> DequantizeLinearObj::getWorkloadVector() const {
+    vector<int> ret = inputs[0]->getDims();
+    ret.emplace(ret.begin(), type.underlying());
+    ret.emplace_back(axis);
+    ret.emplace_back(blockSize);
+    return ret;
+}
+
+vector<int> DequantizeLinearObj::getOpAttrVector() const {
+    return {type.underlying(), axis, blockSize};
+}
+
+QuantizedMatmulObj::QuantizedMatmulObj(GraphObj *graph, Tensor A, Tensor B,
+                                       Tensor scale, Tensor zeroPoint,
+                                       Tensor C, int bits, int groupSize)
+    : OperatorObj(OpType::QuantizedMatMul,
+                  zeroPoint ? TensorVec{A, B, scale, zeroPoint}
+                            : TensorVec{A, B, scale},
+                  {C}),
+      bits(bits), groupSize(groupSize) {
+    IT_ASSERT(bits == 8 || bits == 4, "Only 8-bit and 4-bit weights.");
+    IT_ASSERT(B->getDType() ==
+              (bits == 8 ? DataType::Int8 : DataType::UInt8));
+    if (zeroPoint) {
+        IT_ASSERT(zeroPoint->getDType() == B->getDType());
+        IT_ASSERT(zeroPoint->getDims() == scale->getDims());
+    }
+    IT_ASSERT(checkValid(graph));
+}
+
+optional<vector<Shape>>
+QuantizedMatmulObj::inferShape(const TensorVec &inputs) {
+    auto shapeA = inputs[0]->getDims();
+    auto shapeB = inputs[1]->getDims();
+    auto shapeScale = inputs[2]->getDims();
+    if (shapeA.size() < 2 || shapeB.size() != 2 || shapeScale.size() != 2)
+        return {};
+    k = shapeA.back();
+    n = shapeB[0];
+    m = inputs[0]->size() / k;
+    if (shapeB[1] * (8 / bits) != k || groupSize <= 0 || k % groupSize != 0 ||
+        (bits == 4 && groupSize % 2 != 0))
+        return {};
+    if (shapeScale[0] != n || shapeScale[1] != k / groupSize)
+        return {};
+    Shape ret = shapeA;
+    ret.back() = n;
+    return {{ret}};
+}
+
+std::string QuantizedMatmulObj::toString() const {
+    std::ostringstream os;
+    os << "QuantizedMatmul([int" << bits << ",group=" << groupSize
+       << "],A=" << inputs[0]->getGuid() << ",B=" << inputs[1]->getGuid()
+       << ",C=" << outputs[0]->getGuid() << ",mnk=[" << m << "," << n << ","
+       << k << "])";
+    return os.str();
+}
+
+vector<int> QuantizedMatmulObj::getWorkloadVector() const {
+    return {type.underlying(), m, n, k, bits, groupSize};
+}
+
+vector<int> QuantizedMatmulObj::getOpAttrVector() const {
+    return {type.underlying(), bits, groupSize};
+}
+
+static bool isInt8(const Tensor &t) {
+    return t->getDType() == DataType::UInt8 || t->getDType() == DataType::Int8;
+}
+
+QLinearMatmulObj::QLinearMatmulObj(GraphObj *graph, TensorVec inputs,
+                                   Tensor output, bool transB)
+    : OperatorObj(OpType::QLinearMatMul, inputs, {output}), transB(transB) {
+    IT_ASSERT(inputs.size() == 8);
+    IT_ASSERT(isInt8(inputs[0]) && isInt8(inputs[3]) && isInt8(inputs[7]));
+    IT_ASSERT(inputs[1]->size() == 1 && inputs[6]->size() == 1);
+    IT_ASSERT(checkValid(graph));
+}
+
+optional<vector<Shape>> QLinearMatmulObj::inferShape(const TensorVec &inputs) {
+    auto shapeA = inputs[0]->getDims();
+    auto shapeB = inputs[3]->getDims();
+    if (shapeA.size() < 2 || shapeB.size() != 2 ||
+        shapeA.back() != shapeB[transB])
+        return {};
+    k = shapeB[transB];
+    n = shapeB[!transB];
+    m = inputs[0]->size() / k;
+    if (inputs[4]->size() != 1 && inputs[4]->size() != size_t(n))
+        return {};
+    Shape ret = shapeA;
+    ret.back() = n;
+    return {{ret}};
+}
+
+vector<DataType>
+QLinearMatmulObj::inferDataType(const TensorVec &inputs) const {
+    return {inputs[7]->getDType()};
+}
+
+std::string QLinearMatmulObj::toString() const {
+    std::ostringstream os;
+    os << "QLinearMatmul(A=" << inputs[0]->getGuid()
+       << ",B=" << inputs[3]->getGuid() << ",Y=" << outputs[0]->getGuid()
+       << ",transB=" << transB << ",mnk=[" << m << "," << n << "," << k << "])";
+    return os.str();
+}
+
+vector<int> QLinearMatmulObj::getWorkloadVector() const {
+    return {type.underlying(), m, n, k, transB};
+}
+
+vector<int> QLinearMatmulObj::getOpAttrVector() const {
+    return {type.underlying(), transB};
+}
+
+QLinearConvObj::QLinearConvObj(GraphObj *graph, TensorVec inputs,
+                               Tensor output, int ph, int pw, int sh, int sw,
+                               int dh, int dw)
+    : OperatorObj(OpType::QLinearConv, inputs, {output}), ph(ph), pw(pw),
+      sh(sh), sw(sw), dh(dh), dw(dw) {
+    IT_ASSERT(inputs.size() == 8 || inputs.size() == 9);
+    IT_ASSERT(isInt8(inputs[0]) && isInt8(inputs[3]) && isInt8(inputs[7]));
+    IT_ASSERT(inputs[1]->size() == 1 && inputs[6]->size() == 1);
+    if (inputs.size() == 9)
+        IT_ASSERT(inputs[8]->getDType() == DataType::Int32);
+    IT_ASSERT(checkValid(graph));
+}
+
+optional<vector<Shape>> QLinearConvObj::inferShape(const TensorVec &inputs) {
+    auto x = inputs[0]->getDims(), w = inputs[3]->getDims();
+    if (x.size() != 4 || w.size() != 4 || x[1] % w[1] != 0)
+        return {};
+    int f = w[0];
+    if (inputs[4]->size() != 1 && inputs[4]->size() != size_t(f))
+        return {};
+    int oh = (x[2] + 2 * ph - dh * (w[2] - 1) - 1) / sh + 1;
+    int ow = (x[3] + 2 * pw - dw * (w[3] - 1) - 1) / sw + 1;
+    return {{{x[0], f, oh, ow}}};
+}
+
+vector<DataType> QLinearConvObj::inferDataType(const TensorVec &inputs) const {
+    return {inputs[7]->getDType()};
+}
+
+std::string QLinearConvObj::toString() const {
+    std::ostringstream os;
+    os << "QLinearConv[" << getGuid() << "]";
+    os << "(";
+    os << "p=[" << ph << "," << pw << "],";
+    os << "s=[" << sh << "," << sw << "],";
+    os << "d=[" << dh << "," << dw << "],";
+    os << "input=" << inputs[0]->getGuid() << ",";
+    os << "weight=" << inputs[3]->getGuid() << ",";
+    os << "output=" << outputs[0]->getGuid() << ")";
+    return os.str();
+}
+
+vector<int> QLinearConvObj::getWorkloadVector() const {
+    vector<int> ret = inputs[0]->getDims();
+    auto w = inputs[3]->getDims();
+    ret.insert(ret.end(), w.begin(), w.end());
+    ret.insert(ret.end(), {ph, pw, sh, sw, dh, dw});
+    ret.emplace(ret.begin(), type.underlying());
+    return ret;
+}
+
+vector<int> QLinearConvObj::getOpAttrVector() const {
+    return {type.underlying(), ph, pw, sh, sw, dh, dw};
+}
+
+} // namespace infini
@@ -19,6 +19,8 @@ ReduceBaseObj::ReduceBaseObj(GraphObj *graph, OpType opType, Tensor input,
 }
 
 void ReduceBaseObj::initInfiniOp(const Runtime context){
+    if (reuseInfiniOpDesc(context))
+        return;
     auto x_dim = inputs[0]->getDims();
     auto y_dim = outputs[0]->getDims();
 
@@ -45,18 +47,54 @@ void ReduceBaseObj::initInfiniOp(const Runtime context){
         CHECK_ERROR(infiniopCreateReduceMeanDescriptor(
             context->opHandle(), (infiniopReduceMeanDescriptor_t *)&opDesc,
             y_tensor, x_tensor, axis, axis_num, getKeepDims()));
+        uint64_t workspace_size = 0;
+        CHECK_ERROR(infiniopGetReduceMeanWorkspaceSize(
+            (infiniopReduceMeanDescriptor_t)opDesc, &workspace_size));
+        cacheInfiniOpDesc(
+            [](void *desc) {
+                CHECK_ERROR(infiniopDestroyReduceMeanDescriptor(
+                    (infiniopReduceMeanDescriptor_t)desc));
+            },
+            workspace_size);
     }else if (type == OpType::ReduceMin) {
         CHECK_ERROR(infiniopCreateReduceMinDescriptor(
             context->opHandle(), (infiniopReduceMinDescriptor_t *)&opDesc,
             y_tensor, x_tensor, axis, axis_num, getKeepDims()));
+        uint64_t workspace_size = 0;
+        CHECK_ERROR(infiniopGetReduceMinWorkspaceSize(
+            (infiniopReduceMinDescriptor_t)opDesc, &workspace_size));
+        cacheInfiniOpDesc(
+            [](void *desc) {
+                CHECK_ERROR(infiniopDestroyReduceMinDescriptor(
+                    (infiniopReduceMinDescriptor_t)desc));
+            },
+            workspace_size);
     }else if (type == OpType::ReduceMax) {
         CHECK_ERROR(infiniopCreateReduceMaxDescriptor(
             context->opHandle(), (infiniopReduceMaxDescriptor_t *)&opDesc,
             y_tensor, x_tensor, axis, axis_num, getKeepDims()));
+        uint64_t workspace_size = 0;
+        CHECK_ERROR(infiniopGetReduceMaxWorkspaceSize(
+            (infiniopReduceMaxDescriptor_t)opDesc, &workspace_size));
+        cacheInfiniOpDesc(
+            [](void *desc) {
+                CHECK_ERROR(infiniopDestroyReduceMaxDescriptor(
+                    (infiniopReduceMaxDescriptor_t)desc));
+            },
+            workspace_size);
     }else if (type == OpType::ReduceSum) {
         CHECK_ERROR(infiniopCreateReduceSumDescriptor(
             context->opHandle(), (infiniopReduceSumDescriptor_t *)&opDesc,
             y_tensor, x_tensor, axis, axis_num, getKeepDims()));
+        uint64_t workspace_size = 0;
+        CHECK_ERROR(infiniopGetReduceSumWorkspaceSize(
+            (infiniopReduceSumDescriptor_t)opDesc, &workspace_size));
+        cacheInfiniOpDesc(
+            [](void *desc) {
+                CHECK_ERROR(infiniopDestroyReduceSumDescriptor(
+                    (infiniopReduceSumDescriptor_t)desc));
+            },
+            workspace_size);
     }else {
         opDesc = nullptr;
     }
@@ -2,8 +2,8 @@
 
 namespace infini {
 RMSNormObj::RMSNormObj(GraphObj *graph, Tensor input, Tensor weight,
-                       Tensor output)
-    : OperatorObj(OpType::RMSNorm, {input, weight}, {output}) {
+                       Tensor output, float eps)
+    : OperatorObj(OpType::RMSNorm, {input, weight}, {output}), eps(eps) {
     IT_ASSERT(checkValid(graph));
 }
 
@@ -19,6 +19,7 @@ std::string RMSNormObj::toString() const {
     os << type.toString() << "[" << getGuid() << "]";
     os << "(";
     os << vecToString(inputs[0]->getDims()) << ",";
+    os << "eps=" << eps << ",";
     os << "input=" << inputs[0]->getGuid() << ",";
     os << "output=" << outputs[0]->getGuid() << ")";
     return os.str();
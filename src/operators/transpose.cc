@@ -49,7 +49,9 @@ vector<int> TransposeObj::getWorkloadVector() const {
 }
 
 vector<int> TransposeObj::getOpAttrVector() const {
-    return {type.underlying()};
+    vector<int> ret = transposePermute;
+    ret.emplace(ret.begin(), type.underlying());
+    return ret;
 }
 
 DepthToSpaceObj::DepthToSpaceObj(GraphObj *graph, Tensor input, Tensor output,
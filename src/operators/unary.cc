@@ -1,4 +1,5 @@
 #include "operators/unary.h"
+#include <cstring>
 
 namespace infini {
 UnaryObj::UnaryObj(OpType type, GraphObj *graph, Tensor input, Tensor output)
@@ -11,6 +12,8 @@ void UnaryObj::initInfiniOp(const Runtime context) {
     auto y_dim = outputs[0]->getDims();
 
     if (type == OpType::Relu) {
+        if (reuseInfiniOpDesc(context))
+            return;
         auto x_shape = toInfiniopShape(x_dim);
         auto y_shape = toInfiniopShape(y_dim);
         // create tensor descriptor
@@ -27,6 +30,10 @@ void UnaryObj::initInfiniOp(const Runtime context) {
         CHECK_ERROR(infiniopCreateReluDescriptor(
             context->opHandle(), (infiniopReluDescriptor_t *)&opDesc, y_tensor,
             x_tensor));
+        cacheInfiniOpDesc([](void *desc) {
+            CHECK_ERROR(infiniopDestroyReluDescriptor(
+                (infiniopReluDescriptor_t)desc));
+        });
 
         // destroy tensor descriptor
         CHECK_ERROR(infiniopDestroyTensorDescriptor(x_tensor));
@@ -67,6 +74,8 @@ ClipObj::ClipObj(GraphObj *graph, Tensor input, Tensor output,
     IT_ASSERT(checkValid(graph));
 }
 void ClipObj::initInfiniOp(const Runtime context) {
+    if (reuseInfiniOpDesc(context))
+        return;
     auto x_dim = inputs[0]->getDims();
     auto y_dim = outputs[0]->getDims();
 
@@ -87,6 +96,10 @@ void ClipObj::initInfiniOp(const Runtime context) {
         CHECK_ERROR(infiniopCreateClipDescriptor(
             context->opHandle(), (infiniopClipDescriptor_t *)&opDesc,
             y_tensor, x_tensor, getMin().value(), getMax().value()));
+        cacheInfiniOpDesc([](void *desc) {
+            CHECK_ERROR(infiniopDestroyClipDescriptor(
+                (infiniopClipDescriptor_t)desc));
+        });
     }else {
         opDesc = nullptr;
     }
@@ -116,7 +129,18 @@ vector<int> ClipObj::getWorkloadVector() const {
     return ret;
 }
 
-vector<int> ClipObj::getOpAttrVector() const { return {type.underlying()}; }
+vector<int> ClipObj::getOpAttrVector() const {
+    // Bounds are kept by bit pattern, each behind a presence flag.
+    vector<int> ret{type.underlying()};
+    for (auto bound : {minValue, maxValue}) {
+        int bits = 0;
+        if (bound)
+            std::memcpy(&bits, &*bound, sizeof(bits));
+        ret.emplace_back(bound.has_value());
+        ret.emplace_back(bits);
+    }
+    return ret;
+}
 
 HardtanhObj::HardtanhObj(GraphObj *graph, Tensor input, Tensor output,
                          float min, float max)
@@ -236,7 +260,9 @@ vector<int> CastObj::getWorkloadVector() const {
     return ret;
 }
 
-vector<int> CastObj::getOpAttrVector() const { return {type.underlying()}; }
+vector<int> CastObj::getOpAttrVector() const {
+    return {type.underlying(), enum_to_underlying(castType)};
+}
 
 DataType CastObj::getOutputDataType() const {
     switch (castType) {
@@ -304,6 +330,8 @@ optional<vector<Shape>> ShapeObj::inferShape(const TensorVec &inputs) {
     return {{{static_cast<int>(inputs[0]->getRank())}}};
 }
 
+vector<int> ShapeObj::getOpAttrVector() const { return {type.underlying()}; }
+
 std::string ShapeObj::toString() const {
     std::ostringstream os;
     os << type.toString() << "[" << getGuid() << "]("
@@ -398,7 +426,9 @@ vector<int> LogObj::getWorkloadVector() const {
     return ret;
 }
 
-vector<int> LogObj::getOpAttrVector() const { return {type.underlying()}; }
+vector<int> LogObj::getOpAttrVector() const {
+    return {type.underlying(), (int)logType};
+}
 
 EluObj::EluObj(GraphObj *graph, Tensor input, Tensor output, float alpha)
     : OperatorObj(OpType::Elu, {input}, {output}), alpha(alpha) {
@@ -11,6 +11,8 @@ WhereObj::WhereObj(GraphObj *graph, Tensor inputX, Tensor inputY,
 }
 
 void WhereObj::initInfiniOp(const Runtime context) {
+    if (reuseInfiniOpDesc(context))
+        return;
     auto x_dim = inputs[0]->getDims();
     auto y_dim = inputs[1]->getDims();
     auto condition_dim = inputs[2]->getDims();
@@ -48,6 +50,10 @@ void WhereObj::initInfiniOp(const Runtime context) {
         CHECK_ERROR(infiniopCreateWhereDescriptor(
             context->opHandle(), (infiniopWhereDescriptor_t *)&opDesc,
             dst_tensor, x_tensor, y_tensor, condition_tensor));
+        cacheInfiniOpDesc([](void *desc) {
+            CHECK_ERROR(infiniopDestroyWhereDescriptor(
+                (infiniopWhereDescriptor_t)desc));
+        });
     }else {
         opDesc = nullptr;
     }
@@ -1,18 +1,35 @@
 #include "utils/data_convert.h"
+#include <cmath>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define INFINI_X86 1
+#endif
 
 namespace infini {
 
 uint16_t float_to_fp16(const float x) {
+    // Round to nearest even, matching _mm256_cvtps_ph, so results do not
+    // depend on whether the host has F16C.
     Uf32 u;
     u.f32 = x;
-    const uint32_t b = u.u32 + 0x00001000;
-    const uint32_t e = (b & 0x7F800000) >> 23;
-    const uint32_t m = b & 0x007FFFFF;
-    return (b & 0x80000000) >> 16 |
-           (e > 112) * ((((e - 112) << 10) & 0x7C00) | m >> 13) |
-           ((e < 113) & (e > 101)) *
-               ((((0x007FF000 + m) >> (125 - e)) + 1) >> 1) |
-           (e > 143) * 0x7FFF;
+    const uint16_t sign = (u.u32 >> 16) & 0x8000;
+    const uint32_t a = u.u32 & 0x7FFFFFFF;
+    if (a >= 0x7F800000) // inf, or NaN kept quiet
+        return sign | 0x7C00 |
+               (a > 0x7F800000) * (0x0200 | ((a >> 13) & 0x03FF));
+    if (a >= 0x477FF000) // rounds past 65504
+        return sign | 0x7C00;
+    if (a >= 0x38800000) { // normal half: rebias, then round at bit 13
+        const uint32_t r = a - 0x38000000;
+        return sign | ((r + 0x0FFF + ((r >> 13) & 1)) >> 13);
+    }
+    if (a <= 0x33000000) // at most half of the smallest subnormal
+        return sign;
+    const uint32_t m = (a & 0x007FFFFF) | 0x00800000;
+    const uint32_t shift = 126 - (a >> 23);
+    const uint32_t h = m >> shift, rem = m & ((1u << shift) - 1),
+                   half = 1u << (shift - 1);
+    return sign | (h + (rem > half || (rem == half && (h & 1))));
 }
 
 float fp16_to_float(const uint16_t x) {
@@ -31,13 +48,105 @@ float fp16_to_float(const uint16_t x) {
 uint16_t float_to_bfp16(const float x) {
     Uf32 u;
     u.f32 = x;
-    return u.u32 >> 16;
+    if (std::isnan(x))
+        return (u.u32 >> 16) | 0x0040; // keep NaN quiet after truncation
+    // round to nearest even
+    return (u.u32 + 0x7FFF + ((u.u32 >> 16) & 1)) >> 16;
 }
 
-float bfp16_to_fp32(const uint16_t x) {
+float bfp16_to_float(const uint16_t x) {
     Uf32 u;
-    u.u32 = x << 16;
+    u.u32 = uint32_t(x) << 16;
     return u.f32;
 }
 
+#ifdef INFINI_X86
+__attribute__((target("avx,f16c"))) static void
+fp16_to_float_f16c(const uint16_t *src, float *dst, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+    }
+    for (; i < n; ++i)
+        dst[i] = fp16_to_float(src[i]);
+}
+
+__attribute__((target("avx,f16c"))) static void
+float_to_fp16_f16c(const float *src, uint16_t *dst, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i),
+                                    _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), h);
+    }
+    for (; i < n; ++i)
+        dst[i] = float_to_fp16(src[i]);
+}
+
+__attribute__((target("avx2"))) static void
+bfp16_to_float_avx2(const uint16_t *src, float *dst, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m256i w = _mm256_slli_epi32(_mm256_cvtepu16_epi32(h), 16);
+        _mm256_storeu_ps(dst + i, _mm256_castsi256_ps(w));
+    }
+    for (; i < n; ++i)
+        dst[i] = bfp16_to_float(src[i]);
+}
+
+__attribute__((target("avx512f,avx512bf16"))) static void
+float_to_bfp16_avx512(const float *src, uint16_t *dst, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256bh h = _mm512_cvtneps_pbh(_mm512_loadu_ps(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i),
+                            reinterpret_cast<__m256i &>(h));
+    }
+    for (; i < n; ++i)
+        dst[i] = float_to_bfp16(src[i]);
+}
+
+static const bool hasF16C = __builtin_cpu_supports("f16c");
+static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+static const bool hasAVX512BF16 = __builtin_cpu_supports("avx512bf16");
+#endif
+
+void fp16_to_float(const uint16_t *src, float *dst, size_t n) {
+#ifdef INFINI_X86
+    if (hasF16C)
+        return fp16_to_float_f16c(src, dst, n);
+#endif
+    for (size_t i = 0; i < n; ++i)
+        dst[i] = fp16_to_float(src[i]);
+}
+
+void float_to_fp16(const float *src, uint16_t *dst, size_t n) {
+#ifdef INFINI_X86
+    if (hasF16C)
+        return float_to_fp16_f16c(src, dst, n);
+#endif
+    for (size_t i = 0; i < n; ++i)
+        dst[i] = float_to_fp16(src[i]);
+}
+
+void bfp16_to_float(const uint16_t *src, float *dst, size_t n) {
+#ifdef INFINI_X86
+    if (hasAVX2)
+        return bfp16_to_float_avx2(src, dst, n);
+#endif
+    for (size_t i = 0; i < n; ++i)
+        dst[i] = bfp16_to_float(src[i]);
+}
+
+void float_to_bfp16(const float *src, uint16_t *dst, size_t n) {
+#ifdef INFINI_X86
+    if (hasAVX512BF16)
+        return float_to_bfp16_avx512(src, dst, n);
+#endif
+    for (size_t i = 0; i < n; ++i)
+        dst[i] = float_to_bfp16(src[i]);
+}
+
 } // namespace infini
@@ -4,49 +4,153 @@
 #ifdef TENSOR_PROTOBUF
 #include "data.pb.h"
 #endif
+#include "utils/mapped_file.h"
+#include <cstring>
 #include <fstream>
 
 namespace infini {
 
-void saveTensorData(TensorObj *tensor, std::string file_path) {
-#ifdef TENSOR_PROTOBUF
-    data::Tensor temp;
-    temp.set_id("tensor_id");
-    for (size_t i = 0; i < tensor->getRank(); ++i) {
-        temp.add_shape(tensor->getDims()[i]);
-    }
-    temp.set_layout(data::LAYOUT_NHWC);
-    if (tensor->getDType() == DataType::Float32) {
-        temp.set_dtype(data::DTYPE_FLOAT);
-        for (size_t i = 0; i < tensor->size(); ++i) {
-            temp.add_data_float((tensor->getDataBlob()->getPtr<float *>())[i]);
-        }
-    } else if (tensor->getDType() == DataType::UInt32) {
-        temp.set_dtype(data::DTYPE_UINT32);
-        for (size_t i = 0; i < tensor->size(); ++i) {
-            temp.add_data_uint32(
-                (tensor->getDataBlob()->getPtr<uint32_t *>())[i]);
-        }
+namespace {
+
+constexpr char npyMagic[] = "\x93NUMPY";
+constexpr size_t npyMagicSize = 6;
+// Largest block copied through the host when the tensor is not on the CPU.
+constexpr size_t stagingBytes = 64 << 20;
+
+string npyDescr(DataType dtype) {
+    static const std::map<int, string> descrs{
+        {DataType::Float32.getIndex(), "<f4"},
+        {DataType::UInt8.getIndex(), "|u1"},
+        {DataType::Int8.getIndex(), "|i1"},
+        {DataType::UInt16.getIndex(), "<u2"},
+        {DataType::Int16.getIndex(), "<i2"},
+        {DataType::Int32.getIndex(), "<i4"},
+        {DataType::Int64.getIndex(), "<i8"},
+        {DataType::Bool.getIndex(), "|b1"},
+        {DataType::Float16.getIndex(), "<f2"},
+        {DataType::Double.getIndex(), "<f8"},
+        {DataType::UInt32.getIndex(), "<u4"},
+        {DataType::UInt64.getIndex(), "<u8"},
+        {DataType::BFloat16.getIndex(), "|V2"}};
+    auto it = descrs.find(dtype.getIndex());
+    IT_ASSERT(it != descrs.end(),
+              "Cannot save a tensor of type " + dtype.toString());
+    return it->second;
+}
+
+string npyHeader(const TensorObj *tensor) {
+    std::ostringstream dict;
+    dict << "{'descr': '" << npyDescr(tensor->getDType())
+         << "', 'fortran_order': False, 'shape': (";
+    for (auto d : tensor->getDims())
+        dict << d << (tensor->getRank() == 1 ? "," : ", ");
+    string text = dict.str();
+    if (tensor->getRank() > 1)
+        text.resize(text.size() - 2);
+    text += "), }";
+    // Pad with spaces and a newline so the payload starts on 64 bytes.
+    size_t prefix = npyMagicSize + 2 + 2;
+    if (prefix + text.size() + 1 > 65535)
+        prefix = npyMagicSize + 2 + 4;
+    size_t total = (prefix + text.size() + 1 + 63) / 64 * 64;
+    text.append(total - prefix - text.size() - 1, ' ');
+    text += '\n';
+    string header(npyMagic, npyMagicSize);
+    uint32_t length = text.size();
+    if (prefix == npyMagicSize + 4) {
+        header += {1, 0};
+        header.append(reinterpret_cast<char *>(&length), 2);
     } else {
-        IT_TODO_HALT();
+        header += {2, 0};
+        header.append(reinterpret_cast<char *>(&length), 4);
     }
+    return header + text;
+}
 
+// The value of `key` in the header dict, up to the next ',' or '}' at
+// nesting level 0.
+string npyField(const string &dict, const string &key) {
+    auto pos = dict.find("'" + key + "'");
+    IT_ASSERT(pos != string::npos, "Missing " + key + " in .npy header");
+    pos = dict.find(':', pos) + 1;
+    size_t end = pos;
+    for (int depth = 0; end < dict.size(); ++end) {
+        char c = dict[end];
+        if (c == '(')
+            ++depth;
+        else if (c == ')')
+            --depth;
+        else if ((c == ',' || c == '}') && depth == 0)
+            break;
+    }
+    auto value = dict.substr(pos, end - pos);
+    value.erase(0, value.find_first_not_of(" '"));
+    value.erase(value.find_last_not_of(" '") + 1);
+    return value;
+}
+
+// Check the header against the tensor and return the payload offset.
+size_t checkNpyHeader(const TensorObj *tensor, const uint8_t *file,
+                      size_t fileSize, const string &file_path) {
+    IT_ASSERT(fileSize >= npyMagicSize + 4 &&
+                  std::memcmp(file, npyMagic, npyMagicSize) == 0,
+              file_path + " is not a .npy file");
+    uint8_t major = file[npyMagicSize];
+    size_t prefix = npyMagicSize + 2 + (major == 1 ? 2 : 4), length = 0;
+    IT_ASSERT(fileSize >= prefix, "Truncated .npy file " + file_path);
+    std::memcpy(&length, file + npyMagicSize + 2, prefix - npyMagicSize - 2);
+    IT_ASSERT(fileSize >= prefix + length,
+              "Truncated .npy file " + file_path);
+    string dict(reinterpret_cast<const char *>(file) + prefix, length);
+
+    auto descr = npyField(dict, "descr");
+    IT_ASSERT(descr == npyDescr(tensor->getDType()),
+              file_path + " holds " + descr + ", not " +
+                  tensor->getDType().toString());
+    IT_ASSERT(npyField(dict, "fortran_order") == "False",
+              "Fortran-ordered .npy files are not supported");
+    Shape shape;
+    auto dims = npyField(dict, "shape");
+    for (size_t i = 0; i < dims.size();) {
+        if (std::isdigit(dims[i])) {
+            size_t used;
+            shape.emplace_back(std::stoi(dims.substr(i), &used));
+            i += used;
+        } else
+            ++i;
+    }
+    IT_ASSERT(shape == tensor->getDims(),
+              file_path + " has shape " + vecToString(shape));
+    IT_ASSERT(fileSize - prefix - length >= tensor->getBytes(),
+              "Truncated .npy file " + file_path);
+    return prefix + length;
+}
+
+} // namespace
+
+void saveTensorData(TensorObj *tensor, std::string file_path) {
     std::ofstream fileout(file_path,
                           std::ios::out | std::ios::trunc | std::ios::binary);
-    bool flag = temp.SerializeToOstream(&fileout);
-    if (!flag) {
-        std::cout << "Failed to write file " + file_path << std::endl;
+    IT_ASSERT(fileout.is_open(), "Cannot open " + file_path);
+    auto header = npyHeader(tensor);
+    fileout.write(header.data(), header.size());
+    auto data = tensor->getRawDataPtr<uint8_t *>();
+    if (tensor->getRuntime()->isCpu())
+        fileout.write(reinterpret_cast<char *>(data), tensor->getBytes());
+    else {
+        vector<uint8_t> staged(std::min(tensor->getBytes(), stagingBytes));
+        for (size_t done = 0; done < tensor->getBytes();) {
+            size_t n = std::min(staged.size(), tensor->getBytes() - done);
+            tensor->getRuntime()->copyBlobToCPU(staged.data(), data + done, n);
+            fileout.write(reinterpret_cast<char *>(staged.data()), n);
+            done += n;
+        }
     }
-    fileout.close();
-#else
-    std::cout << "If you want to use this feature, please turn on USE_PROTOBUF "
-                 "option in the cmake file."
-              << std::endl;
-#endif
+    IT_ASSERT(fileout.good(), "Failed to write " + file_path);
 }
 
-void loadTensorData(TensorObj *tensor, std::string file_path) {
 #ifdef TENSOR_PROTOBUF
+static void loadProtobufTensorData(TensorObj *tensor, std::string file_path) {
     data::Tensor temp;
     std::ifstream filein(file_path, std::ios::in | std::ios::binary);
     bool flag = temp.ParseFromIstream(&filein);
@@ -71,11 +175,59 @@ void loadTensorData(TensorObj *tensor, std::string file_path) {
     }
 
     filein.close();
-#else
-    std::cout << "If you want to use this feature, please turn on USE_PROTOBUF "
-                 "option in the cmake file."
-              << std::endl;
+}
+#endif
+
+void loadTensorData(TensorObj *tensor, std::string file_path, bool useMmap) {
+    char magic[npyMagicSize] = {};
+    std::ifstream filein(file_path, std::ios::in | std::ios::binary);
+    IT_ASSERT(filein.is_open(), "Cannot open " + file_path);
+    filein.read(magic, npyMagicSize);
+#ifdef TENSOR_PROTOBUF
+    if (std::memcmp(magic, npyMagic, npyMagicSize) != 0)
+        return loadProtobufTensorData(tensor, file_path);
 #endif
+    if (useMmap) {
+        MappedFile file(file_path);
+        size_t offset =
+            checkNpyHeader(tensor, file.data(), file.size(), file_path);
+        tensor->copyin(file.data() + offset, tensor->getBytes());
+        return;
+    }
+
+    // The header is short; read a page and more only if it is longer.
+    vector<uint8_t> head(4096);
+    filein.seekg(0);
+    filein.read(reinterpret_cast<char *>(head.data()), head.size());
+    head.resize(filein.gcount());
+    filein.clear();
+    filein.seekg(0, std::ios::end);
+    size_t fileSize = filein.tellg();
+    if (head.size() >= npyMagicSize + 8) {
+        size_t length = 0;
+        std::memcpy(&length, head.data() + npyMagicSize + 2,
+                    head[npyMagicSize] == 1 ? 2 : 4);
+        if (length + npyMagicSize + 6 > head.size()) {
+            head.resize(std::min(fileSize, length + npyMagicSize + 6));
+            filein.seekg(0);
+            filein.read(reinterpret_cast<char *>(head.data()), head.size());
+        }
+    }
+    size_t offset = checkNpyHeader(tensor, head.data(), fileSize, file_path);
+    filein.seekg(offset);
+    auto data = tensor->getRawDataPtr<uint8_t *>();
+    if (tensor->getRuntime()->isCpu())
+        filein.read(reinterpret_cast<char *>(data), tensor->getBytes());
+    else {
+        vector<uint8_t> staged(std::min(tensor->getBytes(), stagingBytes));
+        for (size_t done = 0; done < tensor->getBytes();) {
+            size_t n = std::min(staged.size(), tensor->getBytes() - done);
+            filein.read(reinterpret_cast<char *>(staged.data()), n);
+            tensor->getRuntime()->copyBlobFromCPU(data + done, staged.data(), n);
+            done += n;
+        }
+    }
+    IT_ASSERT(filein.good(), "Truncated .npy file " + file_path);
 }
 
 }; // namespace infini
@@ -0,0 +1,49 @@
+#include "utils/mapped_file.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace infini {
+
+MappedFile::MappedFile(const string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    IT_ASSERT(fd >= 0, "Cannot open " + path);
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        IT_ASSERT(false, "Cannot stat " + path);
+    }
+    bytes = st.st_size;
+    if (bytes > 0) {
+        void *p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                       fd, 0);
+        close(fd);
+        IT_ASSERT(p != MAP_FAILED, "Cannot map " + path);
+        ptr = static_cast<uint8_t *>(p);
+    } else
+        close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (ptr)
+        munmap(ptr, bytes);
+}
+
+void MappedFile::prefetch(size_t offset, size_t length) const {
+    if (offset >= bytes)
+        return;
+    length = std::min(length, bytes - offset);
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t begin = offset / page * page, end = offset + length;
+    madvise(ptr + begin, end - begin, MADV_WILLNEED);
+    long pages = (end - begin + page - 1) / page;
+    uint8_t sum = 0;
+#pragma omp parallel for reduction(^ : sum)
+    for (long i = 0; i < pages; ++i)
+        sum ^= ptr[begin + i * page];
+    // Keep the reads from being optimized out.
+    asm volatile("" : : "r"(sum));
+}
+
+} // namespace infini
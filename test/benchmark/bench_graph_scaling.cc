@@ -0,0 +1,66 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/unary.h"
+#include <chrono>
+
+// Times building, sorting, validating, planning and tearing down graphs of
+// growing size. Operators are added in reverse topological order, the
+// worst case for the sort. Usage: bench_graph_scaling [max ops]
+namespace infini {
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double msSince(Clock::time_point begin) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - begin)
+        .count();
+}
+
+// t[i] = abs(t[i-1]) for odd i, t[i-1] - t[i-2] for even i.
+static void bench(const Runtime &runtime, int n) {
+    auto begin = Clock::now();
+    Graph g = make_ref<GraphObj>(runtime);
+    TensorVec t;
+    for (int i = 0; i <= n; ++i)
+        t.emplace_back(g->addTensor({1, 16}));
+    t.front()->setInput();
+    t.back()->setOutput();
+    for (int i = n; i > 0; --i) {
+        if (i % 2 || i < 2)
+            g->addOpWithOutputs<AbsObj>(t[i - 1], t[i]);
+        else
+            g->addOpWithOutputs<SubObj>(t[i - 1], t[i - 2], t[i]);
+    }
+    double build = msSince(begin);
+
+    begin = Clock::now();
+    IT_ASSERT(g->topo_sort());
+    double sort = msSince(begin);
+    begin = Clock::now();
+    IT_ASSERT(g->checkValid());
+    double check = msSince(begin);
+    begin = Clock::now();
+    g->dataMalloc();
+    double plan = msSince(begin);
+    begin = Clock::now();
+    for (auto &op : OpVec(g->getOperators()))
+        g->eraseOperator(op);
+    for (auto &tensor : TensorVec(g->getTensors()))
+        g->removeTensor(tensor);
+    IT_ASSERT(g->getOperators().empty() && g->getTensors().empty());
+    double teardown = msSince(begin);
+    printf("%8d ops: build %9.2f  sort %9.2f  check %9.2f  plan %9.2f  "
+           "teardown %9.2f ms\n",
+           n, build, sort, check, plan, teardown);
+}
+
+} // namespace infini
+
+int main(int argc, char **argv) {
+    using namespace infini;
+    int maxOps = argc > 1 ? atoi(argv[1]) : 100000;
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    for (int n = 1000; n <= maxOps; n *= 10)
+        bench(runtime, n);
+    return 0;
+}
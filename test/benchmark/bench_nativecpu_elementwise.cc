@@ -0,0 +1,80 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/unary.h"
+#include <chrono>
+
+// Times the native CPU element-wise and unary kernels for each dtype and
+// broadcast pattern. Usage: bench_nativecpu_elementwise [elements] [repeats]
+namespace infini {
+
+static double timeOp(const Runtime &runtime, const Operator &op,
+                     int repeats) {
+    auto kernel = KernelRegistry::getInstance().getKernel(
+        KernelAttrs{runtime->getDevice(), op->getOpType().underlying()});
+    kernel->compute(op, runtime.get());
+    auto begin = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < repeats; ++i)
+        kernel->compute(op, runtime.get());
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - begin).count() /
+           repeats;
+}
+
+template <typename T>
+static void benchBinary(const Runtime &runtime, int n, DataType dtype,
+                        int repeats) {
+    Graph g = make_ref<GraphObj>(runtime);
+    int cols = 1024;
+    auto a = g->addTensor({n / cols, cols}, dtype);
+    auto b = g->addTensor({n / cols, cols}, dtype);
+    auto row = g->addTensor({cols}, dtype);
+    auto scalar = g->addTensor({1}, dtype);
+    auto col = g->addTensor({n / cols, 1}, dtype);
+    auto same = g->addOp<T>(a, b, nullptr);
+    auto bRow = g->addOp<T>(a, row, nullptr);
+    auto bScalar = g->addOp<T>(a, scalar, nullptr);
+    auto bCol = g->addOp<T>(a, col, nullptr);
+    // Buffers come zero-filled from the runtime; values do not matter here.
+    g->dataMalloc();
+    printf("%-8s %-9s same %8.3f  row %8.3f  scalar %8.3f  col %8.3f ms\n",
+           same->getOpType().toString(), dtype.toString().c_str(),
+           timeOp(runtime, same, repeats), timeOp(runtime, bRow, repeats),
+           timeOp(runtime, bScalar, repeats), timeOp(runtime, bCol, repeats));
+}
+
+template <typename T>
+static void benchUnary(const Runtime &runtime, int n, DataType dtype,
+                       int repeats) {
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({n}, dtype);
+    auto op = g->addOp<T>(a, nullptr);
+    g->dataMalloc();
+    printf("%-8s %-9s %8.3f ms\n", op->getOpType().toString(),
+           dtype.toString().c_str(), timeOp(runtime, op, repeats));
+}
+
+} // namespace infini
+
+int main(int argc, char **argv) {
+    using namespace infini;
+    int n = argc > 1 ? atoi(argv[1]) : 1 << 22;
+    int repeats = argc > 2 ? atoi(argv[2]) : 20;
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    printf("elements %d, repeats %d\n", n, repeats);
+    for (auto dtype : {DataType::Float32, DataType::Float16, DataType::Int32,
+                       DataType::Int64, DataType::Int8}) {
+        try {
+            benchBinary<SubObj>(runtime, n, dtype, repeats);
+            benchBinary<MulObj>(runtime, n, dtype, repeats);
+        } catch (const Exception &) {
+            printf("%s: unsupported\n", dtype.toString().c_str());
+        }
+    }
+    for (auto dtype : {DataType::Float32, DataType::Float16}) {
+        benchUnary<SigmoidObj>(runtime, n, dtype, repeats);
+        benchUnary<NegObj>(runtime, n, dtype, repeats);
+    }
+    return 0;
+}
@@ -0,0 +1,60 @@
+#include "core/graph.h"
+#include "core/graph_pass.h"
+#include "core/runtime.h"
+#include "operators/matmul.h"
+#include <chrono>
+
+// Times the Q, K and V projections of one activation on the native CPU
+// runtime, as three MatMuls and after horizontal fusion. Usage:
+// bench_nativecpu_horizontal [tokens] [hidden] [repeats]
+namespace infini {
+
+static Graph qkv(const Runtime &runtime, int tokens, int hidden) {
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({tokens, hidden});
+    x->setInput();
+    for (int i = 0; i < 3; ++i) {
+        auto w = g->addTensor({hidden, hidden});
+        auto bias = g->addTensor(Shape{hidden});
+        w->setWeight();
+        bias->setWeight();
+        g->addOp<MatmulObj>(x, w, nullptr, false, false, bias)
+            ->getOutput()
+            ->setOutput();
+    }
+    return g;
+}
+
+static double timeGraph(const Runtime &runtime, const Graph &g, int repeats) {
+    runtime->run(g);
+    auto begin = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < repeats; ++i)
+        runtime->run(g);
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - begin).count() /
+           repeats;
+}
+
+} // namespace infini
+
+int main(int argc, char **argv) {
+    using namespace infini;
+    int tokens = argc > 1 ? atoi(argv[1]) : 128;
+    int hidden = argc > 2 ? atoi(argv[2]) : 512;
+    int repeats = argc > 3 ? atoi(argv[3]) : 10;
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    printf("tokens %d, hidden %d, repeats %d\n", tokens, hidden, repeats);
+    auto separate = qkv(runtime, tokens, hidden);
+    separate->dataMalloc();
+    // Weights need data before the pass concatenates them; values do not
+    // matter here.
+    auto fused = qkv(runtime, tokens, hidden);
+    fused->dataMalloc();
+    fused->optimize();
+    printf("%zu MatMuls -> %zu operator(s)\n",
+           separate->getOperators().size(), fused->getOperators().size());
+    printf("separate %8.3f ms  fused %8.3f ms\n",
+           timeGraph(runtime, separate, repeats),
+           timeGraph(runtime, fused, repeats));
+    return 0;
+}
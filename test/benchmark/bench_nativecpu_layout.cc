@@ -0,0 +1,89 @@
+#include "core/graph.h"
+#include "core/graph_pass.h"
+#include "core/runtime.h"
+#include "operators/concat.h"
+#include "operators/conv.h"
+#include "operators/element_wise.h"
+#include "operators/unary.h"
+#include <chrono>
+
+// Times ResNet- and Inception-style blocks on the native CPU runtime with
+// NCHW tensors and after the layout assignment pass. Usage:
+// bench_nativecpu_layout [channels] [size] [repeats]
+namespace infini {
+
+static Tensor addConv(const Graph &g, const Tensor &x, int f, int k) {
+    auto w = g->addTensor({f, x->getDims()[1], k, k});
+    w->setWeight();
+    return g->addOp<ConvObj>(x, w, nullptr, k / 2, k / 2)->getOutput();
+}
+
+// Two basic blocks: conv3x3 -> relu -> conv3x3 -> + x -> relu.
+static Graph resnet(const Runtime &runtime, int c, int size) {
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({1, c, size, size});
+    x->setInput();
+    for (int i = 0; i < 2; ++i) {
+        auto y = g->addOp<ReluObj>(addConv(g, x, c, 3), nullptr)->getOutput();
+        y = g->addOp<AddObj>(addConv(g, y, c, 3), x, nullptr)->getOutput();
+        x = g->addOp<ReluObj>(y, nullptr)->getOutput();
+    }
+    x->setOutput();
+    return g;
+}
+
+// 1x1, 3x3 and 5x5 branches concatenated on channels, then a 1x1 conv.
+static Graph inception(const Runtime &runtime, int c, int size) {
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({1, c, size, size});
+    x->setInput();
+    TensorVec branches;
+    for (int k : {1, 3, 5})
+        branches.emplace_back(
+            g->addOp<ReluObj>(addConv(g, x, c / 2, k), nullptr)->getOutput());
+    auto cat = g->addOp<ConcatObj>(branches, nullptr, 1)->getOutput();
+    addConv(g, cat, c, 1)->setOutput();
+    return g;
+}
+
+static double timeGraph(const Runtime &runtime, const Graph &g, int repeats) {
+    runtime->run(g);
+    auto begin = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < repeats; ++i)
+        runtime->run(g);
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - begin).count() /
+           repeats;
+}
+
+static void bench(const Runtime &runtime, const char *name,
+                  Graph (*build)(const Runtime &, int, int), int c, int size,
+                  int repeats) {
+    auto nchw = build(runtime, c, size);
+    nchw->dataMalloc();
+    auto nhwc = build(runtime, c, size);
+    for (auto &[order, pass] : GraphPassRegistry::getInstance().getPasses())
+        if (pass->getName() == "LayoutAssignment") {
+            pass->run(nhwc.get());
+            printf("%-10s %s\n", name, pass->report().c_str());
+        }
+    nhwc->dataMalloc();
+    // Buffers come zero-filled from the runtime; values do not matter here.
+    printf("%-10s NCHW %8.3f ms  NHWC %8.3f ms\n", name,
+           timeGraph(runtime, nchw, repeats),
+           timeGraph(runtime, nhwc, repeats));
+}
+
+} // namespace infini
+
+int main(int argc, char **argv) {
+    using namespace infini;
+    int c = argc > 1 ? atoi(argv[1]) : 64;
+    int size = argc > 2 ? atoi(argv[2]) : 28;
+    int repeats = argc > 3 ? atoi(argv[3]) : 5;
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    printf("channels %d, size %d, repeats %d\n", c, size, repeats);
+    bench(runtime, "resnet", resnet, c, size, repeats);
+    bench(runtime, "inception", inception, c, size, repeats);
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/runtime.h"
+#include "operators/matmul.h"
+#include "operators/quantize.h"
+#include <chrono>
+
+// Times a float MatMul against the weight-only int8 and int4 QuantizedMatMul
+// on the same [M, K] x [K, N] problem. The default M = 1 is the decode GEMV.
+// Usage: bench_nativecpu_quantized_matmul [M] [N] [K] [group] [repeats]
+namespace infini {
+
+static double timeOp(const Runtime &runtime, const Operator &op,
+                     int repeats) {
+    auto kernel = KernelRegistry::getInstance().getKernel(
+        KernelAttrs{runtime->getDevice(), op->getOpType().underlying()});
+    kernel->compute(op, runtime.get());
+    auto begin = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < repeats; ++i)
+        kernel->compute(op, runtime.get());
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - begin).count() /
+           repeats;
+}
+
+static void benchQuantized(const Runtime &runtime, int m, int n, int k,
+                           int bits, int group, int repeats) {
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({m, k});
+    auto b = bits == 8 ? g->addTensor({n, k}, DataType::Int8)
+                       : g->addTensor({n, k / 2}, DataType::UInt8);
+    auto scale = g->addTensor({n, k / group});
+    auto op = g->addOp<QuantizedMatmulObj>(a, b, scale, nullptr, nullptr,
+                                           bits, group);
+    // Buffers come zero-filled from the runtime; values do not matter here.
+    g->dataMalloc();
+    printf("int%-5d %8.3f ms\n", bits, timeOp(runtime, op, repeats));
+}
+
+} // namespace infini
+
+int main(int argc, char **argv) {
+    using namespace infini;
+    int m = argc > 1 ? atoi(argv[1]) : 1;
+    int n = argc > 2 ? atoi(argv[2]) : 4096;
+    int k = argc > 3 ? atoi(argv[3]) : 4096;
+    int group = argc > 4 ? atoi(argv[4]) : 128;
+    int repeats = argc > 5 ? atoi(argv[5]) : 20;
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    printf("M %d, N %d, K %d, group %d, repeats %d\n", m, n, k, group,
+           repeats);
+
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({m, k});
+    auto b = g->addTensor({k, n});
+    auto matmul = g->addOp<MatmulObj>(a, b, nullptr);
+    g->dataMalloc();
+    printf("fp32     %8.3f ms\n", timeOp(runtime, matmul, repeats));
+
+    benchQuantized(runtime, m, n, k, 8, group, repeats);
+    benchQuantized(runtime, m, n, k, 4, group, repeats);
+    return 0;
+}
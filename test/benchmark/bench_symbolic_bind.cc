@@ -0,0 +1,67 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "core/symbolic_shape.h"
+#include "operators/element_wise.h"
+#include "operators/matmul.h"
+#include "operators/unary.h"
+#include <chrono>
+#include <cstdio>
+
+// Times switching a chain of MatMul layers to another sequence length, by
+// shape inference and dataMalloc() and by binding a SymbolicGraph. Usage:
+// bench_symbolic_bind [layers] [switches]
+namespace infini {
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double usSince(Clock::time_point begin) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - begin)
+        .count();
+}
+
+static Graph layers(const Runtime &runtime, int n, Tensor &x) {
+    Graph g = make_ref<GraphObj>(runtime);
+    x = g->addTensor({1, 64});
+    x->setInput();
+    auto h = x;
+    for (int i = 0; i < n; ++i) {
+        auto w = g->addTensor({64, 64});
+        w->setWeight();
+        auto y = g->addOp<MatmulObj>(h, w, nullptr)->getOutput();
+        auto a = g->addOp<AbsObj>(y, nullptr)->getOutput();
+        h = g->addOp<MulObj>(a, h, nullptr)->getOutput();
+    }
+    h->setOutput();
+    g->dataMalloc();
+    return g;
+}
+
+} // namespace infini
+
+int main(int argc, char **argv) {
+    using namespace infini;
+    int n = argc > 1 ? atoi(argv[1]) : 64;
+    int switches = argc > 2 ? atoi(argv[2]) : 200;
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    printf("%d layers, %d switches\n", n, switches);
+
+    Tensor x;
+    auto g = layers(runtime, n, x);
+    auto begin = Clock::now();
+    for (int i = 0; i < switches; ++i) {
+        x->setShape({1 + i % 128, 64});
+        g->shape_infer();
+        g->dataMalloc();
+    }
+    printf("replan %9.2f us per switch\n", usSince(begin) / switches);
+
+    auto s = layers(runtime, n, x);
+    begin = Clock::now();
+    SymbolicGraph sg(s, {{"seq", {{x, 0}}}});
+    printf("specialize %9.2f us\n", usSince(begin));
+    begin = Clock::now();
+    for (int i = 0; i < switches; ++i)
+        sg.bind({1 + i % 128});
+    printf("bind   %9.2f us per switch\n", usSince(begin) / switches);
+    return 0;
+}
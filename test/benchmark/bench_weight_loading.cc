@@ -0,0 +1,68 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "utils/mapped_file.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+// Times giving a graph of large weights their data from a file, by reading
+// it into the weight arena and by mapping it. Usage:
+// bench_weight_loading [MiB] [weights]
+namespace infini {
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double msSince(Clock::time_point begin) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - begin)
+        .count();
+}
+
+static Graph weights(const Runtime &runtime, int n, int floats) {
+    Graph g = make_ref<GraphObj>(runtime);
+    for (int i = 0; i < n; ++i)
+        g->addTensor(Shape{floats})->setWeight();
+    return g;
+}
+
+} // namespace infini
+
+int main(int argc, char **argv) {
+    using namespace infini;
+    size_t mib = argc > 1 ? atoi(argv[1]) : 256;
+    int n = argc > 2 ? atoi(argv[2]) : 64;
+    int floats = mib * 1024 * 1024 / 4 / n;
+    size_t bytes = size_t(floats) * 4;
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    string path = "bench_weights.bin";
+    {
+        vector<float> chunk(floats, 1);
+        std::ofstream out(path, std::ios::binary);
+        for (int i = 0; i < n; ++i)
+            out.write(reinterpret_cast<char *>(chunk.data()), bytes);
+    }
+    printf("%d weights, %zu MiB\n", n, mib);
+
+    auto begin = Clock::now();
+    auto copied = weights(runtime, n, floats);
+    copied->dataMalloc();
+    std::ifstream in(path, std::ios::binary);
+    for (auto &t : copied->getTensors())
+        in.read(t->getRawDataPtr<char *>(), bytes);
+    printf("read     %9.2f ms\n", msSince(begin));
+
+    for (bool prefetch : {false, true}) {
+        begin = Clock::now();
+        auto mapped = weights(runtime, n, floats);
+        auto file = std::make_shared<MappedFile>(path);
+        auto &tensors = mapped->getTensors();
+        for (int i = 0; i < n; ++i)
+            mapped->mapWeight(tensors[i], file, i * bytes);
+        mapped->dataMalloc();
+        if (prefetch)
+            mapped->prefetchWeights();
+        printf("%s %9.2f ms\n", prefetch ? "prefetch" : "map     ",
+               msSince(begin));
+    }
+    std::remove(path.c_str());
+    return 0;
+}
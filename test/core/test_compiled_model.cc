@@ -0,0 +1,128 @@
+#include "core/compiled_model.h"
+#include "core/kernel.h"
+#include "core/perf_engine.h"
+#include "core/runtime.h"
+#include "operators/conv.h"
+#include "operators/dropout.h"
+#include "operators/element_wise.h"
+#include "operators/matmul.h"
+#include "operators/unary.h"
+#include "test.h"
+#include <cstdio>
+#include <fstream>
+
+namespace infini {
+
+// y = abs(x w[:, :3] - x w[:, 3:]) * x[:, :3], with a split MatMul.
+static Graph buildModel(const Runtime &runtime) {
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({2, 4});
+    auto w = g->addTensor({4, 6});
+    auto x3 = g->addTensor({2, 3});
+    x->setInput();
+    x3->setInput();
+    w->setWeight();
+    auto matmul = g->addOp<MatmulObj>(x, w, TensorVec{}, vector<int>{3, 3});
+    auto d = g->addOp<SubObj>(matmul->getOutput(0), matmul->getOutput(1),
+                              nullptr)
+                 ->getOutput();
+    auto a = g->addOp<AbsObj>(d, nullptr)->getOutput();
+    g->addOp<MulObj>(a, x3, nullptr)->getOutput()->setOutput();
+    return g;
+}
+
+TEST(CompiledModel, roundTrip) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    auto g = buildModel(runtime);
+    g->dataMalloc();
+    auto &tensors = g->getTensors();
+    Tensor x = tensors[0], w = tensors[1], x3 = tensors[2];
+    w->copyin(vector<float>{1, 0, 2, 0, 1, 0, //
+                            0, 1, 0, 1, 0, 0, //
+                            3, 0, 0, 0, 0, 1, //
+                            0, 0, 1, 2, 2, 2});
+    x->copyin(vector<float>{1, 2, 3, 4, -1, 0, 1, 2});
+    x3->copyin(vector<float>{1, 1, 1, 2, 2, 2});
+    runtime->run(g, true);
+    auto expected = g->getOutputs()[0]->copyout<float>();
+
+    string path = ::testing::TempDir() + "compiled_model.bin";
+    saveCompiledModel(g, path, {{"x", x}, {"x3", x3}},
+                      {{"y", g->getOutputs()[0]}});
+    // The PerfRecords must come back from the file.
+    auto &perfEngine = PerfEngine::getInstance();
+    auto records = perfEngine.get_data();
+    perfEngine.set_data({});
+
+    NamedTensors ins, outs;
+    auto loaded = loadCompiledModel(runtime, path, &ins, &outs);
+    std::remove(path.c_str());
+    ASSERT_EQ(loaded->getOperators().size(), g->getOperators().size());
+    for (size_t i = 0; i < g->getOperators().size(); ++i)
+        EXPECT_EQ(loaded->getOperators()[i]->getOpType(),
+                  g->getOperators()[i]->getOpType());
+    EXPECT_EQ(loaded->getActivationBytes(), g->getActivationBytes());
+    // Weights are mapped from the file rather than copied into an arena.
+    EXPECT_EQ(loaded->getWeightBytes(), 0u);
+    EXPECT_TRUE(loaded->isMappedWeight(loaded->getTensors()[1]));
+    EXPECT_EQ(perfEngine.get_data().size(), records.size());
+    for (auto &op : loaded->getOperators())
+        EXPECT_TRUE(perfEngine.getPerfData(
+            {KernelAttrs{Device::CPU, op->getOpType().underlying()},
+             op->getOpPerfKey()}));
+    perfEngine.set_data(records);
+
+    ASSERT_EQ(ins.size(), 2u);
+    ASSERT_EQ(outs.size(), 1u);
+    EXPECT_EQ(ins[0].first, "x");
+    EXPECT_EQ(outs[0].first, "y");
+    ins[0].second->copyin(vector<float>{1, 2, 3, 4, -1, 0, 1, 2});
+    ins[1].second->copyin(vector<float>{1, 1, 1, 2, 2, 2});
+    runtime->run(loaded);
+    EXPECT_TRUE(outs[0].second->equalData(expected));
+}
+
+TEST(CompiledModel, ConvTransposeAttrs) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({1, 2, 3, 3});
+    auto w = g->addTensor({2, 4, 3, 3});
+    x->setInput();
+    w->setWeight();
+    auto conv =
+        g->addOp<ConvTransposed2dObj>(x, w, nullptr, 1, 0, 2, 1, 1, 2, 1, 0);
+    conv->getOutput()->setOutput();
+    g->dataMalloc();
+    w->setData(IncrementalGenerator());
+
+    string path = ::testing::TempDir() + "compiled_conv_transpose.bin";
+    saveCompiledModel(g, path, {{"x", x}}, {{"y", conv->getOutput()}});
+    auto loaded = loadCompiledModel(runtime, path);
+    std::remove(path.c_str());
+    ASSERT_EQ(loaded->getOperators().size(), 1u);
+    auto op = as<ConvTransposed2dObj>(loaded->getOperators()[0]);
+    EXPECT_EQ(op->getPadStrideDilation(), conv->getPadStrideDilation());
+    EXPECT_EQ(op->getOutputPadding(), conv->getOutputPadding());
+    EXPECT_EQ(op->getNumGroups(), conv->getNumGroups());
+    EXPECT_EQ(op->getOutput()->getDims(), conv->getOutput()->getDims());
+    EXPECT_TRUE(loaded->getTensors()[1]->equalData(w));
+}
+
+TEST(CompiledModel, rejectUnsupported) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({2, 3});
+    x->setInput();
+    auto dropout = g->addOp<DropoutObj>(x, nullptr, nullptr, 0.5, false);
+    g->dataMalloc();
+
+    string path = ::testing::TempDir() + "compiled_unsupported.bin";
+    std::remove(path.c_str());
+    EXPECT_THROW(saveCompiledModel(g, path, {{"x", x}},
+                                   {{"y", dropout->getOutput(0)}}),
+                 Exception);
+    // Nothing is written for a graph that cannot be loaded back.
+    EXPECT_FALSE(std::ifstream(path).good());
+}
+
+} // namespace infini
@@ -0,0 +1,83 @@
+#include "core/descriptor_cache.h"
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "test.h"
+
+namespace infini {
+
+TEST(DescriptorCache, lru) {
+    DescriptorCache cache;
+    cache.setCapacity(2);
+    static int destroyed;
+    destroyed = 0;
+    auto make = [](int id) {
+        return InfiniopDesc{std::shared_ptr<void>(new int(id),
+                                                  [](void *p) {
+                                                      delete (int *)p;
+                                                      ++destroyed;
+                                                  }),
+                            size_t(id) * 16};
+    };
+    EXPECT_FALSE(cache.lookup({1}));
+    cache.insert({1}, make(1));
+    cache.insert({2}, make(2));
+    // Using 1 makes 2 the least recently used one.
+    auto one = cache.lookup({1});
+    ASSERT_TRUE(one);
+    EXPECT_EQ(*(int *)one->desc.get(), 1);
+    EXPECT_EQ(one->workspaceSize, 16u);
+    cache.insert({3}, make(3));
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_FALSE(cache.lookup({2}));
+    EXPECT_TRUE(cache.lookup({3}));
+    EXPECT_EQ(destroyed, 1);
+    EXPECT_EQ(cache.getHits(), 2u);
+    EXPECT_EQ(cache.getMisses(), 3u);
+    EXPECT_EQ(cache.getEvictions(), 1u);
+
+    // Evicted descriptors live on while an operator holds them.
+    cache.setCapacity(0);
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(destroyed, 2);
+    one.reset();
+    EXPECT_EQ(destroyed, 3);
+}
+
+TEST(DescriptorCache, reshape) {
+    auto &cache = DescriptorCache::getInstance();
+    cache.clear();
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({2, 3});
+    auto b = g->addTensor({2, 3});
+    auto add = g->addOp<AddObj>(a, b, nullptr);
+    EXPECT_TRUE(add->hasInfiniOpDesc());
+    EXPECT_EQ(cache.getMisses(), 1u);
+
+    // Unchanged shapes keep the descriptor without a lookup.
+    g->shape_infer();
+    EXPECT_EQ(cache.getHits() + cache.getMisses(), 1u);
+
+    a->setShape({4, 3});
+    b->setShape({4, 3});
+    g->shape_infer();
+    EXPECT_EQ(add->getOutput()->getDims(), (Shape{4, 3}));
+    EXPECT_EQ(cache.getMisses(), 2u);
+    EXPECT_EQ(cache.getHits(), 0u);
+
+    a->setShape({2, 3});
+    b->setShape({2, 3});
+    g->shape_infer();
+    EXPECT_EQ(cache.getHits(), 1u);
+
+    // Another operator with the same shapes shares the descriptor.
+    Graph g2 = make_ref<GraphObj>(runtime);
+    g2->addOp<AddObj>(g2->addTensor({2, 3}), g2->addTensor({2, 3}), nullptr);
+    EXPECT_EQ(cache.getHits(), 2u);
+    EXPECT_EQ(cache.getMisses(), 2u);
+    EXPECT_EQ(cache.size(), 2u);
+    cache.clear();
+}
+
+} // namespace infini
@@ -5,6 +5,9 @@
 #include "operators/matmul.h"
 #include "operators/unary.h"
 #include "test.h"
+#include "utils/mapped_file.h"
+#include <cstdio>
+#include <fstream>
 
 namespace infini {
 
@@ -149,4 +152,114 @@ TEST(Graph, test_OpVec_ctor) {
     }
 }
 
+TEST(Graph, memory_aware_scheduling) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor x = g->addTensor({4, 4});
+    x->setInput();
+    // Two branches that each expand x to 4 KB and reduce it again. Both
+    // expansions come first in insertion order.
+    TensorVec ws, hidden;
+    OpVec reduces;
+    for (int i = 0; i < 2; ++i) {
+        ws.emplace_back(g->addTensor({4, 256}));
+        hidden.emplace_back(g->addOp<MatmulObj>(x, ws.back(), nullptr)
+                                ->getOutput());
+    }
+    for (int i = 0; i < 2; ++i) {
+        ws.emplace_back(g->addTensor({256, 1}));
+        reduces.emplace_back(
+            g->addOp<MatmulObj>(hidden[i], ws.back(), nullptr));
+    }
+    auto y = g->addOp<SubObj>(reduces[0]->getOutput(),
+                              reduces[1]->getOutput(), nullptr)
+                 ->getOutput();
+    y->setOutput();
+    for (auto &w : ws)
+        w->setWeight();
+
+    g->dataMalloc();
+    // Each expansion is reduced before the other one runs.
+    auto ops = g->getOperators();
+    EXPECT_EQ(ops[1]->getInputs(0), ops[0]->getOutput());
+    EXPECT_EQ(ops[3]->getInputs(0), ops[2]->getOutput());
+    EXPECT_LT(g->getActivationBytes(), 2 * 4096u);
+    x->copyin(vector<float>(16, 1));
+    ws[0]->copyin(vector<float>(1024, 1));
+    ws[1]->copyin(vector<float>(1024, 2));
+    ws[2]->copyin(vector<float>(256, 1));
+    ws[3]->copyin(vector<float>(256, 1));
+    runtime->run(g);
+    EXPECT_TRUE(y->equalData(vector<float>(4, -1024)));
+}
+
+TEST(Graph, memory_aware_scheduling_large) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor x = g->addTensor({4, 4});
+    x->setInput();
+    // Too many operators for the exact search: 40 expansions first, then
+    // their reductions, then a chain of Subs.
+    const int branches = 40;
+    TensorVec hidden;
+    for (int i = 0; i < branches; ++i) {
+        auto w = g->addTensor({4, 256});
+        w->setWeight();
+        hidden.emplace_back(g->addOp<MatmulObj>(x, w, nullptr)->getOutput());
+    }
+    Tensor y;
+    for (int i = 0; i < branches; ++i) {
+        auto w = g->addTensor({256, 1});
+        w->setWeight();
+        auto s = g->addOp<MatmulObj>(hidden[i], w, nullptr)->getOutput();
+        y = i ? g->addOp<SubObj>(y, s, nullptr)->getOutput() : s;
+    }
+    y->setOutput();
+
+    g->dataMalloc();
+    EXPECT_GT(g->getOperators().size(), 64u);
+    EXPECT_LT(g->getActivationBytes(), 2 * 4096u);
+}
+
+TEST(Graph, map_weights) {
+    string path = ::testing::TempDir() + "graph_weights.bin";
+    {
+        // 8 bytes of padding, then a 2x2 weight.
+        vector<float> data{0, 0, 1, 2, 3, 4};
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<char *>(data.data()), 24);
+    }
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor x = g->addTensor({1, 2});
+    Tensor w = g->addTensor({2, 2});
+    x->setInput();
+    w->setWeight();
+    auto y = g->addOp<MatmulObj>(x, w, nullptr)->getOutput();
+    y->setOutput();
+
+    auto file = std::make_shared<MappedFile>(path);
+    // A weight that is not aligned to its element size is not mapped.
+    EXPECT_FALSE(g->mapWeight(w, file, 6));
+    EXPECT_FALSE(g->isMappedWeight(w));
+    EXPECT_TRUE(g->mapWeight(w, file, 8));
+    file->prefetch();
+    g->dataMalloc();
+    // The weight is not copied into an arena.
+    EXPECT_TRUE(g->isMappedWeight(w));
+    EXPECT_EQ(g->getWeightBytes(), 0u);
+    EXPECT_EQ(w->getRawDataPtr<uint8_t *>(), file->data() + 8);
+    x->copyin(vector<float>{1, 1});
+    runtime->run(g);
+    EXPECT_TRUE(y->equalData(vector<float>{4, 6}));
+
+    // Writes stay private to the mapping.
+    w->copyin(vector<float>{0, 0, 0, 0});
+    vector<float> onDisk(6);
+    std::ifstream(path, std::ios::binary)
+        .read(reinterpret_cast<char *>(onDisk.data()), 24);
+    EXPECT_EQ(onDisk[2], 1);
+    std::remove(path.c_str());
+}
+
 } // namespace infini
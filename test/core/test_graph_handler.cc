@@ -1,5 +1,8 @@
 ﻿#include "core/graph_handler.h"
 #include "core/runtime.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <test.h>
 
 namespace infini {
@@ -13,4 +16,24 @@ TEST(Handler, matmul) {
     handler->matmul(i, w, o, false, false, nullptr, ActType::None);
 }
 
+TEST(Handler, mapMisalignedWeight) {
+    // ONNX external data may start at any byte; this weight starts at 2.
+    string path = ::testing::TempDir() + "handler_weights.bin";
+    {
+        vector<float> data{1, 2, 3, 4};
+        vector<char> bytes(2 + sizeof(float) * data.size());
+        std::memcpy(bytes.data() + 2, data.data(), bytes.size() - 2);
+        std::ofstream(path, std::ios::binary).write(bytes.data(), bytes.size());
+    }
+    auto runtime = NativeCpuRuntimeObj::getInstance();
+    auto handler = make_ref<GraphHandlerObj>(runtime);
+    auto w = handler->tensor({2, 2}, DataType::Float32.getIndex());
+    w->setWeight();
+    handler->map_weight(w, path, 2);
+    handler->data_malloc();
+    // The weight is copied from the mapping rather than pointing into it.
+    EXPECT_TRUE(w->equalData(vector<float>{1, 2, 3, 4}));
+    std::remove(path.c_str());
+}
+
 } // namespace infini
@@ -0,0 +1,682 @@
+#include "core/graph.h"
+#include "core/graph_pass.h"
+#include "core/runtime.h"
+#include "operators/batch_norm.h"
+#include "operators/concat.h"
+#include "operators/conv.h"
+#include "operators/element_wise.h"
+#include "operators/fused_element_wise.h"
+#include "operators/matmul.h"
+#include "operators/reshape.h"
+#include "operators/transpose.h"
+#include "operators/unary.h"
+#include "test.h"
+
+namespace infini {
+
+TEST(GraphPass, RegistryOrder) {
+    auto &passes = GraphPassRegistry::getInstance().getPasses();
+    ASSERT_FALSE(passes.empty());
+    for (size_t i = 1; i < passes.size(); ++i)
+        EXPECT_LE(passes[i - 1].first, passes[i].first);
+}
+
+TEST(GraphPass, DeadCodeElimination) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({2, 3});
+    auto b = g->addTensor({2, 3});
+    a->setInput();
+    auto live = g->addOp<MulObj>(a, b, nullptr);
+    live->getOutput()->setOutput();
+    // A dead chain: nothing consumes its result.
+    auto dead0 = g->addOp<SubObj>(a, b, nullptr);
+    g->addOp<TransposeObj>(dead0->getOutput(), nullptr, vector<int>{1, 0});
+
+    g->optimize();
+    EXPECT_EQ(g->getOperators().size(), 1u);
+    EXPECT_EQ(g->getOperators()[0], live);
+    EXPECT_EQ(g->getTensors().size(), 3u);
+    EXPECT_TRUE(g->checkValid());
+
+    auto &stats = g->getPassStats();
+    auto it = std::find_if(stats.begin(), stats.end(), [](const PassStat &s) {
+        return s.name == "DeadCodeElimination";
+    });
+    ASSERT_NE(it, stats.end());
+    EXPECT_EQ(it->changes, 1);
+    EXPECT_EQ(it->opsRemoved, 2);
+    // The second iteration finds nothing to do and stops the pipeline.
+    EXPECT_EQ(it->runs, 2);
+}
+
+TEST(GraphPass, UnmarkedOutputsAreKept) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({2, 3});
+    g->addOp<SigmoidObj>(a, nullptr);
+    g->addOp<NegObj>(a, nullptr);
+    g->optimize();
+    EXPECT_EQ(g->getOperators().size(), 2u);
+}
+
+TEST(GraphPass, CommonSubexpressionElimination) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({2, 3});
+    x->setInput();
+    // Two identical Sigmoid -> Transpose chains collapse into one.
+    auto s0 = g->addOp<SigmoidObj>(x, nullptr);
+    auto s1 = g->addOp<SigmoidObj>(x, nullptr);
+    auto t0 = g->addOp<TransposeObj>(s0->getOutput(), nullptr,
+                                     vector<int>{1, 0});
+    auto t1 = g->addOp<TransposeObj>(s1->getOutput(), nullptr,
+                                     vector<int>{1, 0});
+    auto sum = g->addOp<MulObj>(t0->getOutput(), t1->getOutput(), nullptr);
+    sum->getOutput()->setOutput();
+    // Different permutations are kept apart.
+    auto y = g->addTensor({2, 2, 2});
+    y->setInput();
+    auto p0 = g->addOp<TransposeObj>(y, nullptr, vector<int>{1, 0, 2});
+    auto p1 = g->addOp<TransposeObj>(y, nullptr, vector<int>{0, 2, 1});
+    auto diff = g->addOp<SubObj>(p0->getOutput(), p1->getOutput(), nullptr);
+    diff->getOutput()->setOutput();
+
+    g->optimize();
+    EXPECT_TRUE(g->checkValid());
+    EXPECT_EQ(g->getOperators().size(), 6u);
+    EXPECT_EQ(sum->getInputs(0), sum->getInputs(1));
+    EXPECT_NE(diff->getInputs(0), diff->getInputs(1));
+
+    auto &stats = g->getPassStats();
+    auto it = std::find_if(stats.begin(), stats.end(), [](const PassStat &s) {
+        return s.name == "CommonSubexpressionElimination";
+    });
+    ASSERT_NE(it, stats.end());
+    EXPECT_EQ(it->changes, 1);
+    EXPECT_EQ(it->opsRemoved, 2);
+}
+
+TEST(GraphPass, CommonSubexpressionEliminationComputeType) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({2, 3});
+    auto b = g->addTensor({3, 4});
+    a->setInput();
+    b->setInput();
+    // MatMuls that differ only in compute type are not merged.
+    auto m0 = g->addOp<MatmulObj>(a, b, nullptr, false, false, nullptr,
+                                  ActType::None, "default");
+    auto m1 = g->addOp<MatmulObj>(a, b, nullptr, false, false, nullptr,
+                                  ActType::None, "tf32");
+    auto diff = g->addOp<SubObj>(m0->getOutput(), m1->getOutput(), nullptr);
+    diff->getOutput()->setOutput();
+    EXPECT_FALSE(m0->hasSameAttrs(*m1));
+
+    g->optimize();
+    EXPECT_EQ(g->getOperators().size(), 3u);
+    EXPECT_NE(diff->getInputs(0), diff->getInputs(1));
+}
+
+TEST(GraphPass, ElementWiseFusion) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({2, 3});
+    auto w = g->addTensor(Shape{3});
+    x->setInput();
+    w->setInput();
+    // a = x * w + 1; y = a * sigmoid(a). `a` feeds two fused operators.
+    auto one = g->addTensor(Shape{1});
+    one->setWeight();
+    auto mul = g->addOp<MulObj>(x, w, nullptr);
+    auto add = g->addOp<AddObj>(mul->getOutput(), one, nullptr);
+    auto sig = g->addOp<SigmoidObj>(add->getOutput(), nullptr);
+    auto gate =
+        g->addOp<MulObj>(add->getOutput(), sig->getOutput(), nullptr);
+    auto y = gate->getOutput();
+    y->setOutput();
+    // Transpose ends the group; the Neg after it starts a new one that is
+    // left alone as it has a single operator.
+    auto t = g->addOp<TransposeObj>(y, nullptr, vector<int>{1, 0});
+    auto neg = g->addOp<NegObj>(t->getOutput(), nullptr);
+    neg->getOutput()->setOutput();
+
+    g->optimize();
+    EXPECT_TRUE(g->checkValid());
+    ASSERT_EQ(g->getOperators().size(), 3u);
+    auto fused = as<FusedElementWiseObj>(y->getSource());
+    ASSERT_NE(fused, nullptr);
+    EXPECT_EQ(fused->getInputs(), (TensorVec{x, w, one}));
+    EXPECT_EQ(fused->getProgram().size(), 4u);
+    EXPECT_EQ(g->getTensors().size(), 6u);
+
+    g->dataMalloc();
+    one->copyin(vector<float>{1});
+    x->copyin(vector<float>{0, 1, 2, -1, -2, -3});
+    w->copyin(vector<float>{1, 2, 0.5});
+    runtime->run(g);
+    vector<float> ans;
+    for (float v : {1.f, 3.f, 2.f, 0.f, -3.f, -0.5f})
+        ans.push_back(v / (1 + std::exp(-v)));
+    EXPECT_TRUE(y->equalData(ans));
+}
+
+TEST(GraphPass, EpilogueFusionMatmul) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({2, 3});
+    auto b = g->addTensor({3, 2});
+    auto bias = g->addTensor(Shape{2});
+    auto res = g->addTensor({2, 2});
+    a->setInput();
+    res->setInput();
+    b->setWeight();
+    bias->setWeight();
+    // relu(res + (bias + a * b)): both Add orders and an activation.
+    auto mm = g->addOp<MatmulObj>(a, b, nullptr);
+    auto addBias = g->addOp<AddObj>(bias, mm->getOutput(), nullptr);
+    auto addRes = g->addOp<AddObj>(res, addBias->getOutput(), nullptr);
+    auto relu = g->addOp<ReluObj>(addRes->getOutput(), nullptr);
+    auto y = relu->getOutput();
+    y->setOutput();
+
+    g->optimize();
+    EXPECT_TRUE(g->checkValid());
+    ASSERT_EQ(g->getOperators().size(), 1u);
+    auto fused = as<MatmulObj>(y->getSource());
+    ASSERT_NE(fused, nullptr);
+    EXPECT_EQ(fused->getBias(), bias);
+    EXPECT_EQ(fused->getResidual(), res);
+    EXPECT_EQ(fused->getAct(), ActType::Relu);
+
+    g->dataMalloc();
+    a->copyin(vector<float>{1, 0, 2, 0, 1, -1});
+    b->copyin(vector<float>{1, 2, 3, 4, 5, 6});
+    bias->copyin(vector<float>{1, -20});
+    res->copyin(vector<float>{0.5, 0, -20, 3});
+    runtime->run(g);
+    // a * b = {11, 14, -2, -2}
+    EXPECT_TRUE(y->equalData(vector<float>{12.5, 0, 0, 0}));
+}
+
+TEST(GraphPass, EpilogueFusionConv) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({1, 1, 2, 2});
+    auto w = g->addTensor({2, 1, 1, 1});
+    auto bias = g->addTensor({1, 2, 1, 1});
+    x->setInput();
+    w->setWeight();
+    bias->setWeight();
+    auto conv = g->addOp<ConvObj>(x, w, nullptr, 0, 0);
+    auto add = g->addOp<AddObj>(conv->getOutput(), bias, nullptr);
+    auto relu = g->addOp<ReluObj>(add->getOutput(), nullptr);
+    auto y = relu->getOutput();
+    y->setOutput();
+    // The Conv output is also read elsewhere: nothing can be fused.
+    auto x2 = g->addTensor({1, 1, 2, 2});
+    x2->setInput();
+    auto conv2 = g->addOp<ConvObj>(x2, w, nullptr, 0, 0);
+    auto relu2 = g->addOp<ReluObj>(conv2->getOutput(), nullptr);
+    relu2->getOutput()->setOutput();
+    conv2->getOutput()->setOutput();
+
+    g->optimize();
+    EXPECT_TRUE(g->checkValid());
+    ASSERT_EQ(g->getOperators().size(), 3u);
+    auto fused = as<ConvObj>(y->getSource());
+    ASSERT_NE(fused, nullptr);
+    EXPECT_EQ(fused->getBias(), bias);
+    EXPECT_EQ(fused->getAct(), ActType::Relu);
+
+    g->dataMalloc();
+    x->copyin(vector<float>{1, 2, -3, 4});
+    x2->copyin(vector<float>{0, 0, 0, 0});
+    w->copyin(vector<float>{1, -1});
+    bias->copyin(vector<float>{1, 0});
+    runtime->run(g);
+    EXPECT_TRUE(y->equalData(vector<float>{2, 3, 0, 5, 0, 0, 3, 0}));
+}
+
+TEST(GraphPass, ConstantFolding) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({4, 2});
+    auto w = g->addTensor({3, 2});
+    auto k = g->addTensor({2}, DataType::Int32);
+    x->setInput();
+    w->setWeight();
+    k->setWeight();
+    // Weight-only chain: Transpose(w) feeds the MatMul.
+    auto wt = g->addOp<TransposeObj>(w, nullptr, vector<int>{1, 0});
+    auto mm = g->addOp<MatmulObj>(x, wt->getOutput(), nullptr);
+    mm->getOutput()->setOutput();
+    // Shape-only chain: Cast(Shape(x)) * k.
+    auto shape = g->addOp<ShapeObj>(x, nullptr);
+    auto cast = g->addOp<CastObj>(shape->getOutput(), nullptr,
+                                  CastType::Int642Int32);
+    auto mul = g->addOp<MulObj>(cast->getOutput(), k, nullptr);
+    mul->getOutput()->setOutput();
+    g->dataMalloc();
+    EXPECT_EQ(g->getWeightBytes(), 32u);
+    w->copyin(vector<float>{1, 2, 3, 4, 5, 6});
+    k->copyin(vector<int32_t>{10, 100});
+
+    g->optimize();
+    EXPECT_TRUE(g->checkValid());
+    ASSERT_EQ(g->getOperators().size(), 2u);
+    auto b = mm->getInputs(1);
+    EXPECT_TRUE(b->isWeight());
+    EXPECT_EQ(b->copyout<float>(), (vector<float>{1, 3, 5, 2, 4, 6}));
+    auto c = mul->getInputs(0);
+    EXPECT_TRUE(c->isWeight());
+    EXPECT_EQ(c->copyout<int32_t>(), (vector<int32_t>{4, 2}));
+    // w is replaced by its transpose; k and the folded shape stay.
+    EXPECT_EQ(g->getWeightBytes(), 24u + 8u + 8u);
+
+    x->copyin(vector<float>{1, 0, 0, 1, 1, 1, 2, 0});
+    runtime->run(g);
+    EXPECT_EQ(mm->getOutput()->copyout<float>(),
+              (vector<float>{1, 3, 5, 2, 4, 6, 3, 7, 11, 2, 6, 10}));
+    EXPECT_EQ(mul->getOutput()->copyout<int32_t>(),
+              (vector<int32_t>{40, 200}));
+
+    auto &stats = g->getPassStats();
+    auto it = std::find_if(stats.begin(), stats.end(), [](const PassStat &s) {
+        return s.name == "ConstantFolding";
+    });
+    ASSERT_NE(it, stats.end());
+    EXPECT_EQ(it->opsRemoved, 3);
+    EXPECT_EQ(it->note, "weight arena 32 -> 40 bytes");
+}
+
+TEST(GraphPass, BatchNormFoldingConv) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({1, 1, 2, 2});
+    auto w = g->addTensor({2, 1, 1, 1});
+    x->setInput();
+    w->setWeight();
+    TensorVec params;
+    for (int i = 0; i < 4; ++i) {
+        params.emplace_back(g->addTensor(Shape{2}));
+        params.back()->setWeight();
+    }
+    auto conv = g->addOp<ConvObj>(x, w, nullptr, 0, 0);
+    auto bn = g->addOp<BatchNormObj>(conv->getOutput(), nullptr, params[0],
+                                     params[1], params[2], params[3], 0.9,
+                                     1.f);
+    auto y = bn->getOutput();
+    y->setOutput();
+    g->dataMalloc();
+    EXPECT_EQ(g->getWeightBytes(), 40u);
+    w->copyin(vector<float>{1, -1});
+    params[0]->copyin(vector<float>{1, 0}); // mean
+    params[1]->copyin(vector<float>{3, 0}); // var
+    params[2]->copyin(vector<float>{4, 1}); // scale
+    params[3]->copyin(vector<float>{0, 5}); // bias
+
+    g->optimize();
+    EXPECT_TRUE(g->checkValid());
+    ASSERT_EQ(g->getOperators().size(), 1u);
+    auto fused = as<ConvObj>(y->getSource());
+    ASSERT_NE(fused, nullptr);
+    EXPECT_EQ(fused->getInputs(1)->copyout<float>(), (vector<float>{2, -1}));
+    EXPECT_EQ(fused->getBias()->copyout<float>(), (vector<float>{-2, 5}));
+    // The BatchNorm parameters are gone from the weight arena.
+    EXPECT_EQ(g->getWeightBytes(), 16u);
+
+    x->copyin(vector<float>{1, 2, -3, 4});
+    runtime->run(g);
+    EXPECT_TRUE(y->equalData(vector<float>{0, 2, -8, 6, 4, 3, 8, 1}));
+}
+
+TEST(GraphPass, BatchNormFoldingConvTranspose) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({1, 2, 2, 2});
+    // [C, F/g, R, S] with two groups: input channel c writes channel c.
+    auto w = g->addTensor({2, 1, 1, 1});
+    x->setInput();
+    w->setWeight();
+    TensorVec params;
+    for (int i = 0; i < 4; ++i) {
+        params.emplace_back(g->addTensor(Shape{2}));
+        params.back()->setWeight();
+    }
+    auto conv = g->addOp<ConvTransposed2dObj>(x, w, nullptr, 0, 0, 1, 1, 1,
+                                              1, 0, 0, 2);
+    auto bn = g->addOp<BatchNormObj>(conv->getOutput(), nullptr, params[0],
+                                     params[1], params[2], params[3], 0.9,
+                                     1.f);
+    auto y = bn->getOutput();
+    y->setOutput();
+    g->dataMalloc();
+    w->copyin(vector<float>{1, -1});
+    params[0]->copyin(vector<float>{1, 0}); // mean
+    params[1]->copyin(vector<float>{3, 0}); // var
+    params[2]->copyin(vector<float>{4, 1}); // scale
+    params[3]->copyin(vector<float>{0, 5}); // bias
+
+    EXPECT_TRUE(g->foldBatchNorm());
+    EXPECT_TRUE(g->checkValid());
+    ASSERT_EQ(g->getOperators().size(), 2u);
+    auto add = y->getSource();
+    ASSERT_EQ(add->getOpType(), OpType::Add);
+    auto fused = as<ConvTransposed2dObj>(add->getInputs(0)->getSource());
+    ASSERT_NE(fused, nullptr);
+    EXPECT_EQ(fused->getNumGroups(), 2);
+    EXPECT_EQ(fused->getInputs(1)->copyout<float>(), (vector<float>{2, -1}));
+    auto bias = add->getInputs(1);
+    EXPECT_TRUE(bias->isWeight());
+    EXPECT_EQ(bias->getDims(), (Shape{1, 2, 1, 1}));
+    EXPECT_EQ(bias->copyout<float>(), (vector<float>{-2, 5}));
+    // The BatchNorm parameters are gone from the weight arena.
+    EXPECT_EQ(g->getWeightBytes(), 16u);
+}
+
+TEST(GraphPass, BatchNormFoldingMatmul) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({1, 2});
+    auto w = g->addTensor({3, 2});
+    auto bias = g->addTensor(Shape{3});
+    x->setInput();
+    w->setWeight();
+    bias->setWeight();
+    TensorVec params;
+    for (int i = 0; i < 4; ++i) {
+        params.emplace_back(g->addTensor(Shape{3}));
+        params.back()->setWeight();
+    }
+    auto mm = g->addOp<MatmulObj>(x, w, nullptr, false, true, bias);
+    auto bn = g->addOp<BatchNormObj>(mm->getOutput(), nullptr, params[0],
+                                     params[1], params[2], params[3], 0.9,
+                                     0.f);
+    auto y = bn->getOutput();
+    y->setOutput();
+    // The MatMul output is also a graph output: the BatchNorm is kept.
+    auto x2 = g->addTensor({1, 2});
+    x2->setInput();
+    auto mm2 = g->addOp<MatmulObj>(x2, w, nullptr, false, true);
+    mm2->getOutput()->setOutput();
+    g->addOp<BatchNormObj>(mm2->getOutput(), nullptr, params[0], params[1],
+                           params[2], params[3], 0.9, 0.f)
+        ->getOutput()
+        ->setOutput();
+    g->dataMalloc();
+    w->copyin(vector<float>{1, 2, 3, 4, 5, 6});
+    bias->copyin(vector<float>{1, 1, 1});
+    params[0]->copyin(vector<float>{0, 1, 2}); // mean
+    params[1]->copyin(vector<float>{1, 4, 1}); // var
+    params[2]->copyin(vector<float>{1, 2, 3}); // scale
+    params[3]->copyin(vector<float>{0, 0, 1}); // bias
+
+    g->optimize();
+    EXPECT_TRUE(g->checkValid());
+    ASSERT_EQ(g->getOperators().size(), 3u);
+    auto fused = as<MatmulObj>(y->getSource());
+    ASSERT_NE(fused, nullptr);
+    EXPECT_TRUE(fused->getTransB());
+    EXPECT_EQ(fused->getInputs(1)->copyout<float>(),
+              (vector<float>{1, 2, 3, 4, 15, 18}));
+    EXPECT_EQ(fused->getBias()->copyout<float>(), (vector<float>{1, 0, -2}));
+}
+
+TEST(GraphPass, TransposeCancellation) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    // Transpose -> Reshape -> Transpose that amounts to a Reshape.
+    auto a = g->addTensor({2, 3});
+    a->setInput();
+    auto t0 = g->addOp<TransposeObj>(a, nullptr, vector<int>{1, 0});
+    auto r = g->addOp<ReshapeObj>(t0->getOutput(), nullptr, Shape{3, 1, 2});
+    auto t1 =
+        g->addOp<TransposeObj>(r->getOutput(), nullptr, vector<int>{2, 1, 0});
+    auto z = t1->getOutput();
+    z->setOutput();
+    // Back-to-back transposes that compose to identity.
+    auto b = g->addTensor({2, 3, 4});
+    b->setInput();
+    auto t2 = g->addOp<TransposeObj>(b, nullptr, vector<int>{1, 0, 2});
+    auto t3 = g->addOp<TransposeObj>(t2->getOutput(), nullptr,
+                                     vector<int>{1, 0, 2});
+    auto abs = g->addOp<AbsObj>(t3->getOutput(), nullptr);
+    auto y = abs->getOutput();
+    y->setOutput();
+
+    g->optimize();
+    EXPECT_TRUE(g->checkValid());
+    ASSERT_EQ(g->getOperators().size(), 2u);
+    EXPECT_EQ(z->getSource()->getOpType(), OpType::Reshape);
+    EXPECT_EQ(z->getSource()->getInputs(0), a);
+    EXPECT_EQ(y->getSource()->getInputs(0), b);
+
+    g->dataMalloc();
+    a->copyin(vector<float>{1, 2, 3, 4, 5, 6});
+    b->setData(IncrementalGenerator());
+    runtime->run(g);
+    EXPECT_TRUE(z->equalData(vector<float>{1, 2, 3, 4, 5, 6}));
+    EXPECT_TRUE(y->equalData(b));
+}
+
+TEST(GraphPass, TransposeFoldIntoMatmul) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({2, 3});
+    auto b = g->addTensor({4, 3});
+    a->setInput();
+    b->setInput();
+    auto bt = g->addOp<TransposeObj>(b, nullptr, vector<int>{1, 0});
+    auto mm = g->addOp<MatmulObj>(a, bt->getOutput(), nullptr);
+    auto y = mm->getOutput();
+    y->setOutput();
+    // The Transpose sinks below Neg and then folds into transA.
+    auto at = g->addOp<TransposeObj>(a, nullptr, vector<int>{1, 0});
+    auto neg = g->addOp<NegObj>(at->getOutput(), nullptr);
+    auto mm2 = g->addOp<MatmulObj>(neg->getOutput(), a, nullptr);
+    auto z = mm2->getOutput();
+    z->setOutput();
+
+    g->optimize();
+    EXPECT_TRUE(g->checkValid());
+    ASSERT_EQ(g->getOperators().size(), 3u);
+    auto fused = as<MatmulObj>(y->getSource());
+    EXPECT_FALSE(fused->getTransA());
+    EXPECT_TRUE(fused->getTransB());
+    EXPECT_EQ(fused->getInputs(1), b);
+    auto fused2 = as<MatmulObj>(z->getSource());
+    EXPECT_TRUE(fused2->getTransA());
+    EXPECT_FALSE(fused2->getTransB());
+
+    g->dataMalloc();
+    a->copyin(vector<float>{1, 2, 3, 4, 5, 6});
+    b->setData(IncrementalGenerator());
+    runtime->run(g);
+    EXPECT_TRUE(
+        y->equalData(vector<float>{8, 26, 44, 62, 17, 62, 107, 152}));
+    EXPECT_TRUE(z->equalData(
+        vector<float>{-17, -22, -27, -22, -29, -36, -27, -36, -45}));
+}
+
+TEST(GraphPass, LayoutAssignment) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    // conv0 -> Abs -> {conv1, conv2} -> Sub, concatenated with conv0.
+    auto build = [&](bool optimize) {
+        Graph g = make_ref<GraphObj>(runtime);
+        auto x = g->addTensor({1, 3, 5, 5});
+        auto w0 = g->addTensor({4, 3, 3, 3});
+        auto w1 = g->addTensor({4, 4, 3, 3});
+        auto w2 = g->addTensor({4, 4, 1, 1});
+        x->setInput();
+        for (auto &w : {w0, w1, w2})
+            w->setWeight();
+        auto c0 = g->addOp<ConvObj>(x, w0, nullptr, 1, 1);
+        auto abs = g->addOp<AbsObj>(c0->getOutput(), nullptr);
+        auto c1 = g->addOp<ConvObj>(abs->getOutput(), w1, nullptr, 1, 1);
+        auto c2 = g->addOp<ConvObj>(abs->getOutput(), w2, nullptr, 0, 0);
+        auto sub = g->addOp<SubObj>(c1->getOutput(), c2->getOutput(), nullptr);
+        g->addOp<ConcatObj>(TensorVec{sub->getOutput(), c0->getOutput()},
+                            nullptr, 1)
+            ->getOutput()
+            ->setOutput();
+        if (optimize)
+            g->optimize();
+        g->dataMalloc();
+        x->setData(RandomGenerator(-1, 1, 1));
+        w0->setData(RandomGenerator(-1, 1, 2));
+        w1->setData(RandomGenerator(-1, 1, 3));
+        w2->setData(RandomGenerator(-1, 1, 4));
+        runtime->run(g);
+        return std::make_pair(g, c0->getOutput());
+    };
+    auto ref = build(false).first;
+    auto [g, c0] = build(true);
+    EXPECT_TRUE(g->checkValid());
+
+    // conv0 and Abs feed two Convs and need one conversion, for the
+    // Concat; the Sub region feeds no Conv and stays NCHW.
+    EXPECT_EQ(c0->getLayout(), TensorLayout::NHWC);
+    auto targets = c0->getTargets();
+    auto abs = std::find_if(targets.begin(), targets.end(), [](auto &op) {
+        return op->getOpType() == OpType::Abs;
+    });
+    ASSERT_NE(abs, targets.end());
+    EXPECT_EQ((*abs)->getOutput()->getLayout(), TensorLayout::NHWC);
+    auto y = g->getOutputs()[0];
+    auto cat = y->getSource();
+    EXPECT_EQ(cat->getInputs(0)->getLayout(), TensorLayout::NCHW);
+    EXPECT_EQ(cat->getInputs(1)->getSource()->getOpType(), OpType::Identity);
+    EXPECT_EQ(g->getOperators().size(), 7u);
+    EXPECT_TRUE(y->equalData(ref->getOutputs()[0], 1e-5));
+}
+
+TEST(GraphPass, LayoutAssignmentWeightOperand) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    // conv0 -> Add(w) -> conv1, where the full-size weight operand of the
+    // Add is converted to NHWC and then folded.
+    auto build = [&](bool optimize) {
+        Graph g = make_ref<GraphObj>(runtime);
+        auto x = g->addTensor({1, 2, 3, 3});
+        auto w0 = g->addTensor({4, 2, 3, 3});
+        auto b = g->addTensor({1, 4, 3, 3});
+        auto w1 = g->addTensor({2, 4, 1, 1});
+        x->setInput();
+        for (auto &w : {w0, b, w1})
+            w->setWeight();
+        auto c0 = g->addOp<ConvObj>(x, w0, nullptr, 1, 1);
+        auto add = g->addOp<AddObj>(c0->getOutput(), b, nullptr);
+        g->addOp<ConvObj>(add->getOutput(), w1, nullptr, 0, 0)
+            ->getOutput()
+            ->setOutput();
+        g->dataMalloc();
+        x->setData(RandomGenerator(-1, 1, 1));
+        w0->setData(RandomGenerator(-1, 1, 2));
+        b->setData(IncrementalGenerator());
+        w1->setData(RandomGenerator(-1, 1, 3));
+        if (optimize)
+            g->optimize();
+        runtime->run(g);
+        return std::make_pair(g, add);
+    };
+    auto ref = build(false).first;
+    auto [g, add] = build(true);
+    EXPECT_TRUE(g->checkValid());
+    EXPECT_EQ(add->getOutput()->getLayout(), TensorLayout::NHWC);
+    for (auto &op : g->getOperators())
+        EXPECT_NE(op->getOpType(), OpType::Identity);
+    // The folded operand holds the elements in NHWC order.
+    auto b = add->getInputs(1);
+    EXPECT_TRUE(b->isWeight());
+    EXPECT_EQ(b->getLayout(), TensorLayout::NHWC);
+    vector<float> expected(36);
+    for (int c = 0; c < 4; ++c)
+        for (int p = 0; p < 9; ++p)
+            expected[p * 4 + c] = c * 9 + p;
+    EXPECT_EQ(b->copyout<float>(), expected);
+    EXPECT_TRUE(g->getOutputs()[0]->equalData(ref->getOutputs()[0], 1e-5));
+}
+
+TEST(GraphPass, HorizontalMatmulFusion) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({2, 3});
+    x->setInput();
+    // Q, K and V projections of x, and a MatMul with transB that is kept.
+    vector<Shape> wDims{{3, 2}, {3, 1}, {3, 2}, {2, 3}};
+    TensorVec ws, biases, ys;
+    for (size_t i = 0; i < wDims.size(); ++i) {
+        ws.emplace_back(g->addTensor(wDims[i]));
+        ws.back()->setWeight();
+        Tensor bias;
+        if (i < 3) {
+            bias = g->addTensor(Shape{wDims[i][1]});
+            bias->setWeight();
+            biases.emplace_back(bias);
+        }
+        ys.emplace_back(
+            g->addOp<MatmulObj>(x, ws[i], nullptr, false, i == 3, bias)
+                ->getOutput());
+        ys.back()->setOutput();
+    }
+    g->dataMalloc();
+    ws[0]->copyin(vector<float>{1, 2, 3, 4, 5, 6});
+    ws[1]->copyin(vector<float>{1, 2, 3});
+    ws[2]->copyin(vector<float>{0, 1, 1, 0, 1, 1});
+    ws[3]->copyin(vector<float>{1, 1, 1, 0, 0, 1});
+    biases[0]->copyin(vector<float>{1, -1});
+    biases[1]->copyin(vector<float>{10});
+    biases[2]->copyin(vector<float>{0, 0});
+
+    g->optimize();
+    EXPECT_TRUE(g->checkValid());
+    ASSERT_EQ(g->getOperators().size(), 2u);
+    auto fused = as<MatmulObj>(ys[0]->getSource());
+    ASSERT_NE(fused, nullptr);
+    EXPECT_EQ(fused->getOutputs(), (TensorVec{ys[0], ys[1], ys[2]}));
+    EXPECT_EQ(fused->getSplitN(), (vector<int>{2, 1, 2}));
+    EXPECT_TRUE(fused->getInputs(1)->isWeight());
+    EXPECT_EQ(fused->getInputs(1)->copyout<float>(),
+              (vector<float>{1, 2, 1, 0, 1, 3, 4, 2, 1, 0, 5, 6, 3, 1, 1}));
+    EXPECT_EQ(fused->getBias()->copyout<float>(),
+              (vector<float>{1, -1, 10, 0, 0}));
+    EXPECT_EQ(ys[3]->getSource()->numOutputs(), 1);
+
+    x->copyin(vector<float>{1, 0, 2, 0, 1, -1});
+    runtime->run(g);
+    EXPECT_TRUE(ys[0]->equalData(vector<float>{12, 13, -1, -3}));
+    EXPECT_TRUE(ys[1]->equalData(vector<float>{17, 9}));
+    EXPECT_TRUE(ys[2]->equalData(vector<float>{2, 3, 0, -1}));
+    EXPECT_TRUE(ys[3]->equalData(vector<float>{3, 2, 0, -1}));
+}
+
+TEST(GraphPass, HorizontalMatmulFusionMixedActivations) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({4, 8});
+    auto gate = g->addTensor({8, 16});
+    auto up = g->addTensor({8, 16});
+    x->setInput();
+    gate->setWeight();
+    up->setWeight();
+    // silu(x * gate) * (x * up), the gated FFN.
+    auto g0 = g->addOp<MatmulObj>(x, gate, nullptr, false, false, nullptr,
+                                  ActType::Silu);
+    auto u0 = g->addOp<MatmulObj>(x, up, nullptr);
+    auto y = g->addOp<MulObj>(g0->getOutput(), u0->getOutput(), nullptr)
+                 ->getOutput();
+    y->setOutput();
+    g->dataMalloc();
+
+    g->optimize();
+    EXPECT_TRUE(g->checkValid());
+    // The Silu leaves the epilogue and joins the Mul.
+    ASSERT_EQ(g->getOperators().size(), 2u);
+    auto fused = as<MatmulObj>(u0->getOutput()->getSource());
+    ASSERT_NE(fused, nullptr);
+    EXPECT_EQ(fused->getAct(), ActType::None);
+    EXPECT_EQ(fused->getSplitN(), (vector<int>{16, 16}));
+    EXPECT_EQ(y->getSource()->getOpType(), OpType::FusedElementWise);
+}
+
+} // namespace infini
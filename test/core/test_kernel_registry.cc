@@ -0,0 +1,97 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/perf_engine.h"
+#include "core/runtime.h"
+#include "operators/reshape.h"
+#include "operators/unary.h"
+#include "test.h"
+#include <thread>
+
+namespace infini {
+
+// Abs, but slow enough to lose any tuning.
+class SlowAbs : public CpuKernelWithoutConfig {
+    void compute(const Operator &op,
+                 const RuntimeObj *context) const override {
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+        auto in = op->getInputs(0)->getRawDataPtr<float *>();
+        auto out = op->getOutput()->getRawDataPtr<float *>();
+        for (size_t i = 0; i < op->getOutput()->size(); ++i)
+            out[i] = std::abs(in[i]);
+    }
+};
+
+REGISTER_KERNEL_CANDIDATE(Device::CPU, OpType::Abs, SlowAbs, "SlowAbs_CPU", 1,
+                          KernelConstraints());
+
+TEST(KernelRegistry, constraints) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    auto &registry = KernelRegistry::getInstance();
+    KernelAttrs relu{Device::CPU, OpType::Relu};
+    KernelAttrs clip{Device::CPU, OpType::Clip};
+    auto names = [&](const KernelAttrs &attrs, const Operator &op) {
+        vector<string> ret;
+        for (auto candidate : registry.getCandidates(attrs, op))
+            ret.emplace_back(candidate->name);
+        return ret;
+    };
+    Graph g = make_ref<GraphObj>(runtime);
+    auto f = g->addOp<ReluObj>(g->addTensor({2, 3}), nullptr);
+    auto h =
+        g->addOp<ReluObj>(g->addTensor({2, 3}, DataType::Float16), nullptr);
+    auto i = g->addOp<ClipObj>(g->addTensor({2, 3}, DataType::Int32), nullptr,
+                               0.f, 6.f);
+    EXPECT_EQ(names(relu, f),
+              (vector<string>{"Relu_infiniop_CPU", "reluNaive_CPU"}));
+    EXPECT_EQ(names(relu, h),
+              (vector<string>{"Relu_infiniop_CPU", "reluNaive_CPU"}));
+    EXPECT_EQ(names(clip, i), vector<string>{"Clip_infiniop_CPU"});
+
+    // A plain copy does not take a layout conversion.
+    KernelAttrs reshape{Device::CPU, OpType::Reshape};
+    auto x = g->addTensor({1, 2, 2, 3});
+    auto r = g->addOp<ReshapeObj>(x, nullptr, Shape{1, 2, 2, 3});
+    EXPECT_EQ(registry.getCandidates(reshape, r).size(), 2u);
+    r->getOutput()->setLayout(TensorLayout::NHWC);
+    EXPECT_EQ(registry.getCandidates(reshape, r).size(), 1u);
+
+    registry.forceKernel("Clip_CPU");
+    EXPECT_EQ(names(clip, i), vector<string>{"Clip_CPU"});
+    registry.clearForcedKernels();
+    EXPECT_EQ(names(clip, i), vector<string>{"Clip_infiniop_CPU"});
+}
+
+TEST(KernelRegistry, tuneCandidates) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    auto &registry = KernelRegistry::getInstance();
+    KernelAttrs abs{Device::CPU, OpType::Abs};
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({4, 5});
+    auto op = g->addOp<AbsObj>(x, nullptr);
+    g->dataMalloc();
+    x->setData(IncrementalGenerator());
+
+    // The highest-ranked candidate runs until tuning finds a faster one.
+    auto slow = registry.getKernel(abs, op);
+    ASSERT_EQ(registry.getCandidates(abs, op).front()->name, "SlowAbs_CPU");
+    runtime->run(g, true);
+    auto &perfEngine = PerfEngine::getInstance();
+    auto record = perfEngine.getPerfData({abs, op->getOpPerfKey()});
+    ASSERT_TRUE(record);
+    EXPECT_EQ(record->kernel, "absNaive_CPU");
+    EXPECT_NE(registry.getKernel(abs, op, record), slow);
+    EXPECT_TRUE(op->getOutput()->equalData(
+        vector<float>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+                      16, 17, 18, 19}));
+
+    // The kernel name survives the JSON of a record.
+    json j = record;
+    EXPECT_EQ(j.get<PerfRecord>()->kernel, "absNaive_CPU");
+
+    // A forced kernel wins over the record.
+    registry.forceKernel("SlowAbs_CPU");
+    EXPECT_EQ(registry.getKernel(abs, op, record), slow);
+    registry.clearForcedKernels();
+}
+
+} // namespace infini
@@ -25,7 +25,7 @@ TEST(LazyAllocator, testMergeFreeBlocks) {
     allocator.free(offsetC, c->getBytes());
     // expected to be a->mergedFreeBlock->d, where mergedFreeBlock is the result
     // of merging the memory blocks corresponding to the already freed b and c
-    EXPECT_EQ(allocator.freeBlocks.size(), 1);
+    EXPECT_EQ(allocator.freeBlocks.size(), 1u);
     EXPECT_EQ(allocator.freeBlocks.begin()->addr, offsetB);
     EXPECT_EQ(allocator.freeBlocks.begin()->blockSize,
               allocator.getAlignedSize(b->getBytes()) +
@@ -70,7 +70,7 @@ TEST(LazyAllocator, testAllocWithEndFreeBlock) {
     size_t offsetD = allocator.alloc(d->getBytes());
     allocator.info();
     // expected to be a->b->d, with no free block between b and c
-    EXPECT_EQ(allocator.freeBlocks.size(), 0);
+    EXPECT_EQ(allocator.freeBlocks.size(), 0u);
     EXPECT_EQ(offsetC, offsetD);
 }
 
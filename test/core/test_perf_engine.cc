@@ -0,0 +1,108 @@
+#include "core/perf_engine.h"
+#include "core/runtime.h"
+#include "test.h"
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+namespace infini {
+
+static PerfEngine::Key keyOf(int i) {
+    return {KernelAttrs{Device::CPU, OpType::MatMul},
+            OpPerfKey(HashType(i), OpType::MatMul, {i, 2 * i})};
+}
+
+static double timeOf(const PerfEngine &engine, int i) {
+    auto record = engine.getPerfData(keyOf(i));
+    return record ? record->time : -1;
+}
+
+TEST(PerfEngine, upsert) {
+    PerfEngine engine;
+    engine.setPerfData(keyOf(1), make_ref<PerfRecordObj>(2.0));
+    engine.setPerfData(keyOf(1), make_ref<PerfRecordObj>(3.0));
+    EXPECT_EQ(engine.size(), 1u);
+    EXPECT_EQ(timeOf(engine, 1), 3.0);
+    EXPECT_FALSE(engine.mergePerfData(keyOf(1), make_ref<PerfRecordObj>(4.0)));
+    EXPECT_TRUE(engine.mergePerfData(keyOf(1), make_ref<PerfRecordObj>(0.5)));
+    EXPECT_EQ(timeOf(engine, 1), 0.5);
+    EXPECT_EQ(timeOf(engine, 2), -1);
+}
+
+TEST(PerfEngine, concurrent) {
+    PerfEngine engine;
+    vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 1000; ++i) {
+                engine.setPerfData(keyOf(i), make_ref<PerfRecordObj>(t));
+                engine.getPerfData(keyOf(999 - i));
+            }
+        });
+    for (auto &thread : threads)
+        thread.join();
+    EXPECT_EQ(engine.size(), 1000u);
+}
+
+TEST(PerfEngine, saveAndLoad) {
+    string path = ::testing::TempDir() + "perf_engine.jsonl";
+    std::remove(path.c_str());
+    PerfEngine a;
+    a.setPerfData(keyOf(1), make_ref<PerfRecordObj>(0.25));
+    a.setPerfData(keyOf(2), make_ref<PerfRecordObj>(1.5));
+    a.savePerfEngineData(path);
+    PerfEngine b;
+    EXPECT_EQ(b.loadPerfEngineData(path), 2u);
+    // Sub-millisecond times are kept.
+    EXPECT_EQ(timeOf(b, 1), 0.25);
+    EXPECT_EQ(timeOf(b, 2), 1.5);
+
+    // Two processes append to one file; the fastest record of a key wins.
+    b.setPerfData(keyOf(2), make_ref<PerfRecordObj>(1.0));
+    b.setPerfData(keyOf(3), make_ref<PerfRecordObj>(3.0));
+    b.appendPerfEngineData(path);
+    a.setPerfData(keyOf(3), make_ref<PerfRecordObj>(4.0));
+    a.appendPerfEngineData(path);
+    // Only new records are appended.
+    a.appendPerfEngineData(path);
+    PerfEngine c;
+    EXPECT_EQ(c.loadPerfEngineData(path), 5u);
+    EXPECT_EQ(c.size(), 3u);
+    EXPECT_EQ(timeOf(c, 1), 0.25);
+    EXPECT_EQ(timeOf(c, 2), 1.0);
+    EXPECT_EQ(timeOf(c, 3), 3.0);
+
+    // A line cut short by a crashed writer is skipped.
+    std::ofstream(path, std::ios::app) << "{\"key\":[[1,";
+    PerfEngine d;
+    EXPECT_EQ(d.loadPerfEngineData(path), 5u);
+    // The next append starts on a new line, so its records are kept.
+    d.setPerfData(keyOf(4), make_ref<PerfRecordObj>(2.0));
+    d.appendPerfEngineData(path);
+    PerfEngine f;
+    EXPECT_EQ(f.loadPerfEngineData(path), 6u);
+    EXPECT_EQ(timeOf(f, 4), 2.0);
+
+    // Records of other hardware are not used.
+    PerfEngine e;
+    e.setFingerprint("other");
+    EXPECT_EQ(e.loadPerfEngineData(path), 0u);
+    EXPECT_EQ(e.size(), 0u);
+    e.setPerfData(keyOf(5), make_ref<PerfRecordObj>(1.0));
+    EXPECT_THROW(e.appendPerfEngineData(path), Exception);
+    std::remove(path.c_str());
+}
+
+TEST(PerfEngine, loadVersion1) {
+    string path = ::testing::TempDir() + "perf_engine.json";
+    PerfEngine a;
+    a.setPerfData(keyOf(1), make_ref<PerfRecordObj>(0.75));
+    json j = a;
+    std::ofstream(path) << j << std::endl;
+    PerfEngine b;
+    EXPECT_EQ(b.loadPerfEngineData(path), 1u);
+    EXPECT_EQ(timeOf(b, 1), 0.75);
+    std::remove(path.c_str());
+}
+
+} // namespace infini
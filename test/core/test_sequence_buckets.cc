@@ -0,0 +1,104 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/perf_engine.h"
+#include "core/runtime.h"
+#include "core/sequence_buckets.h"
+#include "operators/element_wise.h"
+#include "operators/matmul.h"
+#include "operators/unary.h"
+#include "test.h"
+
+namespace infini {
+
+// out = abs(x w) * y, x: [seq, 4], y: [seq, 6].
+static Graph buildGraph(const Runtime &runtime, int seq, Tensor &x,
+                        Tensor &y) {
+    Graph g = make_ref<GraphObj>(runtime);
+    x = g->addTensor({seq, 4});
+    auto w = g->addTensor({4, 6});
+    y = g->addTensor({seq, 6});
+    x->setInput();
+    y->setInput();
+    w->setWeight();
+    auto xw = g->addOp<MatmulObj>(x, w, nullptr)->getOutput();
+    auto a = g->addOp<AbsObj>(xw, nullptr)->getOutput();
+    g->addOp<MulObj>(a, y, nullptr)->getOutput()->setOutput();
+    g->dataMalloc();
+    w->copyin(vector<float>{1, -2, 3, 0, 1, 0, //
+                            0, 1, -1, 2, 0, 1, //
+                            2, 0, 0, 1, 1, -1, //
+                            1, 1, 1, 1, 1, 1});
+    return g;
+}
+
+// Rows of x and y for a request of `seq` rows, padded with zeros to `rows`.
+static void fill(const Tensor &x, const Tensor &y, int seq, int rows) {
+    vector<float> xs(rows * 4), ys(rows * 6);
+    for (int i = 0; i < seq * 4; ++i)
+        xs[i] = float(i % 7) - 3;
+    for (int i = 0; i < seq * 6; ++i)
+        ys[i] = float(i % 5) - 1;
+    x->copyin(xs);
+    y->copyin(ys);
+}
+
+TEST(SequenceBuckets, padToBucket) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Tensor x, y;
+    auto g = buildGraph(runtime, 2, x, y);
+    SymbolicGraph sg(g, {{"seq", {{x, 0}, {y, 0}}}});
+    SequenceBuckets buckets(sg, {{16}, {4}, {8}}, true);
+    ASSERT_EQ(buckets.getStats().size(), 3u);
+    EXPECT_EQ(buckets.getStats()[0].values, vector<int>{4});
+    EXPECT_EQ(buckets.getStats()[2].values, vector<int>{16});
+
+    // Every bucket is tuned for its own shapes.
+    auto &perfEngine = PerfEngine::getInstance();
+    for (int seq : {4, 8, 16}) {
+        sg.bind({seq});
+        for (auto &op : g->getOperators())
+            EXPECT_TRUE(perfEngine.getPerfData(
+                {KernelAttrs{Device::CPU, op->getOpType().underlying()},
+                 op->getOpPerfKey()}))
+                << "seq " << seq;
+    }
+
+    auto out = g->getOutputs()[0];
+    for (int seq : {5, 1, 8, 3}) {
+        int index = buckets.bind({seq});
+        int rows = buckets.getStats()[index].values[0];
+        EXPECT_GE(rows, seq);
+        EXPECT_EQ(out->getDims(), (Shape{rows, 6}));
+        fill(x, y, seq, rows);
+        runtime->run(g);
+
+        Tensor rx, ry;
+        auto ref = buildGraph(runtime, seq, rx, ry);
+        fill(rx, ry, seq, seq);
+        runtime->run(ref);
+        auto expected = ref->getOutputs()[0]->copyout<float>();
+        auto padded = out->copyout<float>();
+        padded.resize(expected.size());
+        EXPECT_EQ(padded, expected) << "seq " << seq;
+    }
+
+    auto &stats = buckets.getStats();
+    EXPECT_EQ(stats[0].hits, 2u);
+    EXPECT_EQ(stats[1].hits, 2u);
+    EXPECT_EQ(stats[2].hits, 0u);
+    // x and y hold 10 elements per row.
+    EXPECT_EQ(stats[0].usedElements, 40u);
+    EXPECT_EQ(stats[0].paddedElements, 40u);
+    EXPECT_EQ(stats[1].usedElements, 130u);
+    EXPECT_EQ(stats[1].paddedElements, 30u);
+
+    // Longer requests than every bucket run on their own shapes.
+    EXPECT_EQ(buckets.bind({20}), -1);
+    EXPECT_EQ(out->getDims(), (Shape{20, 6}));
+    EXPECT_EQ(buckets.getMisses(), 1u);
+    buckets.resetStats();
+    EXPECT_EQ(buckets.getMisses(), 0u);
+    EXPECT_EQ(buckets.getStats()[1].hits, 0u);
+}
+
+} // namespace infini
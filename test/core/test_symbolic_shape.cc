@@ -0,0 +1,113 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "core/symbolic_shape.h"
+#include "operators/concat.h"
+#include "operators/conv.h"
+#include "operators/element_wise.h"
+#include "operators/matmul.h"
+#include "operators/unary.h"
+#include "test.h"
+
+namespace infini {
+
+TEST(SymbolicShape, polynomial) {
+    vector<string> names{"b", "s"};
+    AffineExpr b{0, {1, 0}}, s2{-1, {0, 2}};
+    EXPECT_EQ(s2.toString(names), "2*s-1");
+    auto p = Polynomial(4) * Polynomial(b) * Polynomial(s2);
+    EXPECT_EQ(p.toString(names), "-4*b+8*b*s");
+    EXPECT_EQ(p.eval({3, 5}), 4 * 3 * 9);
+    auto q = p.upperBound(Polynomial(AffineExpr{7, {0, 1}}));
+    EXPECT_EQ(q.toString(names), "7+8*b*s+s");
+    for (int bv : {1, 2, 7})
+        for (int sv : {1, 3, 10})
+            EXPECT_GE(q.eval({bv, sv}), p.eval({bv, sv}));
+}
+
+// out = abs(concat(x w, x w, axis 0)) * concat(y, y, axis 0), x: [seq, 4],
+// y: [2 seq, 6].
+static Graph buildGraph(const Runtime &runtime, int seq, Tensor &x,
+                        Tensor &y) {
+    Graph g = make_ref<GraphObj>(runtime);
+    x = g->addTensor({seq, 4});
+    auto w = g->addTensor({4, 6});
+    y = g->addTensor({seq, 6});
+    x->setInput();
+    y->setInput();
+    w->setWeight();
+    auto xw = g->addOp<MatmulObj>(x, w, nullptr)->getOutput();
+    auto c = g->addOp<ConcatObj>(TensorVec{xw, xw}, nullptr, 0)->getOutput();
+    auto a = g->addOp<AbsObj>(c, nullptr)->getOutput();
+    auto yy = g->addOp<ConcatObj>(TensorVec{y, y}, nullptr, 0)->getOutput();
+    g->addOp<MulObj>(a, yy, nullptr)->getOutput()->setOutput();
+    g->dataMalloc();
+    w->copyin(vector<float>{1, -2, 3, 0, 1, 0, //
+                            0, 1, -1, 2, 0, 1, //
+                            2, 0, 0, 1, 1, -1, //
+                            1, 1, 1, 1, 1, 1});
+    return g;
+}
+
+static void fill(const Tensor &x, const Tensor &y) {
+    vector<float> xs(x->size()), ys(y->size());
+    for (size_t i = 0; i < xs.size(); ++i)
+        xs[i] = float(i % 7) - 3;
+    for (size_t i = 0; i < ys.size(); ++i)
+        ys[i] = float(i % 5) - 1;
+    x->copyin(xs);
+    y->copyin(ys);
+}
+
+TEST(SymbolicShape, bind) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Tensor x, y;
+    auto g = buildGraph(runtime, 2, x, y);
+    SymbolicGraph sg(g, {{"seq", {{x, 0}, {y, 0}}}});
+    auto out = g->getOutputs()[0];
+    EXPECT_EQ(sg.getDims(out)[0].toString({"seq"}), "2*seq");
+    EXPECT_EQ(sg.getBytes(out).toString({"seq"}), "48*seq");
+    // x, y and out keep their slots; the other four share two.
+    EXPECT_EQ(sg.getNumSlots(), 5u);
+
+    for (int seq : {5, 1, 9, 5}) {
+        sg.bind({seq});
+        EXPECT_EQ(out->getDims(), (Shape{2 * seq, 6}));
+        fill(x, y);
+        runtime->run(g);
+
+        Tensor rx, ry;
+        auto ref = buildGraph(runtime, seq, rx, ry);
+        fill(rx, ry);
+        runtime->run(ref);
+        EXPECT_TRUE(out->equalData(ref->getOutputs()[0])) << "seq " << seq;
+        EXPECT_LE(sg.getActivationBytes({seq}),
+                  ref->getActivationBytes() + 256 * sg.getNumSlots());
+    }
+}
+
+TEST(SymbolicShape, notAffine) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({3, 4});
+    auto b = g->addTensor({3, 4});
+    a->setInput();
+    b->setInput();
+    g->addOp<MatmulObj>(a, b, nullptr, false, true)->getOutput()->setOutput();
+    g->dataMalloc();
+    SymbolicGraph sg(g, {{"n", {{a, 0}, {b, 0}}}});
+    EXPECT_EQ(sg.getBytes(g->getOutputs()[0]).toString({"n"}), "4*n*n");
+    // The contracted dimension of only one side cannot change.
+    EXPECT_THROW(SymbolicGraph(g, {{"k", {{a, 1}}}}), Exception);
+
+    // A strided convolution halves its input, which is not affine.
+    Graph c = make_ref<GraphObj>(runtime);
+    auto x = c->addTensor({1, 1, 4, 4});
+    auto w = c->addTensor({1, 1, 1, 1});
+    x->setInput();
+    w->setWeight();
+    c->addOp<ConvObj>(x, w, nullptr, 0, 0, nullptr, 2, 2);
+    c->dataMalloc();
+    EXPECT_THROW(SymbolicGraph(c, {{"h", {{x, 2}}}}), Exception);
+}
+
+} // namespace infini
@@ -3,11 +3,13 @@
 #include "core/runtime.h"
 #include "operators/matmul.h"
 #include "test.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 
 namespace infini {
 
 TEST(Prtotbuf, save_and_load) {
-#ifdef TENSOR_PROTOBUF
     Runtime runtime = NativeCpuRuntimeObj::getInstance();
     Graph g = make_ref<GraphObj>(runtime);
     Tensor i0 = g->addTensor({1, 3, 4}, DataType::Float32);
@@ -29,7 +31,73 @@ TEST(Prtotbuf, save_and_load) {
     u1->load("u.pb");
     u1->printData();
     EXPECT_TRUE(u1->equalData(u0));
-#endif
+}
+
+TEST(TensorSave, allDataTypes) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    string path = ::testing::TempDir() + "tensor.npy";
+    for (auto dtype :
+         {DataType::Float32, DataType::UInt8, DataType::Int8,
+          DataType::UInt16, DataType::Int16, DataType::Int32,
+          DataType::Int64, DataType::Bool, DataType::Float16,
+          DataType::Double, DataType::UInt32, DataType::UInt64,
+          DataType::BFloat16}) {
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor a = g->addTensor({2, 3, 5}, dtype);
+        Tensor b = g->addTensor({2, 3, 5}, dtype);
+        g->dataMalloc();
+        auto src = a->getRawDataPtr<uint8_t *>();
+        for (size_t i = 0; i < a->getBytes(); ++i)
+            src[i] = dtype.toString() == "Bool" ? i % 2 : i * 7 + 1;
+        a->save(path);
+        for (bool useMmap : {false, true}) {
+            std::memset(b->getRawDataPtr<void *>(), 0, b->getBytes());
+            b->load(path, useMmap);
+            EXPECT_EQ(std::memcmp(b->getRawDataPtr<void *>(), src,
+                                  a->getBytes()),
+                      0)
+                << dtype.toString() << (useMmap ? " mapped" : "");
+        }
+    }
+    std::remove(path.c_str());
+}
+
+TEST(TensorSave, npyHeader) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor a = g->addTensor({7}, DataType::Int64);
+    g->dataMalloc();
+    a->copyin(vector<int64_t>{1, 2, 3, 4, 5, 6, 7});
+    string path = ::testing::TempDir() + "tensor.npy";
+    a->save(path);
+
+    std::ifstream file(path, std::ios::binary);
+    string bytes((std::istreambuf_iterator<char>(file)),
+                 std::istreambuf_iterator<char>());
+    std::remove(path.c_str());
+    ASSERT_EQ(bytes.substr(0, 8), string("\x93NUMPY\x01\x00", 8));
+    size_t length = uint8_t(bytes[8]) | uint8_t(bytes[9]) << 8;
+    EXPECT_EQ((10 + length) % 64, 0u);
+    auto header = bytes.substr(10, length);
+    EXPECT_EQ(header.find("{'descr': '<i8', 'fortran_order': False, "
+                          "'shape': (7,), }"),
+              0u);
+    EXPECT_EQ(header.back(), '\n');
+    EXPECT_EQ(bytes.size(), 10 + length + a->getBytes());
+}
+
+TEST(TensorSave, mismatch) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor a = g->addTensor({2, 3}, DataType::Float32);
+    Tensor b = g->addTensor({3, 2}, DataType::Float32);
+    Tensor c = g->addTensor({2, 3}, DataType::Int32);
+    g->dataMalloc();
+    string path = ::testing::TempDir() + "tensor.npy";
+    a->save(path);
+    EXPECT_THROW(b->load(path), Exception);
+    EXPECT_THROW(c->load(path, true), Exception);
+    std::remove(path.c_str());
 }
 
 } // namespace infini
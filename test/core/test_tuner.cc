@@ -0,0 +1,135 @@
+#include "core/graph.h"
+#include "core/perf_engine.h"
+#include "core/runtime.h"
+#include "core/tuner.h"
+#include "operators/gemm.h"
+#include "operators/unary.h"
+#include "test.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace infini {
+
+static void spin(double us) {
+    auto end = std::chrono::steady_clock::now() +
+               std::chrono::duration<double, std::micro>(us);
+    while (std::chrono::steady_clock::now() < end)
+        ;
+}
+
+TEST(Tuner, measure) {
+    Tuner tuner;
+    tuner.getOptions().flushBytes = 1 << 20;
+    double t = tuner.measure([] { spin(200); });
+    EXPECT_GT(t, 0.19);
+    EXPECT_LT(t, 1.0);
+
+    // Slow trials, e.g. from preemption, do not move the median.
+    int calls = 0;
+    t = tuner.measure([&] { spin(++calls % 5 ? 200 : 5000); });
+    EXPECT_LT(t, 1.0);
+
+    // A fast kernel is repeated within a trial.
+    calls = 0;
+    tuner.measure([&] { ++calls; });
+    EXPECT_GT(calls, tuner.getOptions().maxRounds);
+}
+
+TEST(Tuner, graph) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    auto &options = Tuner::getInstance().getOptions();
+    auto &perfEngine = PerfEngine::getInstance();
+    // Abs of x -> a -> b and of y -> c, z -> d: a and b share a record, as
+    // do c and d.
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({3, 7}), y = g->addTensor({5, 7}),
+         z = g->addTensor({5, 7});
+    auto a = g->addOp<AbsObj>(x, nullptr)->getOutput();
+    auto b = g->addOp<AbsObj>(a, nullptr)->getOutput();
+    auto c = g->addOp<AbsObj>(y, nullptr)->getOutput();
+    auto d = g->addOp<AbsObj>(z, nullptr)->getOutput();
+    g->dataMalloc();
+    x->setData(ValGenerator<-1>());
+    y->setData(ValGenerator<-2>());
+    z->setData(ValGenerator<-3>());
+
+    // Nothing is tuned once the budget is spent.
+    options.graphBudget = 1e-9;
+    auto stats = Tuner::getInstance().tuneGraph(g, runtime.get());
+    EXPECT_EQ(stats.tuned, 0u);
+    EXPECT_EQ(stats.skipped, 2u);
+    EXPECT_EQ(stats.reused, 2u);
+    EXPECT_EQ(perfEngine.size(), 0u);
+    options.graphBudget = 0;
+
+    // Operators of independent tensors are tuned at once.
+    options.threads = 4;
+    runtime->run(g, true);
+    options.threads = 1;
+    EXPECT_EQ(perfEngine.size(), 2u);
+    EXPECT_TRUE(b->equalData(vector<float>(21, 1)));
+    EXPECT_TRUE(c->equalData(vector<float>(35, 2)));
+    EXPECT_TRUE(d->equalData(vector<float>(35, 3)));
+    for (auto &op : g->getOperators()) {
+        auto record = perfEngine.getPerfData(
+            {{Device::CPU, OpType::Abs}, op->getOpPerfKey()});
+        ASSERT_TRUE(record);
+        EXPECT_EQ(record->kernel, "absNaive_CPU");
+    }
+    stats = Tuner::getInstance().tuneGraph(g, runtime.get());
+    EXPECT_EQ(stats.reused, 4u);
+}
+
+TEST(Tuner, workspacePerThread) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    void *shared = runtime->getWorkspace(64);
+    void *ptrs[2];
+    std::atomic<int> ready{0};
+    auto worker = [&](int w) {
+        NativeCpuRuntimeObj::ThreadWorkspace workspace;
+        ptrs[w] = runtime->getWorkspace(64);
+        // Keep both workspaces alive so their addresses can not be reused
+        ready++;
+        while (ready < 2)
+            std::this_thread::yield();
+    };
+    std::thread t0(worker, 0), t1(worker, 1);
+    t0.join();
+    t1.join();
+    EXPECT_NE(ptrs[0], shared);
+    EXPECT_NE(ptrs[1], shared);
+    EXPECT_NE(ptrs[0], ptrs[1]);
+    EXPECT_EQ(runtime->getWorkspace(64), shared);
+}
+
+TEST(Tuner, parallelGemm) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    auto &options = Tuner::getInstance().getOptions();
+    auto &perfEngine = PerfEngine::getInstance();
+    auto records = perfEngine.get_data();
+    perfEngine.set_data({});
+    // Two Gemms of independent tensors, whose kernels take the runtime
+    // workspace, are tuned at once.
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a0 = g->addTensor({2, 3}), b0 = g->addTensor({3, 4});
+    auto a1 = g->addTensor({4, 5}), b1 = g->addTensor({5, 2});
+    auto y0 = g->addOp<GemmObj>(a0, b0, nullptr, nullptr)->getOutput();
+    auto y1 = g->addOp<GemmObj>(a1, b1, nullptr, nullptr)->getOutput();
+    g->dataMalloc();
+    a0->setData(OneGenerator());
+    b0->setData(ValGenerator<2>());
+    a1->setData(ValGenerator<3>());
+    b1->setData(OneGenerator());
+
+    options.threads = 2;
+    auto stats = Tuner::getInstance().tuneGraph(g, runtime.get());
+    options.threads = 1;
+    EXPECT_EQ(stats.tuned, 2u);
+    runtime->run(g);
+    EXPECT_TRUE(y0->equalData(vector<float>(8, 6)));
+    EXPECT_TRUE(y1->equalData(vector<float>(8, 15)));
+    perfEngine.set_data(records);
+}
+
+} // namespace infini
@@ -0,0 +1,73 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini {
+
+template <typename S, typename D>
+static vector<D> runCast(const vector<S> &data, DataType src, DataType dst,
+                         CastType type) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto i = g->addTensor({(int)data.size()}, src);
+    auto op = g->addOp<CastObj>(i, nullptr, type);
+    EXPECT_EQ(op->getOutput()->getDType(), dst);
+    g->dataMalloc();
+    i->copyin(data);
+    runtime->run(g);
+    vector<D> ans(data.size());
+    op->getOutput()->copyout(ans.data(), ans.size() * sizeof(D));
+    return ans;
+}
+
+TEST(Cast, NativeCpu) {
+    vector<float> f{-3.75f, -1.f, 0.f, 0.5f, 2.25f, 100.f};
+    EXPECT_EQ((runCast<float, int32_t>(f, DataType::Float32, DataType::Int32,
+                                       CastType::Float2Int32)),
+              (vector<int32_t>{-3, -1, 0, 0, 2, 100}));
+    EXPECT_EQ((runCast<float, int64_t>(f, DataType::Float32, DataType::Int64,
+                                       CastType::Float2Int64)),
+              (vector<int64_t>{-3, -1, 0, 0, 2, 100}));
+    EXPECT_EQ((runCast<int64_t, int32_t>({-7, 0, 1 << 20}, DataType::Int64,
+                                         DataType::Int32,
+                                         CastType::Int642Int32)),
+              (vector<int32_t>{-7, 0, 1 << 20}));
+    EXPECT_EQ((runCast<uint8_t, float>({0, 7, 255}, DataType::UInt8,
+                                       DataType::Float32,
+                                       CastType::Uint82Float)),
+              (vector<float>{0.f, 7.f, 255.f}));
+}
+
+TEST(Cast, NativeCpuHalf) {
+    vector<float> f{-3.75f, -1.f, 0.f, 0.5f, 2.25f, 100.f};
+    auto h = runCast<float, uint16_t>(f, DataType::Float32, DataType::Float16,
+                                      CastType::Float2Float16);
+    for (size_t i = 0; i < f.size(); ++i)
+        EXPECT_EQ(h[i], float_to_fp16(f[i]));
+    EXPECT_EQ((runCast<uint16_t, float>(h, DataType::Float16,
+                                        DataType::Float32,
+                                        CastType::Float162Float)),
+              f);
+    auto b = runCast<float, uint16_t>(f, DataType::Float32, DataType::BFloat16,
+                                      CastType::Float2BFloat16);
+    EXPECT_EQ((runCast<uint16_t, float>(b, DataType::BFloat16,
+                                        DataType::Float32,
+                                        CastType::BFloat162Float)),
+              f);
+}
+
+TEST(Cast, NativeCpuLarge) {
+    // Spans several parallel chunks.
+    vector<int32_t> data(300000);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = (int32_t)i - 150000;
+    auto ans = runCast<int32_t, int64_t>(data, DataType::Int32,
+                                         DataType::Int64,
+                                         CastType::Int322Int64);
+    for (size_t i = 0; i < data.size(); ++i)
+        ASSERT_EQ(ans[i], data[i]);
+}
+
+} // namespace infini
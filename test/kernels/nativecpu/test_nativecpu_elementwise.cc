@@ -1,6 +1,7 @@
 #include "core/graph.h"
 #include "core/runtime.h"
 #include "operators/element_wise.h"
+#include "operators/unary.h"
 
 #include "test.h"
 
@@ -41,4 +42,49 @@ TEST(ElementWise, NativeCpu) {
         Shape{2, 1, 1}, ExpectOutput{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11});
 }
 
+TEST(ElementWise, NativeCpuBroadcastPatterns) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    // Row broadcast, scalar, and a pattern that changes inside the shape.
+    auto a = g->addTensor({2, 3}, DataType::Int32);
+    auto b = g->addTensor({3}, DataType::Int32);
+    auto s = g->addTensor({1}, DataType::Int32);
+    auto c = g->addTensor({2, 1, 3}, DataType::Int32);
+    auto d = g->addTensor({1, 2, 1}, DataType::Int32);
+    auto sub = g->addOp<SubObj>(a, b, nullptr);
+    auto mul = g->addOp<MulObj>(s, a, nullptr);
+    auto cmp = g->addOp<GreaterThanObj>(c, d, nullptr);
+    g->dataMalloc();
+    a->copyin(vector<int32_t>{1, 2, 3, 4, 5, 6});
+    b->copyin(vector<int32_t>{1, 1, 2});
+    s->copyin(vector<int32_t>{-3});
+    c->copyin(vector<int32_t>{0, 1, 2, 3, 4, 5});
+    d->copyin(vector<int32_t>{1, 4});
+    runtime->run(g);
+    EXPECT_EQ(sub->getOutput()->copyout<int32_t>(),
+              (vector<int32_t>{0, 1, 1, 3, 4, 4}));
+    EXPECT_EQ(mul->getOutput()->copyout<int32_t>(),
+              (vector<int32_t>{-3, -6, -9, -12, -15, -18}));
+    EXPECT_EQ(cmp->getOutput()->getDims(), (Shape{2, 2, 3}));
+    EXPECT_EQ(cmp->getOutput()->copyout<int32_t>(),
+              (vector<int32_t>{0, 0, 1, 0, 0, 0, 1, 1, 1, 0, 0, 1}));
+}
+
+TEST(Unary, NativeCpuIntegerTypes) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto i8 = g->addTensor({4}, DataType::Int8);
+    auto i64 = g->addTensor({4}, DataType::Int64);
+    auto absOp = g->addOp<AbsObj>(i8, nullptr);
+    auto negOp = g->addOp<NegObj>(i64, nullptr);
+    g->dataMalloc();
+    i8->copyin(vector<int8_t>{-3, 0, 7, -128 + 1});
+    i64->copyin(vector<int64_t>{-3, 0, 7, int64_t(1) << 40});
+    runtime->run(g);
+    EXPECT_EQ(absOp->getOutput()->copyout<int8_t>(),
+              (vector<int8_t>{3, 0, 7, 127}));
+    EXPECT_EQ(negOp->getOutput()->copyout<int64_t>(),
+              (vector<int64_t>{3, 0, -7, -(int64_t(1) << 40)}));
+}
+
 } // namespace infini
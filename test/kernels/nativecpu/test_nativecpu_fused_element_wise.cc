@@ -0,0 +1,88 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/fused_element_wise.h"
+
+#include "test.h"
+
+namespace infini {
+
+using Instr = FusedElementWiseObj::Instr;
+
+// relu(a * b + c) with a {n, 3, w}, b {3, 1} and c {w}.
+static void testFused(int n, int w, DataType dtype) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({n, 3, w}, dtype);
+    auto b = g->addTensor({3, 1}, dtype);
+    auto c = g->addTensor({w}, dtype);
+    vector<Instr> program{{OpType::Mul, 0, 1},
+                          {OpType::Add, 3, 2},
+                          {OpType::Relu, 4, -1}};
+    auto op = g->addOp<FusedElementWiseObj>(TensorVec{a, b, c}, nullptr,
+                                            program);
+    EXPECT_EQ(op->getOutput()->getDims(), (Shape{n, 3, w}));
+    g->dataMalloc();
+
+    vector<float> va(n * 3 * w), vb{1, -1, 0.5}, vc(w), ans(va.size());
+    for (size_t i = 0; i < va.size(); ++i)
+        va[i] = float(int(i % 17) - 8);
+    for (int i = 0; i < w; ++i)
+        vc[i] = float(i % 5) - 2;
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < 3; ++j)
+            for (int k = 0; k < w; ++k) {
+                int idx = (i * 3 + j) * w + k;
+                ans[idx] = std::max(0.f, va[idx] * vb[j] + vc[k]);
+            }
+    if (dtype == DataType::Float16) {
+        auto toHalf = [](const vector<float> &v) {
+            vector<uint16_t> ret(v.size());
+            for (size_t i = 0; i < v.size(); ++i)
+                ret[i] = float_to_fp16(v[i]);
+            return ret;
+        };
+        a->copyin(toHalf(va));
+        b->copyin(toHalf(vb));
+        c->copyin(toHalf(vc));
+        runtime->run(g);
+        auto out = op->getOutput()->copyout<uint16_t>();
+        for (size_t i = 0; i < ans.size(); ++i)
+            EXPECT_EQ(fp16_to_float(out[i]), ans[i]);
+    } else {
+        a->copyin(va);
+        b->copyin(vb);
+        c->copyin(vc);
+        runtime->run(g);
+        EXPECT_TRUE(op->getOutput()->equalData(ans));
+    }
+}
+
+TEST(FusedElementWise, NativeCpu) {
+    testFused(2, 4, DataType::Float32);
+    // Rows longer than one block, and enough work to run in parallel.
+    testFused(64, 1000, DataType::Float32);
+    testFused(2, 4, DataType::Float16);
+}
+
+TEST(FusedElementWise, ScalarAndReuse) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor(Shape{5});
+    auto s = g->addTensor(Shape{1});
+    // x * sigmoid(x) - s, reading register 0 twice.
+    vector<Instr> program{{OpType::Sigmoid, 0, -1},
+                          {OpType::Mul, 0, 2},
+                          {OpType::Sub, 3, 1}};
+    auto op =
+        g->addOp<FusedElementWiseObj>(TensorVec{x, s}, nullptr, program);
+    g->dataMalloc();
+    vector<float> vx{-2, -1, 0, 1, 2}, ans;
+    x->copyin(vx);
+    s->copyin(vector<float>{0.5});
+    runtime->run(g);
+    for (float v : vx)
+        ans.push_back(v / (1 + std::exp(-v)) - 0.5f);
+    EXPECT_TRUE(op->getOutput()->equalData(ans));
+}
+
+} // namespace infini
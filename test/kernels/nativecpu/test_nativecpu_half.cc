@@ -0,0 +1,124 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/matmul.h"
+#include "operators/softmax.h"
+
+#include "test.h"
+
+namespace infini {
+
+static void copyinAsHalf(Tensor t, const vector<float> &data) {
+    vector<uint16_t> raw(data.size());
+    if (t->getDType() == DataType::Float16)
+        float_to_fp16(data.data(), raw.data(), data.size());
+    else
+        float_to_bfp16(data.data(), raw.data(), data.size());
+    t->copyin(raw.data(), raw.size() * sizeof(uint16_t));
+}
+
+static vector<float> copyoutAsFloat(Tensor t) {
+    vector<uint16_t> raw(t->size());
+    vector<float> ans(t->size());
+    t->copyout(raw.data(), raw.size() * sizeof(uint16_t));
+    if (t->getDType() == DataType::Float16)
+        fp16_to_float(raw.data(), ans.data(), ans.size());
+    else
+        bfp16_to_float(raw.data(), ans.data(), ans.size());
+    return ans;
+}
+
+static void expectNear(const vector<float> &a, const vector<float> &b,
+                       float tol) {
+    ASSERT_EQ(a.size(), b.size());
+    for (size_t i = 0; i < a.size(); ++i)
+        EXPECT_NEAR(a[i], b[i], tol) << "at " << i;
+}
+
+TEST(HalfConvert, RoundTrip) {
+    vector<float> src;
+    for (int i = -100; i < 100; ++i)
+        src.push_back(i * 0.37f);
+    vector<uint16_t> h(src.size());
+    vector<float> back(src.size());
+    float_to_fp16(src.data(), h.data(), src.size());
+    for (size_t i = 0; i < src.size(); ++i)
+        EXPECT_EQ(h[i], float_to_fp16(src[i]));
+    fp16_to_float(h.data(), back.data(), src.size());
+    expectNear(back, src, 0.02f);
+    float_to_bfp16(src.data(), h.data(), src.size());
+    bfp16_to_float(h.data(), back.data(), src.size());
+    expectNear(back, src, 0.2f);
+}
+
+TEST(HalfConvert, TiesToEven) {
+    // 1 + 2^-11 and 1 + 3 * 2^-11 lie halfway between two halves.
+    vector<float> src{1.00048828125f, 1.00146484375f, -1.00048828125f};
+    vector<uint16_t> expected{0x3C00, 0x3C02, 0xBC00}, h(src.size());
+    float_to_fp16(src.data(), h.data(), src.size());
+    for (size_t i = 0; i < src.size(); ++i) {
+        EXPECT_EQ(float_to_fp16(src[i]), expected[i]);
+        EXPECT_EQ(h[i], expected[i]);
+    }
+}
+
+class HalfKernel : public testing::TestWithParam<DataType> {};
+
+TEST_P(HalfKernel, ElementWise) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto t1 = g->addTensor({2, 3}, GetParam());
+    auto t2 = g->addTensor({3}, GetParam());
+    auto op = g->addOp<MulObj>(t1, t2, nullptr);
+    g->dataMalloc();
+    copyinAsHalf(t1, {0, 1, 2, 3, 4, 5});
+    copyinAsHalf(t2, {0.5, 2, -1});
+    runtime->run(g);
+    expectNear(copyoutAsFloat(op->getOutput()), {0, 2, -2, 1.5, 8, -5}, 1e-2);
+}
+
+TEST_P(HalfKernel, Softmax) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto t = g->addTensor({2, 2}, GetParam());
+    auto op = g->addOp<SoftmaxObj>(t, nullptr, 1);
+    g->dataMalloc();
+    copyinAsHalf(t, {0, 1, 2, 2});
+    runtime->run(g);
+    expectNear(copyoutAsFloat(op->getOutput()), {0.2689, 0.7311, 0.5, 0.5},
+               1e-2);
+}
+
+TEST_P(HalfKernel, Matmul) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({2, 2, 3}, GetParam());
+    auto b = g->addTensor({3, 2}, GetParam());
+    auto op = g->addOp<MatmulObj>(a, b, nullptr);
+    g->dataMalloc();
+    copyinAsHalf(a, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11});
+    copyinAsHalf(b, {1, 0, 0, 1, 1, 1});
+    runtime->run(g);
+    expectNear(copyoutAsFloat(op->getOutput()),
+               {2, 3, 8, 9, 14, 15, 20, 21}, 1e-1);
+}
+
+TEST_P(HalfKernel, MatmulBatchBroadcast) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    // A broadcasts over the second batch dimension only.
+    auto a = g->addTensor({2, 1, 1, 2}, GetParam());
+    auto b = g->addTensor({2, 3, 2, 1}, GetParam());
+    auto op = g->addOp<MatmulObj>(a, b, nullptr);
+    g->dataMalloc();
+    copyinAsHalf(a, {1, 2, 3, 4});
+    copyinAsHalf(b, {1, 0, 0, 1, 1, 1, 1, 0, 0, 1, 1, 1});
+    runtime->run(g);
+    expectNear(copyoutAsFloat(op->getOutput()), {1, 2, 3, 3, 4, 7}, 1e-1);
+}
+
+INSTANTIATE_TEST_SUITE_P(NativeCpu, HalfKernel,
+                         testing::Values(DataType::Float16,
+                                         DataType::BFloat16));
+
+} // namespace infini
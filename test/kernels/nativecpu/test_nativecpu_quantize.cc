@@ -0,0 +1,378 @@
+#include "core/graph.h"
+#include "core/graph_handler.h"
+#include "core/runtime.h"
+#include "operators/conv.h"
+#include "operators/element_wise.h"
+#include "operators/matmul.h"
+#include "operators/quantize.h"
+
+#include "test.h"
+
+namespace infini {
+
+TEST(DequantizeLinear, NativeCpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({2, 3}, DataType::UInt8);
+    auto scale = g->addTensor({3}, DataType::Float32);
+    auto zp = g->addTensor({3}, DataType::UInt8);
+    auto op = g->addOp<DequantizeLinearObj>(x, scale, zp, nullptr, 1);
+    g->dataMalloc();
+    vector<uint8_t> xData{0, 10, 20, 30, 40, 50}, zpData{0, 10, 20};
+    x->copyin(xData.data(), xData.size());
+    scale->copyin(vector<float>{1, 0.5, 2});
+    zp->copyin(zpData.data(), zpData.size());
+    runtime->run(g);
+    EXPECT_TRUE(op->getOutput()->equalData(vector<float>{0, 0, 0, 30, 15, 60}));
+}
+
+TEST(DequantizeLinear, PerTensorBias) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    // The default axis 1 does not exist in a 1-D bias; a per-tensor scale
+    // ignores it.
+    auto x = g->addTensor({3}, DataType::Int32);
+    auto scale = g->addTensor({1}, DataType::Float32);
+    auto zp = g->addTensor({1}, DataType::Int32);
+    auto op = g->addOp<DequantizeLinearObj>(x, scale, zp, nullptr);
+    auto q = g->addOp<QuantizeLinearObj>(op->getOutput(), scale, nullptr,
+                                         nullptr);
+    g->dataMalloc();
+    vector<int32_t> xData{-4, 0, 10}, zpData{2};
+    x->copyin(xData.data(), xData.size() * sizeof(int32_t));
+    zp->copyin(zpData.data(), sizeof(int32_t));
+    scale->copyin(vector<float>{0.5});
+    runtime->run(g);
+    EXPECT_TRUE(op->getOutput()->equalData(vector<float>{-3, -1, 4}));
+    vector<uint8_t> out(3);
+    q->getOutput()->copyout(out.data(), out.size());
+    EXPECT_EQ(out, (vector<uint8_t>{0, 0, 8}));
+}
+
+TEST(QuantizeLinear, NativeCpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({6}, DataType::Float32);
+    auto scale = g->addTensor({1}, DataType::Float32);
+    auto zp = g->addTensor({1}, DataType::Int8);
+    auto op = g->addOp<QuantizeLinearObj>(x, scale, zp, nullptr, 0);
+    EXPECT_EQ(op->getOutput()->getDType(), DataType::Int8);
+    g->dataMalloc();
+    x->copyin(vector<float>{-300, -1.5, -0.5, 0.5, 2.6, 300});
+    scale->copyin(vector<float>{1});
+    int8_t zpData = 1;
+    zp->copyin(&zpData, 1);
+    runtime->run(g);
+    vector<int8_t> ans{-128, -1, 1, 1, 4, 127}, out(6);
+    op->getOutput()->copyout(out.data(), out.size());
+    EXPECT_EQ(out, ans);
+}
+
+// Quantized tensors are given as uint8 activations, int8 weights and
+// per-tensor float parameters.
+struct QParams {
+    float scale;
+    int zeroPoint;
+};
+
+template <typename T> static void addQParams(Graph &g, TensorVec &tensors) {
+    tensors.push_back(g->addTensor({1}, DataType::Float32));
+    tensors.push_back(g->addTensor({1}, DataType::get<T>()));
+}
+
+TEST(QLinearMatmul, NativeCpu) {
+    const int M = 3, K = 70, N = 5;
+    QParams pa{0.02f, 128}, pb{0.01f, 3}, py{0.05f, 100};
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({M, K}, DataType::UInt8);
+    auto b = g->addTensor({K, N}, DataType::Int8);
+    TensorVec in{a};
+    addQParams<uint8_t>(g, in);
+    in.push_back(b);
+    addQParams<int8_t>(g, in);
+    addQParams<uint8_t>(g, in);
+    auto op = g->addOp<QLinearMatmulObj>(in, nullptr);
+    g->dataMalloc();
+    vector<uint8_t> aData(M * K);
+    vector<int8_t> bData(K * N);
+    for (int i = 0; i < M * K; ++i)
+        aData[i] = i * 37 % 256;
+    for (int i = 0; i < K * N; ++i)
+        bData[i] = int8_t(i * 13 % 255 - 127);
+    a->copyin(aData.data(), aData.size());
+    b->copyin(bData.data(), bData.size());
+    uint8_t za = pa.zeroPoint, zy = py.zeroPoint;
+    int8_t zb = pb.zeroPoint;
+    in[1]->copyin(vector<float>{pa.scale});
+    in[2]->copyin(&za, 1);
+    in[4]->copyin(vector<float>{pb.scale});
+    in[5]->copyin(&zb, 1);
+    in[6]->copyin(vector<float>{py.scale});
+    in[7]->copyin(&zy, 1);
+    runtime->run(g);
+    vector<uint8_t> out(M * N);
+    op->getOutput()->copyout(out.data(), out.size());
+    for (int i = 0; i < M; ++i)
+        for (int j = 0; j < N; ++j) {
+            float acc = 0;
+            for (int k = 0; k < K; ++k)
+                acc += (aData[i * K + k] - za) * pa.scale *
+                       (bData[k * N + j] - zb) * pb.scale;
+            float ref = std::clamp(std::nearbyint(acc / py.scale) + zy,
+                                   0.f, 255.f);
+            EXPECT_NEAR(out[i * N + j], ref, 1) << i << "," << j;
+        }
+}
+
+TEST(QLinearMatmul, FoldQDQ) {
+    const int M = 2, K = 67, N = 3;
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto xq = g->addTensor({M, K}, DataType::UInt8);
+    auto xs = g->addTensor({1}, DataType::Float32);
+    auto xz = g->addTensor({1}, DataType::UInt8);
+    auto wq = g->addTensor({K, N}, DataType::Int8);
+    auto ws = g->addTensor({N}, DataType::Float32);
+    auto wz = g->addTensor({N}, DataType::Int8);
+    auto ys = g->addTensor({1}, DataType::Float32);
+    auto yz = g->addTensor({1}, DataType::UInt8);
+    xq->setInput();
+    for (auto &t : {xs, xz, wq, ws, wz, ys, yz})
+        t->setWeight();
+    auto x = g->addOp<DequantizeLinearObj>(xq, xs, xz, nullptr)->getOutput();
+    auto w = g->addOp<DequantizeLinearObj>(wq, ws, wz, nullptr, 1)->getOutput();
+    auto y = g->addOp<MatmulObj>(x, w, nullptr)->getOutput();
+    auto yq = g->addOp<QuantizeLinearObj>(y, ys, yz, nullptr)->getOutput();
+    g->dataMalloc();
+    vector<uint8_t> xData(M * K);
+    vector<int8_t> wData(K * N), wzData{0, 2, -1};
+    for (int i = 0; i < M * K; ++i)
+        xData[i] = i * 37 % 256;
+    for (int i = 0; i < K * N; ++i)
+        wData[i] = int8_t(i * 13 % 255 - 127);
+    vector<float> wsData{0.01f, 0.02f, 0.005f};
+    uint8_t xzData = 120, yzData = 128;
+    xq->copyin(xData.data(), xData.size());
+    xs->copyin(vector<float>{0.02f});
+    xz->copyin(&xzData, 1);
+    wq->copyin(wData.data(), wData.size());
+    ws->copyin(wsData);
+    wz->copyin(wzData.data(), wzData.size());
+    ys->copyin(vector<float>{0.5f});
+    yz->copyin(&yzData, 1);
+
+    EXPECT_TRUE(g->foldQuantizeDequantize());
+    ASSERT_EQ(g->getOperators().size(), 1u);
+    auto op = as<QLinearMatmulObj>(g->getOperators()[0]);
+    // The constant B is transposed once, by the fold.
+    EXPECT_TRUE(op->getTransB());
+    EXPECT_EQ(op->getInputs(3)->getDims(), (Shape{N, K}));
+    EXPECT_TRUE(g->checkValid());
+    runtime->run(g);
+    vector<uint8_t> out(M * N);
+    yq->copyout(out.data(), out.size());
+    for (int i = 0; i < M; ++i)
+        for (int j = 0; j < N; ++j) {
+            float acc = 0;
+            for (int k = 0; k < K; ++k)
+                acc += (xData[i * K + k] - xzData) * 0.02f *
+                       (wData[k * N + j] - wzData[j]) * wsData[j];
+            float ref =
+                std::clamp(std::nearbyint(acc / 0.5f) + yzData, 0.f, 255.f);
+            EXPECT_NEAR(out[i * N + j], ref, 1) << i << "," << j;
+        }
+}
+
+// Build DQ(x) -> Conv(DQ(w), DQ(bias)) -> Q, the QDQ form of a quantized
+// convolution, with the scales of x and w set and the given bias scale and
+// zero point.
+static Graph buildQDQConv(Runtime runtime, Tensor &yq,
+                          const vector<float> &biasScale,
+                          const vector<int32_t> &biasZero = {}) {
+    Graph g = make_ref<GraphObj>(runtime);
+    auto xq = g->addTensor({1, 2, 5, 5}, DataType::UInt8);
+    auto xs = g->addTensor({1}, DataType::Float32);
+    auto xz = g->addTensor({1}, DataType::UInt8);
+    auto wq = g->addTensor({3, 2, 3, 3}, DataType::Int8);
+    auto ws = g->addTensor({3}, DataType::Float32);
+    auto wz = g->addTensor({3}, DataType::Int8);
+    auto bq = g->addTensor({3}, DataType::Int32);
+    auto bs = g->addTensor({3}, DataType::Float32);
+    auto bz = biasZero.empty() ? nullptr : g->addTensor({3}, DataType::Int32);
+    auto ys = g->addTensor({1}, DataType::Float32);
+    auto yz = g->addTensor({1}, DataType::UInt8);
+    auto x = g->addOp<DequantizeLinearObj>(xq, xs, xz, nullptr)->getOutput();
+    auto w = g->addOp<DequantizeLinearObj>(wq, ws, wz, nullptr, 0)->getOutput();
+    auto b = g->addOp<DequantizeLinearObj>(bq, bs, bz, nullptr, 0)->getOutput();
+    auto y = g->addOp<ConvObj>(x, w, nullptr, 1, 1, b, 2, 1)->getOutput();
+    yq = g->addOp<QuantizeLinearObj>(y, ys, yz, nullptr)->getOutput();
+    g->dataMalloc();
+    xs->copyin(vector<float>{0.5f});
+    ws->copyin(vector<float>{0.1f, 0.2f, 0.05f});
+    bs->copyin(biasScale);
+    if (bz)
+        bz->copyin(biasZero.data(), biasZero.size() * sizeof(int32_t));
+    return g;
+}
+
+TEST(QLinearConv, FoldQDQ) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Tensor yq;
+    Graph g = buildQDQConv(runtime, yq, {0.05f, 0.1f, 0.025f});
+    EXPECT_TRUE(g->foldQuantizeDequantize());
+    ASSERT_EQ(g->getOperators().size(), 1u);
+    auto op = as<QLinearConvObj>(g->getOperators()[0]);
+    EXPECT_EQ(op->getOpType(), OpType::QLinearConv);
+    EXPECT_EQ(op->getOutput(), yq);
+    EXPECT_EQ(yq->getDims(), (Shape{1, 3, 3, 5}));
+    EXPECT_TRUE(g->checkValid());
+
+    const auto &in = op->getInputs();
+    vector<uint8_t> x(50);
+    vector<int8_t> w(54), wz{0, 1, -1};
+    for (int i = 0; i < 50; ++i)
+        x[i] = i * 5;
+    for (int i = 0; i < 54; ++i)
+        w[i] = int8_t(i % 7 - 3);
+    uint8_t xz = 10, yz = 128;
+    vector<float> ws{0.1f, 0.2f, 0.05f};
+    vector<int32_t> bias{100, -50, 0};
+    in[0]->copyin(x.data(), x.size());
+    in[1]->copyin(vector<float>{0.5f});
+    in[2]->copyin(&xz, 1);
+    in[3]->copyin(w.data(), w.size());
+    in[4]->copyin(ws);
+    in[5]->copyin(wz.data(), wz.size());
+    in[6]->copyin(vector<float>{2.f});
+    in[7]->copyin(&yz, 1);
+    in[8]->copyin(bias.data(), bias.size() * sizeof(int32_t));
+    runtime->run(g);
+    vector<uint8_t> out(45);
+    yq->copyout(out.data(), out.size());
+    // Float reference: pad 1, stride (2, 1).
+    for (int f = 0; f < 3; ++f)
+        for (int oh = 0; oh < 3; ++oh)
+            for (int ow = 0; ow < 5; ++ow) {
+                float acc = bias[f] * 0.5f * ws[f];
+                for (int c = 0; c < 2; ++c)
+                    for (int r = 0; r < 3; ++r)
+                        for (int s = 0; s < 3; ++s) {
+                            int ih = oh * 2 - 1 + r, iw = ow - 1 + s;
+                            if (ih < 0 || ih >= 5 || iw < 0 || iw >= 5)
+                                continue;
+                            acc += (x[(c * 5 + ih) * 5 + iw] - xz) * 0.5f *
+                                   (w[((f * 2 + c) * 3 + r) * 3 + s] - wz[f]) *
+                                   ws[f];
+                        }
+                float ref =
+                    std::clamp(std::nearbyint(acc / 2.f) + yz, 0.f, 255.f);
+                EXPECT_NEAR(out[(f * 3 + oh) * 5 + ow], ref, 1);
+            }
+}
+
+TEST(QLinearConv, KeepMismatchedBias) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Tensor yq;
+    // The bias scale of channel 1 is not xScale * wScale.
+    Graph g = buildQDQConv(runtime, yq, {0.05f, 0.2f, 0.025f});
+    EXPECT_FALSE(g->foldQuantizeDequantize());
+    EXPECT_EQ(g->getOperators().size(), 5u);
+    // A bias zero point other than 0 is not folded either.
+    g = buildQDQConv(runtime, yq, {0.05f, 0.1f, 0.025f}, {0, 1, 0});
+    EXPECT_FALSE(g->foldQuantizeDequantize());
+    EXPECT_EQ(g->getOperators().size(), 5u);
+}
+
+TEST(Calibration, GraphHandler) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    GraphHandlerObj handler(runtime);
+    auto x = handler.tensor({4}, 1);
+    auto y = handler.mul(x, x, nullptr);
+    handler.data_malloc();
+    x->copyin(vector<float>{-1, 0, 2, 0.5});
+    handler.calibrate();
+    x->copyin(vector<float>{-3, 0, 1, 0.5});
+    handler.calibrate();
+    auto ranges = handler.get_calibration();
+    EXPECT_EQ(ranges[x->getFuid()], std::make_pair(-3.f, 2.f));
+    EXPECT_EQ(ranges[y->getFuid()], std::make_pair(0.f, 9.f));
+}
+
+// Reference: dequantize the weights first, then multiply.
+static vector<float> reference(const vector<float> &a, const vector<float> &w,
+                               int M, int N, int K) {
+    vector<float> c(M * N, 0);
+    for (int m = 0; m < M; ++m)
+        for (int n = 0; n < N; ++n)
+            for (int k = 0; k < K; ++k)
+                c[m * N + n] += a[m * K + k] * w[n * K + k];
+    return c;
+}
+
+TEST(QuantizedMatmul, Int8) {
+    const int M = 2, N = 3, K = 8, G = 4;
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({M, K}, DataType::Float32);
+    auto b = g->addTensor({N, K}, DataType::Int8);
+    auto scale = g->addTensor({N, K / G}, DataType::Float32);
+    auto op =
+        g->addOp<QuantizedMatmulObj>(a, b, scale, nullptr, nullptr, 8, G);
+    g->dataMalloc();
+    vector<float> aData(M * K), sData(N * K / G), w(N * K);
+    vector<int8_t> bData(N * K);
+    for (int i = 0; i < M * K; ++i)
+        aData[i] = i * 0.25f - 1;
+    for (int i = 0; i < N * K / G; ++i)
+        sData[i] = 0.1f * (i + 1);
+    for (int i = 0; i < N * K; ++i) {
+        bData[i] = int8_t(i * 7 % 31 - 15);
+        w[i] = bData[i] * sData[i / G];
+    }
+    a->copyin(aData);
+    b->copyin(bData.data(), bData.size());
+    scale->copyin(sData);
+    runtime->run(g);
+    auto ans = reference(aData, w, M, N, K);
+    auto out = op->getOutput()->copyout<float>();
+    for (size_t i = 0; i < ans.size(); ++i)
+        EXPECT_NEAR(out[i], ans[i], 1e-4);
+}
+
+TEST(QuantizedMatmul, Int4) {
+    const int M = 1, N = 4, K = 8, G = 4;
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({1, M, K}, DataType::Float32);
+    auto b = g->addTensor({N, K / 2}, DataType::UInt8);
+    auto scale = g->addTensor({N, K / G}, DataType::Float32);
+    auto zp = g->addTensor({N, K / G}, DataType::UInt8);
+    auto op = g->addOp<QuantizedMatmulObj>(a, b, scale, zp, nullptr, 4, G);
+    EXPECT_EQ(op->getOutput()->getDims(), (Shape{1, M, N}));
+    g->dataMalloc();
+    vector<float> aData(M * K), sData(N * K / G), w(N * K);
+    vector<uint8_t> bData(N * K / 2), zpData(N * K / G);
+    for (int i = 0; i < M * K; ++i)
+        aData[i] = i - 3.5f;
+    for (int i = 0; i < N * K / G; ++i) {
+        sData[i] = 0.5f + i;
+        zpData[i] = i % 16;
+    }
+    for (int i = 0; i < N * K; ++i) {
+        uint8_t q = i * 5 % 16;
+        bData[i / 2] |= i % 2 ? q << 4 : q;
+        w[i] = (float(q) - zpData[i / G]) * sData[i / G];
+    }
+    a->copyin(aData);
+    b->copyin(bData.data(), bData.size());
+    scale->copyin(sData);
+    zp->copyin(zpData.data(), zpData.size());
+    runtime->run(g);
+    auto ans = reference(aData, w, M, N, K);
+    auto out = op->getOutput()->copyout<float>();
+    for (size_t i = 0; i < ans.size(); ++i)
+        EXPECT_NEAR(out[i], ans[i], 1e-3);
+}
+
+} // namespace infini